@@ -0,0 +1,503 @@
+#include <edyn/edyn.hpp>
+#include <edyn/networking/networking.hpp>
+#include <edyn/networking/sys/client_side.hpp>
+#include <edyn/networking/sys/server_side.hpp>
+#include <edyn/networking/comp/discontinuity.hpp>
+#include <edyn/networking/packet/edyn_packet.hpp>
+#include <edyn/serialization/memory_archive.hpp>
+#include <entt/entt.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Runs one server and a number of clients in the same process. Packets are
+ * exchanged through simulated links with latency, jitter and packet loss, and
+ * bandwidth and processing costs are reported at the end.
+ *
+ * Usage: network_benchmark [--clients N] [--bodies N] [--duration seconds]
+ *        [--warmup seconds] [--latency seconds] [--jitter seconds]
+ *        [--loss fraction] [--compact] [--budget bytes] [--no-extrapolation]
+ *        [--seed N]
+ */
+
+struct benchmark_config {
+    unsigned num_clients {10};
+    unsigned num_bodies {100};
+    double duration {10};
+    double warmup {2};
+    // One-way latency and maximum deviation from it, in seconds.
+    double latency {0.05};
+    double jitter {0.01};
+    double loss {0.01};
+    bool compact_snapshots {false};
+    size_t byte_budget {0};
+    bool extrapolation {true};
+    unsigned seed {1};
+};
+
+// Simulated time shared by all registries. Time only moves forward when the
+// main loop advances it, which allows running faster or slower than real time
+// depending on the load. It is read by extrapolation threads, thus atomic.
+static std::atomic<double> simulated_time {0};
+
+static double get_simulated_time() {
+    return simulated_time.load(std::memory_order_relaxed);
+}
+
+struct running_stats {
+    double sum {0};
+    double max {0};
+    size_t count {0};
+
+    void add(double value) {
+        sum += value;
+        max = std::max(max, value);
+        ++count;
+    }
+
+    double mean() const {
+        return count > 0 ? sum / count : 0;
+    }
+};
+
+// One-way link. Packets are serialized when sent and deserialized when
+// delivered, just like they would be over a real connection, which also gives
+// their size. Unreliable packets are dropped according to the loss rate.
+// Reliable packets are delivered in order and are delayed by one round-trip
+// for each time they are lost, as if they were retransmitted.
+class simulated_link {
+    struct in_flight_packet {
+        double delivery_time;
+        uint64_t sequence;
+        std::vector<uint8_t> data;
+
+        bool operator>(const in_flight_packet &other) const {
+            return delivery_time > other.delivery_time ||
+                   (delivery_time == other.delivery_time && sequence > other.sequence);
+        }
+    };
+
+public:
+    simulated_link(const benchmark_config &config, unsigned seed)
+        : m_latency(config.latency)
+        , m_jitter(config.jitter)
+        , m_loss(config.loss)
+        , m_random(seed)
+    {}
+
+    void send(const edyn::packet::edyn_packet &packet, double time) {
+        auto data = edyn::memory_output_archive::buffer_type{};
+        auto archive = edyn::memory_output_archive(data);
+        archive(packet);
+
+        bytes_sent += data.size();
+        ++packets_sent;
+
+        auto reliable = edyn::should_send_reliably(packet);
+        auto delay = 0.0;
+
+        while (m_uniform(m_random) < m_loss) {
+            if (!reliable) {
+                ++packets_lost;
+                return;
+            }
+
+            delay += 2 * m_latency;
+        }
+
+        delay += std::max(m_latency + m_jitter * (2 * m_uniform(m_random) - 1), 0.0);
+        auto delivery_time = time + delay;
+
+        if (reliable) {
+            delivery_time = std::max(delivery_time, m_last_reliable_delivery_time);
+            m_last_reliable_delivery_time = delivery_time;
+        }
+
+        m_in_flight.push_back({delivery_time, m_sequence++, std::move(data)});
+        std::push_heap(m_in_flight.begin(), m_in_flight.end(), std::greater<in_flight_packet>{});
+    }
+
+    template<typename Func>
+    void deliver(double time, Func func) {
+        while (!m_in_flight.empty() && m_in_flight.front().delivery_time <= time) {
+            std::pop_heap(m_in_flight.begin(), m_in_flight.end(), std::greater<in_flight_packet>{});
+            auto data = std::move(m_in_flight.back().data);
+            m_in_flight.pop_back();
+
+            auto packet = edyn::packet::edyn_packet{};
+            auto archive = edyn::memory_input_archive(data.data(), data.size());
+            archive(packet);
+
+            if (!archive.failed()) {
+                func(packet);
+            }
+        }
+    }
+
+    void reset_counters() {
+        bytes_sent = 0;
+        packets_sent = 0;
+        packets_lost = 0;
+    }
+
+    size_t bytes_sent {0};
+    size_t packets_sent {0};
+    size_t packets_lost {0};
+
+private:
+    double m_latency;
+    double m_jitter;
+    double m_loss;
+    std::mt19937 m_random;
+    std::uniform_real_distribution<double> m_uniform {0.0, 1.0};
+    std::vector<in_flight_packet> m_in_flight;
+    double m_last_reliable_delivery_time {0};
+    uint64_t m_sequence {0};
+};
+
+struct simulated_client {
+    simulated_client(const benchmark_config &config, unsigned index)
+        : index(index)
+        , uplink(config, config.seed * 7919 + index * 2)
+        , downlink(config, config.seed * 7919 + index * 2 + 1)
+    {}
+
+    void on_packet(const edyn::packet::edyn_packet &packet) {
+        uplink.send(packet, get_simulated_time());
+    }
+
+    void on_assigned(entt::entity) {
+        assigned = true;
+    }
+
+    void on_extrapolation_finished(double) {
+        // Extrapolations of consecutive snapshots are coalesced, thus measure
+        // from the oldest snapshot received since the last result.
+        if (!pending_snapshot_times.empty()) {
+            extrapolation_latency.add(edyn::performance_time() - pending_snapshot_times.front());
+            pending_snapshot_times.clear();
+        }
+    }
+
+    unsigned index;
+    entt::registry registry;
+    // Entity which represents this client in the server registry.
+    entt::entity server_entity {entt::null};
+    simulated_link uplink;
+    simulated_link downlink;
+    bool assigned {false};
+    entt::entity body {entt::null};
+    // Real time at which snapshots were received while awaiting extrapolation.
+    std::vector<double> pending_snapshot_times;
+    running_stats extrapolation_latency;
+    running_stats discontinuity;
+};
+
+class network_benchmark {
+public:
+    network_benchmark(const benchmark_config &config)
+        : m_config(config)
+    {
+    }
+
+    void run();
+
+private:
+    void init_registry(entt::registry &registry);
+    void create_server_bodies();
+    void create_client(unsigned index);
+    void update_client(simulated_client &client, double time, bool measure);
+    void on_server_packet(entt::entity client_entity, const edyn::packet::edyn_packet &packet);
+    void reset_counters();
+    void print_results(double wall_time) const;
+
+    benchmark_config m_config;
+    entt::registry m_server;
+    std::vector<std::unique_ptr<simulated_client>> m_clients;
+    std::unordered_map<entt::entity, simulated_client *> m_clients_by_entity;
+    running_stats m_server_network_update;
+    running_stats m_server_step;
+    running_stats m_client_update;
+};
+
+void network_benchmark::init_registry(entt::registry &registry) {
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    config.timestamp = get_simulated_time();
+    edyn::attach(registry, config);
+    edyn::set_time_source(registry, &get_simulated_time);
+
+    // The floor is not networked and is created locally everywhere.
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(registry, floor_def);
+}
+
+void network_benchmark::create_server_bodies() {
+    // Stack boxes in a square grid of columns.
+    auto columns = static_cast<unsigned>(std::ceil(std::sqrt(m_config.num_bodies / 4.0)));
+
+    auto def = edyn::rigidbody_def{};
+    def.mass = 10;
+    def.shape = edyn::box_shape{{0.4, 0.4, 0.4}};
+    def.networked = true;
+
+    for (unsigned i = 0; i < m_config.num_bodies; ++i) {
+        auto column = i % (columns * columns);
+        auto level = i / (columns * columns);
+        def.position = {
+            edyn::scalar(column % columns) * 2 - columns,
+            edyn::scalar(0.4 + level * 0.81),
+            edyn::scalar(column / columns) * 2 - columns
+        };
+        edyn::make_rigidbody(m_server, def);
+    }
+}
+
+void network_benchmark::create_client(unsigned index) {
+    auto &client = *m_clients.emplace_back(std::make_unique<simulated_client>(m_config, index));
+
+    init_registry(client.registry);
+    edyn::init_network_client(client.registry);
+    edyn::set_network_client_extrapolation_enabled(client.registry, m_config.extrapolation);
+
+    edyn::network_client_packet_sink(client.registry).connect<&simulated_client::on_packet>(client);
+    edyn::network_client_assigned_sink(client.registry).connect<&simulated_client::on_assigned>(client);
+    edyn::network_client_extrapolation_finished_sink(client.registry)
+        .connect<&simulated_client::on_extrapolation_finished>(client);
+
+    client.server_entity = edyn::server_make_client(m_server);
+    m_clients_by_entity[client.server_entity] = &client;
+}
+
+void network_benchmark::on_server_packet(entt::entity client_entity, const edyn::packet::edyn_packet &packet) {
+    m_clients_by_entity.at(client_entity)->downlink.send(packet, get_simulated_time());
+}
+
+void network_benchmark::update_client(simulated_client &client, double time, bool measure) {
+    client.downlink.deliver(time, [&](edyn::packet::edyn_packet &packet) {
+        if (std::holds_alternative<edyn::packet::registry_snapshot>(packet.var) ||
+            std::holds_alternative<edyn::packet::compact_registry_snapshot>(packet.var)) {
+            client.pending_snapshot_times.push_back(edyn::performance_time());
+        }
+
+        edyn::client_receive_packet(client.registry, packet);
+    });
+
+    // Each client controls one body once connected, which is pushed around
+    // periodically so it has state to send to the server.
+    if (client.assigned && client.body == entt::null) {
+        auto def = edyn::rigidbody_def{};
+        def.mass = 50;
+        def.shape = edyn::sphere_shape{0.5};
+        def.networked = true;
+        auto angle = edyn::scalar(client.index);
+        def.position = {std::cos(angle) * 20, 0.5, std::sin(angle) * 20};
+        client.body = edyn::make_rigidbody(client.registry, def);
+    }
+
+    if (client.body != entt::null && std::fmod(time, 1.0) < edyn::get_fixed_dt(client.registry)) {
+        auto angle = edyn::scalar(time + client.index);
+        auto impulse = edyn::vector3{std::cos(angle), 0, std::sin(angle)} * 100;
+        edyn::rigidbody_apply_impulse(client.registry, client.body, impulse, edyn::vector3_zero);
+    }
+
+    edyn::update_network_client(client.registry);
+    edyn::update(client.registry, time);
+
+    if (measure) {
+        for (auto [entity, discontinuity] : client.registry.view<edyn::discontinuity>().each()) {
+            client.discontinuity.add(edyn::length(discontinuity.position_offset));
+        }
+    }
+}
+
+void network_benchmark::reset_counters() {
+    for (auto &client : m_clients) {
+        client->uplink.reset_counters();
+        client->downlink.reset_counters();
+        client->extrapolation_latency = {};
+        client->discontinuity = {};
+    }
+
+    m_server_network_update = {};
+    m_server_step = {};
+    m_client_update = {};
+}
+
+void network_benchmark::run() {
+    init_registry(m_server);
+    edyn::init_network_server(m_server);
+
+    auto &server_settings = std::get<edyn::server_network_settings>(
+        m_server.ctx().at<edyn::settings>().network_settings);
+    server_settings.compact_snapshots = m_config.compact_snapshots;
+    server_settings.priority.byte_budget = m_config.byte_budget;
+
+    edyn::network_server_packet_sink(m_server).connect<&network_benchmark::on_server_packet>(*this);
+
+    create_server_bodies();
+
+    for (unsigned i = 0; i < m_config.num_clients; ++i) {
+        create_client(i);
+    }
+
+    auto dt = double(edyn::get_fixed_dt(m_server));
+    auto num_ticks = static_cast<size_t>(std::ceil((m_config.warmup + m_config.duration) / dt));
+    auto warmup_ticks = static_cast<size_t>(std::ceil(m_config.warmup / dt));
+    auto wall_start = edyn::performance_time();
+
+    for (size_t tick = 0; tick < num_ticks; ++tick) {
+        if (tick == warmup_ticks) {
+            reset_counters();
+            wall_start = edyn::performance_time();
+        }
+
+        auto measure = tick >= warmup_ticks;
+        auto time = (tick + 1) * dt;
+        simulated_time.store(time, std::memory_order_relaxed);
+
+        for (auto &client : m_clients) {
+            client->uplink.deliver(time, [&](edyn::packet::edyn_packet &packet) {
+                edyn::server_receive_packet(m_server, client->server_entity, packet);
+            });
+        }
+
+        auto t0 = edyn::performance_time();
+        edyn::update_network_server(m_server);
+        auto t1 = edyn::performance_time();
+        edyn::update(m_server, time);
+        auto t2 = edyn::performance_time();
+
+        for (auto &client : m_clients) {
+            update_client(*client, time, measure);
+        }
+
+        auto t3 = edyn::performance_time();
+
+        if (measure) {
+            m_server_network_update.add(t1 - t0);
+            m_server_step.add(t2 - t1);
+            m_client_update.add((t3 - t2) / std::max<size_t>(m_clients.size(), 1));
+        }
+    }
+
+    print_results(edyn::performance_time() - wall_start);
+
+    for (auto &client : m_clients) {
+        edyn::deinit_network_client(client->registry);
+    }
+
+    edyn::deinit_network_server(m_server);
+
+    for (auto &client : m_clients) {
+        edyn::detach(client->registry);
+    }
+
+    edyn::detach(m_server);
+}
+
+void network_benchmark::print_results(double wall_time) const {
+    auto downlink = running_stats{};
+    auto uplink = running_stats{};
+    auto extrapolation_latency = running_stats{};
+    auto discontinuity = running_stats{};
+    size_t packets_sent = 0, packets_lost = 0;
+
+    for (auto &client : m_clients) {
+        downlink.add(client->downlink.bytes_sent / m_config.duration);
+        uplink.add(client->uplink.bytes_sent / m_config.duration);
+        packets_sent += client->downlink.packets_sent + client->uplink.packets_sent;
+        packets_lost += client->downlink.packets_lost + client->uplink.packets_lost;
+
+        extrapolation_latency.sum += client->extrapolation_latency.sum;
+        extrapolation_latency.count += client->extrapolation_latency.count;
+        extrapolation_latency.max = std::max(extrapolation_latency.max, client->extrapolation_latency.max);
+
+        discontinuity.sum += client->discontinuity.sum;
+        discontinuity.count += client->discontinuity.count;
+        discontinuity.max = std::max(discontinuity.max, client->discontinuity.max);
+    }
+
+    printf("clients: %u, bodies: %u, latency: %.0f ms, jitter: %.0f ms, loss: %.1f%%\n",
+           m_config.num_clients, m_config.num_bodies, m_config.latency * 1000,
+           m_config.jitter * 1000, m_config.loss * 100);
+    printf("simulated: %.1f s, real: %.2f s\n", m_config.duration, wall_time);
+    printf("server to client: %.0f B/s per client (max %.0f)\n", downlink.mean(), downlink.max);
+    printf("client to server: %.0f B/s per client (max %.0f)\n", uplink.mean(), uplink.max);
+    printf("packets: %zu sent, %zu lost\n", packets_sent, packets_lost);
+    printf("server network update (snapshot export): %.3f ms per tick (max %.3f)\n",
+           m_server_network_update.mean() * 1000, m_server_network_update.max * 1000);
+    printf("server simulation step: %.3f ms per tick (max %.3f)\n",
+           m_server_step.mean() * 1000, m_server_step.max * 1000);
+    printf("client update: %.3f ms per client per tick (max %.3f)\n",
+           m_client_update.mean() * 1000, m_client_update.max * 1000);
+    printf("extrapolation latency: %.2f ms (max %.2f) over %zu results\n",
+           extrapolation_latency.mean() * 1000, extrapolation_latency.max * 1000,
+           extrapolation_latency.count);
+    printf("discontinuity: %.4f m (max %.4f)\n", discontinuity.mean(), discontinuity.max);
+}
+
+static bool parse_args(int argc, char **argv, benchmark_config &config) {
+    for (int i = 1; i < argc; ++i) {
+        auto arg = argv[i];
+        auto has_value = i + 1 < argc;
+
+        if (strcmp(arg, "--compact") == 0) {
+            config.compact_snapshots = true;
+        } else if (strcmp(arg, "--no-extrapolation") == 0) {
+            config.extrapolation = false;
+        } else if (has_value && strcmp(arg, "--clients") == 0) {
+            config.num_clients = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--bodies") == 0) {
+            config.num_bodies = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--duration") == 0) {
+            config.duration = std::strtod(argv[++i], nullptr);
+        } else if (has_value && strcmp(arg, "--warmup") == 0) {
+            config.warmup = std::strtod(argv[++i], nullptr);
+        } else if (has_value && strcmp(arg, "--latency") == 0) {
+            config.latency = std::strtod(argv[++i], nullptr);
+        } else if (has_value && strcmp(arg, "--jitter") == 0) {
+            config.jitter = std::strtod(argv[++i], nullptr);
+        } else if (has_value && strcmp(arg, "--loss") == 0) {
+            config.loss = std::strtod(argv[++i], nullptr);
+        } else if (has_value && strcmp(arg, "--budget") == 0) {
+            config.byte_budget = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--seed") == 0) {
+            config.seed = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            printf("Unknown or incomplete argument: %s\n", arg);
+            return false;
+        }
+    }
+
+    if (config.duration <= 0 || config.loss < 0 || config.loss >= 1) {
+        printf("Duration must be positive and loss must be in [0, 1).\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    auto config = benchmark_config{};
+
+    if (!parse_args(argc, argv, config)) {
+        return 1;
+    }
+
+    auto benchmark = network_benchmark(config);
+    benchmark.run();
+
+    return 0;
+}
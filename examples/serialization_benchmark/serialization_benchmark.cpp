@@ -0,0 +1,216 @@
+#include <edyn/edyn.hpp>
+#include <edyn/time/time.hpp>
+#include <edyn/util/shape_util.hpp>
+#include <edyn/serialization/memory_archive.hpp>
+#include <edyn/serialization/file_archive.hpp>
+#include <edyn/serialization/triangle_mesh_s11n.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Serializes a large triangle mesh into memory and into a file and reports
+ * the throughput of writing and reading it back. The same is done with an
+ * archive which serializes arrays element by element, for comparison.
+ *
+ * Usage: serialization_benchmark [--vertices N] [--repetitions N]
+ *        [--file path]
+ */
+
+struct benchmark_config {
+    // Number of vertices along each side of the mesh.
+    unsigned num_vertices {256};
+    unsigned repetitions {5};
+    const char *path {"serialization_benchmark.bin"};
+};
+
+// Forwards values to another archive without exposing support for arrays,
+// thus every element of every array is serialized individually.
+template<typename Archive>
+class elementwise_archive {
+public:
+    using is_input = typename Archive::is_input;
+    using is_output = typename Archive::is_output;
+
+    elementwise_archive(Archive &archive)
+        : m_archive(&archive)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            (*m_archive)(t);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+private:
+    Archive *m_archive;
+};
+
+static edyn::triangle_mesh make_mesh(unsigned num_vertices) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    auto extent = edyn::scalar(num_vertices);
+    edyn::make_plane_mesh(extent, extent, num_vertices, num_vertices, vertices, indices);
+
+    for (auto &vertex : vertices) {
+        vertex.y = std::sin(vertex.x * edyn::scalar(0.1)) * std::cos(vertex.z * edyn::scalar(0.1));
+    }
+
+    auto trimesh = edyn::triangle_mesh();
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+
+    return trimesh;
+}
+
+template<typename Func>
+static double measure(unsigned repetitions, Func func) {
+    auto best = std::numeric_limits<double>::max();
+
+    for (unsigned i = 0; i < repetitions; ++i) {
+        auto start = edyn::performance_time();
+        func();
+        best = std::min(best, edyn::performance_time() - start);
+    }
+
+    return best;
+}
+
+static void report(const char *name, size_t num_bytes, double seconds) {
+    auto megabytes = double(num_bytes) / (1024 * 1024);
+    printf("%-28s %10.2f ms %10.1f MB/s\n", name, seconds * 1000, megabytes / seconds);
+}
+
+template<bool Elementwise>
+static void run_memory(const benchmark_config &config, edyn::triangle_mesh &trimesh) {
+    auto buffer = edyn::memory_output_archive::buffer_type{};
+    const char *suffix = Elementwise ? " (elementwise)" : "";
+    char name[64];
+
+    auto write_time = measure(config.repetitions, [&]() {
+        buffer.clear();
+        auto output = edyn::memory_output_archive(buffer);
+
+        if constexpr(Elementwise) {
+            auto archive = elementwise_archive(output);
+            serialize(archive, trimesh);
+        } else {
+            serialize(output, trimesh);
+        }
+    });
+
+    snprintf(name, sizeof(name), "memory write%s", suffix);
+    report(name, buffer.size(), write_time);
+
+    auto read_time = measure(config.repetitions, [&]() {
+        auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+        auto result = edyn::triangle_mesh();
+
+        if constexpr(Elementwise) {
+            auto archive = elementwise_archive(input);
+            serialize(archive, result);
+        } else {
+            serialize(input, result);
+        }
+    });
+
+    snprintf(name, sizeof(name), "memory read%s", suffix);
+    report(name, buffer.size(), read_time);
+}
+
+template<bool Elementwise>
+static void run_file(const benchmark_config &config, edyn::triangle_mesh &trimesh) {
+    const char *suffix = Elementwise ? " (elementwise)" : "";
+    char name[64];
+
+    auto write_time = measure(config.repetitions, [&]() {
+        auto output = edyn::file_output_archive(config.path);
+
+        if constexpr(Elementwise) {
+            auto archive = elementwise_archive(output);
+            serialize(archive, trimesh);
+        } else {
+            serialize(output, trimesh);
+        }
+    });
+
+    auto num_bytes = edyn::serialization_sizeof(trimesh);
+    snprintf(name, sizeof(name), "file write%s", suffix);
+    report(name, num_bytes, write_time);
+
+    auto read_time = measure(config.repetitions, [&]() {
+        auto input = edyn::file_input_archive(config.path);
+        auto result = edyn::triangle_mesh();
+
+        if constexpr(Elementwise) {
+            auto archive = elementwise_archive(input);
+            serialize(archive, result);
+        } else {
+            serialize(input, result);
+        }
+    });
+
+    snprintf(name, sizeof(name), "file read%s", suffix);
+    report(name, num_bytes, read_time);
+}
+
+static bool parse_args(int argc, char **argv, benchmark_config &config) {
+    for (int i = 1; i < argc; ++i) {
+        auto arg = argv[i];
+        auto has_value = i + 1 < argc;
+
+        if (has_value && strcmp(arg, "--vertices") == 0) {
+            config.num_vertices = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--repetitions") == 0) {
+            config.repetitions = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--file") == 0) {
+            config.path = argv[++i];
+        } else {
+            printf("Unknown or incomplete argument: %s\n", arg);
+            return false;
+        }
+    }
+
+    if (config.num_vertices < 2 || config.repetitions == 0) {
+        printf("Vertices must be at least 2 and repetitions must be positive.\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    auto config = benchmark_config{};
+
+    if (!parse_args(argc, argv, config)) {
+        return 1;
+    }
+
+    auto trimesh = make_mesh(config.num_vertices);
+    printf("Mesh with %zu vertices, %zu triangles, %zu bytes serialized.\n",
+           trimesh.num_vertices(), trimesh.num_triangles(),
+           edyn::serialization_sizeof(trimesh));
+
+    run_memory<false>(config, trimesh);
+    run_memory<true>(config, trimesh);
+    run_file<false>(config, trimesh);
+    run_file<true>(config, trimesh);
+
+    std::remove(config.path);
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <edyn/edyn.hpp>
+#include <edyn/time/time.hpp>
+#include <edyn/util/shape_util.hpp>
+#include <edyn/serialization/world_snapshot.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/*
+ * Compares restoring a world from a snapshot against creating it again from
+ * scratch. The world has a static triangle mesh terrain and a grid of boxes
+ * resting on it. Recreating it involves calculating the adjacency and the
+ * tree of the mesh and the mass properties of every body, while restoring it
+ * copies the stored state back into the registry. Both are followed by the
+ * first step, where bodies are inserted into the broadphase and islands are
+ * formed, unless they were restored.
+ *
+ * Usage: world_snapshot_benchmark [--bodies N] [--vertices N]
+ *        [--repetitions N]
+ */
+
+struct benchmark_config {
+    unsigned num_bodies {4096};
+    // Number of vertices along each side of the terrain.
+    unsigned num_vertices {256};
+    unsigned repetitions {5};
+};
+
+static std::shared_ptr<edyn::triangle_mesh> make_terrain(unsigned num_vertices) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    auto extent = edyn::scalar(num_vertices);
+    edyn::make_plane_mesh(extent, extent, num_vertices, num_vertices, vertices, indices);
+
+    for (auto &vertex : vertices) {
+        vertex.y = std::sin(vertex.x * edyn::scalar(0.1)) * std::cos(vertex.z * edyn::scalar(0.1));
+    }
+
+    auto trimesh = std::make_shared<edyn::triangle_mesh>();
+    trimesh->insert_vertices(vertices.begin(), vertices.end());
+    trimesh->insert_indices(indices.begin(), indices.end());
+    trimesh->initialize();
+
+    return trimesh;
+}
+
+static void make_world(entt::registry &registry, const benchmark_config &config) {
+    auto terrain_def = edyn::rigidbody_def{};
+    terrain_def.kind = edyn::rigidbody_kind::rb_static;
+    terrain_def.shape = edyn::mesh_shape{make_terrain(config.num_vertices)};
+    edyn::make_rigidbody(registry, terrain_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.mass = 10;
+
+    auto side = static_cast<unsigned>(std::ceil(std::sqrt(double(config.num_bodies))));
+    auto spacing = edyn::scalar(config.num_vertices) / edyn::scalar(side + 1);
+
+    for (unsigned i = 0; i < config.num_bodies; ++i) {
+        auto x = (edyn::scalar(i % side) + 1) * spacing - edyn::scalar(config.num_vertices) / 2;
+        auto z = (edyn::scalar(i / side) + 1) * spacing - edyn::scalar(config.num_vertices) / 2;
+        def.position = {x, 2, z};
+        edyn::make_rigidbody(registry, def);
+    }
+}
+
+// Runs `func` in a fresh registry after `setup` and returns the shortest
+// time `func` took.
+template<typename Setup, typename Func>
+static double measure(unsigned repetitions, Setup setup, Func func) {
+    auto best = std::numeric_limits<double>::max();
+
+    for (unsigned i = 0; i < repetitions; ++i) {
+        entt::registry registry;
+        // Snapshots are only supported in the sequential execution modes.
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+        setup(registry);
+
+        auto start = edyn::performance_time();
+        func(registry);
+        best = std::min(best, edyn::performance_time() - start);
+
+        edyn::detach(registry);
+    }
+
+    return best;
+}
+
+static void report(const char *name, double seconds) {
+    printf("%-16s %10.2f ms\n", name, seconds * 1000);
+}
+
+static bool parse_args(int argc, char **argv, benchmark_config &config) {
+    for (int i = 1; i < argc; ++i) {
+        auto arg = argv[i];
+        auto has_value = i + 1 < argc;
+
+        if (has_value && strcmp(arg, "--bodies") == 0) {
+            config.num_bodies = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--vertices") == 0) {
+            config.num_vertices = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && strcmp(arg, "--repetitions") == 0) {
+            config.repetitions = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            printf("Unknown or incomplete argument: %s\n", arg);
+            return false;
+        }
+    }
+
+    if (config.num_vertices < 2 || config.repetitions == 0) {
+        printf("Vertices must be at least 2 and repetitions must be positive.\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    auto config = benchmark_config{};
+
+    if (!parse_args(argc, argv, config)) {
+        return 1;
+    }
+
+    auto buffer = std::vector<uint8_t>{};
+    auto no_setup = [](entt::registry &) {};
+
+    auto recreate_time = measure(config.repetitions, no_setup, [&](entt::registry &registry) {
+        make_world(registry, config);
+        edyn::step_simulation(registry);
+    });
+
+    // The world is stepped once before it is written, thus the snapshot holds
+    // its islands.
+    auto write_time = measure(config.repetitions, [&](entt::registry &registry) {
+        make_world(registry, config);
+        edyn::step_simulation(registry);
+        buffer.clear();
+    }, [&](entt::registry &registry) {
+        edyn::write_world_snapshot(registry, buffer);
+    });
+
+    printf("%u bodies, terrain with %u vertices, snapshot of %zu bytes.\n",
+           config.num_bodies, config.num_vertices * config.num_vertices, buffer.size());
+
+    auto restore_time = measure(config.repetitions, no_setup, [&](entt::registry &registry) {
+        if (!edyn::read_world_snapshot(registry, buffer.data(), buffer.size())) {
+            printf("Failed to read snapshot.\n");
+            std::exit(1);
+        }
+
+        edyn::step_simulation(registry);
+    });
+
+    report("recreate", recreate_time);
+    report("restore", restore_time);
+    report("write", write_time);
+    printf("Restoring is %.1fx faster than recreating.\n", recreate_time / restore_time);
+
+    return 0;
+}
@@ -22,11 +22,12 @@ class broadphase final {
 
     void collide_tree(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb) const;
     void collide_tree_async(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb, size_t result_index);
-    void collide_parallel();
-    void finish_collide();
+    void collide_deferred(bool mt);
+    void finish_collide(bool canonical);
 
     void on_construct_aabb(entt::registry &, entt::entity);
     void on_destroy_aabb(entt::registry &, entt::entity);
+    void on_update_aabb(entt::registry &, entt::entity);
     void on_destroy_tree_resident(entt::registry &, entt::entity);
     void on_construct_island_aabb(entt::registry &, entt::entity);
     void on_destroy_island_tree_resident(entt::registry &, entt::entity);
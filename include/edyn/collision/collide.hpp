@@ -63,6 +63,30 @@ void collide(const polyhedron_shape &poly, const triangle_mesh &mesh,
 void collide(const compound_shape &compound, const triangle_mesh &mesh,
              const collision_context &ctx, collision_result &result);
 
+// Sphere-Heightfield
+void collide(const sphere_shape &sphere, const heightfield &field,
+             const collision_context &ctx, collision_result &result);
+
+// Cylinder-Heightfield
+void collide(const cylinder_shape &cylinder, const heightfield &field,
+             const collision_context &ctx, collision_result &result);
+
+// Capsule-Heightfield
+void collide(const capsule_shape &capsule, const heightfield &field,
+             const collision_context &ctx, collision_result &result);
+
+// Box-Heightfield
+void collide(const box_shape &box, const heightfield &field,
+             const collision_context &ctx, collision_result &result);
+
+// Polyhedron-Heightfield
+void collide(const polyhedron_shape &poly, const heightfield &field,
+             const collision_context &ctx, collision_result &result);
+
+// Compound-Heightfield
+void collide(const compound_shape &compound, const heightfield &field,
+             const collision_context &ctx, collision_result &result);
+
 // Sphere-Sphere
 void collide(const sphere_shape &shA, const sphere_shape &shB,
              const collision_context &ctx, collision_result &result);
@@ -222,6 +246,55 @@ void collide(const paged_mesh_shape &shA, const mesh_shape &shB,
     swap_collide(shA, shB, ctx, result);
 }
 
+// Heightfield-Heightfield
+inline
+void collide(const heightfield_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between heightfields is undefined.
+}
+
+// Plane-Heightfield
+inline
+void collide(const plane_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between heightfields and planes is undefined.
+}
+
+// Heightfield-Plane
+inline
+void collide(const heightfield_shape &shA, const plane_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
+// Mesh-Heightfield
+inline
+void collide(const mesh_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between triangle meshes and heightfields is undefined.
+}
+
+// Heightfield-Mesh
+inline
+void collide(const heightfield_shape &shA, const mesh_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
+// Paged Mesh-Heightfield
+inline
+void collide(const paged_mesh_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between paged triangle meshes and heightfields is undefined.
+}
+
+// Heightfield-Paged Mesh
+inline
+void collide(const heightfield_shape &shA, const paged_mesh_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
 // Polyhedron-Polyhedron
 void collide(const polyhedron_shape &shA, const polyhedron_shape &shB,
              const collision_context &ctx, collision_result &result);
@@ -366,6 +439,27 @@ void collide(const paged_mesh_shape &shA, const T &shB,
     swap_collide(shA, shB, ctx, result);
 }
 
+// Box/Sphere/Cylinder/Capsule/Polyhedron/Compound-Heightfield
+template<typename T>
+void collide(const T &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // Inset AABB to load nearby tiles.
+    constexpr auto inset = vector3 {
+        -contact_breaking_threshold,
+        -contact_breaking_threshold,
+        -contact_breaking_threshold
+    };
+    shB.field->prefetch(ctx.aabbA.inset(inset));
+    collide(shA, *shB.field, ctx, result);
+}
+
+// Heightfield-Box/Sphere/Cylinder/Capsule/Polyhedron/Compound
+template<typename T>
+void collide(const heightfield_shape &shA, const T &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
 template<typename ShapeAType, typename ShapeBType>
 void swap_collide(const ShapeAType &shA, const ShapeBType &shB,
                   const collision_context &ctx, collision_result &result) {
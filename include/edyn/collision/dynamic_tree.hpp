@@ -32,6 +32,14 @@ private:
     void refit(tree_node_id_t);
     tree_node_id_t balance(tree_node_id_t);
 
+    // Leaf node and the center of its AABB, used when building the tree.
+    struct build_leaf {
+        vector3 center;
+        tree_node_id_t id;
+    };
+
+    tree_node_id_t build(build_leaf *leaves, size_t count);
+
 public:
     dynamic_tree();
 
@@ -46,6 +54,21 @@ public:
      */
     tree_node_id_t create(const AABB &, entt::entity);
 
+    /**
+     * @brief Creates many leaf nodes at once.
+     *
+     * If the tree is empty, the leaves are arranged into a balanced hierarchy
+     * built top-down, which is much faster than inserting them one by one.
+     * Otherwise, each leaf is inserted as in `create`.
+     *
+     * @param aabbs The leaf node AABBs.
+     * @param entities The entities associated with each leaf node.
+     * @param count Number of leaf nodes.
+     * @param ids Receives the new node ids, in the same order.
+     */
+    void create(const AABB *aabbs, const entt::entity *entities, size_t count,
+                tree_node_id_t *ids);
+
     /**
      * @brief Attempts to change the AABB of a node.
      *
@@ -28,7 +28,7 @@ class narrowphase {
         size_t count {0};
     };
 
-    void detect_collision_parallel();
+    void detect_collision_deferred(bool mt);
     void finish_detect_collision();
     void clear_contact_manifold_events();
 
@@ -26,6 +26,7 @@ struct compound_shape;
 struct plane_shape;
 struct mesh_shape;
 struct paged_mesh_shape;
+struct heightfield_shape;
 
 /**
  * @brief Info provided when raycasting a box.
@@ -81,6 +82,14 @@ struct paged_mesh_raycast_info {
     size_t triangle_index;
 };
 
+/**
+ * @brief Info provided when raycasting a heightfield.
+ */
+struct heightfield_raycast_info {
+    // Index of triangle the ray intersects.
+    size_t triangle_index;
+};
+
 /**
  * @brief Info provided when raycasting a compound.
  */
@@ -116,7 +125,8 @@ struct shape_raycast_result {
         polyhedron_raycast_info,
         compound_raycast_info,
         mesh_raycast_info,
-        paged_mesh_raycast_info
+        paged_mesh_raycast_info,
+        heightfield_raycast_info
     > info_var;
 };
 
@@ -192,6 +202,7 @@ shape_raycast_result shape_raycast(const compound_shape &, const raycast_context
 shape_raycast_result shape_raycast(const plane_shape &, const raycast_context &);
 shape_raycast_result shape_raycast(const mesh_shape &, const raycast_context &);
 shape_raycast_result shape_raycast(const paged_mesh_shape &, const raycast_context &);
+shape_raycast_result shape_raycast(const heightfield_shape &, const raycast_context &);
 
 }
 
@@ -2,44 +2,255 @@
 #define EDYN_COLLISION_STATIC_TREE_HPP
 
 #include "edyn/comp/aabb.hpp"
+#include <array>
 #include <vector>
+#include <utility>
 #include <iterator>
 #include <numeric>
 #include <algorithm>
 #include "edyn/collision/query_tree.hpp"
+#include "edyn/parallel/parallel_for.hpp"
 
 namespace edyn {
 
 constexpr uint32_t EDYN_NULL_NODE = UINT32_MAX;
 
+/**
+ * @brief Parameters for building a `static_tree`.
+ */
+struct static_tree_build_config {
+    // Maximum number of objects in each leaf.
+    uint32_t max_obj_per_leaf {1};
+    // Number of bins along the split axis where split candidates are
+    // evaluated using the surface area heuristic.
+    uint32_t num_bins {16};
+    // Subtrees with at most this many objects are built as separate jobs in
+    // the global `job_dispatcher`. Set to zero to build in the calling thread.
+    // Nested parallel loops are not supported, thus trees are always built in
+    // the calling thread if it is a worker of a `job_dispatcher`, since it
+    // would otherwise occupy a worker while waiting for the jobs it dispatched.
+    size_t parallel_threshold {4096};
+    // Also create a 4-ary version of the tree which is used in queries and
+    // raycasts. It's not serialized.
+    bool wide {false};
+};
+
 namespace detail {
-    template<typename Iterator_AABB, typename Iterator_ids>
-    Iterator_ids aabb_set_partition(Iterator_AABB aabb_begin, Iterator_AABB aabb_end,
-                                    Iterator_ids ids_begin, Iterator_ids ids_end,
-                                    const AABB &set_aabb) {
-        auto aabb_size = set_aabb.max - set_aabb.min;
-        auto split_axis_idx = max_index(aabb_size);
-        auto split_pos = set_aabb.center()[split_axis_idx];
-
-        std::sort(ids_begin, ids_end, [&](auto a, auto b) {
-            auto &b0 = *(aabb_begin + a);
-            auto &b1 = *(aabb_begin + b);
-            auto ca = b0.center();
-            auto cb = b1.center();
-            return ca[split_axis_idx] < cb[split_axis_idx];
-        });
+    // Node used while building a `static_tree`. Leaves store the range of
+    // object ids they contain.
+    struct static_tree_build_node {
+        AABB aabb;
+        uint32_t child1;
+        uint32_t child2;
+        uint32_t begin;
+        uint32_t end;
+    };
 
-        for (auto it = ids_begin; it != ids_end; ++it) {
-            auto &aabb = *(aabb_begin + *it);
-            auto center = aabb.center();
+    // Builds a subtree over a range of object ids using the binned surface
+    // area heuristic. Nodes are processed from an explicit stack, thus the
+    // depth of the tree is not limited by the size of the call stack.
+    template<typename Iterator_AABB>
+    class static_tree_builder {
+    public:
+        struct subtree {
+            uint32_t node;
+            uint32_t begin;
+            uint32_t end;
+        };
 
-            if (center[split_axis_idx] > split_pos) {
-                return it;
+        struct bin {
+            AABB aabb;
+            uint32_t count;
+        };
+
+        // Buffers reused across splits.
+        struct scratch {
+            std::vector<bin> bins;
+            std::vector<scalar> right_cost;
+        };
+
+        static_tree_builder(Iterator_AABB aabb_begin, const std::vector<vector3> &centers,
+                            std::vector<uint32_t> &ids, const static_tree_build_config &config)
+            : m_aabb_begin(aabb_begin)
+            , m_centers(&centers)
+            , m_ids(&ids)
+            , m_config(&config)
+        {}
+
+        // Builds the tree over the range `[begin, end)` of ids into `nodes`
+        // with the root at index `root`, which must already exist. Ranges with
+        // no more than `defer_threshold` ids and which are not leaves are not
+        // built and are appended to `deferred` instead.
+        void build(std::vector<static_tree_build_node> &nodes, uint32_t root,
+                   uint32_t begin, uint32_t end, size_t defer_threshold,
+                   std::vector<subtree> *deferred) const {
+            std::vector<subtree> stack;
+            stack.push_back({root, begin, end});
+
+            auto buffers = scratch{};
+            buffers.bins.resize(m_config->num_bins);
+            buffers.right_cost.resize(m_config->num_bins);
+
+            while (!stack.empty()) {
+                auto task = stack.back();
+                stack.pop_back();
+
+                auto [aabb, center_aabb] = range_bounds(task.begin, task.end);
+                auto &node = nodes[task.node];
+                node.aabb = aabb;
+                node.begin = task.begin;
+                node.end = task.end;
+
+                auto count = task.end - task.begin;
+
+                if (count <= m_config->max_obj_per_leaf) {
+                    node.child1 = EDYN_NULL_NODE;
+                    node.child2 = EDYN_NULL_NODE;
+                    continue;
+                }
+
+                if (deferred != nullptr && count <= defer_threshold && task.node != root) {
+                    deferred->push_back(task);
+                    continue;
+                }
+
+                auto middle = partition(task.begin, task.end, center_aabb, buffers);
+                auto child1 = static_cast<uint32_t>(nodes.size());
+                auto child2 = child1 + 1;
+                nodes[task.node].child1 = child1;
+                nodes[task.node].child2 = child2;
+                nodes.emplace_back();
+                nodes.emplace_back();
+
+                // Push second child first so the first child is processed
+                // first, which keeps siblings close in memory.
+                stack.push_back({child2, middle, task.end});
+                stack.push_back({child1, task.begin, middle});
             }
         }
 
-        return ids_begin + std::distance(ids_begin, ids_end) / 2;
-    }
+    private:
+        std::pair<AABB, AABB> range_bounds(uint32_t begin, uint32_t end) const {
+            auto &ids = *m_ids;
+            auto &centers = *m_centers;
+            auto aabb = *(m_aabb_begin + ids[begin]);
+            auto center_aabb = AABB{centers[ids[begin]], centers[ids[begin]]};
+
+            for (auto i = begin + 1; i < end; ++i) {
+                auto id = ids[i];
+                aabb = enclosing_aabb(aabb, *(m_aabb_begin + id));
+                center_aabb.min = min(center_aabb.min, centers[id]);
+                center_aabb.max = max(center_aabb.max, centers[id]);
+            }
+
+            return {aabb, center_aabb};
+        }
+
+        // Splits the range of ids in two and returns the start of the second
+        // half. Uses the surface area heuristic over bins along the axis of
+        // greatest extent of the centers. Falls back to splitting at the
+        // median if the heuristic doesn't separate the objects.
+        uint32_t partition(uint32_t begin, uint32_t end, const AABB &center_aabb, scratch &buffers) const {
+            auto &ids = *m_ids;
+            auto &centers = *m_centers;
+            auto extent = center_aabb.max - center_aabb.min;
+            auto axis = max_index(extent);
+            auto axis_min = center_aabb.min[axis];
+            auto axis_extent = extent[axis];
+
+            if (axis_extent > EDYN_EPSILON && m_config->num_bins > 1) {
+                auto num_bins = m_config->num_bins;
+                auto scale = scalar(num_bins) / axis_extent;
+
+                auto bin_index = [&](uint32_t id) {
+                    auto index = static_cast<uint32_t>((centers[id][axis] - axis_min) * scale);
+                    return std::min(index, num_bins - 1);
+                };
+
+                auto &bins = buffers.bins;
+
+                for (auto &b : bins) {
+                    b.count = 0;
+                }
+
+                for (auto i = begin; i < end; ++i) {
+                    auto id = ids[i];
+                    auto &b = bins[bin_index(id)];
+                    auto &aabb = *(m_aabb_begin + id);
+                    b.aabb = b.count == 0 ? aabb : enclosing_aabb(b.aabb, aabb);
+                    ++b.count;
+                }
+
+                // Area times count of the bins to the right of each split,
+                // accumulated from the right.
+                auto &right_cost = buffers.right_cost;
+                auto right_aabb = AABB{};
+                uint32_t right_count = 0;
+
+                for (auto i = num_bins - 1; i > 0; --i) {
+                    auto &b = bins[i];
+
+                    if (b.count > 0) {
+                        right_aabb = right_count == 0 ? b.aabb : enclosing_aabb(right_aabb, b.aabb);
+                        right_count += b.count;
+                    }
+
+                    right_cost[i] = right_count > 0 ? right_aabb.area() * scalar(right_count) : 0;
+                }
+
+                // Sweep from the left to find the split with the lowest cost,
+                // where the split happens after `best_bin`.
+                auto best_cost = EDYN_SCALAR_MAX;
+                uint32_t best_bin = 0;
+                auto left_aabb = AABB{};
+                uint32_t left_count = 0;
+
+                for (uint32_t i = 0; i < num_bins - 1; ++i) {
+                    auto &b = bins[i];
+
+                    if (b.count > 0) {
+                        left_aabb = left_count == 0 ? b.aabb : enclosing_aabb(left_aabb, b.aabb);
+                        left_count += b.count;
+                    }
+
+                    if (left_count == 0 || left_count == end - begin) {
+                        continue;
+                    }
+
+                    auto cost = left_aabb.area() * scalar(left_count) + right_cost[i + 1];
+
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_bin = i;
+                    }
+                }
+
+                if (best_cost < EDYN_SCALAR_MAX) {
+                    auto it = std::partition(ids.begin() + begin, ids.begin() + end, [&](uint32_t id) {
+                        return bin_index(id) <= best_bin;
+                    });
+                    auto middle = static_cast<uint32_t>(std::distance(ids.begin(), it));
+
+                    if (middle != begin && middle != end) {
+                        return middle;
+                    }
+                }
+            }
+
+            auto middle = begin + (end - begin) / 2;
+            std::nth_element(ids.begin() + begin, ids.begin() + middle, ids.begin() + end,
+                             [&](uint32_t a, uint32_t b) {
+                return centers[a][axis] < centers[b][axis];
+            });
+
+            return middle;
+        }
+
+        Iterator_AABB m_aabb_begin;
+        const std::vector<vector3> *m_centers;
+        std::vector<uint32_t> *m_ids;
+        const static_tree_build_config *m_config;
+    };
 }
 
 class static_tree {
@@ -76,81 +287,350 @@ public:
     template<typename Func>
     void raycast(vector3 p0, vector3 p1, Func func) const;
 
+    /**
+     * @brief Builds the tree over a set of AABBs.
+     * @param aabb_begin Iterator to the first AABB.
+     * @param aabb_end Iterator past the last AABB.
+     * @param report_leaf Called for each leaf in depth-first order with the
+     * node and the range of indices of the AABBs it contains. Expected
+     * signature: `void(tree_node &, IdIterator ids_begin, IdIterator ids_end)`.
+     * @param config Build parameters.
+     */
+    template<typename Iterator, typename Func>
+    void build(Iterator aabb_begin, Iterator aabb_end, Func &report_leaf,
+               const static_tree_build_config &config);
+
     template<typename Iterator, typename Func>
     void build(Iterator aabb_begin, Iterator aabb_end, Func &report_leaf, uint32_t max_obj_per_leaf = 1) {
-        EDYN_ASSERT(aabb_begin != aabb_end);
+        auto config = static_tree_build_config{};
+        config.max_obj_per_leaf = max_obj_per_leaf;
+        build(aabb_begin, aabb_end, report_leaf, config);
+    }
 
-        auto count = std::distance(aabb_begin, aabb_end);
-        std::vector<uint32_t> ids(count);
-        std::iota(ids.begin(), ids.end(), 0);
+    void clear() {
+        m_nodes.clear();
+        m_wide_nodes.clear();
+        m_parents.clear();
+    }
 
-        // Insert root node.
-        m_nodes.emplace_back();
+    size_t num_nodes() const {
+        return m_nodes.size();
+    }
 
-        recurse_build(aabb_begin, aabb_end, ids.begin(), ids.end(),
-                      0, report_leaf, max_obj_per_leaf);
+    /**
+     * @brief Checks whether the children of each node come after it in the
+     * node array and whether all leaf ids are smaller than `num_ids`, which
+     * might not be the case if this tree was deserialized from corrupt data.
+     * @param num_ids Number of objects in the tree.
+     * @return Whether the tree can be traversed safely.
+     */
+    bool is_valid(size_t num_ids) const;
+
+    /**
+     * @brief Assigns new AABBs to some leaves and refits their ancestors. Only
+     * the nodes between these leaves and the root are visited. The topology
+     * of the tree is not changed, thus its quality degrades if the AABBs move
+     * too far, in which case it should be built again.
+     * @param leaf_begin Iterator to the first index of a leaf node.
+     * @param leaf_end Iterator past the last index of a leaf node.
+     * @param get_aabb Returns the new AABB of a leaf. Expected signature:
+     * `AABB(const tree_node &)`.
+     */
+    template<typename Iterator, typename Func>
+    void refit(Iterator leaf_begin, Iterator leaf_end, Func get_aabb);
+
+    template<typename Archive>
+    friend void serialize(Archive &archive, static_tree &tree);
+    friend size_t serialization_sizeof(const static_tree &tree);
+
+private:
+    // Node of the 4-ary tree. Each child is either another wide node or a
+    // leaf of the binary tree, in which case the bit of its slot is set in
+    // `leaf_mask`. Unused slots are null.
+    struct wide_node {
+        std::array<AABB, 4> aabb;
+        std::array<uint32_t, 4> child;
+        uint8_t leaf_mask;
+    };
+
+    void build_wide_tree();
+
+    template<typename TestFunc, typename VisitFunc>
+    void traverse_wide(TestFunc test_func, VisitFunc visit_func) const;
+
+    std::vector<tree_node> m_nodes;
+    std::vector<wide_node> m_wide_nodes;
+
+    // Parent of each node. Calculated on demand by `refit`.
+    std::vector<uint32_t> m_parents;
+};
+
+template<typename Iterator, typename Func>
+void static_tree::build(Iterator aabb_begin, Iterator aabb_end, Func &report_leaf,
+                        const static_tree_build_config &config) {
+    EDYN_ASSERT(aabb_begin != aabb_end);
+    EDYN_ASSERT(config.max_obj_per_leaf > 0);
+
+    auto count = static_cast<uint32_t>(std::distance(aabb_begin, aabb_end));
+    std::vector<uint32_t> ids(count);
+    std::iota(ids.begin(), ids.end(), 0);
+
+    auto parallel = config.parallel_threshold > 0 && !job_dispatcher::is_worker_thread();
+
+    std::vector<vector3> centers(count);
+
+    if (parallel) {
+        parallel_for(size_t{0}, size_t{count}, [&](size_t i) {
+            centers[i] = (aabb_begin + i)->center();
+        });
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            centers[i] = (aabb_begin + i)->center();
+        }
     }
 
-    template<typename Iterator_AABB, typename Iterator_ids, typename Func>
-    void recurse_build(Iterator_AABB aabb_begin, Iterator_AABB aabb_end,
-                       Iterator_ids ids_begin, Iterator_ids ids_end,
-                       size_t node_idx, Func &report_leaf,
-                       uint32_t max_obj_per_leaf) {
-        EDYN_ASSERT(aabb_begin != aabb_end);
+    using builder_type = detail::static_tree_builder<Iterator>;
+    using build_node = detail::static_tree_build_node;
+    auto builder = builder_type(aabb_begin, centers, ids, config);
+
+    // Build the top of the tree in the calling thread and defer smaller
+    // subtrees, which are then built in parallel, each into their own array
+    // of nodes. Then, append them in order, which results in the same layout
+    // regardless of the number of threads.
+    std::vector<build_node> nodes(1);
+    std::vector<typename builder_type::subtree> subtrees;
+    auto defer = parallel && count > config.parallel_threshold;
+    builder.build(nodes, 0, 0, count, config.parallel_threshold, defer ? &subtrees : nullptr);
+
+    if (!subtrees.empty()) {
+        std::vector<std::vector<build_node>> subtree_nodes(subtrees.size());
+
+        parallel_for(size_t{0}, subtrees.size(), [&](size_t i) {
+            auto &subtree = subtrees[i];
+            auto &local_nodes = subtree_nodes[i];
+            local_nodes.resize(1);
+            builder.build(local_nodes, 0, subtree.begin, subtree.end, 0, nullptr);
+        });
 
-        AABB set_aabb = *(aabb_begin + *ids_begin);
+        for (size_t i = 0; i < subtrees.size(); ++i) {
+            auto &local_nodes = subtree_nodes[i];
+            // The local root replaces the deferred node and the remaining
+            // nodes are appended.
+            auto offset = static_cast<uint32_t>(nodes.size()) - 1;
+            auto remap = [&](uint32_t idx) {
+                return idx == EDYN_NULL_NODE ? idx : idx == 0 ? subtrees[i].node : idx + offset;
+            };
+
+            for (auto &node : local_nodes) {
+                node.child1 = remap(node.child1);
+                node.child2 = remap(node.child2);
+            }
 
-        for (auto it = ids_begin + 1; it != ids_end; ++it) {
-            set_aabb = enclosing_aabb(set_aabb, *(aabb_begin + *it));
+            nodes[subtrees[i].node] = local_nodes.front();
+            nodes.insert(nodes.end(), local_nodes.begin() + 1, local_nodes.end());
         }
+    }
 
-        auto &node = m_nodes[node_idx];
-        node.aabb = set_aabb;
+    m_nodes.resize(nodes.size());
+    m_wide_nodes.clear();
+    m_parents.clear();
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        m_nodes[i].aabb = nodes[i].aabb;
+        m_nodes[i].child1 = nodes[i].child1;
+        m_nodes[i].child2 = nodes[i].child2;
+    }
 
-        auto count = std::distance(ids_begin, ids_end);
+    // Report leaves in depth-first order with the first child visited first.
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
 
-        if (count <= max_obj_per_leaf) {
-            node.child1 = EDYN_NULL_NODE;
-            report_leaf(node, ids_begin, ids_end);
+    while (!stack.empty()) {
+        auto idx = stack.back();
+        stack.pop_back();
+        auto &node = nodes[idx];
+
+        if (node.child1 == EDYN_NULL_NODE) {
+            report_leaf(m_nodes[idx], ids.begin() + node.begin, ids.begin() + node.end);
         } else {
-            auto ids_middle = detail::aabb_set_partition(aabb_begin, aabb_end, ids_begin, ids_end, set_aabb);
+            stack.push_back(node.child2);
+            stack.push_back(node.child1);
+        }
+    }
 
-            auto child1 = m_nodes.size();
-            auto child2 = m_nodes.size() + 1;
+    if (config.wide) {
+        build_wide_tree();
+    }
+}
+
+inline bool static_tree::is_valid(size_t num_ids) const {
+    for (uint32_t idx = 0; idx < m_nodes.size(); ++idx) {
+        auto &node = m_nodes[idx];
+
+        if (node.leaf()) {
+            if (node.id >= num_ids) {
+                return false;
+            }
+        } else if (node.child1 <= idx || node.child1 >= m_nodes.size() ||
+                   node.child2 <= idx || node.child2 >= m_nodes.size()) {
+            return false;
+        }
+    }
 
-            node.child1 = child1;
-            node.child2 = child2;
+    return true;
+}
 
-            m_nodes.emplace_back();
-            m_nodes.emplace_back();
+inline void static_tree::build_wide_tree() {
+    m_wide_nodes.clear();
 
-            recurse_build(aabb_begin, aabb_end, ids_begin, ids_middle,
-                          child1, report_leaf, max_obj_per_leaf);
-            recurse_build(aabb_begin, aabb_end, ids_middle, ids_end,
-                          child2, report_leaf, max_obj_per_leaf);
+    if (m_nodes.empty() || m_nodes.front().leaf()) {
+        return;
+    }
+
+    // Each wide node takes the children of a binary node, replacing the
+    // children which aren't leaves by their own children.
+    struct pending {
+        uint32_t node_idx;
+        uint32_t wide_idx;
+    };
+
+    std::vector<pending> stack;
+    m_wide_nodes.emplace_back();
+    stack.push_back({0, 0});
+
+    while (!stack.empty()) {
+        auto [node_idx, wide_idx] = stack.back();
+        stack.pop_back();
+
+        std::array<uint32_t, 4> slots;
+        unsigned num_slots = 0;
+        auto &node = m_nodes[node_idx];
+
+        for (auto child_idx : {node.child1, node.child2}) {
+            auto &child = m_nodes[child_idx];
+
+            if (child.leaf()) {
+                slots[num_slots++] = child_idx;
+            } else {
+                slots[num_slots++] = child.child1;
+                slots[num_slots++] = child.child2;
+            }
         }
+
+        auto wide = wide_node{};
+        wide.child.fill(EDYN_NULL_NODE);
+        wide.leaf_mask = 0;
+
+        for (unsigned i = 0; i < num_slots; ++i) {
+            auto &slot_node = m_nodes[slots[i]];
+            wide.aabb[i] = slot_node.aabb;
+
+            if (slot_node.leaf()) {
+                wide.child[i] = slots[i];
+                wide.leaf_mask |= 1 << i;
+            } else {
+                auto child_wide_idx = static_cast<uint32_t>(m_wide_nodes.size());
+                m_wide_nodes.emplace_back();
+                wide.child[i] = child_wide_idx;
+                stack.push_back({slots[i], child_wide_idx});
+            }
+        }
+
+        m_wide_nodes[wide_idx] = wide;
     }
+}
 
-    void clear() {
-        m_nodes.clear();
+template<typename Iterator, typename Func>
+void static_tree::refit(Iterator leaf_begin, Iterator leaf_end, Func get_aabb) {
+    if (m_parents.size() != m_nodes.size()) {
+        m_parents.assign(m_nodes.size(), EDYN_NULL_NODE);
+
+        for (uint32_t idx = 0; idx < m_nodes.size(); ++idx) {
+            auto &node = m_nodes[idx];
+
+            if (!node.leaf()) {
+                m_parents[node.child1] = idx;
+                m_parents[node.child2] = idx;
+            }
+        }
     }
 
-    template<typename Archive>
-    friend void serialize(Archive &archive, static_tree &tree);
-    friend size_t serialization_sizeof(const static_tree &tree);
+    for (auto it = leaf_begin; it != leaf_end; ++it) {
+        auto &node = m_nodes[*it];
+        EDYN_ASSERT(node.leaf());
+        node.aabb = get_aabb(std::as_const(node));
+    }
 
-private:
-    std::vector<tree_node> m_nodes;
-};
+    // Walk up from each leaf. If the AABB of a node does not change, its
+    // ancestors are not affected either. Other leaves under the same node
+    // which did change will reach it on their own walk.
+    for (auto it = leaf_begin; it != leaf_end; ++it) {
+        auto idx = m_parents[*it];
+
+        while (idx != EDYN_NULL_NODE) {
+            auto &node = m_nodes[idx];
+            auto aabb = enclosing_aabb(m_nodes[node.child1].aabb, m_nodes[node.child2].aabb);
+
+            if (aabb.min == node.aabb.min && aabb.max == node.aabb.max) {
+                break;
+            }
+
+            node.aabb = aabb;
+            idx = m_parents[idx];
+        }
+    }
+
+    // Wide nodes hold copies of the binary AABBs.
+    if (!m_wide_nodes.empty()) {
+        build_wide_tree();
+    }
+}
+
+template<typename TestFunc, typename VisitFunc>
+void static_tree::traverse_wide(TestFunc test_func, VisitFunc visit_func) const {
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        auto &node = m_wide_nodes[stack.back()];
+        stack.pop_back();
+
+        for (unsigned i = 0; i < 4; ++i) {
+            if (node.child[i] == EDYN_NULL_NODE || !test_func(node.aabb[i])) {
+                continue;
+            }
+
+            if (node.leaf_mask & (1 << i)) {
+                visit_func(node.child[i]);
+            } else {
+                stack.push_back(node.child[i]);
+            }
+        }
+    }
+}
 
 template<typename Func>
 void static_tree::query(const AABB &aabb, Func func) const {
+    if (!m_wide_nodes.empty()) {
+        traverse_wide([&](const AABB &node_aabb) {
+            return intersect(node_aabb, aabb);
+        }, func);
+        return;
+    }
+
     uint32_t root_node_idx = 0;
     query_tree(*this, root_node_idx, EDYN_NULL_NODE, aabb, func);
 }
 
 template<typename Func>
 void static_tree::raycast(vector3 p0, vector3 p1, Func func) const {
+    if (!m_wide_nodes.empty()) {
+        traverse_wide([&](const AABB &node_aabb) {
+            return intersect_segment_aabb(p0, p1, node_aabb.min, node_aabb.max);
+        }, func);
+        return;
+    }
+
     uint32_t root_node_idx = 0;
     raycast_tree(*this, root_node_idx, EDYN_NULL_NODE, p0, p1, func);
 }
@@ -0,0 +1,18 @@
+#ifndef EDYN_COMP_SIMULATION_PARTITION_HPP
+#define EDYN_COMP_SIMULATION_PARTITION_HPP
+
+namespace edyn {
+
+/**
+ * @brief Assigned to entities in the main registry when the asynchronous
+ * simulation is split among multiple workers. It holds the index of the
+ * worker which simulates the entity. Entities without it are replicated in
+ * all workers, which is the case for non-procedural rigid bodies.
+ */
+struct simulation_partition {
+    unsigned worker_index;
+};
+
+}
+
+#endif // EDYN_COMP_SIMULATION_PARTITION_HPP
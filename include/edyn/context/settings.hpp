@@ -27,7 +27,15 @@ struct settings {
 
     edyn::execution_mode execution_mode;
 
-    
+    // Process new contact manifolds, contact points and constraint rows in a
+    // canonical order so that results do not depend on the number of threads
+    // nor on the order of entities in component pools.
+    bool deterministic {false};
+
+    // Submeshes of paged triangle meshes are loaded ahead of time in the
+    // region dynamic bodies are expected to sweep over this amount of time,
+    // in seconds. Set to zero to disable prefetching.
+    scalar paged_mesh_prefetch_time {scalar(0.5)};
 
     init_callback_t init_callback {nullptr};
     init_callback_t deinit_callback {nullptr};
@@ -84,6 +84,24 @@ public:
         return inner_array(this, range_start, range_size);
     }
 
+    /**
+     * Whether the subranges are in order and within the data, which might
+     * not be the case if this array was deserialized from corrupt data.
+     */
+    bool is_valid() const {
+        size_t prev_start = 0;
+
+        for (auto start : m_range_starts) {
+            if (start < prev_start || start > m_data.size()) {
+                return false;
+            }
+
+            prev_start = start;
+        }
+
+        return true;
+    }
+
     template<typename Archive, typename U>
     friend void serialize(Archive &, flat_nested_array<U> &);
 
@@ -13,6 +13,8 @@
 #include "math/transform.hpp"
 #include "math/math.hpp"
 #include "time/time.hpp"
+#include "time/tick_scheduler.hpp"
+#include "parallel/job_dispatcher.hpp"
 #include "util/rigidbody.hpp"
 #include "util/constraint_util.hpp"
 #include "util/exclude_collision.hpp"
@@ -44,6 +46,20 @@ struct init_config {
     // If using a custom time source, assign the current time here for the
     // engine initialization.
     std::optional<double> timestamp;
+    // Produce the same results regardless of the number of worker threads.
+    // See `settings::deterministic`.
+    bool deterministic {false};
+    // Number of dedicated simulation threads in asynchronous mode. If greater
+    // than one, space is split in slabs of `partition_region_size` along the
+    // x axis and islands are distributed among workers by region. Islands
+    // closer than `partition_margin` are kept in the same worker. Only
+    // supported without networking.
+    unsigned num_simulation_workers {1};
+    scalar partition_region_size {scalar(64)};
+    scalar partition_margin {scalar(1)};
+    // Naming, CPU affinity, priority and NUMA placement of worker threads
+    // and of the dedicated simulation and extrapolation threads.
+    job_dispatcher_config dispatcher_config;
 };
 
 /**
@@ -157,6 +173,14 @@ double get_time(entt::registry &registry);
  */
 double get_simulation_timestamp(entt::registry &registry);
 
+/**
+ * @brief Get how late the simulation thread has been waking up after its
+ * scheduled step times. Only meaningful in asynchronous execution mode.
+ * @param registry Data source.
+ * @return Wake-up lateness in seconds.
+ */
+tick_lateness get_simulation_tick_lateness(entt::registry &registry);
+
 }
 
 #endif // EDYN_EDYN_HPP
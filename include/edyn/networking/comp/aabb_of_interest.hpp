@@ -25,6 +25,10 @@ struct aabb_of_interest {
     // and so they get cleared up in every update and should not be modified.
     std::vector<entt::entity> entities_entered;
     std::vector<entt::entity> entities_exited;
+
+    // AABB used in the last query of the interest grid. Initially empty so
+    // the first update always runs the query.
+    AABB query_aabb {vector3_one * EDYN_SCALAR_MAX, vector3_one * -EDYN_SCALAR_MAX};
 };
 
 }
@@ -0,0 +1,21 @@
+#ifndef EDYN_NETWORKING_ISLAND_OWNERS_HPP
+#define EDYN_NETWORKING_ISLAND_OWNERS_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Component assigned to island entities in the server which holds the
+ * clients that own entities residing in the island. It is recalculated in
+ * every update of the snapshot exporter, thus islands which were merged or
+ * split do not keep stale owners.
+ */
+struct island_owners {
+    std::vector<entt::entity> client_entities;
+};
+
+}
+
+#endif // EDYN_NETWORKING_ISLAND_OWNERS_HPP
@@ -2,11 +2,15 @@
 #define EDYN_NETWORKING_REMOTE_CLIENT_HPP
 
 #include <vector>
+#include <cstdint>
+#include <unordered_map>
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/sparse_set.hpp>
 #include "edyn/replication/entity_map.hpp"
 #include "edyn/networking/packet/edyn_packet.hpp"
 #include "edyn/networking/util/clock_sync.hpp"
+#include "edyn/networking/util/component_index_type.hpp"
+#include "edyn/networking/util/snapshot_codec.hpp"
 
 namespace edyn {
 
@@ -47,6 +51,21 @@ struct remote_client {
 
     clock_sync_data clock_sync;
 
+    // Encodes snapshots sent to this client if compact snapshots are enabled.
+    snapshot_encoder compact_snapshot_encoder;
+
+    // Priority accumulated by entities since they were last sent to this
+    // client. Only used if the snapshot byte budget is limited.
+    std::unordered_map<entt::entity, scalar> snapshot_priority_accumulator;
+
+    // Components of entities which were left out of snapshots due to the byte
+    // budget. They're included in subsequent snapshots until sent, even if
+    // they're not modified anymore, e.g. because the entity fell asleep.
+    std::unordered_map<entt::entity, std::vector<component_index_type>> snapshot_pending_components;
+
+    // Identifier of the next packet split into `packet::packet_fragment`s.
+    uint16_t next_fragment_message_id {0};
+
     double last_executed_history_entry_timestamp {0};
 };
 
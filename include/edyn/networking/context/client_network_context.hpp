@@ -8,6 +8,8 @@
 #include "edyn/networking/util/client_snapshot_importer.hpp"
 #include "edyn/networking/util/client_snapshot_exporter.hpp"
 #include "edyn/networking/util/clock_sync.hpp"
+#include "edyn/networking/util/snapshot_codec.hpp"
+#include "edyn/networking/util/packet_fragmentation.hpp"
 #include "edyn/networking/extrapolation/extrapolation_worker.hpp"
 #include "edyn/networking/extrapolation/extrapolation_modified_comp.hpp"
 #include "edyn/replication/registry_operation.hpp"
@@ -17,6 +19,7 @@
 #include <entt/signal/sigh.hpp>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace edyn {
 
@@ -47,13 +50,26 @@ struct client_network_context {
     // Without full ownership, the client will only send input components to server.
     bool allow_full_ownership {true};
 
+    // Decodes compact snapshots using the quantization sent by the server.
+    snapshot_decoder compact_snapshot_decoder;
+    snapshot_quantization compact_snapshot_quantization;
+
+    // Reassembles packets the server had to split into fragments.
+    fragment_assembler packet_fragment_assembler;
+
     std::shared_ptr<input_state_history_writer> input_history;
 
-    std::unique_ptr<extrapolation_worker> extrapolator;
+    // Requests are routed to extrapolators by island, allowing independent
+    // islands to be extrapolated in parallel.
+    std::vector<std::unique_ptr<extrapolation_worker>> extrapolators;
     std::vector<extrapolation_request> pending_extrapolations;
 
+    // Results received in the last update, which are applied in timestamp
+    // order since they can arrive out of order from multiple extrapolators.
+    std::vector<extrapolation_result> extrapolation_results;
+
     message_queue_handle<extrapolation_result> message_queue {
-        message_dispatcher::global().make_queue<extrapolation_result>("client_side")};
+        message_dispatcher::global().make_unique_queue<extrapolation_result>("client_side")};
 
     using packet_observer_func_t = void(const packet::edyn_packet &);
     entt::sigh<packet_observer_func_t> packet_signal;
@@ -72,6 +88,11 @@ struct client_network_context {
         return entt::sink{extrapolation_timeout_signal};
     }
 
+    entt::sigh<void(double)> extrapolation_finished_signal;
+    auto extrapolation_finished_sink() {
+        return entt::sink{extrapolation_finished_signal};
+    }
+
     using entity_entered_func_t = void(entt::entity);
     entt::sigh<entity_entered_func_t> entity_entered_signal;
     auto entity_entered_sink() {
@@ -6,6 +6,7 @@
 #include <entt/signal/sigh.hpp>
 #include "edyn/networking/util/server_snapshot_importer.hpp"
 #include "edyn/networking/util/server_snapshot_exporter.hpp"
+#include "edyn/networking/util/lag_compensation_history.hpp"
 
 namespace edyn {
 
@@ -17,6 +18,9 @@ struct server_network_context {
     std::shared_ptr<server_snapshot_importer> snapshot_importer;
     std::shared_ptr<server_snapshot_exporter> snapshot_exporter;
 
+    // Recent state of procedural bodies for lag-compensated queries.
+    lag_compensation_history lag_compensation;
+
     // Packet signals contain the client entity and the packet.
     using packet_observer_func_t = void(entt::entity, const packet::edyn_packet &);
     entt::sigh<packet_observer_func_t> packet_signal;
@@ -11,6 +11,11 @@ struct extrapolation_request {
     message_queue_identifier destination;
     double start_time;
     packet::registry_snapshot snapshot;
+    // State of entities which are extrapolated by another worker. It is only
+    // stored as the last known remote state of these entities so this worker
+    // stays up to date in case their islands become involved in its
+    // extrapolations later.
+    packet::registry_snapshot remote_state;
     double execution_time_limit {0.4};
     bool should_remap {true};
 };
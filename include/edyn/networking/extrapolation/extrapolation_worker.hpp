@@ -1,9 +1,11 @@
 #ifndef EDYN_NETWORKING_EXTRAPOLATION_WORKER_HPP
 #define EDYN_NETWORKING_EXTRAPOLATION_WORKER_HPP
 
+#include <deque>
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <entt/entity/fwd.hpp>
@@ -30,13 +32,16 @@ class extrapolation_worker final {
     void init();
     void deinit();
     bool begin_extrapolation(const extrapolation_request &);
-    bool should_step(const extrapolation_request &);
+    bool import_snapshot(const packet::registry_snapshot &, bool initial);
+    void import_remote_state(const packet::registry_snapshot &);
+    bool should_step(double execution_time_limit);
     void begin_step();
     void finish_step();
     void apply_history();
     void finish_extrapolation(const extrapolation_request &);
     void run();
-    void extrapolate(const extrapolation_request &);
+    std::vector<extrapolation_request> take_batch();
+    void extrapolate(std::vector<extrapolation_request> &batch);
 
 public:
     extrapolation_worker(const settings &settings,
@@ -55,6 +60,10 @@ public:
     void set_context_settings(std::shared_ptr<input_state_history_reader> input_history,
                               make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp);
 
+    const message_queue_identifier & identifier() const {
+        return m_message_queue.identifier;
+    }
+
     void on_extrapolation_request(message<extrapolation_request> &msg);
     void on_extrapolation_operation_create(message<extrapolation_operation_create> &msg);
     void on_extrapolation_operation_destroy(message<extrapolation_operation_destroy> &msg);
@@ -86,9 +95,12 @@ private:
     std::atomic<bool> m_running {false};
     std::atomic<bool> m_has_messages {false};
 
-    std::vector<extrapolation_request> m_requests;
+    // Pending requests in order of arrival. Requests cut short by a timeout
+    // are put back in front.
+    std::deque<extrapolation_request> m_requests;
     unsigned m_max_requests {3};
     entt::sparse_set m_owned_entities;
+    entt::sparse_set m_extrapolated_entities;
 
     double m_init_time;
     double m_current_time;
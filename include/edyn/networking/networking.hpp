@@ -2,6 +2,8 @@
 #define EDYN_NETWORKING_NETWORKING_HPP
 
 #include "edyn/math/scalar.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/collision/raycast.hpp"
 #include "edyn/networking/packet/edyn_packet.hpp"
 #include "edyn/networking/networking_external.hpp"
 #include "edyn/networking/util/asset_util.hpp"
@@ -123,6 +125,16 @@ network_client_assigned_sink(entt::registry &);
 entt::sink<entt::sigh<void(void)>>
 network_client_extrapolation_timeout_sink(entt::registry &);
 
+/**
+ * @brief Triggered when the result of an extrapolation job is received, right
+ * before it is applied. The argument is the simulation time the extrapolation
+ * reached.
+ * @param registry Data source.
+ * @return Extrapolation completion sink.
+ */
+entt::sink<entt::sigh<void(double)>>
+network_client_extrapolation_finished_sink(entt::registry &);
+
 /**
  * @brief Get server packet sink. This sink must be observed and the packets
  * that are published into it should be sent over the network immediately.
@@ -133,6 +145,36 @@ network_client_extrapolation_timeout_sink(entt::registry &);
 entt::sink<entt::sigh<void(entt::entity, const packet::edyn_packet &)>>
 network_server_packet_sink(entt::registry &);
 
+/**
+ * @brief Performs a raycast against networked procedural bodies as they were
+ * at an earlier time in the server, e.g. to validate a hit reported by a
+ * client using the state it was seeing. Transforms are interpolated between
+ * recorded steps. Only bodies in the lag compensation history are
+ * considered, thus static geometry must be checked with `edyn::raycast`.
+ * Nothing is recorded unless `server_network_settings::lag_compensation_duration`
+ * is greater than zero.
+ * @param registry Data source.
+ * @param time Simulation time, which is clamped into the range covered by
+ * `server_network_settings::lag_compensation_duration`.
+ * @param p0 First point in the ray.
+ * @param p1 Second point in the ray.
+ * @param ignore_entities Entities to be ignored during raycast.
+ * @return Result containing the first entity that was hit by the ray.
+ */
+raycast_result raycast_at(entt::registry &, double time, vector3 p0, vector3 p1,
+                          const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Finds networked procedural bodies whose AABB intersected the given
+ * AABB at an earlier time in the server. Requires lag compensation to be
+ * enabled, as in `edyn::raycast_at`.
+ * @param registry Data source.
+ * @param time Simulation time, which is clamped into the recorded range.
+ * @param aabb Query AABB.
+ * @return Entities whose AABB intersected the query AABB.
+ */
+std::vector<entt::entity> query_aabb_at(entt::registry &, double time, const AABB &aabb);
+
 /**
  * @brief Notify client about an entity entering its AABB of interest.
  * The entity contains an `edyn::asset_ref` component which holds the id of
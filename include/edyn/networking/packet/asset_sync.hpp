@@ -30,6 +30,7 @@ void serialize(Archive &archive, asset_sync_response &packet) {
     //archive(packet.timestamp); // Unnecessary in this context.
     archive(packet.entities);
     archive(packet.pools);
+    check_pool_entity_indices(archive, packet.pools, packet.entities.size());
 }
 
 }
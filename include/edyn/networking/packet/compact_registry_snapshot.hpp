@@ -0,0 +1,50 @@
+#ifndef EDYN_NETWORKING_PACKET_COMPACT_REGISTRY_SNAPSHOT_HPP
+#define EDYN_NETWORKING_PACKET_COMPACT_REGISTRY_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <vector>
+#include "edyn/serialization/std_s11n.hpp"
+
+namespace edyn::packet {
+
+/**
+ * @brief A `registry_snapshot` encoded with quantized transforms and
+ * velocities, delta-compressed against a previous snapshot acknowledged by
+ * the client. Sent by the server instead of `registry_snapshot` if
+ * `server_network_settings::compact_snapshots` is enabled.
+ * @see snapshot_encoder
+ */
+struct compact_registry_snapshot {
+    double timestamp;
+    uint16_t sequence;
+    // Sequence of the snapshot values were delta-encoded against. Equals
+    // `sequence` if this snapshot does not depend on a previous one.
+    uint16_t baseline;
+    // Bit-packed entities and pools.
+    std::vector<uint8_t> data;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, compact_registry_snapshot &snapshot) {
+    archive(snapshot.timestamp);
+    archive(snapshot.sequence);
+    archive(snapshot.baseline);
+    archive(snapshot.data);
+}
+
+/**
+ * @brief Sent by the client upon receiving a `compact_registry_snapshot`, so
+ * the server can use it as baseline for delta compression.
+ */
+struct snapshot_ack {
+    uint16_t sequence;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, snapshot_ack &ack) {
+    archive(ack.sequence);
+}
+
+}
+
+#endif // EDYN_NETWORKING_PACKET_COMPACT_REGISTRY_SNAPSHOT_HPP
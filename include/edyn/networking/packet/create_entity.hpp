@@ -16,6 +16,7 @@ void serialize(Archive &archive, create_entity &packet) {
     archive(packet.timestamp);
     archive(packet.entities);
     archive(packet.pools);
+    check_pool_entity_indices(archive, packet.pools, packet.entities.size());
 }
 
 }
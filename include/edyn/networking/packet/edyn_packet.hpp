@@ -7,6 +7,8 @@
 #include "edyn/networking/packet/entity_response.hpp"
 #include "edyn/networking/packet/query_entity.hpp"
 #include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/packet/compact_registry_snapshot.hpp"
+#include "edyn/networking/packet/packet_fragment.hpp"
 #include "edyn/networking/packet/create_entity.hpp"
 #include "edyn/networking/packet/destroy_entity.hpp"
 #include "edyn/networking/packet/update_entity_map.hpp"
@@ -42,7 +44,10 @@ struct edyn_packet {
         entity_entered,
         entity_exited,
         asset_sync,
-        asset_sync_response
+        asset_sync_response,
+        compact_registry_snapshot,
+        snapshot_ack,
+        packet_fragment
     > var;
 };
 
@@ -56,7 +61,9 @@ using timed_packets_tuple_t = std::tuple<
 using unreliable_packets_tuple_t = std::tuple<
     packet::registry_snapshot,
     packet::time_request,
-    packet::time_response
+    packet::time_response,
+    packet::compact_registry_snapshot,
+    packet::snapshot_ack
 >;
 
 template<typename Archive>
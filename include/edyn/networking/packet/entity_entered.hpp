@@ -25,6 +25,7 @@ void serialize(Archive &archive, entity_entered::asset_info &info) {
     archive(info.owner);
     archive(info.entities);
     archive(info.pools);
+    check_pool_entity_indices(archive, info.pools, info.entities.size());
 }
 
 template<typename Archive>
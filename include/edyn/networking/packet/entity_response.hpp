@@ -19,6 +19,7 @@ void serialize(Archive &archive, entity_response &packet) {
     //archive(packet.timestamp); // Unnecessary in this context.
     archive(packet.entities);
     archive(packet.pools);
+    check_pool_entity_indices(archive, packet.pools, packet.entities.size());
 }
 
 }
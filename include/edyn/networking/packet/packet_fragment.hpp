@@ -0,0 +1,35 @@
+#ifndef EDYN_NETWORKING_PACKET_PACKET_FRAGMENT_HPP
+#define EDYN_NETWORKING_PACKET_PACKET_FRAGMENT_HPP
+
+#include <cstdint>
+#include <vector>
+#include "edyn/serialization/std_s11n.hpp"
+
+namespace edyn::packet {
+
+/**
+ * @brief A piece of a serialized `edyn_packet` which is larger than
+ * `server_network_settings::max_packet_size` and which could not be split
+ * into smaller packets that can be applied independently. The original packet
+ * is reassembled once all of its fragments have been received.
+ * @see fragment_assembler
+ */
+struct packet_fragment {
+    // Identifies the packet this fragment belongs to.
+    uint16_t message_id;
+    uint16_t index;
+    uint16_t count;
+    std::vector<uint8_t> data;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, packet_fragment &fragment) {
+    archive(fragment.message_id);
+    archive(fragment.index);
+    archive(fragment.count);
+    archive(fragment.data);
+}
+
+}
+
+#endif // EDYN_NETWORKING_PACKET_PACKET_FRAGMENT_HPP
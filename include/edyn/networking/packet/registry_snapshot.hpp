@@ -37,6 +37,7 @@ void serialize(Archive &archive, registry_snapshot &snapshot) {
     archive(snapshot.timestamp);
     archive(snapshot.entities);
     archive(snapshot.pools);
+    check_pool_entity_indices(archive, snapshot.pools, snapshot.entities.size());
 }
 
 }
@@ -74,6 +75,33 @@ namespace edyn::internal {
                                   packet::registry_snapshot &snap, component_index_type component_index) {
         get_pool<Component>(snap.pools, component_index)->insert(registry, first, last, snap.entities);
     }
+
+    // Creates a snapshot with a subset of the entities of another snapshot
+    // and all of their components. `indices` refer to elements of
+    // `snap.entities` and must not contain duplicates.
+    inline packet::registry_snapshot snapshot_subset(const packet::registry_snapshot &snap,
+                                                     const std::vector<size_t> &indices) {
+        using index_type = pool_snapshot_data::index_type;
+        auto index_map = std::vector<index_type>(snap.entities.size(), pool_snapshot_data::null_index);
+        auto subset = packet::registry_snapshot{};
+        subset.timestamp = snap.timestamp;
+        subset.entities.reserve(indices.size());
+
+        for (auto index : indices) {
+            index_map[index] = static_cast<index_type>(subset.entities.size());
+            subset.entities.push_back(snap.entities[index]);
+        }
+
+        for (auto &pool : snap.pools) {
+            auto ptr = pool.ptr->subset(index_map);
+
+            if (!ptr->empty()) {
+                subset.pools.push_back(pool_snapshot{pool.component_index, std::move(ptr)});
+            }
+        }
+
+        return subset;
+    }
 }
 
 #endif // EDYN_NETWORKING_UTIL_REGISTRY_SNAPSHOT_HPP
@@ -15,6 +15,7 @@ struct server_settings {
     uint8_t num_restitution_iterations;
     uint8_t num_individual_restitution_iterations;
     bool allow_full_ownership;
+    snapshot_quantization quantization;
 
     server_settings() = default;
 
@@ -26,7 +27,11 @@ struct server_settings {
         , num_restitution_iterations(settings.num_restitution_iterations)
         , num_individual_restitution_iterations(settings.num_individual_restitution_iterations)
         , allow_full_ownership(allow_full_ownership)
-    {}
+    {
+        if (auto *server = std::get_if<server_network_settings>(&settings.network_settings)) {
+            quantization = server->quantization;
+        }
+    }
 };
 
 template<typename Archive>
@@ -38,6 +43,7 @@ void serialize(Archive &archive, server_settings &settings) {
     archive(settings.num_restitution_iterations);
     archive(settings.num_individual_restitution_iterations);
     archive(settings.allow_full_ownership);
+    archive(settings.quantization);
 }
 
 }
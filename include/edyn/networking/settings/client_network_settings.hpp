@@ -23,6 +23,12 @@ struct client_network_settings {
     // is sensible to increase it in case packet loss is high.
     double action_history_max_age {1.0};
 
+    // Maximum amount of time in seconds an extrapolation is allowed to run.
+    // Pending requests are coalesced into a single extrapolation. If it runs
+    // out of time, the state reached so far is applied and the extrapolation
+    // timeout signal is published.
+    double extrapolation_time_budget {0.4};
+
     extrapolation_callback_t extrapolation_init_callback {nullptr};
     extrapolation_callback_t extrapolation_deinit_callback {nullptr};
     extrapolation_callback_t extrapolation_begin_callback {nullptr};
@@ -1,6 +1,11 @@
 #ifndef EDYN_NETWORKING_SETTINGS_SERVER_NETWORK_SETTINGS_HPP
 #define EDYN_NETWORKING_SETTINGS_SERVER_NETWORK_SETTINGS_HPP
 
+#include <cstddef>
+#include "edyn/math/scalar.hpp"
+#include "edyn/networking/settings/snapshot_quantization.hpp"
+#include "edyn/networking/settings/snapshot_priority.hpp"
+
 namespace edyn {
 
 struct server_network_settings {
@@ -15,6 +20,42 @@ struct server_network_settings {
     // longer be delayed, they'll be applied immediately instead, which can lead
     // to jitter.
     double max_playout_delay {2};
+
+    // Send registry snapshots to clients as `packet::compact_registry_snapshot`,
+    // with quantized transforms and velocities and delta compression. The
+    // quantization is sent to clients on creation, thus it should not be
+    // changed afterwards.
+    bool compact_snapshots {false};
+    snapshot_quantization quantization;
+
+    // Packets carrying snapshots which are larger than this many bytes once
+    // serialized are split into multiple packets that can be applied
+    // independently. Reliable packets which cannot be split are sent as
+    // `packet::packet_fragment`s and reassembled by the client. The default
+    // leaves room for the headers of the transport layer within a typical
+    // MTU. Set to zero to disable.
+    size_t max_packet_size {1200};
+
+    // Size of the cells of the grid used to determine which entities are in
+    // the AABB of interest of each client. Islands and non-procedural entities
+    // are bucketed into these cells and clients receive everything in the
+    // cells their AABB of interest overlaps. Read when the first update runs.
+    scalar interest_cell_size {32};
+
+    // Limits the size of registry snapshots by sending the entities which
+    // need it the most first.
+    snapshot_priority priority;
+
+    // Length of time in seconds the transforms of networked procedural bodies
+    // are kept for, enabling queries against the world as it was in the past
+    // via `edyn::raycast_at` and `edyn::query_aabb_at`. Disabled when zero,
+    // which is the default since recording has a cost on every update.
+    double lag_compensation_duration {0};
+
+    // Number of consecutive frames grouped under the same tree in the lag
+    // compensation history. Larger chunks reduce the cost of recording but
+    // make queries less selective.
+    unsigned lag_compensation_chunk_size {8};
 };
 
 }
@@ -0,0 +1,38 @@
+#ifndef EDYN_NETWORKING_SETTINGS_SNAPSHOT_PRIORITY_HPP
+#define EDYN_NETWORKING_SETTINGS_SNAPSHOT_PRIORITY_HPP
+
+#include <cstddef>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Parameters of the prioritization of entities in registry snapshots
+ * sent to clients. Every time a snapshot is sent, the priority of each
+ * modified entity is added to its accumulated priority. The entities with
+ * highest accumulated priority are included in the snapshot up to the byte
+ * budget and then their accumulated priority is reset.
+ */
+struct snapshot_priority {
+    // Maximum size in bytes of each registry snapshot sent to a client.
+    // Zero means unlimited, in which case all modified entities are sent.
+    size_t byte_budget {0};
+
+    // Priority is halved at this distance from the entity followed by the
+    // client, or from the center of its AABB of interest if it follows none.
+    scalar half_priority_distance {20};
+
+    // Priority is scaled by `1 + speed * velocity_factor`.
+    scalar velocity_factor {scalar(0.2)};
+
+    // Priority multiplier for entities owned by any client, which are likely
+    // to be involved in interactions the players care about.
+    scalar owned_factor {2};
+
+    // Priority multiplier for sleeping entities.
+    scalar sleeping_factor {scalar(0.1)};
+};
+
+}
+
+#endif // EDYN_NETWORKING_SETTINGS_SNAPSHOT_PRIORITY_HPP
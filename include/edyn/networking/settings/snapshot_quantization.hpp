@@ -0,0 +1,34 @@
+#ifndef EDYN_NETWORKING_SETTINGS_SNAPSHOT_QUANTIZATION_HPP
+#define EDYN_NETWORKING_SETTINGS_SNAPSHOT_QUANTIZATION_HPP
+
+#include <cstdint>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Precision of transforms and velocities in compact registry snapshots.
+ */
+struct snapshot_quantization {
+    // Positions are sent as fixed-point values with this resolution, relative
+    // to the center of the client's AABB of interest.
+    scalar position_precision {scalar(1) / 1024};
+    scalar linvel_precision {scalar(1) / 256};
+    scalar angvel_precision {scalar(1) / 256};
+
+    // Number of bits for each of the three smallest components of
+    // orientations.
+    uint8_t orientation_bits {12};
+};
+
+template<typename Archive>
+void serialize(Archive &archive, snapshot_quantization &quantization) {
+    archive(quantization.position_precision);
+    archive(quantization.linvel_precision);
+    archive(quantization.angvel_precision);
+    archive(quantization.orientation_bits);
+}
+
+}
+
+#endif // EDYN_NETWORKING_SETTINGS_SNAPSHOT_QUANTIZATION_HPP
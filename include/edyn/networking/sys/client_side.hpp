@@ -15,8 +15,11 @@ namespace edyn {
  * must have been initialized and attached to the same registry prior to this
  * call.
  * @param registry Data source.
+ * @param num_extrapolation_workers Number of extrapolation threads. Server
+ * corrections of independent islands are extrapolated in parallel when
+ * greater than one.
  */
-void init_network_client(entt::registry &);
+void init_network_client(entt::registry &, unsigned num_extrapolation_workers = 1);
 
 /**
  * @brief Remove network client context from registry where it was previously
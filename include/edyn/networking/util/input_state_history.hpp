@@ -2,50 +2,265 @@
 #define EDYN_NETWORKING_UTIL_INPUT_STATE_HISTORY_HPP
 
 #include <entt/entity/fwd.hpp>
+#include <atomic>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <vector>
 #include <type_traits>
 #include <entt/core/type_info.hpp>
 #include <entt/entity/registry.hpp>
 #include "edyn/comp/action_list.hpp"
+#include "edyn/config/config.h"
 #include "edyn/networking/comp/action_history.hpp"
 #include "edyn/networking/packet/registry_snapshot.hpp"
 
 namespace edyn {
 
 namespace internal {
+    /**
+     * @brief Fixed-capacity ring buffer of timestamped component states which
+     * can be written by a single thread while being read by multiple threads
+     * without locking. Each slot carries a sequence number which allows
+     * readers to detect whether it was overwritten while being read, in which
+     * case the entry is treated as older than all others since the writer
+     * only overwrites the oldest entries. Timestamps must be non-decreasing.
+     * Entries are copied in and out of slots one 64-bit word at a time using
+     * relaxed atomics, thus a torn read is never a data race and is discarded
+     * once the sequence number check fails.
+     */
     template<typename Component>
-    struct component_history {
+    class component_history {
+        static_assert(std::is_trivially_copyable_v<Component>,
+                      "Input components must be trivially copyable.");
+
+    public:
         struct entry {
             Component component;
             double timestamp;
         };
 
-        std::vector<entry> entries;
+        component_history(size_t capacity)
+            : m_slots(new slot[capacity])
+            , m_capacity(capacity)
+        {
+            EDYN_ASSERT(capacity > 0);
+        }
+
+        // Must only be called by the writer.
+        void push(const Component &component, double timestamp) {
+            auto index = m_end.load(std::memory_order_relaxed);
+            auto begin = m_begin.load(std::memory_order_relaxed);
+
+            // Overwrite oldest entry if full. It is counted as lost since it
+            // had not been erased yet, thus it might still be needed.
+            if (index - begin == m_capacity) {
+                ++m_num_lost;
+                m_begin.store(begin + 1, std::memory_order_release);
+            }
+
+            auto &slot = m_slots[index % m_capacity];
+            slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.store(entry{component, timestamp});
+            slot.sequence.store(index * 2 + 2, std::memory_order_release);
+            m_end.store(index + 1, std::memory_order_release);
+        }
+
+        // Must only be called by the writer.
+        void erase_until(double timestamp) {
+            auto begin = m_begin.load(std::memory_order_relaxed);
+            auto end = m_end.load(std::memory_order_relaxed);
+            auto index = upper_bound(begin, end, timestamp);
+            m_begin.store(index, std::memory_order_release);
+        }
+
+        /**
+         * @brief Number of entries which were overwritten before being erased,
+         * which means the capacity is not enough to hold all entries in the
+         * time window being kept. Must only be called by the writer.
+         */
+        size_t num_lost() const {
+            return m_num_lost;
+        }
+
+        /**
+         * @brief Finds the latest entry with a timestamp not greater than the
+         * given time.
+         * @return Whether an entry was found.
+         */
+        bool latest_before(double time, entry &result) const {
+            auto begin = m_begin.load(std::memory_order_acquire);
+            auto end = m_end.load(std::memory_order_acquire);
+            auto index = upper_bound(begin, end, time);
+            return index > begin && read(index - 1, result);
+        }
+
+        /**
+         * @brief Visits entries with timestamp in the range `[start, end]`
+         * in chronological order.
+         * @param func Function with signature `void(const entry &)`.
+         */
+        template<typename Func>
+        void each(double start_time, double end_time, Func func) const {
+            auto begin = m_begin.load(std::memory_order_acquire);
+            auto end = m_end.load(std::memory_order_acquire);
+            auto e = entry{};
+
+            for (auto index = lower_bound(begin, end, start_time); index < end; ++index) {
+                if (!read(index, e)) {
+                    continue;
+                }
+
+                if (e.timestamp > end_time) {
+                    break;
+                }
+
+                func(e);
+            }
+        }
+
+        size_t capacity() const {
+            return m_capacity;
+        }
+
+        size_t size() const {
+            return m_end.load(std::memory_order_acquire) - m_begin.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct slot {
+            static constexpr size_t num_words = (sizeof(entry) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+            std::atomic<uint64_t> sequence {0};
+            std::atomic<uint64_t> words[num_words] {};
+
+            void store(const entry &value) {
+                uint64_t buffer[num_words] {};
+                std::memcpy(buffer, &value, sizeof(entry));
+
+                for (size_t i = 0; i < num_words; ++i) {
+                    words[i].store(buffer[i], std::memory_order_relaxed);
+                }
+            }
+
+            void load(entry &value) const {
+                uint64_t buffer[num_words];
+
+                for (size_t i = 0; i < num_words; ++i) {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+
+                std::memcpy(&value, buffer, sizeof(entry));
+            }
+        };
+
+        bool read(uint64_t index, entry &result) const {
+            auto &slot = m_slots[index % m_capacity];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+            if (sequence != index * 2 + 2) {
+                return false;
+            }
+
+            auto value = entry{};
+            slot.load(value);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                return false;
+            }
+
+            result = value;
+            return true;
+        }
+
+        // Timestamp of entry or negative infinity if it has been overwritten.
+        double timestamp_at(uint64_t index) const {
+            auto e = entry{};
+            return read(index, e) ? e.timestamp : -std::numeric_limits<double>::infinity();
+        }
+
+        // Index of first entry with timestamp greater than or equal to `time`.
+        uint64_t lower_bound(uint64_t first, uint64_t last, double time) const {
+            while (first < last) {
+                auto mid = first + (last - first) / 2;
+
+                if (timestamp_at(mid) < time) {
+                    first = mid + 1;
+                } else {
+                    last = mid;
+                }
+            }
+
+            return first;
+        }
+
+        // Index of first entry with timestamp greater than `time`.
+        uint64_t upper_bound(uint64_t first, uint64_t last, double time) const {
+            while (first < last) {
+                auto mid = first + (last - first) / 2;
+
+                if (timestamp_at(mid) <= time) {
+                    first = mid + 1;
+                } else {
+                    last = mid;
+                }
+            }
+
+            return first;
+        }
+
+        std::unique_ptr<slot[]> m_slots;
+        size_t m_capacity;
+        std::atomic<uint64_t> m_begin {0};
+        std::atomic<uint64_t> m_end {0};
+        size_t m_num_lost {0}; // Only accessed by the writer.
     };
 }
 
 /**
  * @brief A history of user inputs and actions which will be applied during
- * extrapolation. It is accessed from multiple threads so it has to be thread-safe.
+ * extrapolation. It is written by the main thread and read by extrapolation
+ * workers. Inputs of each entity are stored in ring buffers which the writer
+ * fills without locking. The set of entities is guarded by a shared mutex:
+ * readers hold it shared while importing and the writer only locks it
+ * exclusively when entities are inserted or removed, thus readers only block
+ * each other out when the set of entities changes. Actions have variable
+ * size and are guarded by a separate mutex.
  */
 template<typename... Inputs>
 struct input_state_history {
     entt::storage<action_history> actions;
-    std::tuple<entt::storage<internal::component_history<Inputs>>...> inputs;
-    std::mutex mutex;
+    std::tuple<entt::storage<std::unique_ptr<internal::component_history<Inputs>>>...> inputs;
+    std::shared_mutex mutex;
+    std::mutex actions_mutex;
+
+    // Maximum number of entries per entity and input type. Inputs are recorded
+    // once per client update and are kept until they're older than the erase
+    // window of the client (`1.6 * client_server_time_difference + 0.4`
+    // seconds), thus it must be at least the client update rate times the
+    // window, e.g. 60 updates per second with a 150ms time difference require
+    // 60 * (1.6 * 0.15 + 0.4) ~= 39 entries. Inputs overwritten before
+    // leaving the window are counted in `num_lost_inputs()` of the writer.
+    size_t capacity {default_capacity};
+    static constexpr size_t default_capacity = 256;
 
     input_state_history() = default;
     input_state_history(input_state_history &) = default;
     input_state_history(input_state_history &&) = default;
     input_state_history & operator=(input_state_history &) = default;
     input_state_history & operator=(input_state_history &&) = default;
-    input_state_history([[maybe_unused]] const std::tuple<Inputs...> &) {}
+    input_state_history([[maybe_unused]] const std::tuple<Inputs...> &,
+                        size_t capacity = default_capacity)
+        : capacity(capacity)
+    {}
 
     template<typename Input>
     auto & get_inputs() {
-        return std::get<entt::storage<internal::component_history<Input>>>(inputs);
+        return std::get<entt::storage<std::unique_ptr<internal::component_history<Input>>>>(inputs);
     }
 };
 
@@ -64,6 +279,10 @@ public:
     // Erase all recorded input and actions until the given timestamp.
     virtual void erase_until(double timestamp) = 0;
 
+    // Number of inputs which were overwritten before being erased due to lack
+    // of capacity in the history.
+    virtual size_t num_lost_inputs() const = 0;
+
     // Removes an entity from internal storages in case it had been added before.
     // Must be called for all entities that have been destroyed.
     virtual void remove_entity(entt::entity entity) = 0;
@@ -86,19 +305,29 @@ public:
 template<typename... Inputs>
 class input_state_history_writer_impl : public input_state_history_writer {
 
+    // Get history of entity, inserting it if necessary. Readers are locked
+    // out only when the set of entities changes.
+    template<typename Component>
+    auto & get_or_insert_history(entt::entity entity) {
+        auto &inputs = m_history->template get_inputs<Component>();
+
+        if (!inputs.contains(entity)) {
+            auto history = std::make_unique<internal::component_history<Component>>(m_history->capacity);
+            std::lock_guard lock(m_history->mutex);
+            inputs.emplace(entity, std::move(history));
+        }
+
+        return *inputs.get(entity);
+    }
+
     template<typename Component>
     void add(const entt::registry &registry, const entt::sparse_set &entities, double timestamp) {
         auto view = registry.view<Component>();
-        auto &inputs = m_history->template get_inputs<Component>();
 
         for (auto entity : entities) {
             if (view.contains(entity)) {
-                if (!inputs.contains(entity)) {
-                    inputs.emplace(entity);
-                }
-
                 auto [comp] = view.get(entity);
-                inputs.get(entity).entries.push_back({comp, timestamp});
+                get_or_insert_history<Component>(entity).push(comp, timestamp);
             }
         }
     }
@@ -106,7 +335,6 @@ class input_state_history_writer_impl : public input_state_history_writer {
     template<typename Component>
     void add(const std::vector<entt::entity> &pool_entities, const pool_snapshot &pool_snapshot,
              const entt::sparse_set &entities, double timestamp) {
-        auto &inputs = m_history->template get_inputs<Component>();
         auto *typed_pool = static_cast<pool_snapshot_data_impl<Component> *>(pool_snapshot.ptr.get());
 
         for (size_t i = 0; i < typed_pool->entity_indices.size(); ++i) {
@@ -115,11 +343,7 @@ class input_state_history_writer_impl : public input_state_history_writer {
             auto &comp = typed_pool->components[i];
 
             if (entities.contains(entity)) {
-                if (!inputs.contains(entity)) {
-                    inputs.emplace(entity);
-                }
-
-                inputs.get(entity).entries.push_back({comp, timestamp});
+                get_or_insert_history<Component>(entity).push(comp, timestamp);
             }
         }
     }
@@ -164,10 +388,26 @@ class input_state_history_writer_impl : public input_state_history_writer {
         }
     }
 
-    template<typename Array>
-    auto first_after(const Array &arr, double timestamp) const {
-        return std::find_if(arr.begin(), arr.end(),
-                            [timestamp](auto &&elem) { return elem.timestamp > timestamp; });
+    template<typename Component>
+    size_t count_lost() const {
+        auto &inputs = m_history->template get_inputs<Component>();
+        size_t count = 0;
+
+        for (auto [entity, history] : inputs.each()) {
+            count += history->num_lost();
+        }
+
+        return count;
+    }
+
+    template<typename Component>
+    void remove_inputs(entt::entity entity) {
+        auto &inputs = m_history->template get_inputs<Component>();
+
+        if (inputs.contains(entity)) {
+            m_num_lost_inputs += inputs.get(entity)->num_lost();
+            inputs.remove(entity);
+        }
     }
 
     template<typename Component>
@@ -175,8 +415,7 @@ class input_state_history_writer_impl : public input_state_history_writer {
         auto &inputs = m_history->template get_inputs<Component>();
 
         for (auto [entity, history] : inputs.each()) {
-            auto it = first_after(history.entries, timestamp);
-            history.entries.erase(history.entries.begin(), it);
+            history->erase_until(timestamp);
         }
     }
 
@@ -187,15 +426,15 @@ public:
 
     void emplace(const entt::registry &registry,
                  const entt::sparse_set &entities, double timestamp) override {
-        std::lock_guard lock(m_history->mutex);
         (add<Inputs>(registry, entities, timestamp), ...);
+
+        std::lock_guard lock(m_history->actions_mutex);
         add_actions(registry, entities);
     }
 
     void emplace(const packet::registry_snapshot &snap,
                  const entt::sparse_set &entities,
                  double timestamp, double time_delta) override {
-        std::lock_guard lock(m_history->mutex);
         for (auto &pool : snap.pools) {
             ((entt::type_index<Inputs>::value() == pool.ptr->get_type_id() ?
                 add<Inputs>(snap.entities, pool, entities, timestamp) :
@@ -203,29 +442,40 @@ public:
 
             if (entt::type_index<action_history>::value() == pool.ptr->get_type_id()) {
                 auto *typed_pool = static_cast<pool_snapshot_data_impl<action_history> *>(pool.ptr.get());
+                std::lock_guard lock(m_history->actions_mutex);
                 add_actions(snap.entities, *typed_pool, entities, time_delta);
             }
         }
     }
 
     void erase_until(double timestamp) override {
-        std::lock_guard lock(m_history->mutex);
         (erase_until<Inputs>(timestamp), ...);
 
+        std::lock_guard lock(m_history->actions_mutex);
+
         for (auto [entity, actions] : m_history->actions.each()) {
             actions.erase_until(timestamp);
         }
     }
 
+    size_t num_lost_inputs() const override {
+        return m_num_lost_inputs + (count_lost<Inputs>() + ... + size_t{0});
+    }
+
     void remove_entity(entt::entity entity) override {
-        std::lock_guard lock(m_history->mutex);
+        {
+            std::lock_guard lock(m_history->actions_mutex);
+            m_history->actions.remove(entity);
+        }
 
-        m_history->actions.remove(entity);
-        (m_history->template get_inputs<Inputs>().remove(entity), ...);
+        std::lock_guard lock(m_history->mutex);
+        (remove_inputs<Inputs>(entity), ...);
     }
 
 private:
     std::shared_ptr<input_state_history<Inputs...>> m_history;
+    // Lost inputs of entities which have been removed.
+    size_t m_num_lost_inputs {0};
 };
 
 template<typename... Inputs>
@@ -262,15 +512,9 @@ class input_state_history_reader_impl : public input_state_history_reader {
         auto end_time = start_time + length_of_time;
 
         for (auto [entity, history] : inputs.each()) {
-            for (auto &entry : history.entries) {
-                if (entry.timestamp > end_time) {
-                    break;
-                }
-
-                if (entry.timestamp >= start_time) {
-                    import_component(registry, entity, entry.component, emap);
-                }
-            }
+            history->each(start_time, end_time, [&, entity = entity](auto &entry) {
+                import_component(registry, entity, entry.component, emap);
+            });
         }
     }
 
@@ -303,22 +547,15 @@ class input_state_history_reader_impl : public input_state_history_reader {
         }
     }
 
-    template<typename Array>
-    auto first_before(const Array &arr, double timestamp) const {
-        return std::find_if(arr.rbegin(), arr.rend(),
-                            [timestamp](auto &&elem) { return elem.timestamp <= timestamp; });
-    }
-
     template<typename Component>
     void import_latest_inputs(double time, entt::registry &registry, const entity_map &emap) const {
         auto &inputs = m_history->template get_inputs<Component>();
+        auto entry = typename internal::component_history<Component>::entry{};
 
         for (auto [entity, history] : inputs.each()) {
             // Import the first component state that's before the given time.
-            auto it = first_before(history.entries, time);
-
-            if (it != history.entries.rend()) {
-                import_component(registry, entity, it->component, emap);
+            if (history->latest_before(time, entry)) {
+                import_component(registry, entity, entry.component, emap);
             }
         }
     }
@@ -373,13 +610,17 @@ public:
 
     void import_each(double start_time, double length_of_time,
                      entt::registry &registry, const entity_map &emap) const override {
-        std::lock_guard lock(m_history->mutex);
-        (import_each_input<Inputs>(start_time, length_of_time, registry, emap), ...);
+        {
+            std::shared_lock lock(m_history->mutex);
+            (import_each_input<Inputs>(start_time, length_of_time, registry, emap), ...);
+        }
+
+        std::lock_guard lock(m_history->actions_mutex);
         import_each_action(start_time, length_of_time, registry, emap);
     }
 
     void import_latest(double time, entt::registry &registry, const entity_map &emap) const override {
-        std::lock_guard lock(m_history->mutex);
+        std::shared_lock lock(m_history->mutex);
         (import_latest_inputs<Inputs>(time, registry, emap), ...);
     }
 
@@ -0,0 +1,241 @@
+#ifndef EDYN_NETWORKING_UTIL_INTEREST_GRID_HPP
+#define EDYN_NETWORKING_UTIL_INTEREST_GRID_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/sparse_set.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief An inclusive range of cells of an `interest_grid`.
+ */
+struct interest_cell_range {
+    std::array<int32_t, 3> min {0, 0, 0};
+    std::array<int32_t, 3> max {-1, -1, -1};
+
+    bool empty() const {
+        return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+    }
+
+    bool contains(const std::array<int32_t, 3> &cell) const {
+        return min[0] <= cell[0] && cell[0] <= max[0] &&
+               min[1] <= cell[1] && cell[1] <= max[1] &&
+               min[2] <= cell[2] && cell[2] <= max[2];
+    }
+
+    bool intersects(const interest_cell_range &other) const {
+        return min[0] <= other.max[0] && other.min[0] <= max[0] &&
+               min[1] <= other.max[1] && other.min[1] <= max[1] &&
+               min[2] <= other.max[2] && other.min[2] <= max[2];
+    }
+
+    size_t volume() const {
+        if (empty()) return 0;
+        return size_t(max[0] - min[0] + 1) * size_t(max[1] - min[1] + 1) * size_t(max[2] - min[2] + 1);
+    }
+
+    bool operator==(const interest_cell_range &other) const {
+        return min == other.min && max == other.max;
+    }
+
+    bool operator!=(const interest_cell_range &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @brief Uniform grid which buckets items by their AABB, used for interest
+ * management in the server. Items are islands and non-procedural entities,
+ * each of which holds a list of entities that become of interest to a client
+ * when the item intersects its AABB of interest. Cells only narrow down the
+ * candidates, which are then checked against the actual AABB. Items are moved
+ * between cells only when the range of cells they overlap changes. Cells in
+ * which items were inserted, removed or modified are marked as dirty, allowing
+ * clients to skip updates when none of the cells they overlap changed.
+ */
+class interest_grid {
+public:
+    interest_grid(scalar cell_size);
+
+    scalar cell_size() const {
+        return m_cell_size;
+    }
+
+    /**
+     * @brief Calculates the range of cells which overlap an AABB.
+     */
+    interest_cell_range get_cell_range(const AABB &aabb) const;
+
+    /**
+     * @brief Must be called before items are updated. Clears dirty cells.
+     */
+    void begin_update();
+
+    /**
+     * @brief Inserts a new item or updates an existing one. Items which are not
+     * updated between `begin_update` and `end_update` are removed.
+     * @param item The item, i.e. an island or a non-procedural entity.
+     * @param aabb The item's AABB.
+     * @param entities Entities that are of interest when the item is.
+     * @param content_hash Hash of `entities`. The cells of the item are marked
+     * as dirty if it changes.
+     */
+    void update_item(entt::entity item, const AABB &aabb,
+                     std::vector<entt::entity> &&entities, uint64_t content_hash);
+
+    /**
+     * @brief Removes items which were not updated since `begin_update`.
+     */
+    void end_update();
+
+    /**
+     * @brief Whether any of the cells in the range became dirty in the last
+     * update.
+     */
+    bool is_dirty(const interest_cell_range &range) const;
+
+    /**
+     * @brief Whether the set of items which intersect the AABB might have
+     * changed in the last update. Besides dirty cells, this considers items
+     * which moved within cells that are not entirely inside the AABB.
+     */
+    bool is_dirty(const AABB &aabb) const;
+
+    /**
+     * @brief Visits the entities of all items in the given cells. Items which
+     * span multiple cells are visited once.
+     * @param range Range of cells.
+     * @param func Function with signature `void(entt::entity)`.
+     */
+    template<typename Func>
+    void each_entity(const interest_cell_range &range, Func func) const;
+
+    /**
+     * @brief Visits the entities of all items which intersect the AABB. Items
+     * which span multiple cells are visited once.
+     * @param aabb Query AABB.
+     * @param func Function with signature `void(entt::entity)`.
+     */
+    template<typename Func>
+    void each_entity(const AABB &aabb, Func func) const;
+
+    // Items which overlap more cells than this are not inserted in cells and
+    // instead are checked individually in queries.
+    static constexpr size_t max_item_cells = 512;
+
+    // Cell coordinates are clamped into this range.
+    static constexpr int32_t max_cell_coordinate = (1 << 20) - 1;
+
+private:
+    using cell_key_type = uint64_t;
+
+    struct item_info {
+        AABB aabb;
+        interest_cell_range range;
+        std::vector<entt::entity> entities;
+        uint64_t content_hash;
+        uint32_t generation;
+        bool large;
+    };
+
+    static cell_key_type make_key(int32_t x, int32_t y, int32_t z);
+    static std::array<int32_t, 3> key_to_cell(cell_key_type key);
+
+    void insert_into_cells(entt::entity item, const interest_cell_range &range);
+    void remove_from_cells(entt::entity item, const interest_cell_range &range);
+    void mark_dirty(const interest_cell_range &range);
+    void mark_moved(const interest_cell_range &range);
+    bool cell_inside(const std::array<int32_t, 3> &cell, const AABB &aabb) const;
+
+    template<typename Func>
+    void each_item(const interest_cell_range &range, Func func) const;
+
+    scalar m_cell_size;
+    std::unordered_map<entt::entity, item_info> m_items;
+    std::unordered_map<cell_key_type, std::vector<entt::entity>> m_cells;
+    std::vector<entt::entity> m_large_items;
+    std::unordered_set<cell_key_type> m_dirty_cells;
+    // Cells in which items moved without changing their range of cells.
+    std::unordered_set<cell_key_type> m_moved_cells;
+    bool m_large_items_dirty {false};
+    uint32_t m_generation {0};
+};
+
+template<typename Func>
+void interest_grid::each_item(const interest_cell_range &range, Func func) const {
+    if (range.empty()) {
+        return;
+    }
+
+    auto visited = entt::sparse_set{};
+
+    auto visit = [&](entt::entity item) {
+        if (!visited.contains(item)) {
+            visited.emplace(item);
+            func(m_items.at(item));
+        }
+    };
+
+    // Iterate over the cells in range or over all non-empty cells, whichever
+    // is smaller.
+    if (range.volume() <= m_cells.size()) {
+        for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+            for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+                for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                    auto it = m_cells.find(make_key(x, y, z));
+
+                    if (it != m_cells.end()) {
+                        for (auto item : it->second) {
+                            visit(item);
+                        }
+                    }
+                }
+            }
+        }
+    } else {
+        for (auto &[key, items] : m_cells) {
+            if (range.contains(key_to_cell(key))) {
+                for (auto item : items) {
+                    visit(item);
+                }
+            }
+        }
+    }
+
+    for (auto item : m_large_items) {
+        if (m_items.at(item).range.intersects(range)) {
+            visit(item);
+        }
+    }
+}
+
+template<typename Func>
+void interest_grid::each_entity(const interest_cell_range &range, Func func) const {
+    each_item(range, [&](const item_info &info) {
+        for (auto entity : info.entities) {
+            func(entity);
+        }
+    });
+}
+
+template<typename Func>
+void interest_grid::each_entity(const AABB &aabb, Func func) const {
+    each_item(get_cell_range(aabb), [&](const item_info &info) {
+        if (intersect(info.aabb, aabb)) {
+            for (auto entity : info.entities) {
+                func(entity);
+            }
+        }
+    });
+}
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_INTEREST_GRID_HPP
@@ -0,0 +1,123 @@
+#ifndef EDYN_NETWORKING_UTIL_LAG_COMPENSATION_HISTORY_HPP
+#define EDYN_NETWORKING_UTIL_LAG_COMPENSATION_HISTORY_HPP
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <entt/entity/fwd.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/collision/raycast.hpp"
+#include "edyn/collision/static_tree.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Keeps the recent transforms and AABBs of networked procedural bodies
+ * on the server, allowing queries to be performed against the world as it was
+ * at an earlier time, such as when a client fired a shot, i.e. lag
+ * compensation.
+ *
+ * Frames are grouped in chunks of consecutive frames. Once a chunk is
+ * complete, a tree is built over the AABBs swept by each body during the
+ * chunk, which is used to find candidates in queries at any time in the
+ * chunk. Candidates are then tested against their state interpolated at the
+ * time of the query. Frames in the chunk which is still being filled are
+ * scanned linearly.
+ */
+class lag_compensation_history {
+public:
+    struct record {
+        entt::entity entity;
+        vector3 pos;
+        quaternion orn;
+        AABB aabb;
+    };
+
+    /**
+     * @brief Records the current state of networked procedural bodies.
+     * @param registry Data source.
+     * @param timestamp Simulation time of the current state. Must be greater
+     * than the timestamp of the previous frame, otherwise it is ignored.
+     */
+    void record_frame(entt::registry &registry, double timestamp);
+
+    /**
+     * @brief Erases frames which are older than the given time, keeping
+     * whole chunks.
+     */
+    void erase_until(double timestamp);
+
+    /**
+     * @brief Performs a raycast against bodies as they were at the given
+     * time, which is clamped into the recorded range.
+     * @param registry Data source where the shapes are obtained from.
+     * @param time Simulation time.
+     * @param p0 First point in the ray.
+     * @param p1 Second point in the ray.
+     * @param ignore_entities Entities to be ignored.
+     * @return Result containing the first entity hit by the ray, where the
+     * normal is given in world space at the given time.
+     */
+    raycast_result raycast(entt::registry &registry, double time,
+                           vector3 p0, vector3 p1,
+                           const std::vector<entt::entity> &ignore_entities = {}) const;
+
+    /**
+     * @brief Finds bodies whose AABB intersected the given AABB at the given
+     * time, which is clamped into the recorded range. Bodies which have been
+     * destroyed since are not included.
+     * @param registry Data source used to check whether bodies still exist.
+     * @param time Simulation time.
+     * @param aabb Query AABB.
+     */
+    std::vector<entt::entity> query_aabb(entt::registry &registry, double time, const AABB &aabb) const;
+
+    /**
+     * @brief Number of frames in each chunk.
+     */
+    void set_chunk_size(unsigned chunk_size);
+
+    bool empty() const {
+        return m_frames.empty();
+    }
+
+    double oldest_timestamp() const;
+    double newest_timestamp() const;
+
+private:
+    struct frame {
+        double timestamp;
+        // Sorted by entity.
+        std::vector<record> records;
+    };
+
+    struct chunk {
+        // Absolute index of first frame.
+        uint64_t first_frame;
+        // Leaves reference elements of `entities`.
+        static_tree tree;
+        std::vector<entt::entity> entities;
+    };
+
+    const frame & get_frame(uint64_t index) const;
+    void build_chunk(uint64_t first_frame);
+    uint64_t find_frame(double time) const;
+
+    // Visit the state of all bodies which could intersect the query volume
+    // at the given time, interpolated between the frame at or before the
+    // time and the next frame.
+    template<typename TreeFunc, typename VisitFunc>
+    void visit_candidates(double time, TreeFunc tree_func, VisitFunc visit_func) const;
+
+    std::deque<frame> m_frames;
+    std::deque<chunk> m_chunks;
+    // Absolute index of the first frame in `m_frames`.
+    uint64_t m_frame_offset {0};
+    unsigned m_chunk_size {8};
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_LAG_COMPENSATION_HISTORY_HPP
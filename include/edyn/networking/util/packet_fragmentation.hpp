@@ -0,0 +1,91 @@
+#ifndef EDYN_NETWORKING_UTIL_PACKET_FRAGMENTATION_HPP
+#define EDYN_NETWORKING_UTIL_PACKET_FRAGMENTATION_HPP
+
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/packet/entity_entered.hpp"
+#include "edyn/networking/packet/packet_fragment.hpp"
+
+namespace edyn {
+
+namespace packet {
+    struct edyn_packet;
+}
+
+/**
+ * @brief Calculates the number of bytes a packet takes once serialized.
+ */
+size_t serialized_packet_size(const packet::edyn_packet &packet);
+
+/**
+ * @brief Splits a registry snapshot into smaller snapshots holding a subset of
+ * its entities, each of which takes at most `max_size` bytes once serialized
+ * unless it holds a single entity. Each snapshot contains all components of
+ * its entities, thus they can be applied independently.
+ * @param snapshot The registry snapshot.
+ * @param max_size Maximum serialized size.
+ * @return List of snapshots. Contains a copy of the original snapshot if it
+ * does not need splitting.
+ */
+std::vector<packet::registry_snapshot>
+split_registry_snapshot(const packet::registry_snapshot &snapshot, size_t max_size);
+
+/**
+ * @brief Distributes the entries of an `entity_entered` packet into multiple
+ * packets which take at most `max_size` bytes once serialized unless they hold
+ * a single entry. Entries are independent of one another.
+ * @param packet The packet to be split.
+ * @param max_size Maximum serialized size.
+ * @return List of packets.
+ */
+std::vector<packet::entity_entered>
+split_entity_entered(packet::entity_entered &&packet, size_t max_size);
+
+/**
+ * @brief Splits a serialized packet into fragments whose data has at most
+ * `max_size` bytes, to be reassembled with a `fragment_assembler`.
+ * @param packet The packet to be fragmented.
+ * @param message_id Identifier which must be unique among the packets that
+ * are being reassembled at any time by the receiver.
+ * @param max_size Maximum size of the data of each fragment.
+ * @return List of fragments.
+ */
+std::vector<packet::packet_fragment>
+fragment_packet(const packet::edyn_packet &packet, uint16_t message_id, size_t max_size);
+
+/**
+ * @brief Reassembles packets from their fragments, which can arrive in any
+ * order.
+ */
+class fragment_assembler {
+public:
+    /**
+     * @brief Inserts a fragment.
+     * @param fragment The fragment.
+     * @param packet Destination of the reassembled packet.
+     * @return Whether this was the last missing fragment of a packet, which
+     * was deserialized into `packet` successfully.
+     */
+    bool insert(const packet::packet_fragment &fragment, packet::edyn_packet &packet);
+
+    // Maximum number of packets being reassembled at once. The oldest are
+    // dropped when exceeded.
+    static constexpr size_t max_pending = 16;
+
+private:
+    struct pending_packet {
+        std::vector<std::vector<uint8_t>> fragments;
+        size_t num_received {0};
+        size_t age {0};
+    };
+
+    std::map<uint16_t, pending_packet> m_pending;
+    size_t m_counter {0};
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_PACKET_FRAGMENTATION_HPP
@@ -26,7 +26,17 @@ void serialize(Archive &archive, pool_snapshot &pool) {
         archive(data);
         auto input = memory_input_archive(data.data(), data.size());
         pool.ptr = (*g_make_pool_snapshot_data)(pool.component_index);
+
+        if (!pool.ptr) {
+            archive.fail();
+            return;
+        }
+
         pool.ptr->read(input);
+
+        if (input.failed()) {
+            archive.fail();
+        }
     } else {
         auto output = memory_output_archive(data);
         pool.ptr->write(output);
@@ -34,6 +44,23 @@ void serialize(Archive &archive, pool_snapshot &pool) {
     }
 }
 
+/**
+ * @brief Fails an input archive if any pool refers to an entity index that is
+ * out of bounds in a snapshot with `num_entities` entities. Must be called
+ * after deserializing the pools of snapshots received from remote peers.
+ */
+template<typename Archive>
+void check_pool_entity_indices(Archive &archive, const std::vector<pool_snapshot> &pools, size_t num_entities) {
+    if constexpr(Archive::is_input::value) {
+        for (auto &pool : pools) {
+            if (pool.ptr && !pool.ptr->indices_in_range(num_entities)) {
+                archive.fail();
+                return;
+            }
+        }
+    }
+}
+
 template<typename... Components>
 auto create_make_pool_snapshot_data_function([[maybe_unused]] std::tuple<Components...>) {
     return [](component_index_type component_index) {
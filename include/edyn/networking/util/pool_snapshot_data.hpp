@@ -1,8 +1,10 @@
 #ifndef EDYN_NETWORKING_UTIL_POOL_SNAPSHOT_DATA_HPP
 #define EDYN_NETWORKING_UTIL_POOL_SNAPSHOT_DATA_HPP
 
+#include <limits>
 #include <iterator>
 #include <memory>
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include <entt/entity/fwd.hpp>
@@ -17,8 +19,10 @@
 namespace edyn {
 
 struct pool_snapshot_data {
-    // Snapshot is not expected to have more than 256 entities.
-    using index_type = uint8_t;
+    // Indices are serialized with the smallest width that fits the largest
+    // index in the pool, thus small snapshots take a single byte per entity.
+    using index_type = uint32_t;
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
     std::vector<index_type> entity_indices;
 
     virtual ~pool_snapshot_data() = default;
@@ -26,6 +30,15 @@ struct pool_snapshot_data {
     virtual void write(memory_output_archive &archive) = 0;
     virtual void read(memory_input_archive &archive) = 0;
 
+    /**
+     * @brief Creates a pool containing only the elements of the entities in a
+     * subset of the snapshot entities.
+     * @param index_map Maps indices into the snapshot entities to indices into
+     * the subset, or to `null_index` if the entity is not in the subset.
+     * @return The new pool, which might be empty.
+     */
+    virtual std::unique_ptr<pool_snapshot_data> subset(const std::vector<index_type> &index_map) const = 0;
+
     virtual void replace_into_registry(entt::registry &registry,
                                        const std::vector<entt::entity> &entities,
                                        const entity_map &emap) = 0;
@@ -38,6 +51,75 @@ struct pool_snapshot_data {
     bool empty() const {
         return entity_indices.empty();
     }
+
+    /**
+     * @brief Checks whether all entity indices refer to an entity in a
+     * snapshot with `num_entities` entities.
+     */
+    bool indices_in_range(size_t num_entities) const {
+        return std::all_of(entity_indices.begin(), entity_indices.end(),
+                           [num_entities](auto idx) { return idx < num_entities; });
+    }
+
+protected:
+    void write_indices(memory_output_archive &archive) const {
+        auto num_entities = static_cast<index_type>(entity_indices.size());
+        auto max_value = num_entities;
+
+        for (auto idx : entity_indices) {
+            max_value = std::max(max_value, idx);
+        }
+
+        uint8_t width = max_value <= std::numeric_limits<uint8_t>::max() ? 1 :
+                        max_value <= std::numeric_limits<uint16_t>::max() ? 2 : 4;
+        archive(width);
+        write_index(archive, num_entities, width);
+
+        for (auto idx : entity_indices) {
+            write_index(archive, idx, width);
+        }
+    }
+
+    void read_indices(memory_input_archive &archive) {
+        uint8_t width;
+        archive(width);
+
+        if (width != 1 && width != 2 && width != 4) {
+            entity_indices.clear();
+            archive.fail();
+            return;
+        }
+
+        auto num_entities = read_index(archive, width);
+
+        if (!archive.expect_remaining(num_entities, width)) {
+            entity_indices.clear();
+            return;
+        }
+
+        entity_indices.resize(num_entities);
+
+        for (auto &idx : entity_indices) {
+            idx = read_index(archive, width);
+        }
+    }
+
+private:
+    static void write_index(memory_output_archive &archive, index_type value, uint8_t width) {
+        switch (width) {
+        case 1: archive(static_cast<uint8_t>(value)); break;
+        case 2: archive(static_cast<uint16_t>(value)); break;
+        default: archive(value);
+        }
+    }
+
+    static index_type read_index(memory_input_archive &archive, uint8_t width) {
+        switch (width) {
+        case 1: { uint8_t value {}; archive(value); return value; }
+        case 2: { uint16_t value {}; archive(value); return value; }
+        default: { index_type value {}; archive(value); return value; }
+        }
+    }
 };
 
 template<typename Component>
@@ -55,12 +137,7 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
     }
 
     void write(memory_output_archive &archive) override {
-        index_type num_entities = static_cast<index_type>(entity_indices.size());
-        archive(num_entities);
-
-        for (auto &idx : entity_indices) {
-            archive(idx);
-        }
+        write_indices(archive);
 
         if constexpr(!is_empty_type) {
             for (auto &comp : components) {
@@ -70,16 +147,16 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
     }
 
     void read(memory_input_archive &archive) override {
-        index_type num_entities;
-        archive(num_entities);
-        entity_indices.resize(num_entities);
-
-        for (auto &idx : entity_indices) {
-            archive(idx);
-        }
+        read_indices(archive);
 
         if constexpr(!is_empty_type) {
-            components.resize(num_entities);
+            if (!archive.expect_remaining(entity_indices.size(), internal::min_serialized_size<Component>())) {
+                entity_indices.clear();
+                components.clear();
+                return;
+            }
+
+            components.resize(entity_indices.size());
 
             for (auto &comp : components) {
                 archive(comp);
@@ -87,6 +164,26 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
         }
     }
 
+    std::unique_ptr<pool_snapshot_data> subset(const std::vector<index_type> &index_map) const override {
+        auto result = std::make_unique<pool_snapshot_data_impl<Component>>();
+
+        for (size_t i = 0; i < entity_indices.size(); ++i) {
+            auto idx = index_map[entity_indices[i]];
+
+            if (idx == null_index) {
+                continue;
+            }
+
+            result->entity_indices.push_back(idx);
+
+            if constexpr(!is_empty_type) {
+                result->components.push_back(components[i]);
+            }
+        }
+
+        return result;
+    }
+
     void replace_into_registry(entt::registry &registry,
                                const std::vector<entt::entity> &pool_entities,
                                const entity_map &emap) override {
@@ -0,0 +1,50 @@
+#ifndef EDYN_NETWORKING_UTIL_PRIORITIZE_SNAPSHOT_HPP
+#define EDYN_NETWORKING_UTIL_PRIORITIZE_SNAPSHOT_HPP
+
+#include <entt/entity/fwd.hpp>
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/settings/snapshot_priority.hpp"
+
+namespace edyn {
+
+struct remote_client;
+class server_snapshot_exporter;
+
+/**
+ * @brief Inserts the components of entities which were left out of previous
+ * snapshots by `prioritize_snapshot` and have not been sent since. Entities
+ * which are no longer of interest are forgotten, since their full state is
+ * sent again when they reenter the client's AABB of interest.
+ * @param registry The server registry.
+ * @param exporter Snapshot exporter which created the snapshot.
+ * @param client The destination client's `remote_client` component.
+ * @param entities_of_interest Entities in the client's AABB of interest.
+ * @param snapshot Snapshot with all modified entities in the client's AABB of
+ * interest.
+ */
+void insert_pending_snapshot_components(const entt::registry &registry,
+                                        const server_snapshot_exporter &exporter,
+                                        remote_client &client,
+                                        const entt::sparse_set &entities_of_interest,
+                                        packet::registry_snapshot &snapshot);
+
+/**
+ * @brief Reduces a registry snapshot to the entities with the highest
+ * accumulated priority whose components fit into the byte budget. Entities
+ * which are left out keep accumulating priority and their components are
+ * kept pending, thus they are sent later even if no longer modified.
+ * The snapshot is left untouched if the budget is unlimited.
+ * @param registry The server registry.
+ * @param client_entity The destination client.
+ * @param client The destination client's `remote_client` component.
+ * @param snapshot Snapshot with all modified entities in the client's AABB of
+ * interest.
+ * @param priority Prioritization parameters.
+ */
+void prioritize_snapshot(const entt::registry &registry, entt::entity client_entity,
+                         remote_client &client, packet::registry_snapshot &snapshot,
+                         const snapshot_priority &priority);
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_PRIORITIZE_SNAPSHOT_HPP
@@ -12,6 +12,7 @@
 #include "edyn/comp/child_list.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/graph_node.hpp"
+#include "edyn/comp/island.hpp"
 #include "edyn/comp/linvel.hpp"
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/position.hpp"
@@ -21,12 +22,14 @@
 #include "edyn/networking/comp/action_history.hpp"
 #include "edyn/networking/comp/entity_owner.hpp"
 #include "edyn/networking/comp/exporter_modified_components.hpp"
+#include "edyn/networking/comp/island_owners.hpp"
 #include "edyn/networking/comp/network_input.hpp"
 #include "edyn/networking/comp/remote_client.hpp"
 #include "edyn/networking/packet/registry_snapshot.hpp"
 #include "edyn/networking/util/component_index_type.hpp"
 #include "edyn/util/island_util.hpp"
 #include "edyn/util/tuple_util.hpp"
+#include "edyn/util/vector_util.hpp"
 
 namespace edyn {
 
@@ -39,6 +42,8 @@ public:
     virtual void export_all(packet::registry_snapshot &snap, const std::vector<entt::entity> &entities) const = 0;
 
     // Write all components that have been recently modified into a snapshot.
+    // Only reads from the registry, thus it can be called for multiple clients
+    // in parallel.
     virtual void export_modified(packet::registry_snapshot &snap,
                                  const entt::sparse_set &entities_of_interest,
                                  entt::entity dest_client_entity) const = 0;
@@ -48,6 +53,7 @@ public:
 
     // Decays the time remaining in each of the recently modified components.
     // They stop being included in the snapshot once the timer reaches zero.
+    // Also recalculates the owners of each island.
     virtual void update(double time) = 0;
 
     template<typename Component>
@@ -124,6 +130,100 @@ class server_snapshot_exporter_impl : public server_snapshot_exporter {
         }
     }
 
+    void update_island_owners() {
+        auto &registry = *m_registry;
+        registry.clear<island_owners>();
+
+        auto island_view = registry.view<island_tag>();
+
+        auto insert_owner = [&](entt::entity island_entity, entt::entity client_entity) {
+            if (!island_view.contains(island_entity)) {
+                return;
+            }
+
+            auto &owners = registry.get_or_emplace<island_owners>(island_entity);
+
+            if (!vector_contains(owners.client_entities, client_entity)) {
+                owners.client_entities.push_back(client_entity);
+            }
+        };
+
+        for (auto [entity, owner, resident] : registry.view<entity_owner, island_resident>().each()) {
+            if (owner.client_entity != entt::null) {
+                insert_owner(resident.island_entity, owner.client_entity);
+            }
+        }
+
+        for (auto [entity, owner, resident] : registry.view<entity_owner, multi_island_resident>().each()) {
+            if (owner.client_entity != entt::null) {
+                for (auto island_entity : resident.island_entities) {
+                    insert_owner(island_entity, owner.client_entity);
+                }
+            }
+        }
+    }
+
+    // Determines whether the destination client and other clients own
+    // entities that are reachable from this entity through the entity graph.
+    // The owners of the island where the entity resides are used if known,
+    // otherwise the graph is traversed.
+    void find_reachable_clients(entt::entity entity, entt::entity dest_client_entity,
+                                bool &dest_client_reachable, bool &other_client_reachable) const {
+        const auto &registry = *m_registry;
+        auto resident_view = registry.view<island_resident>();
+        auto island_view = registry.view<island_tag>();
+        auto island_owners_view = registry.view<island_owners>();
+
+        auto check_owner = [&](entt::entity client_entity) {
+            if (client_entity == dest_client_entity) {
+                dest_client_reachable = true;
+            } else if (client_entity != entt::null) {
+                other_client_reachable = true;
+            }
+        };
+
+        if (resident_view.contains(entity)) {
+            auto [resident] = resident_view.get(entity);
+
+            if (island_view.contains(resident.island_entity)) {
+                if (island_owners_view.contains(resident.island_entity)) {
+                    auto [owners] = island_owners_view.get(resident.island_entity);
+
+                    for (auto client_entity : owners.client_entities) {
+                        check_owner(client_entity);
+                    }
+                }
+
+                return;
+            }
+        }
+
+        // Traverse entity graph using this entity as the starting point and
+        // collect all owners (i.e. clients) that are reachable from this node.
+        auto &graph = registry.ctx().at<entity_graph>();
+        auto node_view = registry.view<graph_node>();
+        auto edge_view = registry.view<graph_edge>();
+        auto owner_view = registry.view<entity_owner>();
+        entity_graph::index_type node_index;
+
+        if (edge_view.contains(entity)) {
+            auto [edge] = edge_view.get(entity);
+            node_index = graph.edge_node_indices(edge.edge_index)[0];
+        } else {
+            auto [node] = node_view.get(entity);
+            node_index = node.node_index;
+        }
+
+        graph.traverse(node_index, [&](auto node_index) {
+            auto neighbor = graph.node_entity(node_index);
+
+            if (owner_view.contains(neighbor)) {
+                auto [owner] = owner_view.get(neighbor);
+                check_owner(owner.client_entity);
+            }
+        });
+    }
+
     template<typename It, size_t... Indexes>
     void export_all_indices(packet::registry_snapshot &snap, It first, It last, std::index_sequence<Indexes...>) const {
         (export_single<Components>(snap, first, last, Indexes), ...);
@@ -158,12 +258,9 @@ public:
     void export_modified(packet::registry_snapshot &snap,
                          const entt::sparse_set &entities_of_interest,
                          entt::entity dest_client_entity) const override {
-        auto &registry = *m_registry;
-        auto &graph = registry.ctx().at<entity_graph>();
-        auto node_view = registry.view<graph_node>();
-        auto edge_view = registry.view<graph_edge>();
-        auto owner_view = registry.view<const entity_owner>();
-        auto modified_view = registry.view<const modified_components>();
+        const auto &registry = *m_registry;
+        auto owner_view = registry.view<entity_owner>();
+        auto modified_view = registry.view<modified_components>();
         auto parent_view = registry.view<parent_comp>();
         auto child_view = registry.view<child_list>();
 
@@ -188,39 +285,16 @@ public:
                 continue;
             }
 
-            // Traverse entity graph using this entity as the starting point and
-            // collect all owners (i.e. clients) that are reachable from this node.
+            // Find all owners (i.e. clients) that are reachable from this entity.
             // If the only reachable client is the destination client, do not
             // include this entity in the packet because the client is allowed to
             // own the island when it's in it by itself.
-            entity_graph::index_type node_index;
-            bool dest_client_reachable = false;
-            bool other_client_reachable = false;
-
-            if (edge_view.contains(entity)) {
-                auto [edge] = edge_view.get(entity);
-                node_index = graph.edge_node_indices(edge.edge_index)[0];
-            } else {
-                auto [node] = node_view.get(entity);
-                node_index = node.node_index;
-            }
-
             bool temporary_ownership = false;
 
             if (allow_ownership) {
-                graph.traverse(node_index, [&](auto node_index) {
-                    auto neighbor = graph.node_entity(node_index);
-
-                    if (owner_view.contains(neighbor)) {
-                        auto [owner] = owner_view.get(neighbor);
-
-                        if (owner.client_entity == dest_client_entity) {
-                            dest_client_reachable = true;
-                        } else if (owner.client_entity != entt::null) {
-                            other_client_reachable = true;
-                        }
-                    }
-                });
+                bool dest_client_reachable = false;
+                bool other_client_reachable = false;
+                find_reachable_clients(entity, dest_client_entity, dest_client_reachable, other_client_reachable);
 
                 // The client temporarily owns the entity if it's the only client
                 // reachable through the graph.
@@ -293,6 +367,8 @@ public:
                 bump_component<position, orientation, linvel, angvel>(modified);
             }
         }
+
+        update_island_owners();
     }
 
 private:
@@ -0,0 +1,88 @@
+#ifndef EDYN_NETWORKING_UTIL_SNAPSHOT_CODEC_HPP
+#define EDYN_NETWORKING_UTIL_SNAPSHOT_CODEC_HPP
+
+#include <map>
+#include <array>
+#include <deque>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/vector3.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/packet/compact_registry_snapshot.hpp"
+#include "edyn/networking/settings/snapshot_quantization.hpp"
+#include "edyn/networking/util/component_index_type.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Quantized values of the components of a snapshot, which both ends
+ * keep so later snapshots can be delta-encoded against it.
+ */
+struct snapshot_baseline {
+    using key_type = std::pair<entt::entity, component_index_type>;
+    using value_type = std::array<int64_t, 4>;
+
+    uint16_t sequence;
+    std::map<key_type, value_type> values;
+};
+
+/**
+ * @brief Encodes registry snapshots sent to one client into compact
+ * snapshots. Positions are encoded as fixed-point values relative to an
+ * origin, orientations using the smallest-three method and velocities are
+ * quantized. These are delta-encoded against the latest snapshot acknowledged
+ * by the client. Pools of other components are written at full precision.
+ */
+class snapshot_encoder {
+public:
+    packet::compact_registry_snapshot encode(const packet::registry_snapshot &snapshot,
+                                             const vector3 &origin,
+                                             const snapshot_quantization &quantization);
+
+    /**
+     * @brief Marks a snapshot as received by the client, allowing it to be
+     * used as baseline.
+     * @param sequence Sequence of the acknowledged snapshot.
+     */
+    void acknowledge(uint16_t sequence);
+
+    // Snapshots older than this many sequences are not used as baseline,
+    // which guarantees the client still has them.
+    static constexpr uint16_t max_baseline_age = 32;
+
+private:
+    uint16_t m_next_sequence {0};
+    std::deque<snapshot_baseline> m_sent;
+    std::optional<snapshot_baseline> m_acked;
+};
+
+/**
+ * @brief Decodes compact snapshots received from the server.
+ */
+class snapshot_decoder {
+public:
+    /**
+     * @brief Decodes a compact snapshot.
+     * @param compact The compact snapshot.
+     * @param quantization Quantization used by the server.
+     * @param snapshot Destination snapshot.
+     * @return Whether the snapshot was decoded successfully. It fails if the
+     * data is malformed or if its baseline is unknown.
+     */
+    bool decode(const packet::compact_registry_snapshot &compact,
+                const snapshot_quantization &quantization,
+                packet::registry_snapshot &snapshot);
+
+    // Number of decoded snapshots kept as potential baselines. Must be greater
+    // than `snapshot_encoder::max_baseline_age`.
+    static constexpr size_t max_history = 64;
+
+private:
+    std::deque<snapshot_baseline> m_history;
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_SNAPSHOT_CODEC_HPP
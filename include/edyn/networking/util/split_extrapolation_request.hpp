@@ -0,0 +1,29 @@
+#ifndef EDYN_NETWORKING_UTIL_SPLIT_EXTRAPOLATION_REQUEST_HPP
+#define EDYN_NETWORKING_UTIL_SPLIT_EXTRAPOLATION_REQUEST_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include "edyn/networking/extrapolation/extrapolation_request.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Splits the snapshot of a request by island and assigns each island
+ * to one extrapolator. The extrapolator is chosen by the lowest entity in the
+ * island, thus the same island tends to go to the same extrapolator over
+ * time. Entities which are not in an island go to the first extrapolator.
+ * Each extrapolator receives the state of the islands assigned to the others
+ * as remote state.
+ * @param registry The client registry.
+ * @param request Request to be split.
+ * @param num_extrapolators Number of extrapolators.
+ * @return One request per extrapolator, which might be empty.
+ */
+std::vector<extrapolation_request>
+split_extrapolation_request(const entt::registry &registry,
+                            const extrapolation_request &request,
+                            size_t num_extrapolators);
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_SPLIT_EXTRAPOLATION_REQUEST_HPP
@@ -1,44 +1,69 @@
 #ifndef EDYN_PARALLEL_ATOMIC_COUNTER_SYNC_HPP
 #define EDYN_PARALLEL_ATOMIC_COUNTER_SYNC_HPP
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include "edyn/config/config.h"
+
+#if !defined(__linux__)
 #include <mutex>
 #include <condition_variable>
+#endif
 
 namespace edyn {
 
+/**
+ * @brief Counts down to zero and lets one thread wait until it gets there.
+ * Decrementing is a single atomic operation. The waiting thread spins for a
+ * short while before parking, which is done with a futex on Linux and with a
+ * condition variable elsewhere. The counter can be destroyed as soon as
+ * `wait()` returns.
+ */
 class atomic_counter_sync {
 public:
     atomic_counter_sync(size_t count)
-        : count(count)
-        , done(false)
+        : m_count(count)
+        , m_state(count == 0 ? state_done : state_pending)
     {}
 
     ~atomic_counter_sync() {
-        EDYN_ASSERT(count == 0);
+        EDYN_ASSERT(m_count.load(std::memory_order_relaxed) == 0);
     }
 
     void decrement() {
-        std::lock_guard lock(mutex);
-        EDYN_ASSERT(count > 0);
-        --count;
-        done = count == 0;
+        auto prev = m_count.fetch_sub(1, std::memory_order_acq_rel);
+        EDYN_ASSERT(prev > 0);
 
-        if (done) {
-            cv.notify_one();
+        if (prev == 1) {
+            release();
         }
     }
 
-    void wait() {
-        std::unique_lock lock(mutex);
-        cv.wait(lock, [&] { return done; });
+    bool done() const {
+        return m_state.load(std::memory_order_acquire) == state_done;
     }
 
+    /**
+     * @brief Blocks until the counter reaches zero. Must be called by a
+     * single thread.
+     */
+    void wait();
+
 private:
-    size_t count;
-    bool done;
-    std::mutex mutex;
-    std::condition_variable cv;
+    void release();
+
+    static constexpr uint32_t state_pending = 0;
+    static constexpr uint32_t state_parked = 1;
+    static constexpr uint32_t state_done = 2;
+
+    std::atomic<size_t> m_count;
+    std::atomic<uint32_t> m_state;
+
+#if !defined(__linux__)
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+#endif
 };
 
 }
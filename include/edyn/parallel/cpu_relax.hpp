@@ -0,0 +1,25 @@
+#ifndef EDYN_PARALLEL_CPU_RELAX_HPP
+#define EDYN_PARALLEL_CPU_RELAX_HPP
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace edyn {
+
+/**
+ * @brief Hints the processor that the calling thread is in a spin-wait loop.
+ */
+inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+}
+
+#endif // EDYN_PARALLEL_CPU_RELAX_HPP
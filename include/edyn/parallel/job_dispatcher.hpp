@@ -1,18 +1,38 @@
 #ifndef EDYN_PARALLEL_JOB_DISPATCHER_HPP
 #define EDYN_PARALLEL_JOB_DISPATCHER_HPP
 
-#include <map>
 #include <atomic>
 #include <vector>
 #include <thread>
-#include <mutex>
-#include <shared_mutex>
+#include <string>
+#include <memory>
 #include "edyn/parallel/worker.hpp"
+#include "edyn/parallel/thread_config.hpp"
 
 namespace edyn {
 
 struct job;
 
+/**
+ * @brief Placement and scheduling settings of the worker threads of a
+ * `job_dispatcher`.
+ */
+struct job_dispatcher_config {
+    // Base name of worker threads. The worker index is appended to it.
+    std::string name {"edyn-worker"};
+    // Logical CPUs worker threads are allowed to run on. All CPUs if empty.
+    std::vector<unsigned> cpus;
+    thread_priority priority {thread_priority::normal};
+    // Distribute workers among NUMA nodes and pin each to the CPUs of its
+    // node. Jobs are preferably scheduled on a worker in the same node as the
+    // calling thread.
+    bool numa_groups {false};
+    // CPUs reserved for latency-sensitive threads, i.e. the simulation and
+    // extrapolation workers. Worker threads avoid these CPUs if possible.
+    std::vector<unsigned> low_latency_cpus;
+    thread_priority low_latency_priority {thread_priority::normal};
+};
+
 /**
  * Manages a set of worker threads and dispatches jobs to them.
  */
@@ -22,12 +42,17 @@ public:
 
     ~job_dispatcher();
 
-    void start(size_t num_worker_threads);
+    void start(size_t num_worker_threads, const job_dispatcher_config &config = {});
 
     void stop();
 
     bool running() const;
 
+    /**
+     * Whether the calling thread is a worker of any dispatcher.
+     */
+    static bool is_worker_thread();
+
     /**
      * Schedules a job to run asynchronously in a worker thread.
      */
@@ -38,9 +63,28 @@ public:
      */
     size_t num_workers() const;
 
+    const job_dispatcher_config &config() const {
+        return m_config;
+    }
+
+    /**
+     * @brief Applies the low-latency configuration to the calling thread,
+     * which is meant to be a long-running latency-sensitive thread not owned
+     * by this dispatcher.
+     * @param name Thread name.
+     * @return Whether all settings were applied successfully.
+     */
+    bool apply_low_latency_config(const std::string &name) const;
+
 private:
+    size_t caller_node() const;
+
     std::vector<std::unique_ptr<std::thread>> m_threads;
-    std::map<std::thread::id, std::unique_ptr<worker>> m_workers;
+    std::vector<std::unique_ptr<worker>> m_workers;
+    // Indices of workers in each NUMA node and node of each logical CPU.
+    std::vector<std::vector<size_t>> m_node_workers;
+    std::vector<size_t> m_cpu_node;
+    job_dispatcher_config m_config;
     std::atomic<size_t> m_start;
 };
 
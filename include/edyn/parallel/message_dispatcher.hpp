@@ -3,6 +3,7 @@
 
 #include <mutex>
 #include <shared_mutex>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -64,6 +65,39 @@ public:
         return message_queue_handle<MessageTypes...>({name}, *m_queues.at(name));
     }
 
+    /**
+     * @brief Creates a queue whose name is the given prefix, followed by a
+     * number if a queue with that name already exists. Allows multiple
+     * instances of the same kind of queue to coexist, such as when multiple
+     * registries are attached in the same process.
+     * @param prefix Base name of the queue.
+     * @return Handle to the new queue, whose identifier holds the final name.
+     */
+    template<typename... MessageTypes>
+    auto make_unique_queue(const std::string &prefix) {
+        auto lock = std::lock_guard(m_queues_mutex);
+        auto name = prefix;
+
+        for (unsigned i = 1; m_queues.count(name); ++i) {
+            name = prefix + "_" + std::to_string(i);
+        }
+
+        m_queues[name] = std::make_unique<message_queue>();
+        return message_queue_handle<MessageTypes...>({name}, *m_queues.at(name));
+    }
+
+    /**
+     * @brief Destroys a queue, which allows its name to be reused. Handles
+     * to this queue must not be used afterwards. Messages sent to it are
+     * discarded. Does nothing if the queue does not exist, e.g. if it was
+     * removed in `clear_queues`.
+     * @param identifier Identifier of the queue to be removed.
+     */
+    void remove_queue(const message_queue_identifier &identifier) {
+        auto lock = std::lock_guard(m_queues_mutex);
+        m_queues.erase(identifier.value);
+    }
+
     template<typename T, typename... Args>
     void send(message_queue_identifier destination, message_queue_identifier source, Args&& ... args) {
         auto lock = std::shared_lock(m_queues_mutex);
@@ -73,7 +107,7 @@ public:
     }
 
     void clear_queues() {
-        auto lock = std::shared_lock(m_queues_mutex);
+        auto lock = std::lock_guard(m_queues_mutex);
         m_queues.clear();
     }
 
@@ -2,27 +2,62 @@
 #define EDYN_PARALLEL_PARALLEL_FOR_HPP
 
 #include <atomic>
-#include <condition_variable>
+#include <algorithm>
 #include <iterator>
 #include "edyn/config/config.h"
 #include "edyn/parallel/job.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/atomic_counter_sync.hpp"
+#include "edyn/time/time.hpp"
 #include "edyn/serialization/memory_archive.hpp"
 
 namespace edyn {
 
 namespace detail {
 
+// Duration of the initial run in the calling thread that measures the cost
+// per element of the loop body.
+constexpr double parallel_for_probe_time = 2e-6;
+
+// If the estimated time for the remaining elements is below this threshold,
+// they are processed in the calling thread since the cost of dispatching and
+// synchronizing jobs would dominate.
+constexpr double parallel_for_min_parallel_time = 20e-6;
+
+// Desired duration of each chunk. Big enough to amortize the cost of claiming
+// a chunk and small enough to balance the load among threads.
+constexpr double parallel_for_target_chunk_time = 50e-6;
+
+/**
+ * @brief Calculates how many elements should be processed per chunk given
+ * the measured cost per element.
+ * @param cost_per_element Time in seconds per element.
+ * @param remaining Number of elements left to be processed.
+ * @param num_threads Number of threads which will process chunks.
+ * @return Chunk size, which is at least 1.
+ */
+inline size_t parallel_for_chunk_size(double cost_per_element, size_t remaining, size_t num_threads) {
+    auto max_chunk_size = remaining / num_threads + static_cast<size_t>(remaining % num_threads != 0);
+    auto chunk_size = max_chunk_size;
+
+    if (cost_per_element > 0) {
+        auto target = parallel_for_target_chunk_time / cost_per_element;
+
+        if (target < static_cast<double>(max_chunk_size)) {
+            chunk_size = static_cast<size_t>(target);
+        }
+    }
+
+    return std::max(chunk_size, size_t{1});
+}
+
 template<typename IndexType, typename Function>
 struct parallel_for_context {
     std::atomic<IndexType> current;
     const IndexType last;
     const IndexType step;
     const IndexType chunk_size;
-    size_t count;
-    bool done;
-    std::mutex mutex;
-    std::condition_variable cv;
+    atomic_counter_sync counter;
     Function func;
 
     parallel_for_context(IndexType first, IndexType last, IndexType step,
@@ -31,44 +66,47 @@ struct parallel_for_context {
         , last(last)
         , step(step)
         , chunk_size(chunk_size)
-        , count(num_jobs)
-        , done(false)
+        , counter(num_jobs)
         , func(func)
     {}
+};
 
-    ~parallel_for_context() {
-        EDYN_ASSERT(count == 0);
-    }
+/**
+ * @brief Runs the loop body for exponentially growing batches of elements
+ * starting at `first` until the probe time elapses or the range ends.
+ * @param cost_per_index Receives the measured time in seconds per unit of index.
+ * @return Index where the probe stopped.
+ */
+template<typename IndexType, typename Function>
+IndexType probe_parallel_for(IndexType first, IndexType last, IndexType step,
+                             Function &func, double &cost_per_index) {
+    const auto freq = static_cast<double>(performance_frequency());
+    const auto start = performance_counter();
+    auto current = first;
+    auto batch_size = step;
+    double elapsed = 0;
+
+    while (current < last) {
+        auto end = last - current > batch_size ? current + batch_size : last;
+
+        for (auto i = current; i < end; i += step) {
+            func(i);
+        }
 
-    void decrement() {
-        std::lock_guard lock(mutex);
-        EDYN_ASSERT(count > 0);
-        --count;
-        done = count == 0;
-
-        // Normally, `notify_one` would be called without the lock being held.
-        // However, according to
-        // https://en.cppreference.com/w/cpp/thread/condition_variable/notify_one:
-        // "Notifying while under the lock may nevertheless be necessary when precise
-        // scheduling of events is required, e.g. if the waiting thread would exit
-        // the program if the condition is satisfied, causing destruction of the
-        // notifying thread's condition_variable."
-        // If the lock would be released right here, there is a very slim chance
-        // that `wait()` would be called in the other thread right after, before
-        // `notify_one()` below, where the lock would be acquired and the predicate
-        // would test true, causing `parallel_for` to return, thus destroying this
-        // object (since it is in the stack) and then everything down from here is
-        // undefined behavior.
-        if (done) {
-            cv.notify_one();
+        current = end;
+        elapsed = static_cast<double>(performance_counter() - start) / freq;
+
+        if (elapsed >= parallel_for_probe_time) {
+            break;
         }
-    }
 
-    void wait() {
-        std::unique_lock lock(mutex);
-        cv.wait(lock, [&] { return done; });
+        batch_size *= 2;
     }
-};
+
+    cost_per_index = elapsed / static_cast<double>(current - first);
+
+    return current;
+}
 
 template<typename IndexType, typename Function>
 void run_parallel_for(parallel_for_context<IndexType, Function> &ctx) {
@@ -96,59 +134,81 @@ void parallel_for_job_func(job::data_type &data) {
 
     run_parallel_for(*ctx);
 
-    ctx->decrement();
+    ctx->counter.decrement();
 }
 
 template<typename Iterator, typename Function>
 struct parallel_for_each_context {
     std::atomic<size_t> current;
     const Iterator first;
-    const Iterator last;
+    const size_t first_index;
     const size_t total_size;
     const size_t chunk_size;
-    size_t count;
-    bool done;
-    std::mutex mutex;
-    std::condition_variable cv;
+    atomic_counter_sync counter;
     Function func;
 
-    parallel_for_each_context(Iterator first, Iterator last, size_t total_size,
+    parallel_for_each_context(Iterator first, size_t first_index, size_t total_size,
                               size_t chunk_size, size_t num_jobs, Function func)
         : current(0)
         , first(first)
-        , last(last)
+        , first_index(first_index)
         , total_size(total_size)
         , chunk_size(chunk_size)
-        , count(num_jobs)
-        , done(false)
+        , counter(num_jobs)
         , func(func)
     {}
+};
+
+template<typename Iterator, typename Function>
+void invoke_parallel_for_each(Function &func, Iterator it, size_t index) {
+    using reference = decltype(*it);
 
-    ~parallel_for_each_context() {
-        EDYN_ASSERT(count == 0);
+    if constexpr(std::is_invocable_v<Function, reference, size_t>) {
+        func(*it, index);
+    } else {
+        func(*it);
     }
+}
+
+/**
+ * @brief Iterator version of `probe_parallel_for`.
+ * @param first Iterator to the first element. Receives the iterator to the
+ * element where the probe stopped.
+ * @param cost_per_element Receives the measured time in seconds per element.
+ * @return Number of elements processed.
+ */
+template<typename Iterator, typename Function>
+size_t probe_parallel_for_each(Iterator &first, size_t count,
+                               Function &func, double &cost_per_element) {
+    const auto freq = static_cast<double>(performance_frequency());
+    const auto start = performance_counter();
+    size_t index = 0;
+    size_t batch_size = 1;
+    double elapsed = 0;
+
+    while (index < count) {
+        auto end = std::min(index + batch_size, count);
+
+        for (; index < end; ++index, ++first) {
+            invoke_parallel_for_each(func, first, index);
+        }
 
-    void decrement() {
-        std::lock_guard lock(mutex);
-        EDYN_ASSERT(count > 0);
-        --count;
-        done = count == 0;
+        elapsed = static_cast<double>(performance_counter() - start) / freq;
 
-        if (done) {
-            cv.notify_one();
+        if (elapsed >= parallel_for_probe_time) {
+            break;
         }
-    }
 
-    void wait() {
-        std::unique_lock lock(mutex);
-        cv.wait(lock, [&] { return done; });
+        batch_size *= 2;
     }
-};
+
+    cost_per_element = elapsed / static_cast<double>(index);
+
+    return index;
+}
 
 template<typename Iterator, typename Function>
 void run_parallel_for_each(parallel_for_each_context<Iterator, Function> &ctx) {
-    using value_type = typename Iterator::value_type;
-
     while (true) {
         auto first_index = ctx.current.fetch_add(ctx.chunk_size, std::memory_order_relaxed);
 
@@ -161,13 +221,10 @@ void run_parallel_for_each(parallel_for_each_context<Iterator, Function> &ctx) {
 
         auto last = first;
         std::advance(last, std::min(ctx.chunk_size, ctx.total_size - first_index));
+        auto index = ctx.first_index + first_index;
 
         for (; first != last; ++first) {
-            if constexpr(std::is_invocable_v<Function, value_type, size_t>) {
-                ctx.func(*first, first_index++);
-            } else {
-                ctx.func(*first);
-            }
+            invoke_parallel_for_each(ctx.func, first, index++);
         }
     }
 }
@@ -181,7 +238,7 @@ void parallel_for_each_job_func(job::data_type &data) {
 
     run_parallel_for_each(*ctx);
 
-    ctx->decrement();
+    ctx->counter.decrement();
 }
 
 } // namespace detail
@@ -189,6 +246,9 @@ void parallel_for_each_job_func(job::data_type &data) {
 /**
  * @brief Dynamically splits the range `[first, last)` and calls `func` in parallel
  * once for each element starting at `first` and incrementing by `step` until `last`.
+ * The calling thread first runs a few elements to measure the cost of `func`,
+ * which determines the chunk size and whether the remaining elements are worth
+ * running in parallel at all. It then processes chunks along with the workers.
  *
  * @tparam IndexType Type of the index values.
  * @tparam Function Type of function to be invoked.
@@ -207,20 +267,38 @@ void parallel_for(job_dispatcher &dispatcher, IndexType first, IndexType last, I
     // Number of available workers.
     auto num_workers = dispatcher.num_workers();
 
-    // Number of elements to be processed.
-    auto count = last - first;
-    EDYN_ASSERT(count > 1);
+    // Measure the cost of the loop body by running a few elements in the
+    // calling thread first.
+    double cost_per_index;
+    auto next = detail::probe_parallel_for(first, last, step, func, cost_per_index);
+
+    if (next >= last) {
+        return;
+    }
+
+    // Number of elements left to be processed.
+    auto count = last - next;
+
+    // Finish in the calling thread if it's not worth going parallel.
+    if (num_workers == 0 || cost_per_index * count < detail::parallel_for_min_parallel_time) {
+        for (auto i = next; i < last; i += step) {
+            func(i);
+        }
+        return;
+    }
 
     // Size of chunk that will be processed per job iteration. The calling thread
-    // also does work thus 1 is added to the number of workers.
-    auto chunk_size = std::max(count / (num_workers + 1), IndexType{1});
+    // also does work thus 1 is added to the number of workers. It must be a
+    // multiple of `step` so that all chunks start at a valid index.
+    auto chunk_size = static_cast<IndexType>(detail::parallel_for_chunk_size(cost_per_index * step, count / step, num_workers + 1)) * step;
+    auto num_chunks = count / chunk_size + IndexType{count % chunk_size != 0};
 
     // Number of jobs that will be dispatched. Must not be greater than number
     // of workers (including this thread).
-    auto num_jobs = std::min(num_workers, count - 1);
+    auto num_jobs = std::min(num_workers, static_cast<size_t>(num_chunks - 1));
 
     // Context that's shared among all jobs.
-    auto context = detail::parallel_for_context<IndexType, Function>(first, last, step, chunk_size, num_jobs, func);
+    auto context = detail::parallel_for_context<IndexType, Function>(next, last, step, chunk_size, num_jobs, func);
 
     // Job that'll process chunks of data in worker threads.
     auto child_job = job();
@@ -238,7 +316,7 @@ void parallel_for(job_dispatcher &dispatcher, IndexType first, IndexType last, I
     detail::run_parallel_for(context);
 
     // Wait all background jobs to finish.
-    context.wait();
+    context.counter.wait();
 }
 
 /**
@@ -278,7 +356,8 @@ void parallel_for(IndexType first, IndexType last, Function func) {
 
 /**
  * @brief Dynamically splits the range `[first, last)` and calls `func` in parallel
- * once for each element` in the range.
+ * once for each element` in the range. Chunk size is chosen the same way as in
+ * `parallel_for`.
  *
  * @tparam Type of input iterator.
  * @tparam Function Type of function to be invoked.
@@ -294,19 +373,38 @@ void parallel_for_each(job_dispatcher &dispatcher, Iterator first, Iterator last
     auto num_workers = dispatcher.num_workers();
 
     // Number of elements to be processed.
-    auto count = std::distance(first, last);
-    EDYN_ASSERT(count > 1);
+    auto total_size = static_cast<size_t>(std::distance(first, last));
+    EDYN_ASSERT(total_size > 1);
+
+    // Measure the cost of the loop body by running a few elements in the
+    // calling thread first. `first` is advanced past the processed elements.
+    double cost_per_element;
+    auto num_processed = detail::probe_parallel_for_each(first, total_size, func, cost_per_element);
+    auto count = total_size - num_processed;
+
+    if (count == 0) {
+        return;
+    }
+
+    // Finish in the calling thread if it's not worth going parallel.
+    if (num_workers == 0 || cost_per_element * count < detail::parallel_for_min_parallel_time) {
+        for (auto index = num_processed; first != last; ++first) {
+            detail::invoke_parallel_for_each(func, first, index++);
+        }
+        return;
+    }
 
     // Size of chunk that will be processed per job iteration. The calling thread
     // also does work thus 1 is added to the number of workers.
-    size_t chunk_size = std::max(count / (num_workers + 1), size_t{1});
+    auto chunk_size = detail::parallel_for_chunk_size(cost_per_element, count, num_workers + 1);
+    auto num_chunks = count / chunk_size + static_cast<size_t>(count % chunk_size != 0);
 
     // Number of jobs that will be dispatched. Must not be greater than number
     // of workers (including this thread).
-    auto num_jobs = std::min(num_workers, size_t(count - 1));
+    auto num_jobs = std::min(num_workers, num_chunks - 1);
 
     // Context that's shared among all jobs.
-    auto context = detail::parallel_for_each_context<Iterator, Function>(first, last, count, chunk_size, num_jobs, func);
+    auto context = detail::parallel_for_each_context<Iterator, Function>(first, num_processed, count, chunk_size, num_jobs, func);
 
     // Job that'll process chunks of data in worker threads.
     auto child_job = job();
@@ -324,7 +422,7 @@ void parallel_for_each(job_dispatcher &dispatcher, Iterator first, Iterator last
     detail::run_parallel_for_each(context);
 
     // Wait all background jobs to finish.
-    context.wait();
+    context.counter.wait();
 }
 
 /**
@@ -0,0 +1,60 @@
+#ifndef EDYN_PARALLEL_THREAD_CONFIG_HPP
+#define EDYN_PARALLEL_THREAD_CONFIG_HPP
+
+#include <string>
+#include <vector>
+
+namespace edyn {
+
+enum class thread_priority {
+    low,
+    normal,
+    high,
+    // Real-time scheduling. Usually requires elevated privileges.
+    realtime
+};
+
+/**
+ * @brief Name, CPU affinity and priority of a thread.
+ */
+struct thread_config {
+    // Thread name as shown by debuggers and profilers. Limited to 15
+    // characters on Linux. Left unchanged if empty.
+    std::string name;
+    // Indices of the logical CPUs the thread is allowed to run on. Left
+    // unchanged if empty.
+    std::vector<unsigned> cpus;
+    thread_priority priority {thread_priority::normal};
+};
+
+/**
+ * @brief Applies a configuration to the calling thread.
+ * @param config Thread configuration.
+ * @return Whether all settings were applied successfully. Unsupported
+ * settings on the current platform are considered a failure.
+ */
+bool apply_thread_config(const thread_config &config);
+
+/**
+ * @brief Get the logical CPUs the calling thread is allowed to run on.
+ * @return CPU indices, or an empty vector if not supported on this platform.
+ */
+std::vector<unsigned> get_thread_affinity();
+
+/**
+ * @brief Get the logical CPUs of each NUMA node in the system. If the
+ * topology cannot be determined, a single node containing all CPUs is
+ * returned.
+ * @return CPU indices of each node.
+ */
+std::vector<std::vector<unsigned>> get_numa_node_cpus();
+
+/**
+ * @brief Get the logical CPU the calling thread is currently running on.
+ * @return CPU index, or -1 if not supported on this platform.
+ */
+int get_current_cpu();
+
+}
+
+#endif // EDYN_PARALLEL_THREAD_CONFIG_HPP
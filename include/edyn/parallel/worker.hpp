@@ -18,8 +18,6 @@ public:
     }
 
     void run() {
-        m_running = true;
-
         for (;;) {
             auto j = m_queue.pop();
             j();
@@ -53,7 +51,9 @@ public:
     }
 
 private:
-    std::atomic_bool m_running {false};
+    // Starts as running so that a `stop()` issued before the thread enters
+    // `run()` isn't overwritten.
+    std::atomic_bool m_running {true};
     job_queue m_queue;
     std::atomic<size_t> m_size {0};
 };
@@ -35,6 +35,10 @@ public:
         }
     }
 
+    bool observes(entt::entity entity) const {
+        return m_observed_entities.contains(entity);
+    }
+
     void set_active(bool active) {
         m_active = active;
     }
@@ -0,0 +1,43 @@
+#ifndef EDYN_SERIALIZATION_BINARY_FILE_HPP
+#define EDYN_SERIALIZATION_BINARY_FILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "edyn/serialization/memory_archive.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Writes the header which identifies binary data in a format of its
+ * own, i.e. a magic number, the version of the format and the size of
+ * `scalar`.
+ * @param archive Destination archive.
+ * @param magic Identifies the format.
+ * @param version Version of the format.
+ */
+void write_binary_header(memory_output_archive &archive, uint64_t magic, uint32_t version);
+
+/**
+ * @brief Reads a header written by `write_binary_header`. The archive fails
+ * if the header does not match.
+ * @param archive Source archive.
+ * @param magic Expected magic number.
+ * @param version Expected version.
+ * @return Whether the data has the expected format and version and was
+ * written with the same scalar type.
+ */
+bool read_binary_header(memory_input_archive &archive, uint64_t magic, uint32_t version);
+
+/**
+ * @brief Writes a buffer into a file, replacing its contents. Files are read
+ * back using a `mapped_file`.
+ * @param path Destination file.
+ * @param buffer Data.
+ * @return Whether the file was written successfully.
+ */
+bool write_binary_file(const std::string &path, const std::vector<uint8_t> &buffer);
+
+}
+
+#endif // EDYN_SERIALIZATION_BINARY_FILE_HPP
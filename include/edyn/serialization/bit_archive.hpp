@@ -0,0 +1,176 @@
+#ifndef EDYN_SERIALIZATION_BIT_ARCHIVE_HPP
+#define EDYN_SERIALIZATION_BIT_ARCHIVE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "edyn/config/config.h"
+
+namespace edyn {
+
+/**
+ * @brief Variant of `memory_output_archive` which packs values at bit
+ * granularity. Fundamental types are written with all of their bits, except
+ * for booleans which take a single bit. Arbitrary bit counts can be written
+ * with `write_bits`.
+ */
+class bit_output_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = std::vector<data_type>;
+    using is_input = std::false_type;
+    using is_output = std::true_type;
+
+    bit_output_archive(buffer_type &buffer)
+        : m_buffer(&buffer)
+        , m_bit_position(buffer.size() * 8)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_same_v<T, bool>) {
+            write_bits(t ? 1 : 0, 1);
+        } else if constexpr(std::is_fundamental_v<T>) {
+            static_assert(sizeof(T) <= sizeof(uint64_t));
+            uint64_t bits = 0;
+            std::memcpy(&bits, &t, sizeof(T));
+            write_bits(bits, sizeof(T) * 8);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename T>
+    void operator()(const T &t) {
+        operator()(const_cast<T &>(t));
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    /**
+     * @brief Writes the lowest `count` bits of `value`.
+     */
+    void write_bits(uint64_t value, unsigned count) {
+        EDYN_ASSERT(count <= 64);
+
+        for (unsigned i = 0; i < count;) {
+            auto byte_index = m_bit_position / 8;
+            auto bit_offset = static_cast<unsigned>(m_bit_position % 8);
+
+            if (byte_index == m_buffer->size()) {
+                m_buffer->push_back(0);
+            }
+
+            // Fill the remaining bits of the current byte at once.
+            auto num_bits = std::min(8 - bit_offset, count - i);
+            auto mask = static_cast<uint64_t>((1u << num_bits) - 1);
+            auto bits = static_cast<data_type>(((value >> i) & mask) << bit_offset);
+            (*m_buffer)[byte_index] |= bits;
+
+            m_bit_position += num_bits;
+            i += num_bits;
+        }
+    }
+
+    size_t bit_size() const {
+        return m_bit_position;
+    }
+
+protected:
+    buffer_type *m_buffer;
+    size_t m_bit_position;
+};
+
+/**
+ * @brief Reads data written by a `bit_output_archive`.
+ */
+class bit_input_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = const data_type*;
+    using is_input = std::true_type;
+    using is_output = std::false_type;
+
+    bit_input_archive(buffer_type buffer, size_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_bit_position(0)
+        , m_failed(false)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_same_v<T, bool>) {
+            t = read_bits(1) != 0;
+        } else if constexpr(std::is_fundamental_v<T>) {
+            static_assert(sizeof(T) <= sizeof(uint64_t));
+            auto bits = read_bits(sizeof(T) * 8);
+            std::memcpy(&t, &bits, sizeof(T));
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    /**
+     * @brief Reads `count` bits. Returns zero and sets the failed flag if
+     * there are not enough bits left.
+     */
+    uint64_t read_bits(unsigned count) {
+        EDYN_ASSERT(count <= 64);
+
+        if (m_failed) return 0;
+
+        if (m_bit_position + count > m_size * 8) {
+            m_failed = true;
+            return 0;
+        }
+
+        uint64_t value = 0;
+
+        for (unsigned i = 0; i < count;) {
+            auto byte_index = m_bit_position / 8;
+            auto bit_offset = static_cast<unsigned>(m_bit_position % 8);
+            auto num_bits = std::min(8 - bit_offset, count - i);
+            auto mask = static_cast<uint64_t>((1u << num_bits) - 1);
+            auto bits = (static_cast<uint64_t>(m_buffer[byte_index]) >> bit_offset) & mask;
+            value |= bits << i;
+
+            m_bit_position += num_bits;
+            i += num_bits;
+        }
+
+        return value;
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+    /**
+     * @brief Marks the data as invalid. All further reads are ignored.
+     */
+    void fail() {
+        m_failed = true;
+    }
+
+protected:
+    buffer_type m_buffer;
+    const size_t m_size;
+    size_t m_bit_position;
+    bool m_failed;
+};
+
+}
+
+#endif // EDYN_SERIALIZATION_BIT_ARCHIVE_HPP
@@ -16,6 +16,7 @@ class file_input_archive {
 public:
     using is_input = std::true_type;
     using is_output = std::false_type;
+    using supports_arrays = std::true_type;
 
     file_input_archive() {}
 
@@ -39,6 +40,17 @@ public:
         return m_file.eof();
     }
 
+    bool failed() const {
+        return m_file.fail();
+    }
+
+    /**
+     * @brief Marks the data as invalid. All further reads are ignored.
+     */
+    void fail() {
+        m_file.setstate(std::ios::failbit);
+    }
+
     template<typename T>
     void operator()(T& t) {
         if constexpr(std::is_fundamental_v<T>) {
@@ -60,6 +72,28 @@ public:
         return m_file.tellg();
     }
 
+    /**
+     * @brief Reads a contiguous array of trivially serializable values.
+     */
+    template<typename T>
+    void read_array(T *data, size_t count) {
+        static_assert(is_trivially_serializable_v<T>);
+        EDYN_ASSERT(m_file.is_open());
+        m_file.read(reinterpret_cast<char *>(data), count * sizeof(T));
+    }
+
+    /**
+     * @brief Read container sizes as 16-bit integers, which is how they were
+     * stored by earlier versions. Enable to load files written by them.
+     */
+    void set_legacy_size_format(bool legacy) {
+        m_legacy_size_format = legacy;
+    }
+
+    bool legacy_size_format() const {
+        return m_legacy_size_format;
+    }
+
 protected:
     template<typename T>
     void read_bytes(T &t) {
@@ -68,12 +102,14 @@ protected:
     }
 
     std::ifstream m_file;
+    bool m_legacy_size_format {false};
 };
 
 class file_output_archive {
 public:
     using is_input = std::false_type;
     using is_output = std::true_type;
+    using supports_arrays = std::true_type;
 
     file_output_archive(const std::string &path)
         : m_file(path, std::ios::binary | std::ios::out)
@@ -99,6 +135,15 @@ public:
         m_file.close();
     }
 
+    /**
+     * @brief Writes a contiguous array of trivially serializable values.
+     */
+    template<typename T>
+    void write_array(const T *data, size_t count) {
+        static_assert(is_trivially_serializable_v<T>);
+        m_file.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+    }
+
 private:
     template<typename T>
     void write_bytes(T &t) {
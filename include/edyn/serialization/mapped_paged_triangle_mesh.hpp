@@ -0,0 +1,99 @@
+#ifndef EDYN_SERIALIZATION_MAPPED_PAGED_TRIANGLE_MESH_HPP
+#define EDYN_SERIALIZATION_MAPPED_PAGED_TRIANGLE_MESH_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/collision/static_tree.hpp"
+#include "edyn/math/scalar.hpp"
+#include "edyn/parallel/job.hpp"
+#include "edyn/shapes/triangle_mesh_page_loader.hpp"
+#include "edyn/util/mapped_file.hpp"
+
+namespace edyn {
+
+class paged_triangle_mesh;
+
+/**
+ * Version of the memory-mapped paged triangle mesh file format. Files written
+ * with a different version, or with a different scalar type, are rejected.
+ */
+inline constexpr uint32_t mapped_paged_triangle_mesh_version = 1;
+
+/**
+ * @brief Writes a `paged_triangle_mesh` into a file whose layout allows it to
+ * be memory-mapped. Each array is stored contiguously with its elements in
+ * their in-memory representation and aligned, and each submesh starts at a
+ * page boundary. All submeshes must be loaded.
+ * @param path Destination file.
+ * @param paged_tri_mesh The paged triangle mesh.
+ * @return Whether the file was written successfully.
+ */
+bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                      const paged_triangle_mesh &paged_tri_mesh);
+
+/**
+ * @brief Page loader which maps a file written by
+ * `write_mapped_paged_triangle_mesh` into memory. Submeshes are loaded in the
+ * background by copying each of their arrays from the mapped pages in one go,
+ * without parsing individual elements. After a submesh is loaded, the pages of
+ * its neighboring submeshes are prefetched, since they are likely to be
+ * needed soon.
+ */
+class mapped_paged_triangle_mesh_loader: public triangle_mesh_page_loader_base {
+public:
+    struct submesh_entry {
+        uint64_t num_vertices;
+        uint64_t num_indices;
+        // Location of the submesh in the file.
+        uint64_t offset;
+        uint64_t size;
+        AABB aabb;
+    };
+
+    mapped_paged_triangle_mesh_loader(const std::string &path);
+
+    /**
+     * @brief Whether the file was mapped and has a valid header.
+     */
+    bool is_open() const {
+        return m_file.is_open();
+    }
+
+    /**
+     * @brief Initializes a paged triangle mesh with the tree and submesh
+     * information stored in the file. The mesh must be using this loader.
+     * @param paged_tri_mesh The paged triangle mesh.
+     * @return Whether the file is open and valid.
+     */
+    bool init(paged_triangle_mesh &paged_tri_mesh) const;
+
+    void load(paged_triangle_mesh *trimesh, size_t index) override;
+
+    /**
+     * @brief Submeshes whose AABB is within this distance of the AABB of a
+     * submesh that was just loaded are prefetched.
+     */
+    void set_prefetch_distance(scalar distance) {
+        m_prefetch_distance = distance;
+    }
+
+    friend void load_mapped_mesh_job_func(job::data_type &);
+
+private:
+    void load_submesh(paged_triangle_mesh *trimesh, size_t index) const;
+    void prefetch_neighbors(size_t index) const;
+
+    mapped_file m_file;
+    scalar m_thickness {1};
+    static_tree m_tree;
+    std::vector<submesh_entry> m_submeshes;
+    scalar m_prefetch_distance {0};
+};
+
+void load_mapped_mesh_job_func(job::data_type &);
+
+}
+
+#endif // EDYN_SERIALIZATION_MAPPED_PAGED_TRIANGLE_MESH_HPP
@@ -1,6 +1,7 @@
 #ifndef EDYN_SERIALIZATION_MATH_S11N_HPP
 #define EDYN_SERIALIZATION_MATH_S11N_HPP
 
+#include "edyn/math/vector2.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/quaternion.hpp"
 #include "edyn/math/matrix3x3.hpp"
@@ -8,6 +9,11 @@
 
 namespace edyn {
 
+template<typename Archive>
+void serialize(Archive &archive, vector2 &v) {
+    archive(v.x, v.y);
+}
+
 template<typename Archive>
 void serialize(Archive &archive, vector3 &v) {
     archive(v.x, v.y, v.z);
@@ -23,6 +29,18 @@ void serialize(Archive &archive, matrix3x3 &m) {
     archive(m.row);
 }
 
+template<>
+struct is_trivially_serializable<vector3>
+    : std::bool_constant<sizeof(vector3) == 3 * sizeof(scalar)> {};
+
+template<>
+struct is_trivially_serializable<quaternion>
+    : std::bool_constant<sizeof(quaternion) == 4 * sizeof(scalar)> {};
+
+template<>
+struct is_trivially_serializable<matrix3x3>
+    : std::bool_constant<sizeof(matrix3x3) == 9 * sizeof(scalar)> {};
+
 }
 
 #endif // EDYN_SERIALIZATION_MATH_S11N_HPP
\ No newline at end of file
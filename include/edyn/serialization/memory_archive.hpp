@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <vector>
 #include <array>
@@ -18,6 +19,7 @@ public:
     using buffer_type = const data_type*;
     using is_input = std::true_type;
     using is_output = std::false_type;
+    using supports_arrays = std::true_type;
 
     memory_input_archive(buffer_type buffer, size_t size)
         : m_buffer(buffer)
@@ -44,10 +46,53 @@ public:
         return m_failed;
     }
 
+    /**
+     * @brief Marks the data as invalid, e.g. when a value that was read is
+     * unacceptable. All further reads are ignored.
+     */
+    void fail() {
+        m_failed = true;
+    }
+
     bool eof() const {
         return m_position == m_size;
     }
 
+    /**
+     * @brief Reads a contiguous array of trivially serializable values.
+     */
+    template<typename T>
+    void read_array(T *data, size_t count) {
+        static_assert(is_trivially_serializable_v<T>);
+
+        if (!expect_remaining(count, sizeof(T))) {
+            return;
+        }
+
+        auto num_bytes = count * sizeof(T);
+
+        if (num_bytes > 0) {
+            std::memcpy(data, m_buffer + m_position, num_bytes);
+        }
+
+        m_position += num_bytes;
+    }
+
+    /**
+     * @brief Checks whether there are at least `count` elements of
+     * `element_size` bytes left to be read. Otherwise, the archive fails.
+     * Allows rejecting invalid container sizes before allocating memory.
+     */
+    bool expect_remaining(size_t count, size_t element_size) {
+        if (m_failed) return false;
+
+        if (element_size > 0 && count > (m_size - m_position) / element_size) {
+            m_failed = true;
+        }
+
+        return !m_failed;
+    }
+
 protected:
     template<typename T>
     void read_bytes(T &t) {
@@ -58,8 +103,7 @@ protected:
             return;
         }
 
-        auto* buff = reinterpret_cast<const T*>(m_buffer + m_position);
-        t = *buff;
+        std::memcpy(&t, m_buffer + m_position, sizeof(T));
         m_position += sizeof(T);
     }
 
@@ -77,6 +121,8 @@ public:
     using is_input = std::false_type;
     using is_output = std::true_type;
 
+    using supports_arrays = std::true_type;
+
     memory_output_archive(buffer_type& buffer)
         : m_buffer(&buffer)
     {}
@@ -105,13 +151,26 @@ public:
         (operator()(t), ...);
     }
 
+    /**
+     * @brief Writes a contiguous array of trivially serializable values.
+     */
+    template<typename T>
+    void write_array(const T *data, size_t count) {
+        static_assert(is_trivially_serializable_v<T>);
+
+        if (count == 0) return;
+
+        auto idx = m_buffer->size();
+        m_buffer->resize(idx + count * sizeof(T));
+        std::memcpy(&(*m_buffer)[idx], data, count * sizeof(T));
+    }
+
 protected:
     template<typename T>
     void write_bytes(const T &t) {
         auto idx = m_buffer->size();
         m_buffer->resize(idx + sizeof(T));
-        auto *dest = reinterpret_cast<T*>(&(*m_buffer)[idx]);
-        *dest = t;
+        std::memcpy(&(*m_buffer)[idx], &t, sizeof(T));
     }
 
     buffer_type *m_buffer;
@@ -124,6 +183,8 @@ public:
     using is_input = std::false_type;
     using is_output = std::true_type;
 
+    using supports_arrays = std::true_type;
+
     fixed_memory_output_archive(buffer_type buffer, size_t size)
         : m_buffer(buffer)
         , m_size(size)
@@ -149,6 +210,29 @@ public:
         return m_failed;
     }
 
+    /**
+     * @brief Writes a contiguous array of trivially serializable values.
+     */
+    template<typename T>
+    void write_array(const T *data, size_t count) {
+        static_assert(is_trivially_serializable_v<T>);
+
+        if (m_failed) return;
+
+        if (count > (m_size - m_position) / sizeof(T)) {
+            m_failed = true;
+            return;
+        }
+
+        auto num_bytes = count * sizeof(T);
+
+        if (num_bytes > 0) {
+            std::memcpy(m_buffer + m_position, data, num_bytes);
+        }
+
+        m_position += num_bytes;
+    }
+
 protected:
     template<typename T>
     void write_bytes(T &t) {
@@ -159,8 +243,7 @@ protected:
             return;
         }
 
-        auto *dest = reinterpret_cast<T*>(m_buffer + m_position);
-        *dest = t;
+        std::memcpy(m_buffer + m_position, &t, sizeof(T));
         m_position += sizeof(T);
     }
 
@@ -3,6 +3,8 @@
 #include "edyn/serialization/static_tree_s11n.hpp"
 #include "edyn/serialization/triangle_mesh_s11n.hpp"
 #include "edyn/serialization/paged_triangle_mesh_s11n.hpp"
+#include "edyn/serialization/mapped_paged_triangle_mesh.hpp"
 #include "edyn/serialization/entt_s11n.hpp"
 #include "edyn/serialization/file_archive.hpp"
-#include "edyn/serialization/memory_archive.hpp"
\ No newline at end of file
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/world_snapshot.hpp"
\ No newline at end of file
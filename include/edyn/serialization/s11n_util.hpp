@@ -2,6 +2,7 @@
 #define EDYN_SERIALIZATION_S11N_UTIL_HPP
 
 #include <cstdint>
+#include <cstddef>
 #include <type_traits>
 
 namespace edyn {
@@ -31,6 +32,84 @@ void serialize_pointer(Archive &archive, T **ptr) {
     }
 }
 
+/**
+ * @brief Whether the serialized representation of a value of type `T` is
+ * identical to its representation in memory, i.e. `serialize` writes all of
+ * its members in declaration order and there is no padding. Contiguous arrays
+ * of such values are serialized in one block by archives which support it.
+ * Specialize for types which satisfy these conditions.
+ */
+template<typename T>
+struct is_trivially_serializable : std::bool_constant<std::is_arithmetic_v<T>> {};
+
+template<typename T>
+inline constexpr bool is_trivially_serializable_v = is_trivially_serializable<T>::value;
+
+/**
+ * @brief Whether an archive provides `write_array`/`read_array` to serialize
+ * a contiguous array of trivially serializable values at once.
+ */
+template<typename Archive, typename = void>
+struct archive_supports_arrays : std::false_type {};
+
+template<typename Archive>
+struct archive_supports_arrays<Archive, std::void_t<typename Archive::supports_arrays>>
+    : Archive::supports_arrays {};
+
+template<typename Archive>
+inline constexpr bool archive_supports_arrays_v = archive_supports_arrays<Archive>::value;
+
+/**
+ * @brief Writes an unsigned integer using 7 bits per byte, where the highest
+ * bit indicates whether more bytes follow. Small values take a single byte.
+ */
+template<typename Archive>
+void write_varint(Archive &archive, uint64_t value) {
+    while (value >= 0x80) {
+        auto byte = static_cast<uint8_t>(value | 0x80);
+        archive(byte);
+        value >>= 7;
+    }
+
+    auto byte = static_cast<uint8_t>(value);
+    archive(byte);
+}
+
+/**
+ * @brief Reads an unsigned integer written by `write_varint`. Stops after the
+ * maximum number of bytes a 64-bit value can take.
+ */
+template<typename Archive>
+uint64_t read_varint(Archive &archive) {
+    uint64_t value = 0;
+
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = 0;
+        archive(byte);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    return value;
+}
+
+/**
+ * @brief Number of bytes taken by `value` when written with `write_varint`.
+ */
+constexpr size_t varint_sizeof(uint64_t value) {
+    size_t size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+
+    return size;
+}
+
 }
 
 #endif // EDYN_SERIALIZATION_S11N_UTIL_HPP
@@ -3,6 +3,7 @@
 
 #include "edyn/collision/static_tree.hpp"
 #include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/math_s11n.hpp"
 
 namespace edyn {
 
@@ -14,9 +15,19 @@ void serialize(Archive &archive, static_tree::tree_node &node) {
     archive(node.child2);
 }
 
+template<>
+struct is_trivially_serializable<static_tree::tree_node>
+    : std::bool_constant<sizeof(static_tree::tree_node) ==
+                         2 * sizeof(vector3) + 2 * sizeof(uint32_t)> {};
+
 template<typename Archive>
 void serialize(Archive &archive, static_tree &tree) {
     archive(tree.m_nodes);
+
+    if constexpr(Archive::is_input::value) {
+        tree.m_wide_nodes.clear();
+        tree.m_parents.clear();
+    }
 }
 
 inline
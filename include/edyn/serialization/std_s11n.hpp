@@ -2,6 +2,7 @@
 #define EDYN_SERIALIZATION_STD_S11N_HPP
 
 #include <array>
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <vector>
@@ -13,47 +14,123 @@
 #include <type_traits>
 #include <entt/core/ident.hpp>
 #include "edyn/util/tuple_util.hpp"
+#include "edyn/serialization/s11n_util.hpp"
 
 namespace edyn {
 
+namespace internal {
+    template<typename Archive, typename = void>
+    struct has_legacy_size_format : std::false_type {};
+
+    template<typename Archive>
+    struct has_legacy_size_format<Archive, std::void_t<decltype(std::declval<Archive &>().legacy_size_format())>>
+        : std::true_type {};
+
+    template<typename Archive, typename = void>
+    struct has_expect_remaining : std::false_type {};
+
+    template<typename Archive>
+    struct has_expect_remaining<Archive, std::void_t<decltype(std::declval<Archive &>().expect_remaining(size_t{}, size_t{}))>>
+        : std::true_type {};
+
+    /**
+     * Container sizes are written as variable-length integers. Archives which
+     * read data written by earlier versions can opt into the legacy format,
+     * where sizes are 16-bit integers. In input archives which can tell how
+     * many bytes are left, the size is rejected if there isn't enough data
+     * for that many elements with at least `min_element_size` bytes each.
+     */
+    template<typename Archive>
+    size_t serialize_size(Archive &archive, size_t size, size_t min_element_size) {
+        if constexpr(has_legacy_size_format<Archive>::value) {
+            if (archive.legacy_size_format()) {
+                using size_type = uint16_t;
+                size_type legacy_size = std::min(size, static_cast<size_t>(std::numeric_limits<size_type>::max()));
+                archive(legacy_size);
+                return legacy_size;
+            }
+        }
+
+        if constexpr(Archive::is_input::value) {
+            size = static_cast<size_t>(read_varint(archive));
+
+            if constexpr(has_expect_remaining<Archive>::value) {
+                if (!archive.expect_remaining(size, min_element_size)) {
+                    return 0;
+                }
+            }
+        } else {
+            write_varint(archive, size);
+        }
+
+        return size;
+    }
+
+    template<typename T>
+    constexpr size_t min_serialized_size() {
+        if constexpr(is_trivially_serializable_v<T>) {
+            return sizeof(T);
+        } else if constexpr(std::is_empty_v<T>) {
+            return 0;
+        } else {
+            return 1;
+        }
+    }
+
+    // Serialize a contiguous array in one block if possible, otherwise
+    // serialize each element.
+    template<typename Archive, typename T>
+    void serialize_array(Archive &archive, T *data, size_t size) {
+        if constexpr(is_trivially_serializable_v<T> && archive_supports_arrays_v<Archive>) {
+            if constexpr(Archive::is_input::value) {
+                archive.read_array(data, size);
+            } else {
+                archive.write_array(data, size);
+            }
+        } else {
+            for (size_t i = 0; i < size; ++i) {
+                archive(data[i]);
+            }
+        }
+    }
+}
+
 template<typename Archive>
 void serialize(Archive &archive, std::string& str) {
-    using size_type = uint16_t;
-    size_type size = std::min(str.size(), static_cast<size_t>(std::numeric_limits<size_type>::max()));
-    archive(size);
+    auto size = internal::serialize_size(archive, str.size(), sizeof(char));
     str.resize(size);
-
-    for (size_t i = 0; i < size; ++i) {
-        archive(str[i]);
-    }
+    internal::serialize_array(archive, str.data(), size);
 }
 
 template<typename Archive, typename T>
 void serialize(Archive &archive, std::vector<T> &vector) {
-    using size_type = uint16_t;
-    size_type size = std::min(vector.size(), static_cast<size_t>(std::numeric_limits<size_type>::max()));
-    archive(size);
+    auto size = internal::serialize_size(archive, vector.size(), internal::min_serialized_size<T>());
     vector.resize(size);
-
-    for (size_t i = 0; i < size; ++i) {
-        archive(vector[i]);
-    }
+    internal::serialize_array(archive, vector.data(), size);
 }
 
 template<typename Archive>
 void serialize(Archive &archive, std::vector<bool> &vector) {
-    using size_type = uint16_t;
-    size_type size = std::min(vector.size(), static_cast<size_t>(std::numeric_limits<size_type>::max()));
-    archive(size);
-    vector.resize(size);
-
     // Serialize individual bits.
     using set_type = uint32_t;
     constexpr auto set_num_bits = sizeof(set_type) * 8;
+
+    // Each set holds `set_num_bits` elements, thus the minimum size per
+    // element is rounded down to zero. Validate the number of sets instead.
+    auto size = internal::serialize_size(archive, vector.size(), 0);
+
     // Number of sets of bits of size `set_num_bits`.
     // Use ceiling on integer division.
     const auto num_sets = size / set_num_bits + (size % set_num_bits != 0);
 
+    if constexpr(internal::has_expect_remaining<Archive>::value) {
+        if (!archive.expect_remaining(num_sets, sizeof(set_type))) {
+            size = 0;
+        }
+    }
+
+    vector.resize(size);
+
     for (size_t i = 0; i < num_sets; ++i) {
         const auto start = i * set_num_bits;
         const auto count = std::min(size - start, set_num_bits);
@@ -61,14 +138,14 @@ void serialize(Archive &archive, std::vector<bool> &vector) {
         if constexpr(Archive::is_output::value) {
             set_type set = 0;
             for (size_t j = 0; j < count; ++j) {
-                set |= static_cast<bool>(vector[start + j]) << j;
+                set |= static_cast<set_type>(static_cast<bool>(vector[start + j])) << j;
             }
             archive(set);
         } else {
             set_type set;
             archive(set);
             for (size_t j = 0; j < count; ++j) {
-                vector[start + j] = (set & (1 << j)) > 0;
+                vector[start + j] = (set & (set_type(1) << j)) > 0;
             }
         }
     }
@@ -76,7 +153,7 @@ void serialize(Archive &archive, std::vector<bool> &vector) {
 
 template<typename T>
 size_t serialization_sizeof(const std::vector<T> &vec) {
-    return sizeof(size_t) + vec.size() * sizeof(typename std::vector<T>::value_type);
+    return varint_sizeof(vec.size()) + vec.size() * sizeof(typename std::vector<T>::value_type);
 }
 
 inline
@@ -84,16 +161,18 @@ size_t serialization_sizeof(const std::vector<bool> &vec) {
     using set_type = uint32_t;
     constexpr auto set_num_bits = sizeof(set_type) * 8;
     const auto num_sets = vec.size() / set_num_bits + (vec.size() % set_num_bits != 0);
-    return sizeof(size_t) + num_sets * sizeof(set_type);
+    return varint_sizeof(vec.size()) + num_sets * sizeof(set_type);
 }
 
 template<typename Archive, typename T, size_t N>
 void serialize(Archive &archive, std::array<T, N> &arr) {
-    for (size_t i = 0; i < arr.size(); ++i) {
-        archive(arr[i]);
-    }
+    internal::serialize_array(archive, arr.data(), N);
 }
 
+template<typename T, size_t N>
+struct is_trivially_serializable<std::array<T, N>>
+    : std::bool_constant<is_trivially_serializable_v<T> && sizeof(std::array<T, N>) == N * sizeof(T)> {};
+
 namespace internal {
     template<typename T, typename Archive, typename... Ts>
     void read_variant(Archive& archive, std::variant<Ts...>& var) {
@@ -168,13 +247,11 @@ size_t serialization_sizeof(const std::optional<T> &opt) {
 
 template<typename Archive, typename K, typename V>
 void serialize(Archive &archive, std::map<K, V> &map) {
-    using size_type = uint16_t;
-    size_type size = std::min(map.size(), static_cast<size_t>(std::numeric_limits<size_type>::max()));
-    archive(size);
+    auto size = internal::serialize_size(archive, map.size(), 1);
 
     if constexpr(Archive::is_input::value) {
         auto pair = std::pair<K, V>{};
-        for (size_type i = 0; i < size; ++i) {
+        for (size_t i = 0; i < size; ++i) {
             archive(pair);
             map.emplace(pair);
         }
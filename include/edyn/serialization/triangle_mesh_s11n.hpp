@@ -3,6 +3,7 @@
 
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/math_s11n.hpp"
 #include "edyn/serialization/static_tree_s11n.hpp"
 
 namespace edyn {
@@ -18,6 +19,10 @@ constexpr size_t serialization_sizeof(const unordered_pair<T> &pair) {
     return 2 * sizeof(T);
 }
 
+template<typename T>
+struct is_trivially_serializable<unordered_pair<T>>
+    : std::bool_constant<is_trivially_serializable_v<T> && sizeof(unordered_pair<T>) == 2 * sizeof(T)> {};
+
 template<typename Archive, typename T>
 void serialize(Archive &archive, flat_nested_array<T> &array) {
     archive(array.m_data);
@@ -46,6 +51,10 @@ void serialize(Archive &archive, triangle_mesh &tri_mesh) {
     archive(tri_mesh.m_restitution);
     archive(tri_mesh.m_material_ids);
     archive(tri_mesh.m_thickness);
+
+    if constexpr(Archive::is_input::value) {
+        tri_mesh.m_triangle_leaves.clear();
+    }
 }
 
 inline
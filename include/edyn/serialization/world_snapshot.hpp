@@ -0,0 +1,77 @@
+#ifndef EDYN_SERIALIZATION_WORLD_SNAPSHOT_HPP
+#define EDYN_SERIALIZATION_WORLD_SNAPSHOT_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+class entity_map;
+
+/**
+ * Version of the world snapshot format. Snapshots written with a different
+ * version, or with a different scalar type, are rejected.
+ */
+inline constexpr uint32_t world_snapshot_version = 3;
+
+/**
+ * @brief Writes the state of the entire simulation into a buffer, i.e. all
+ * rigid bodies and their shapes, constraints, contact manifolds including the
+ * impulses used for warm starting, islands and which of them are asleep.
+ * Meshes shared among multiple shapes are written only once. Settings and
+ * material mixing tables are not included.
+ * Only supported in the sequential execution modes. Rigid bodies with a
+ * `paged_mesh_shape` or a paged `heightfield_shape` are not supported since
+ * the page loader cannot be serialized. Heightfields which are not paged are
+ * written with all of their heights. Polyhedrons in compound shapes whose
+ * mesh is replicated by hash in the global `mesh_asset_cache` are written as
+ * a hash, thus the same meshes must be interned before the snapshot is
+ * loaded.
+ * @param registry Data source.
+ * @param buffer Destination buffer. The snapshot is appended to it.
+ */
+void write_world_snapshot(entt::registry &registry, std::vector<uint8_t> &buffer);
+
+/**
+ * @brief Loads a snapshot written by `write_world_snapshot` into a registry
+ * which has Edyn attached in one of the sequential execution modes. New
+ * entities are created for all entities in the snapshot.
+ * Component pools are filled in bulk and entities keep the islands they were
+ * in, thus islands are not formed again and sleeping islands remain asleep.
+ * The broadphase trees are built in one go in the next update. The time at
+ * which awake islands started resting is not preserved.
+ * @param registry Destination registry.
+ * @param data Snapshot data.
+ * @param size Size of snapshot data in bytes.
+ * @param emap Optional entity map which receives the mapping from the
+ * entities in the snapshot to the entities created in `registry`. Useful to
+ * restore custom components which refer to physics entities.
+ * @return Whether the snapshot is valid. Nothing is created if it isn't.
+ */
+bool read_world_snapshot(entt::registry &registry, const uint8_t *data, size_t size,
+                         entity_map *emap = nullptr);
+
+/**
+ * @brief Writes a world snapshot into a file.
+ * @param registry Data source.
+ * @param path Destination file.
+ * @return Whether the file was written successfully.
+ */
+bool save_world_snapshot(entt::registry &registry, const std::string &path);
+
+/**
+ * @brief Loads a world snapshot from a file.
+ * @param registry Destination registry.
+ * @param path Snapshot file.
+ * @param emap Optional entity map, as in `read_world_snapshot`.
+ * @return Whether the file was read and is valid.
+ */
+bool load_world_snapshot(entt::registry &registry, const std::string &path,
+                         entity_map *emap = nullptr);
+
+}
+
+#endif // EDYN_SERIALIZATION_WORLD_SNAPSHOT_HPP
@@ -117,6 +117,11 @@ void serialize(Archive &archive, compound_shape &shape) {
     archive(shape.nodes);
 
     if constexpr(Archive::is_input::value) {
+        // Nodes might hold polyhedrons without a mesh.
+        if (archive.failed()) {
+            return;
+        }
+
         shape.tree.clear();
         shape.finish();
     }
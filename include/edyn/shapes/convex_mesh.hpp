@@ -66,6 +66,13 @@ struct convex_mesh {
 
     void update_calculated_properties();
 
+    /**
+     * @brief Checks whether the faces refer to valid ranges of indices and
+     * whether these refer to existing vertices, i.e. whether `initialize` can
+     * be called. Must be checked for meshes read from untrusted sources.
+     */
+    bool has_valid_faces() const;
+
     size_t num_edges() const {
         EDYN_ASSERT(edges.size() % 2 == 0);
         return edges.size() / 2;
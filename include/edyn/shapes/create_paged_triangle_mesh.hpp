@@ -230,12 +230,7 @@ void create_paged_triangle_mesh(
     paged_tri_mesh.m_tree.build(aabbs.begin(), aabbs.end(), builder, max_tri_per_submesh);
     builder.build(paged_tri_mesh, global_tri_mesh, vertex_begin, index_begin, vertex_colors, color_scale);
 
-    // Resize LRU queue to have the number of leaves.
-    paged_tri_mesh.m_lru_indices.resize(paged_tri_mesh.m_cache.size());
-    std::iota(paged_tri_mesh.m_lru_indices.begin(),
-              paged_tri_mesh.m_lru_indices.end(), 0);
-
-    paged_tri_mesh.m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(paged_tri_mesh.m_cache.size());
+    paged_tri_mesh.init_cache();
 }
 
 }
@@ -0,0 +1,528 @@
+#ifndef EDYN_SHAPES_HEIGHTFIELD_HPP
+#define EDYN_SHAPES_HEIGHTFIELD_HPP
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "edyn/config/config.h"
+#include "edyn/math/math.hpp"
+#include "edyn/math/vector2.hpp"
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/triangle.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/shapes/heightfield_tile_loader.hpp"
+
+namespace edyn {
+
+/**
+ * @brief A regular grid of heights with two triangles per cell, which is a
+ * compact representation of terrain. Only the heights are stored, and
+ * normals, adjacency and edge convexity are calculated when needed. Cells
+ * are found by direct indexing, which makes AABB queries and raycasts
+ * independent of the size of the grid.
+ *
+ * Sample `(column, row)` is located at
+ * `origin + vector3{column * spacing.x, height, row * spacing.y}`, i.e.
+ * columns advance along the x axis and rows along the z axis. Cell
+ * `(column, row)` is split along the diagonal between samples
+ * `(column, row)` and `(column + 1, row + 1)`.
+ *
+ * The grid is divided into square tiles of cells. A heightfield created
+ * with all of its heights has a single tile. A paged heightfield loads its
+ * tiles on demand using a `heightfield_tile_loader_base` and queries skip
+ * tiles which are not loaded.
+ *
+ * Each tile can hold a pyramid of the height range of blocks of 2x2, 4x4,
+ * 8x8... cells, which allows large queries to skip whole blocks. It takes
+ * about two thirds of the memory of the heights.
+ *
+ * Triangle, edge and vertex indices are global, thus they are stable while
+ * tiles are loaded and unloaded.
+ */
+class heightfield {
+public:
+    using index_type = uint32_t;
+
+    struct height_range {
+        scalar min;
+        scalar max;
+
+        bool intersects(const height_range &other) const {
+            return min <= other.max && max >= other.min;
+        }
+    };
+
+    /**
+     * @brief Creates a heightfield with all of its heights.
+     * @param num_columns Number of samples along the x axis. At least two.
+     * @param num_rows Number of samples along the z axis. At least two.
+     * @param spacing Distance between samples along the x and z axes.
+     * @param origin Position of the first sample at height zero.
+     * @param heights Heights of all samples, row after row.
+     * @param build_pyramid Whether to build the height range pyramid.
+     */
+    heightfield(size_t num_columns, size_t num_rows, vector2 spacing, const vector3 &origin,
+                std::vector<scalar> heights, bool build_pyramid = true);
+
+    /**
+     * @brief Creates a paged heightfield whose tiles are loaded on demand.
+     * @param num_columns Number of samples along the x axis. At least two.
+     * @param num_rows Number of samples along the z axis. At least two.
+     * @param spacing Distance between samples along the x and z axes.
+     * @param origin Position of the first sample at height zero.
+     * @param bounds Minimum and maximum height of all samples. It's used to
+     * calculate the AABB of the heightfield before tiles are loaded.
+     * @param tile_size Number of cells along each side of a tile.
+     * @param loader Provides the heights of the tiles.
+     * @param build_pyramid Whether to build the height range pyramid of
+     * tiles as they're loaded.
+     */
+    heightfield(size_t num_columns, size_t num_rows, vector2 spacing, const vector3 &origin,
+                height_range bounds, size_t tile_size,
+                std::shared_ptr<heightfield_tile_loader_base> loader,
+                bool build_pyramid = true);
+
+    heightfield(const heightfield &) = delete;
+    heightfield & operator=(const heightfield &) = delete;
+
+    size_t num_columns() const {
+        return m_num_samples[0];
+    }
+
+    size_t num_rows() const {
+        return m_num_samples[1];
+    }
+
+    size_t num_vertices() const {
+        return m_num_samples[0] * m_num_samples[1];
+    }
+
+    size_t num_triangles() const {
+        return m_num_cells[0] * m_num_cells[1] * 2;
+    }
+
+    size_t num_tiles() const {
+        return m_num_tiles[0] * m_num_tiles[1];
+    }
+
+    size_t tile_size() const {
+        return m_tile_size;
+    }
+
+    vector2 get_spacing() const {
+        return m_spacing;
+    }
+
+    vector3 get_origin() const {
+        return m_origin;
+    }
+
+    /**
+     * @brief Whether tiles are loaded on demand by a tile loader.
+     */
+    bool is_paged() const {
+        return m_loader != nullptr;
+    }
+
+    bool has_pyramid() const {
+        return m_build_pyramid;
+    }
+
+    /**
+     * @brief Get the heights of all samples, row after row, as passed to the
+     * constructor. Only available if the heightfield is not paged.
+     */
+    const std::vector<scalar> & get_heights() const {
+        EDYN_ASSERT(!is_paged());
+        return m_tile_storage[0]->heights;
+    }
+
+    /**
+     * @brief Get AABB of the entire heightfield, including tiles which are
+     * not loaded.
+     */
+    AABB get_aabb() const;
+
+    /**
+     * @brief Gets the range of samples covered by a tile. The heights passed
+     * to `assign_tile` must contain `num_columns * num_rows` values, row after
+     * row, starting at sample `(first_column, first_row)`.
+     */
+    void get_tile_samples(size_t tile_idx, size_t &first_column, size_t &first_row,
+                          size_t &num_columns, size_t &num_rows) const;
+
+    /**
+     * @brief Assigns the heights of a tile, usually called by the tile loader.
+     * Thread-safe with respect to queries, unless the tile was already loaded,
+     * in which case it's replaced and that must not happen while the
+     * heightfield is queried in another thread.
+     * @param tile_idx Tile index.
+     * @param heights Heights of the samples of the tile. See `get_tile_samples`.
+     */
+    void assign_tile(size_t tile_idx, std::vector<scalar> heights);
+
+    /**
+     * @brief Unloads a tile. Must not be called while the heightfield is
+     * queried in another thread.
+     */
+    void unload_tile(size_t tile_idx);
+
+    bool is_tile_loaded(size_t tile_idx) const {
+        EDYN_ASSERT(tile_idx < num_tiles());
+        return m_tiles[tile_idx].load(std::memory_order_acquire) != nullptr;
+    }
+
+    /**
+     * @brief Starts loading the tiles which intersect the given AABB and are
+     * not loaded yet. Does nothing if the heightfield is not paged.
+     */
+    void prefetch(const AABB &aabb);
+
+    /**
+     * @brief Get the height of a sample relative to the origin. The tile
+     * containing the sample must be loaded.
+     */
+    scalar get_height(size_t column, size_t row) const;
+
+    vector3 get_vertex_position(size_t vertex_idx) const;
+
+    triangle_vertices get_triangle_vertices(size_t tri_idx) const;
+
+    vector3 get_triangle_normal(size_t tri_idx) const;
+
+    index_type get_face_vertex_index(size_t tri_idx, size_t vertex_idx) const;
+
+    index_type get_face_edge_index(size_t tri_idx, size_t edge_idx) const;
+
+    /**
+     * @brief Get the normal of the triangle which shares the given edge of a
+     * triangle. At the border of the grid or of a loaded tile, it's a normal
+     * which forms a near 180 degree angle with the triangle, as in boundary
+     * edges of triangle meshes.
+     */
+    vector3 get_adjacent_face_normal(size_t tri_idx, size_t edge_idx) const;
+
+    bool is_convex_edge(size_t edge_idx) const;
+
+    /**
+     * @brief Contact point will be ignored if they're deeper than this value.
+     * See `triangle_mesh::get_thickness`.
+     */
+    scalar get_thickness() const { return m_thickness; }
+
+    void set_thickness(scalar thickness) { m_thickness = thickness; }
+
+    /**
+     * @brief Visits all triangles of loaded tiles that intersect the given AABB.
+     * @param aabb Query AABB.
+     * @param func Called with the index of each triangle.
+     */
+    template<typename Func>
+    void visit_triangles(const AABB &aabb, Func func) const {
+        std::array<size_t, 2> cell_min, cell_max;
+
+        if (!get_cell_range(aabb, cell_min, cell_max)) {
+            return;
+        }
+
+        auto query_range = height_range{aabb.min.y - m_origin.y, aabb.max.y - m_origin.y};
+
+        for (auto tz = cell_min[1] / m_tile_size; tz <= cell_max[1] / m_tile_size; ++tz) {
+            for (auto tx = cell_min[0] / m_tile_size; tx <= cell_max[0] / m_tile_size; ++tx) {
+                auto *tile = m_tiles[tz * m_num_tiles[0] + tx].load(std::memory_order_acquire);
+
+                if (tile == nullptr || !tile->range.intersects(query_range)) {
+                    continue;
+                }
+
+                // Range of cells in the tile.
+                auto local_min = std::array<size_t, 2>{
+                    std::max(cell_min[0], tile->first_column) - tile->first_column,
+                    std::max(cell_min[1], tile->first_row) - tile->first_row
+                };
+                auto local_max = std::array<size_t, 2>{
+                    std::min(cell_max[0] - tile->first_column, tile->num_columns - 2),
+                    std::min(cell_max[1] - tile->first_row, tile->num_rows - 2)
+                };
+
+                if (tile->pyramid.empty()) {
+                    for (auto z = local_min[1]; z <= local_max[1]; ++z) {
+                        for (auto x = local_min[0]; x <= local_max[0]; ++x) {
+                            visit_cell(*tile, x, z, query_range, func);
+                        }
+                    }
+                } else {
+                    visit_block(*tile, tile->pyramid.size(), 0, 0, local_min, local_max, query_range, func);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Visits the triangles of the cells of loaded tiles crossed by a
+     * segment, in order from `p0` to `p1`, using a digital differential
+     * analyzer over tiles and then over the cells of each tile. Cells whose
+     * height range does not intersect the segment are skipped.
+     * @param p0 First point in the segment.
+     * @param p1 Second point in the segment.
+     * @param func Called with the index of each triangle. If it returns a
+     * `bool`, the traversal stops after the current cell if `true` is returned
+     * for any of its triangles, which allows stopping at the first hit.
+     */
+    template<typename Func>
+    void raycast(const vector3 &p0, const vector3 &p1, Func func) const {
+        auto q0 = p0 - m_origin;
+        auto dir = p1 - p0;
+        auto tile_extent = vector2{m_spacing.x * m_tile_size, m_spacing.y * m_tile_size};
+        auto stop = false;
+
+        traverse_grid(q0.x / tile_extent.x, q0.z / tile_extent.y,
+                      dir.x / tile_extent.x, dir.z / tile_extent.y,
+                      m_num_tiles[0], m_num_tiles[1], 0, 1,
+                      [&](size_t tx, size_t tz, scalar t0, scalar t1) {
+            auto *tile = m_tiles[tz * m_num_tiles[0] + tx].load(std::memory_order_acquire);
+
+            if (tile == nullptr || !tile->range.intersects(segment_range(q0.y, dir.y, t0, t1))) {
+                return true;
+            }
+
+            traverse_grid(q0.x / m_spacing.x - tile->first_column, q0.z / m_spacing.y - tile->first_row,
+                          dir.x / m_spacing.x, dir.z / m_spacing.y,
+                          tile->num_columns - 1, tile->num_rows - 1, t0, t1,
+                          [&](size_t x, size_t z, scalar s0, scalar s1) {
+                auto heights = get_cell_heights(*tile, x, z);
+                auto cell_range = height_range{
+                    std::min(std::min(heights[0], heights[1]), std::min(heights[2], heights[3])),
+                    std::max(std::max(heights[0], heights[1]), std::max(heights[2], heights[3]))
+                };
+
+                if (!cell_range.intersects(segment_range(q0.y, dir.y, s0, s1))) {
+                    return true;
+                }
+
+                auto cell_tri_idx = get_cell_triangle_index(tile->first_column + x, tile->first_row + z);
+
+                if constexpr(std::is_same_v<std::invoke_result_t<Func, index_type>, bool>) {
+                    auto hit0 = func(cell_tri_idx);
+                    auto hit1 = func(cell_tri_idx + 1);
+                    stop = hit0 || hit1;
+                } else {
+                    func(cell_tri_idx);
+                    func(cell_tri_idx + 1);
+                }
+
+                return !stop;
+            });
+
+            return !stop;
+        });
+    }
+
+private:
+    struct tile {
+        size_t first_column;
+        size_t first_row;
+        // Number of samples.
+        size_t num_columns;
+        size_t num_rows;
+        std::vector<scalar> heights;
+        height_range range;
+        // The i-th level contains the height range of blocks of 2^(i+1) by
+        // 2^(i+1) cells. The last level has a single block.
+        std::vector<std::vector<height_range>> pyramid;
+    };
+
+    void init_tiles();
+    std::unique_ptr<tile> make_tile(size_t tile_idx, std::vector<scalar> heights) const;
+    bool get_cell_range(const AABB &aabb, std::array<size_t, 2> &cell_min,
+                        std::array<size_t, 2> &cell_max) const;
+    const tile * get_cell_tile(size_t column, size_t row) const;
+    bool get_adjacent_triangle(size_t tri_idx, size_t edge_idx, size_t &adj_tri_idx) const;
+    void start_loading(size_t tile_idx);
+
+    index_type get_cell_triangle_index(size_t column, size_t row) const {
+        return static_cast<index_type>((row * m_num_cells[0] + column) * 2);
+    }
+
+    // Heights of the corners `(x, z)`, `(x + 1, z)`, `(x, z + 1)` and
+    // `(x + 1, z + 1)` of a cell, in tile coordinates.
+    static std::array<scalar, 4> get_cell_heights(const tile &tile, size_t x, size_t z) {
+        auto *h = &tile.heights[z * tile.num_columns + x];
+        return {h[0], h[1], h[tile.num_columns], h[tile.num_columns + 1]};
+    }
+
+    static height_range segment_range(scalar y0, scalar dy, scalar t0, scalar t1) {
+        auto a = y0 + dy * t0;
+        auto b = y0 + dy * t1;
+        return {std::min(a, b), std::max(a, b)};
+    }
+
+    template<typename Func>
+    void visit_cell(const tile &tile, size_t x, size_t z,
+                    const height_range &query_range, Func &func) const {
+        auto h = get_cell_heights(tile, x, z);
+        auto cell_tri_idx = get_cell_triangle_index(tile.first_column + x, tile.first_row + z);
+
+        // The first triangle has corners 0, 3, 1 and the second 0, 2, 3.
+        auto range0 = height_range{std::min(std::min(h[0], h[3]), h[1]), std::max(std::max(h[0], h[3]), h[1])};
+        auto range1 = height_range{std::min(std::min(h[0], h[2]), h[3]), std::max(std::max(h[0], h[2]), h[3])};
+
+        if (range0.intersects(query_range)) {
+            func(cell_tri_idx);
+        }
+
+        if (range1.intersects(query_range)) {
+            func(cell_tri_idx + 1);
+        }
+    }
+
+    // Visits cells in the block `(bx, bz)` of the given pyramid level which
+    // are in the range of cells and whose height range intersects the query.
+    template<typename Func>
+    void visit_block(const tile &tile, size_t level, size_t bx, size_t bz,
+                     const std::array<size_t, 2> &local_min,
+                     const std::array<size_t, 2> &local_max,
+                     const height_range &query_range, Func &func) const {
+        if (level == 0) {
+            visit_cell(tile, bx, bz, query_range, func);
+            return;
+        }
+
+        auto num_cells_x = tile.num_columns - 1;
+        auto num_cells_z = tile.num_rows - 1;
+        auto dim_x = (num_cells_x + (size_t(1) << level) - 1) >> level;
+
+        if (!tile.pyramid[level - 1][bz * dim_x + bx].intersects(query_range)) {
+            return;
+        }
+
+        auto child_level = level - 1;
+
+        for (auto cz = bz * 2; cz < bz * 2 + 2; ++cz) {
+            auto first_z = cz << child_level;
+            auto last_z = ((cz + 1) << child_level) - 1;
+
+            if (first_z >= num_cells_z || first_z > local_max[1] || last_z < local_min[1]) {
+                continue;
+            }
+
+            for (auto cx = bx * 2; cx < bx * 2 + 2; ++cx) {
+                auto first_x = cx << child_level;
+                auto last_x = ((cx + 1) << child_level) - 1;
+
+                if (first_x >= num_cells_x || first_x > local_max[0] || last_x < local_min[0]) {
+                    continue;
+                }
+
+                visit_block(tile, child_level, cx, cz, local_min, local_max, query_range, func);
+            }
+        }
+    }
+
+    // Visits the cells of a grid of unit cells of the given size crossed by
+    // the segment `(x0 + dx * t, z0 + dz * t)` for `t` in `[t_begin, t_end]`
+    // in order, passing the cell coordinates and the interval of `t` inside
+    // the cell to `func`, which returns whether to continue.
+    template<typename Func>
+    static void traverse_grid(scalar x0, scalar z0, scalar dx, scalar dz,
+                              size_t size_x, size_t size_z,
+                              scalar t_begin, scalar t_end, Func func) {
+        scalar origin[] = {x0, z0};
+        scalar dir[] = {dx, dz};
+        int size[] = {static_cast<int>(size_x), static_cast<int>(size_z)};
+
+        // Clip segment against the bounds of the grid.
+        for (int i = 0; i < 2; ++i) {
+            if (dir[i] == 0) {
+                if (origin[i] < 0 || origin[i] > size[i]) {
+                    return;
+                }
+
+                continue;
+            }
+
+            auto ta = -origin[i] / dir[i];
+            auto tb = (size[i] - origin[i]) / dir[i];
+            t_begin = std::max(t_begin, std::min(ta, tb));
+            t_end = std::min(t_end, std::max(ta, tb));
+        }
+
+        if (t_begin > t_end) {
+            return;
+        }
+
+        int cell[2], step[2];
+        scalar t_next[2], t_delta[2];
+
+        for (int i = 0; i < 2; ++i) {
+            auto p = origin[i] + dir[i] * t_begin;
+            cell[i] = std::clamp(static_cast<int>(std::floor(p)), 0, size[i] - 1);
+
+            if (dir[i] > 0) {
+                step[i] = 1;
+                t_next[i] = (cell[i] + 1 - origin[i]) / dir[i];
+                t_delta[i] = 1 / dir[i];
+            } else if (dir[i] < 0) {
+                step[i] = -1;
+                t_next[i] = (cell[i] - origin[i]) / dir[i];
+                t_delta[i] = -1 / dir[i];
+            } else {
+                step[i] = 0;
+                t_next[i] = EDYN_SCALAR_MAX;
+                t_delta[i] = EDYN_SCALAR_MAX;
+            }
+        }
+
+        auto t = t_begin;
+
+        while (true) {
+            auto axis = t_next[0] < t_next[1] ? 0 : 1;
+            auto t_exit = std::min(t_next[axis], t_end);
+
+            if (!func(static_cast<size_t>(cell[0]), static_cast<size_t>(cell[1]), t, t_exit)) {
+                return;
+            }
+
+            if (t_next[axis] >= t_end) {
+                return;
+            }
+
+            cell[axis] += step[axis];
+
+            if (cell[axis] < 0 || cell[axis] >= size[axis]) {
+                return;
+            }
+
+            t = t_next[axis];
+            t_next[axis] += t_delta[axis];
+        }
+    }
+
+    std::array<size_t, 2> m_num_samples;
+    std::array<size_t, 2> m_num_cells;
+    std::array<size_t, 2> m_num_tiles;
+    size_t m_tile_size;
+    vector2 m_spacing;
+    vector3 m_origin;
+    height_range m_bounds;
+    bool m_build_pyramid;
+    scalar m_thickness {1};
+
+    // Tiles are published atomically so they can be assigned by the loader
+    // while the heightfield is queried in other threads.
+    std::unique_ptr<std::atomic<const tile *>[]> m_tiles;
+    std::vector<std::unique_ptr<tile>> m_tile_storage;
+    std::unique_ptr<std::atomic<bool>[]> m_is_loading_tile;
+    std::shared_ptr<heightfield_tile_loader_base> m_loader;
+    // Protects the tile storage.
+    std::mutex m_mutex;
+};
+
+}
+
+#endif // EDYN_SHAPES_HEIGHTFIELD_HPP
@@ -0,0 +1,21 @@
+#ifndef EDYN_SHAPES_HEIGHTFIELD_SHAPE_HPP
+#define EDYN_SHAPES_HEIGHTFIELD_SHAPE_HPP
+
+#include <memory>
+#include "heightfield.hpp"
+
+namespace edyn {
+
+/**
+ * @brief A terrain shape defined by a regular grid of heights.
+ * @remarks Heightfields can only be assigned to static rigid bodies.
+ * The `collide` functions involving this shape ignore position and
+ * orientation. Use the origin of the heightfield to place it in the world.
+ */
+struct heightfield_shape {
+    std::shared_ptr<heightfield> field;
+};
+
+}
+
+#endif // EDYN_SHAPES_HEIGHTFIELD_SHAPE_HPP
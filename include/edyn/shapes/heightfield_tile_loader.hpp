@@ -0,0 +1,23 @@
+#ifndef EDYN_SHAPES_HEIGHTFIELD_TILE_LOADER_HPP
+#define EDYN_SHAPES_HEIGHTFIELD_TILE_LOADER_HPP
+
+#include <cstddef>
+
+namespace edyn {
+
+class heightfield;
+
+/**
+ * @brief Provides the heights of the tiles of a paged heightfield. The
+ * implementation must eventually call `heightfield::assign_tile` with the
+ * heights of the requested tile, which can be done from any thread.
+ */
+class heightfield_tile_loader_base {
+public:
+    virtual ~heightfield_tile_loader_base() = default;
+    virtual void load(heightfield *field, size_t tile_idx) = 0;
+};
+
+}
+
+#endif // EDYN_SHAPES_HEIGHTFIELD_TILE_LOADER_HPP
@@ -0,0 +1,202 @@
+#ifndef EDYN_SHAPES_MESH_ASSET_CACHE_HPP
+#define EDYN_SHAPES_MESH_ASSET_CACHE_HPP
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/matrix3x3.hpp"
+
+namespace edyn {
+
+struct convex_mesh;
+class triangle_mesh;
+
+/**
+ * @brief Registry of meshes identified by a hash of their contents. Meshes
+ * with identical contents are interned, i.e. all users share a single
+ * instance, and the data derived from their vertices is calculated only once.
+ *
+ * The cache holds weak references to the meshes, thus a mesh is freed once
+ * the last shape using it is gone, unless it is replicated by hash, in which
+ * case the cache keeps it alive until `clear` is called. Entries of freed
+ * meshes are purged as new meshes are interned.
+ *
+ * Interned meshes are shared by all users and thus must not be modified.
+ * Deforming an interned `triangle_mesh` triggers an assertion.
+ *
+ * Convex meshes replicated by hash are serialized as their hash in
+ * `polyhedron_shape`s, instead of their vertex data. That means the receiver
+ * must have interned the same mesh, e.g. by loading the same asset files as
+ * the sender at startup.
+ *
+ * All functions are thread-safe.
+ */
+class mesh_asset_cache {
+public:
+    using hash_type = uint64_t;
+
+    /**
+     * @brief The cache used when serializing shapes.
+     */
+    static mesh_asset_cache &global();
+
+    /**
+     * @brief Interns a convex mesh, which must be initialized.
+     * @param mesh The mesh.
+     * @param replicate_by_hash Whether to keep the mesh alive and serialize it
+     * by hash in polyhedron shapes. If the mesh is already interned, it is
+     * replicated by hash if this is true in any of the calls.
+     * @return A previously interned mesh with the same contents if there's
+     * one, or `mesh` otherwise.
+     */
+    std::shared_ptr<convex_mesh> intern(std::shared_ptr<convex_mesh> mesh,
+                                        bool replicate_by_hash = false);
+
+    /**
+     * @brief Interns a triangle mesh, which must be initialized. Meshes are
+     * equal if they have the same vertices, indices, per-vertex properties
+     * and thickness. The mesh becomes immutable if it is interned.
+     * @param mesh The mesh.
+     * @return A previously interned mesh with the same contents if there's
+     * one, or `mesh` otherwise.
+     */
+    std::shared_ptr<triangle_mesh> intern(std::shared_ptr<triangle_mesh> mesh);
+
+    /**
+     * @brief Returns an interned convex mesh created from the given faces. The
+     * mesh is only created and initialized if no mesh was previously created
+     * from the same data.
+     * @param vertices Vertex positions.
+     * @param indices Vertex indices of all faces.
+     * @param faces Pairs of index of first vertex in `indices` and vertex
+     * count for each face.
+     * @param replicate_by_hash See `intern`.
+     * @return The interned mesh.
+     */
+    std::shared_ptr<convex_mesh> make_convex_mesh(const std::vector<vector3> &vertices,
+                                                  const std::vector<uint32_t> &indices,
+                                                  const std::vector<uint32_t> &faces,
+                                                  bool replicate_by_hash = false);
+
+    /**
+     * @brief Returns an interned triangle mesh created from the given
+     * triangles. The mesh is only created and initialized if no identical
+     * mesh is interned.
+     * @param vertices Vertex positions.
+     * @param indices Vertex indices, three per triangle.
+     * @return The interned mesh.
+     */
+    std::shared_ptr<triangle_mesh> make_triangle_mesh(const std::vector<vector3> &vertices,
+                                                      const std::vector<uint32_t> &indices);
+
+    /**
+     * @brief Finds an interned mesh by the hash of its contents.
+     * @param hash Content hash.
+     * @return The mesh, or null if no live mesh has this hash.
+     */
+    std::shared_ptr<convex_mesh> find_convex_mesh(hash_type hash) const;
+    std::shared_ptr<triangle_mesh> find_triangle_mesh(hash_type hash) const;
+
+    /**
+     * @brief Gets the content hash of an interned convex mesh.
+     * @param mesh The mesh.
+     * @param hash Receives the hash if the mesh is interned.
+     * @return Whether this exact instance is interned.
+     */
+    bool get_hash(const convex_mesh *mesh, hash_type &hash) const;
+
+    /**
+     * @brief Gets the content hash of a convex mesh if it's interned and
+     * replicated by hash.
+     */
+    bool get_replicated_hash(const convex_mesh *mesh, hash_type &hash) const;
+
+    /**
+     * @brief Gets the inertia tensor of an interned convex mesh for a unit
+     * mass. It's proportional to the mass.
+     * @param mesh The mesh.
+     * @param inertia Receives the inertia tensor if the mesh is interned.
+     * @return Whether this exact instance is interned.
+     */
+    bool get_unit_inertia(const convex_mesh *mesh, matrix3x3 &inertia) const;
+
+    /**
+     * @brief Removes entries of meshes which were freed. It's also done
+     * automatically once the number of entries doubles.
+     * @return Number of entries removed.
+     */
+    size_t purge_expired();
+
+    /**
+     * @brief Removes all entries, including meshes replicated by hash.
+     */
+    void clear();
+
+    size_t num_convex_meshes() const;
+    size_t num_triangle_meshes() const;
+
+private:
+    struct convex_entry {
+        std::weak_ptr<convex_mesh> mesh;
+        // Holds meshes replicated by hash.
+        std::shared_ptr<convex_mesh> pinned;
+        matrix3x3 unit_inertia;
+    };
+
+    struct triangle_entry {
+        std::weak_ptr<triangle_mesh> mesh;
+    };
+
+    std::shared_ptr<convex_mesh> intern_locked(std::shared_ptr<convex_mesh> mesh, hash_type hash,
+                                               const matrix3x3 &unit_inertia, bool replicate_by_hash);
+    std::shared_ptr<triangle_mesh> intern_locked(std::shared_ptr<triangle_mesh> mesh, hash_type hash);
+    std::shared_ptr<triangle_mesh> find_same(const triangle_mesh &mesh, hash_type hash) const;
+    const convex_entry * find_entry(const convex_mesh *mesh, hash_type &hash) const;
+    static bool same_contents(const convex_mesh &a, const convex_mesh &b);
+    static bool same_contents(const triangle_mesh &a, const triangle_mesh &b);
+    size_t purge_expired_locked();
+    void purge_if_grown_locked();
+
+    std::unordered_map<hash_type, convex_entry> m_convex_meshes;
+    std::unordered_map<hash_type, triangle_entry> m_triangle_meshes;
+
+    // Maps interned instances to their hash, for serialization.
+    std::unordered_map<const convex_mesh *, hash_type> m_convex_hashes;
+
+    // Maps the hash of the data convex meshes were created from to the hash
+    // of the resulting mesh, whose vertices are shifted to the centroid.
+    std::unordered_map<hash_type, hash_type> m_convex_sources;
+
+    // Number of entries at which expired entries are purged next.
+    static constexpr size_t min_purge_threshold = 64;
+    size_t m_purge_threshold {min_purge_threshold};
+
+    mutable std::mutex m_mutex;
+};
+
+/**
+ * @brief Calculates a hash of the vertices, indices and faces of a convex
+ * mesh. It is the same on all platforms with the same byte order and scalar
+ * type.
+ */
+mesh_asset_cache::hash_type content_hash(const convex_mesh &mesh);
+
+/**
+ * @brief Calculates a hash of the vertices, indices and per-vertex properties
+ * of a triangle mesh.
+ */
+mesh_asset_cache::hash_type content_hash(const triangle_mesh &mesh);
+
+/**
+ * @brief Calculates a hash of mesh data which is yet to be used to create
+ * a mesh, e.g. to identify the source of derived assets.
+ */
+mesh_asset_cache::hash_type content_hash(const std::vector<vector3> &vertices,
+                                         const std::vector<uint32_t> &indices);
+
+}
+
+#endif // EDYN_SHAPES_MESH_ASSET_CACHE_HPP
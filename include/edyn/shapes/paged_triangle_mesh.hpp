@@ -2,6 +2,7 @@
 #define EDYN_SHAPES_PAGED_TRIANGLE_MESH_HPP
 
 #include <mutex>
+#include <string>
 #include <vector>
 #include <atomic>
 #include <memory>
@@ -13,6 +14,7 @@ namespace edyn {
 
 class paged_triangle_mesh_file_input_archive;
 class paged_triangle_mesh_file_output_archive;
+class mapped_paged_triangle_mesh_loader;
 class finish_load_mesh_job;
 
 // Forward declaration of `detail::submesh_builder` needed by `friend`
@@ -33,6 +35,29 @@ public:
         std::shared_ptr<triangle_mesh> trimesh;
     };
 
+    /**
+     * @brief Cache statistics. Counters accumulate until reset.
+     */
+    struct cache_stats {
+        // Number of visits to submeshes which were loaded.
+        size_t hits;
+        // Number of visits to submeshes which were not loaded yet.
+        size_t misses;
+        // Number of loads started, including prefetches.
+        size_t loads;
+        // Number of loads started by `prefetch`.
+        size_t prefetches;
+        size_t evictions;
+        size_t loads_in_flight;
+        // Estimated size of loaded submeshes and loads in flight, in bytes.
+        size_t cache_size;
+
+        double hit_rate() const {
+            auto total = hits + misses;
+            return total > 0 ? double(hits) / double(total) : 1.0;
+        }
+    };
+
     paged_triangle_mesh(std::shared_ptr<triangle_mesh_page_loader_base> loader);
 
     /**
@@ -56,6 +81,15 @@ public:
         });
     }
 
+    /**
+     * @brief Starts loading submeshes which intersect the given AABB, without
+     * visiting them. Used to have submeshes ready before they're needed, such
+     * as in the region a body is moving towards. Prefetched submeshes which
+     * are already loaded are marked as recently visited.
+     * @param aabb Region to be prefetched, in object space.
+     */
+    void prefetch(const AABB &aabb);
+
     /**
      * @brief Loops over all edges present in the cache.
      * @tparam Func Type of the function object to invoke.
@@ -208,6 +242,16 @@ public:
      */
     size_t cache_num_vertices() const;
 
+    /**
+     * @brief Returns the cache statistics accumulated since the last reset.
+     */
+    cache_stats get_cache_stats() const;
+
+    /**
+     * @brief Resets the hit, miss, load, prefetch and eviction counters.
+     */
+    void reset_cache_stats();
+
     /**
      * @brief Get total number of sub-meshes this triangle mesh was
      * subdivided into.
@@ -238,6 +282,14 @@ public:
 
     void assign_mesh(size_t index, std::shared_ptr<triangle_mesh>);
 
+    /**
+     * @brief Must be called by page loaders instead of `assign_mesh` when a
+     * submesh could not be loaded. Releases the space reserved in the cache
+     * and allows the submesh to be requested again.
+     * @param index Sub-mesh index.
+     */
+    void cancel_loading(size_t index);
+
     auto & get_page_loader() {
         return *m_page_loader;
     }
@@ -287,12 +339,12 @@ public:
     void set_thickness(scalar thickness);
 
     /**
-     * @brief Maximum number of vertices in the cache. Before a new triangle mesh
-     * is loaded, if the number of vertices would exceed this number, the
-     * least recently visited nodes will be unloaded until the new total
-     * number of vertices stays below this value.
+     * @brief Maximum estimated size of the cache in bytes. Before a new
+     * triangle mesh is loaded, if the size would exceed this number, the
+     * least recently visited nodes will be unloaded until the new total size
+     * stays below this value. Loads in flight count towards the total.
      */
-    size_t m_max_cache_num_vertices = 1 << 13;
+    size_t m_max_cache_size = size_t(32) << 20;
 
     template<typename VertexIterator, typename IndexIterator>
     friend void create_paged_triangle_mesh(
@@ -314,18 +366,42 @@ public:
     friend void serialize(paged_triangle_mesh_file_input_archive &archive,
                           paged_triangle_mesh &paged_tri_mesh);
 
+    friend class mapped_paged_triangle_mesh_loader;
+
+    friend bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                                 const paged_triangle_mesh &paged_tri_mesh);
+
 private:
+    // Must be called after `m_cache` is filled.
+    void init_cache();
     void load_node_if_needed(size_t trimesh_idx);
+    void start_loading(size_t trimesh_idx, bool prefetch);
     void mark_recent_visit(size_t trimesh_idx);
-    void unload_least_recently_visited_node();
+    bool unload_least_recently_visited_node();
 
     static_tree m_tree;
     std::vector<triangle_mesh_node> m_cache;
-    std::vector<size_t> m_lru_indices;
-    std::mutex m_lru_mutex;
+
+    // Least recently visited submeshes are approximated with the CLOCK
+    // algorithm. Visits set a flag without locking, and to find a submesh to
+    // unload, a hand sweeps over the submeshes clearing the flags and stops
+    // at the first loaded submesh whose flag was not set.
+    std::unique_ptr<std::atomic<bool>[]> m_recently_visited;
+    size_t m_clock_hand {0};
+    // Protects the clock hand, assignment and unloading of submeshes.
+    std::mutex m_cache_mutex;
+    std::atomic<size_t> m_cache_size {0};
+
     std::unique_ptr<std::atomic<bool>[]> m_is_loading_submesh;
     std::shared_ptr<triangle_mesh_page_loader_base> m_page_loader;
     scalar m_thickness {1};
+
+    std::atomic<size_t> m_num_hits {0};
+    std::atomic<size_t> m_num_misses {0};
+    std::atomic<size_t> m_num_loads {0};
+    std::atomic<size_t> m_num_prefetches {0};
+    std::atomic<size_t> m_num_evictions {0};
+    std::atomic<size_t> m_num_loads_in_flight {0};
 };
 
 }
@@ -5,6 +5,7 @@
 #include <string>
 #include "edyn/config/config.h"
 #include "edyn/shapes/convex_mesh.hpp"
+#include "edyn/shapes/mesh_asset_cache.hpp"
 
 namespace edyn {
 
@@ -42,15 +43,45 @@ struct polyhedron_shape {
     polyhedron_shape(std::shared_ptr<convex_mesh> mesh);
 };
 
+/**
+ * Meshes which are replicated by hash in the global `mesh_asset_cache` are
+ * written as their content hash. Otherwise, the entire mesh is written. Meshes
+ * which are read are interned, thus identical meshes are shared. If the hash
+ * of a mesh which was not interned is read, the archive fails and the mesh is
+ * left null.
+ */
 template<typename Archive>
 void serialize(Archive &archive, polyhedron_shape &shape) {
+    auto &cache = mesh_asset_cache::global();
+    uint8_t by_hash {};
+    mesh_asset_cache::hash_type hash {};
+
     if constexpr(Archive::is_input::value) {
-        shape.mesh = std::make_shared<convex_mesh>();
+        archive(by_hash);
+
+        if (by_hash) {
+            archive(hash);
+            shape.mesh = cache.find_convex_mesh(hash);
+
+            if (!shape.mesh) {
+                archive.fail();
+            }
+        } else {
+            auto mesh = std::make_shared<convex_mesh>();
+            archive(*mesh);
+            shape.mesh = cache.intern(mesh);
+        }
     } else {
         EDYN_ASSERT(shape.mesh);
-    }
+        by_hash = cache.get_replicated_hash(shape.mesh.get(), hash);
+        archive(by_hash);
 
-    archive(*shape.mesh);
+        if (by_hash) {
+            archive(hash);
+        } else {
+            archive(*shape.mesh);
+        }
+    }
 }
 
 }
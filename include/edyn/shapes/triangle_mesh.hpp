@@ -32,6 +32,44 @@ public:
     void calculate_adjacent_normals();
     void build_triangle_tree();
 
+    /**
+     * @brief Recalculates the normals, the adjacent normals, the convexity of
+     * the edges and the tree leaves of a range of triangles after the
+     * positions of their vertices have changed. Triangles which share an edge
+     * with the range are also updated as needed. The connectivity of the mesh
+     * must not have changed. If the mesh is assigned to a rigid body, call
+     * `rigidbody_update_aabb` afterwards so its AABB is updated in the
+     * broadphase. The mesh must not be modified while it is being used in
+     * another thread, e.g. by a simulation worker in asynchronous mode. Meshes
+     * interned in a `mesh_asset_cache` are shared and must not be deformed.
+     * Deform a copy instead.
+     * @param first_tri_idx Index of the first triangle in the range.
+     * @param last_tri_idx Index past the last triangle in the range.
+     */
+    void update_triangles(size_t first_tri_idx, size_t last_tri_idx);
+
+    /**
+     * @brief Updates all triangles which contain any of the given vertices
+     * after their positions have changed. See `update_triangles`.
+     * @param first Iterator to the first vertex index.
+     * @param last Iterator past the last vertex index.
+     */
+    template<typename It>
+    void update_vertices(It first, It last) {
+        std::vector<index_type> tri_indices;
+
+        for (auto it = first; it != last; ++it) {
+            auto edge_indices = m_vertex_edge_indices[*it];
+
+            for (size_t i = 0; i < edge_indices.size(); ++i) {
+                auto &face_indices = m_edge_face_indices[edge_indices[i]];
+                tri_indices.insert(tri_indices.end(), face_indices.begin(), face_indices.end());
+            }
+        }
+
+        update_faces(tri_indices);
+    }
+
 public:
     using index_type = uint32_t;
 
@@ -84,6 +122,17 @@ public:
         return m_vertices[vertex_idx];
     }
 
+    /**
+     * @brief Moves a vertex. The triangles which contain it must be updated
+     * afterwards using `update_triangles` or `update_vertices`. The same
+     * restrictions of `update_triangles` regarding concurrency apply.
+     */
+    void set_vertex_position(size_t vertex_idx, const vector3 &position) {
+        EDYN_ASSERT(vertex_idx < m_vertices.size());
+        EDYN_ASSERT(!is_interned(), "Interned meshes are immutable.");
+        m_vertices[vertex_idx] = position;
+    }
+
     triangle_vertices get_triangle_vertices(size_t tri_idx) const;
 
     vector3 get_triangle_normal(size_t tri_idx) const {
@@ -202,15 +251,38 @@ public:
 
     void set_thickness(scalar thickness) { m_thickness = thickness; }
 
+    /**
+     * @brief Whether this instance is held by a `mesh_asset_cache`, in which
+     * case it is immutable. Copies are not interned.
+     */
+    bool is_interned() const { return m_interned.value; }
+
+    /**
+     * @brief Checks whether the sizes of all arrays are consistent and all
+     * indices are in range. Meshes loaded from untrusted sources must be
+     * validated before use.
+     * @return Whether this mesh can be used safely.
+     */
+    bool is_valid() const;
+
     vector3 barycentric_coordinates(size_t tri_idx, vector3 point) const;
     scalar interpolate_triangle(size_t tri_idx, vector3 point, vector3 values) const;
 
     template<typename Archive>
     friend void serialize(Archive &, triangle_mesh &);
     friend size_t serialization_sizeof(const triangle_mesh &);
+    friend uint64_t content_hash(const triangle_mesh &);
     friend struct detail::submesh_builder;
+    friend class mesh_asset_cache;
 
 private:
+    vector3 calculate_face_normal(size_t tri_idx) const;
+    void update_adjacent_normals(size_t tri_idx);
+    bool calculate_edge_convexity(size_t edge_idx) const;
+
+    // Updates the triangles with the given indices. Duplicates are allowed.
+    void update_faces(std::vector<index_type> &tri_indices);
+
     // Vertex positions.
     std::vector<vector3> m_vertices;
 
@@ -253,7 +325,19 @@ private:
 
     scalar m_thickness {1};
 
+    // Set by the `mesh_asset_cache`. Not copied, thus copies can be deformed.
+    struct interned_flag {
+        bool value {false};
+        interned_flag() = default;
+        interned_flag(const interned_flag &) {}
+        interned_flag & operator=(const interned_flag &) { return *this; }
+    } m_interned;
+
     static_tree m_triangle_tree;
+
+    // Index of the tree leaf of each triangle. Calculated on demand when
+    // triangles are updated.
+    std::vector<uint32_t> m_triangle_leaves;
 };
 
 }
@@ -5,6 +5,7 @@
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <string>
 #include <entt/entity/fwd.hpp>
 #include "edyn/collision/raycast.hpp"
 #include "edyn/collision/raycast_service.hpp"
@@ -17,6 +18,7 @@
 #include "edyn/replication/registry_operation_builder.hpp"
 #include "edyn/replication/registry_operation_observer.hpp"
 #include "edyn/simulation/island_manager.hpp"
+#include "edyn/time/tick_scheduler.hpp"
 #include "edyn/util/polyhedron_shape_initializer.hpp"
 
 namespace edyn {
@@ -39,9 +41,16 @@ class simulation_worker final {
     void mark_transforms_replaced();
 
 public:
+    /**
+     * @param report_progress Whether to send a step update after every step
+     * even if nothing changed, so the main thread knows how far this worker
+     * has progressed. Only necessary when there are multiple workers.
+     */
     simulation_worker(const settings &settings,
                       const registry_operation_context &reg_op_ctx,
-                      const material_mix_table &material_table);
+                      const material_mix_table &material_table,
+                      const std::string &queue_name = "worker",
+                      bool report_progress = false);
     ~simulation_worker();
 
     void on_construct_shared_entity(entt::registry &registry, entt::entity entity);
@@ -65,6 +74,10 @@ public:
     void start();
     void stop();
 
+    tick_lateness get_tick_lateness() const {
+        return m_tick_scheduler.get_lateness();
+    }
+
 private:
     entt::registry m_registry;
     entity_map m_entity_map;
@@ -95,10 +108,14 @@ private:
 
     std::unique_ptr<std::thread> m_thread;
     std::atomic<bool> m_running {false};
+    tick_scheduler m_tick_scheduler;
+    std::string m_thread_name;
     double m_accumulated_time {};
     double m_current_time {};
     double m_last_time {};
     double m_sim_time {};
+    double m_last_sync_time {-1};
+    bool m_report_progress;
     bool m_paused {false};
 
     std::vector<entt::scoped_connection> m_connections;
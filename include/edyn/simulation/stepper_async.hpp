@@ -1,9 +1,12 @@
 #ifndef EDYN_SIMULATION_STEPPER_ASYNC_HPP
 #define EDYN_SIMULATION_STEPPER_ASYNC_HPP
 
+#include <deque>
 #include <vector>
 #include <memory>
+#include <type_traits>
 #include <entt/entity/fwd.hpp>
+#include <entt/entity/sparse_set.hpp>
 #include <entt/signal/sigh.hpp>
 #include "edyn/collision/query_aabb.hpp"
 #include "edyn/collision/raycast.hpp"
@@ -19,33 +22,80 @@ namespace edyn {
 
 /**
  * Steps the simulation asynchronously. It runs as a background job which does
- * the actual simulation and synchronizes it with the main registry.
+ * the actual simulation and synchronizes it with the main registry. The
+ * simulation can be split among multiple workers, each one simulating the
+ * islands located in a different region of space. Non-procedural entities
+ * are replicated in all workers.
  */
 class stepper_async final {
 
-    void insert_to_worker(const std::vector<entt::entity> &nodes,
-                          const std::vector<entt::entity> &edges);
+    struct worker_context {
+        std::unique_ptr<simulation_worker> worker;
+        message_queue_identifier queue;
+        entity_map emap;
+        std::unique_ptr<registry_operation_builder> op_builder;
+        std::unique_ptr<registry_operation_observer> op_observer;
+        // Step updates received but not yet applied because other workers
+        // are behind in time.
+        std::deque<msg::step_update> pending_updates;
+        // Entities which must be woken up in this worker after next sync.
+        std::vector<entt::entity> pending_wake_up;
+        // Timestamp of the last step update applied.
+        double timestamp;
+    };
 
     void sync();
 
     void calculate_presentation_delay(double current_time, double elapsed, scalar fixed_dt);
 
+    unsigned worker_index(const message_queue_identifier &queue) const;
+    unsigned region_worker(const vector3 &pos) const;
+
+    void apply_step_updates();
+    void import_step_update(unsigned worker_index, msg::step_update &update);
+
+    void observe_imported(entt::entity entity);
+    void forget_entity(entt::entity entity);
+
+    void update_partitions();
+    void migrate(entt::entity node_entity, unsigned dest);
+    void move_to_worker(entt::entity entity, unsigned dest);
+    void destroy_contact_manifolds(const entt::sparse_set &bodies, unsigned keep_worker);
+
+    template<typename Func>
+    void each_worker_of(entt::entity entity, Func func);
+
+    template<typename Message, typename... Args>
+    void send_message_to_worker_index(unsigned worker_index, Args &&... args) {
+        message_dispatcher::global().send<Message>(m_workers[worker_index].queue,
+                                                   m_message_queue_handle.identifier,
+                                                   std::forward<Args>(args)...);
+    }
+
     struct worker_raycast_context {
         vector3 p0, p1;
         raycast_delegate_type delegate;
+        raycast_result result;
+        size_t pending;
     };
 
     struct worker_query_aabb_context {
         AABB aabb;
         query_aabb_delegate_type delegate;
+        query_aabb_result result;
+        size_t pending;
     };
 
 public:
     stepper_async(stepper_async const&) = delete;
     stepper_async operator=(stepper_async const&) = delete;
-    stepper_async(entt::registry &, double time);
+    stepper_async(entt::registry &, double time, unsigned num_workers = 1,
+                  scalar partition_region_size = scalar(64),
+                  scalar partition_margin = scalar(1));
 
-    void on_construct_shared(entt::registry &, entt::entity);
+    void on_construct_graph_node(entt::registry &, entt::entity);
+    void on_construct_graph_edge(entt::registry &, entt::entity);
+    void on_construct_child_list(entt::registry &, entt::entity);
 
     void on_destroy_graph_node(entt::registry &, entt::entity);
     void on_destroy_graph_edge(entt::registry &, entt::entity);
@@ -74,11 +124,25 @@ public:
     double get_simulation_timestamp() const { return m_sim_time; }
     double get_presentation_delay() const { return m_presentation_delay; }
 
+    // Worst wake-up lateness among all simulation workers.
+    tick_lateness get_tick_lateness() const;
+
+    /**
+     * @brief Sends a message to all workers. Messages which cannot be copied
+     * are only supported with a single worker.
+     */
     template<typename Message, typename... Args>
     void send_message_to_worker(Args &&... args) {
-        message_dispatcher::global().send<Message>({"worker"},
-                                                   m_message_queue_handle.identifier,
-                                                   std::forward<Args>(args)...);
+        if constexpr(std::is_copy_constructible_v<Message>) {
+            auto msg = Message{std::forward<Args>(args)...};
+
+            for (unsigned i = 0; i < m_workers.size(); ++i) {
+                send_message_to_worker_index<Message>(i, msg);
+            }
+        } else {
+            EDYN_ASSERT(m_workers.size() == 1);
+            send_message_to_worker_index<Message>(0, std::forward<Args>(args)...);
+        }
     }
 
     raycast_id_type raycast(vector3 p0, vector3 p1,
@@ -95,18 +159,18 @@ public:
 private:
     entt::registry *m_registry;
 
-    simulation_worker m_worker;
-    entity_map m_entity_map;
-
-    std::unique_ptr<registry_operation_builder> m_op_builder;
-    std::unique_ptr<registry_operation_observer> m_op_observer;
     message_queue_handle<
         msg::step_update,
         msg::raycast_response,
         msg::query_aabb_response
     > m_message_queue_handle;
 
+    std::vector<worker_context> m_workers;
+    scalar m_partition_region_size;
+    scalar m_partition_margin;
+
     bool m_importing {false};
+    unsigned m_importing_worker {};
     double m_last_time {};
     double m_sim_time {};
     double m_presentation_delay {};
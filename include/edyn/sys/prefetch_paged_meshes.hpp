@@ -0,0 +1,23 @@
+#ifndef EDYN_SYS_PREFETCH_PAGED_MESHES_HPP
+#define EDYN_SYS_PREFETCH_PAGED_MESHES_HPP
+
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Starts loading the submeshes of paged triangle meshes and the tiles
+ * of paged heightfields which moving bodies are expected to touch soon. The
+ * AABB of each awake dynamic body is extended by its linear velocity over the
+ * given time horizon and submeshes or tiles which intersect the swept region
+ * are prefetched, which gives them time to be loaded before the body reaches
+ * them.
+ * @param registry Data source.
+ * @param time_horizon How far ahead in time to extrapolate body motion.
+ */
+void prefetch_paged_meshes(entt::registry &registry, scalar time_horizon);
+
+}
+
+#endif // EDYN_SYS_PREFETCH_PAGED_MESHES_HPP
@@ -0,0 +1,103 @@
+#ifndef EDYN_TIME_TICK_SCHEDULER_HPP
+#define EDYN_TIME_TICK_SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(__linux__)
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace edyn {
+
+/**
+ * @brief How late the thread woke up after a tick deadline, in seconds.
+ */
+struct tick_lateness {
+    double last {};
+    double average {};
+    double max {};
+};
+
+/**
+ * @brief Puts a thread to sleep until an absolute deadline with sub-millisecond
+ * precision. The thread sleeps in the kernel until shortly before the deadline
+ * and spins for the remainder. The spin window adapts to how much the kernel
+ * oversleeps. The sleep can be interrupted from any thread by calling `wake`.
+ */
+class tick_scheduler {
+public:
+    using clock = std::chrono::steady_clock;
+    using time_func_t = double(void);
+
+    /**
+     * @brief Blocks until the deadline or until `wake` is called.
+     * @param deadline Point in time at which to wake up.
+     * @return Whether the deadline was reached. False if woken up early.
+     */
+    bool sleep_until(clock::time_point deadline);
+
+    /**
+     * @brief Blocks until the given time source reaches the deadline or until
+     * `wake` is called. The time source is polled after parking in bounded
+     * slices, thus it can advance at a different rate than the steady clock,
+     * or stall, e.g. when the simulation is driven by a custom clock.
+     * @param deadline Time at which to wake up, in seconds of `time_func`.
+     * @param time_func Time source, e.g. `settings::time_func`.
+     * @return Whether the deadline was reached. False if woken up early.
+     */
+    bool sleep_until(double deadline, time_func_t *time_func);
+
+    /**
+     * @brief Blocks for the given duration or until `wake` is called.
+     * @param seconds Time to sleep in seconds.
+     * @return Whether the deadline was reached. False if woken up early.
+     */
+    bool sleep_for(double seconds) {
+        auto duration = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(seconds));
+        return sleep_until(clock::now() + duration);
+    }
+
+    /**
+     * @brief Interrupts the current sleep, or the next one if the thread is
+     * not sleeping. Can be called from any thread.
+     */
+    void wake();
+
+    /**
+     * @brief Get statistics of how late the thread woke up after deadlines.
+     * Can be called from any thread.
+     * @return Wake-up lateness.
+     */
+    tick_lateness get_lateness() const;
+
+private:
+    bool park_until(clock::time_point deadline);
+    bool consume_wake();
+    void record_lateness(double lateness);
+
+    static constexpr uint32_t state_running = 0;
+    static constexpr uint32_t state_parked = 1;
+    static constexpr uint32_t state_woken = 2;
+
+    std::atomic<uint32_t> m_state {state_running};
+
+    // Estimate of how much the kernel oversleeps, which determines how long
+    // to spin before the deadline.
+    double m_oversleep {100e-6};
+
+    std::atomic<double> m_last_lateness {0};
+    std::atomic<double> m_average_lateness {0};
+    std::atomic<double> m_max_lateness {0};
+
+#if !defined(__linux__)
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+#endif
+};
+
+}
+
+#endif // EDYN_TIME_TICK_SCHEDULER_HPP
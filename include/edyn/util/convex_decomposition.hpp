@@ -0,0 +1,117 @@
+#ifndef EDYN_UTIL_CONVEX_DECOMPOSITION_HPP
+#define EDYN_UTIL_CONVEX_DECOMPOSITION_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "edyn/math/scalar.hpp"
+#include "edyn/math/vector3.hpp"
+#include "edyn/shapes/compound_shape.hpp"
+#include "edyn/util/shape_io.hpp"
+
+namespace edyn {
+
+struct convex_decomposition_settings {
+    // Number of voxels along the longest side of the bounding box of the mesh.
+    uint32_t resolution {64};
+
+    // Parts are not split further once the volume of their convex hull
+    // which is not occupied by the part, relative to the volume of the
+    // entire mesh, is below this value.
+    scalar max_concavity {0.01};
+
+    // Maximum number of times the mesh is recursively split.
+    uint32_t max_depth {8};
+
+    // Number of cutting planes evaluated along each axis when splitting a part.
+    uint32_t planes_per_axis {16};
+
+    // Maximum number of hulls. Hulls whose union adds the least volume are
+    // merged until the number of hulls is within this limit.
+    uint32_t max_hulls {32};
+
+    // Maximum number of vertices of each hull. Hulls with more vertices are
+    // simplified by keeping the vertices which add the most volume.
+    uint32_t max_vertices_per_hull {32};
+};
+
+/**
+ * @brief Approximates a concave triangle mesh with a set of convex
+ * polyhedrons. The mesh is voxelized and recursively split by the axis-aligned
+ * planes which minimize the concavity of the parts. Each part is then
+ * replaced by its convex hull. Thus hulls enclose the mesh with an error of up
+ * to one voxel. Hulls are computed in parallel in the global `job_dispatcher`,
+ * if running.
+ * @remark The mesh should be closed. Otherwise, its interior is considered
+ * empty and the result approximates its surface only.
+ * @param vertices Vertex positions.
+ * @param indices Vertex indices, three per triangle.
+ * @param settings Decomposition parameters.
+ * @return List of polyhedrons with their respective centroid. Empty if the
+ * mesh is degenerate.
+ */
+std::vector<polyhedron_with_center> decompose_into_convex_polyhedrons(
+    const std::vector<vector3> &vertices,
+    const std::vector<uint32_t> &indices,
+    const convex_decomposition_settings &settings = {});
+
+/**
+ * @brief Creates a compound shape of polyhedrons which approximates a concave
+ * triangle mesh. See `decompose_into_convex_polyhedrons`.
+ */
+compound_shape make_convex_decomposition(const std::vector<vector3> &vertices,
+                                         const std::vector<uint32_t> &indices,
+                                         const convex_decomposition_settings &settings = {});
+
+/**
+ * @brief Writes the polyhedrons of a convex decomposition into a file along
+ * with a hash of the source mesh and the settings, which allows the
+ * decomposition to be reused while the source doesn't change.
+ * @param path Destination file.
+ * @param polyhedrons Result of `decompose_into_convex_polyhedrons`.
+ * @param vertices Vertex positions of the source mesh.
+ * @param indices Vertex indices of the source mesh.
+ * @param settings Settings used in the decomposition.
+ * @return Whether the file was written successfully.
+ */
+bool save_convex_decomposition(const std::string &path,
+                               const std::vector<polyhedron_with_center> &polyhedrons,
+                               const std::vector<vector3> &vertices,
+                               const std::vector<uint32_t> &indices,
+                               const convex_decomposition_settings &settings);
+
+/**
+ * @brief Loads a convex decomposition written by `save_convex_decomposition`.
+ * @param path Source file.
+ * @param vertices Vertex positions of the source mesh.
+ * @param indices Vertex indices of the source mesh.
+ * @param settings Settings of the decomposition.
+ * @param polyhedrons Array to be filled with polyhedrons. Their meshes are
+ * interned in the global `mesh_asset_cache`.
+ * @return Whether the file is valid and was created from the same mesh and
+ * settings.
+ */
+bool load_convex_decomposition(const std::string &path,
+                               const std::vector<vector3> &vertices,
+                               const std::vector<uint32_t> &indices,
+                               const convex_decomposition_settings &settings,
+                               std::vector<polyhedron_with_center> &polyhedrons);
+
+/**
+ * @brief Creates a compound shape from the decomposition cached in a file if
+ * it's up to date. Otherwise, the decomposition is computed and written into
+ * the file.
+ * @param cache_path Cache file.
+ * @param vertices Vertex positions.
+ * @param indices Vertex indices, three per triangle.
+ * @param settings Decomposition parameters.
+ * @return Compound shape.
+ */
+compound_shape load_or_make_convex_decomposition(const std::string &cache_path,
+                                                 const std::vector<vector3> &vertices,
+                                                 const std::vector<uint32_t> &indices,
+                                                 const convex_decomposition_settings &settings = {});
+
+}
+
+#endif // EDYN_UTIL_CONVEX_DECOMPOSITION_HPP
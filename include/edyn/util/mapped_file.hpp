@@ -0,0 +1,77 @@
+#ifndef EDYN_UTIL_MAPPED_FILE_HPP
+#define EDYN_UTIL_MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace edyn {
+
+/**
+ * @brief Read-only view of the contents of a file. The file is memory-mapped,
+ * thus its pages are loaded on demand and are not allocated in the heap.
+ */
+class mapped_file {
+public:
+    // How the contents are going to be accessed, which tunes read-ahead.
+    enum class access_pattern {
+        sequential,
+        random
+    };
+
+    mapped_file() = default;
+    mapped_file(const std::string &path, access_pattern pattern);
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file & operator=(const mapped_file &) = delete;
+
+    /**
+     * @brief Maps a file into memory, closing the current one, if any.
+     * @param path Path to file.
+     * @param pattern Expected access pattern.
+     * @return Whether the file was opened successfully. Empty files are opened
+     * but have no data.
+     */
+    bool open(const std::string &path, access_pattern pattern);
+
+    void close();
+
+    bool is_open() const {
+        return m_open;
+    }
+
+    const uint8_t * data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    std::string_view text() const {
+        return {reinterpret_cast<const char *>(m_data), m_size};
+    }
+
+    /**
+     * @brief Hints that a range of the file will be accessed soon so its pages
+     * are read in the background. Does nothing where not supported.
+     * @param offset Start of range.
+     * @param size Size of range.
+     */
+    void prefetch(size_t offset, size_t size) const;
+
+private:
+    const uint8_t *m_data {nullptr};
+    size_t m_size {0};
+    bool m_open {false};
+#if defined(_WIN32)
+    void *m_file_handle {nullptr};
+    void *m_mapping_handle {nullptr};
+#endif
+};
+
+}
+
+#endif // EDYN_UTIL_MAPPED_FILE_HPP
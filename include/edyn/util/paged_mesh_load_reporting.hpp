@@ -1,6 +1,7 @@
 #ifndef EDYN_UTIL_PAGED_MESH_LOAD_REPORTING_HPP
 #define EDYN_UTIL_PAGED_MESH_LOAD_REPORTING_HPP
 
+#include <cstddef>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
 
@@ -16,6 +17,10 @@ entt::sink<entt::sigh<void(entt::entity, size_t)>> on_paged_mesh_page_loaded(ent
 
 }
 
+namespace edyn {
+    class paged_triangle_mesh;
+}
+
 namespace edyn::internal {
 
 inline constexpr auto paged_mesh_load_queue_identifier = "paged_triangle_mesh_page_load";
@@ -24,6 +29,12 @@ void init_paged_mesh_load_reporting(entt::registry &registry);
 void update_paged_mesh_load_reporting(entt::registry &registry);
 void deinit_paged_mesh_load_reporting(entt::registry &registry);
 
+/**
+ * @brief Notifies all attached registries that a page was loaded or unloaded.
+ * Each registry only reports it if it has a shape using the given mesh.
+ */
+void report_paged_mesh_page_load(paged_triangle_mesh *trimesh, size_t mesh_index);
+
 }
 
 #endif // EDYN_UTIL_PAGED_MESH_LOAD_REPORTING_HPP
@@ -213,6 +213,19 @@ void wake_up_entity(entt::registry &, entt::entity);
  */
 void rigidbody_set_shape(entt::registry &, entt::entity, std::optional<shapes_variant_t> shape_opt);
 
+/**
+ * @brief Recalculates the AABB of a rigid body after its shape was modified
+ * in place, such as after moving vertices of the `triangle_mesh` of a
+ * `mesh_shape` and updating its triangles, and updates it in the broadphase.
+ * In asynchronous mode, the new AABB is sent to the simulation workers, which
+ * share the modified shape with the main registry. Thus the shape must only
+ * be modified while the simulation is paused, since workers could be reading
+ * it concurrently otherwise.
+ * @param registry Data source.
+ * @param entity Rigid body entity.
+ */
+void rigidbody_update_aabb(entt::registry &, entt::entity);
+
 /**
  * @brief Check whether a rigid body is amorphous.
  * @param registry Data source.
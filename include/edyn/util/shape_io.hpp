@@ -22,6 +22,8 @@ struct obj_mesh {
 /**
  * @brief Loads meshes from a *.obj file.
  * Scale, rotation and translation are applied to all vertices in this order.
+ * Faces with indices that do not refer to a vertex of their own mesh are
+ * skipped.
  * @param path Path to file.
  * @param meshes Array to be filled with meshes.
  * @param pos Position offset to add to vertices.
@@ -42,8 +44,10 @@ void load_meshes_from_obj(std::stringstream &ss,
                           vector3 scale = vector3_one);
 
 /**
- * @brief Loads a triangle mesh from a *.obj file which must've been
- * triangulated during export.
+ * @brief Loads a triangle mesh from a *.obj file. Faces with more than three
+ * vertices are triangulated as a fan. The file is memory-mapped and parsed
+ * in parallel in the global `job_dispatcher`, if running, writing directly
+ * into the output arrays, which are appended to.
  * @param path Path to file.
  * @param vertices Array to be filled with vertices.
  * @param indices Array to be filled with indices for each triangle.
@@ -51,7 +55,7 @@ void load_meshes_from_obj(std::stringstream &ss,
  * @param pos Position offset to add to vertices.
  * @param orn Orientation to rotate vertices.
  * @param scale Scaling to be applied to all vertices.
- * @return Success or failure.
+ * @return Whether the file was opened and all lines were valid.
  */
 bool load_tri_mesh_from_obj(const std::string &path,
                             std::vector<vector3> &vertices,
@@ -398,6 +398,13 @@ struct collision_feature;
 size_t get_triangle_mesh_feature_index(const triangle_mesh &mesh, size_t tri_idx,
                                        triangle_feature tri_feature, size_t tri_feature_idx);
 
+/**
+ * @brief Get a heightfield feature index from the local index of a triangle
+ * feature. Equivalent to the triangle mesh overload.
+ */
+size_t get_triangle_mesh_feature_index(const heightfield &field, size_t tri_idx,
+                                       triangle_feature tri_feature, size_t tri_feature_idx);
+
 }
 
 #endif // EDYN_UTIL_SHAPE_UTIL_HPP
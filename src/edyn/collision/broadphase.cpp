@@ -15,6 +15,7 @@
 #include "edyn/util/entt_util.hpp"
 #include "edyn/util/island_util.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 
 namespace edyn {
 
@@ -27,6 +28,7 @@ broadphase::broadphase(entt::registry &registry)
 {
     m_connections.emplace_back(registry.on_construct<AABB>().connect<&broadphase::on_construct_aabb>(*this));
     m_connections.emplace_back(registry.on_destroy<AABB>().connect<&broadphase::on_destroy_aabb>(*this));
+    m_connections.emplace_back(registry.on_update<AABB>().connect<&broadphase::on_update_aabb>(*this));
     m_connections.emplace_back(registry.on_destroy<tree_resident>().connect<&broadphase::on_destroy_tree_resident>(*this));
     m_connections.emplace_back(registry.on_construct<island_AABB>().connect<&broadphase::on_construct_island_aabb>(*this));
     m_connections.emplace_back(registry.on_destroy<island_tree_resident>().connect<&broadphase::on_destroy_island_tree_resident>(*this));
@@ -50,6 +52,17 @@ void broadphase::on_destroy_aabb(entt::registry &registry, entt::entity entity)
     registry.remove<tree_resident>(entity);
 }
 
+void broadphase::on_update_aabb(entt::registry &registry, entt::entity entity) {
+    // AABBs of procedural and kinematic entities are moved in every update.
+    // Static entities are only moved when their AABB is replaced, e.g. after
+    // their shape is modified.
+    auto *node = registry.try_get<tree_resident>(entity);
+
+    if (node && !node->procedural) {
+        m_np_tree.move(node->id, registry.get<AABB>(entity));
+    }
+}
+
 void broadphase::on_destroy_tree_resident(entt::registry &registry, entt::entity entity) {
     auto &node = registry.get<tree_resident>(entity);
 
@@ -80,16 +93,30 @@ void broadphase::init_new_aabb_entities() {
 
     auto aabb_view = m_registry->view<AABB>();
     auto procedural_view = m_registry->view<procedural_tag>();
+    std::vector<entt::entity> entities[2];
+    std::vector<AABB> aabbs[2];
+    std::vector<tree_node_id_t> ids;
 
     for (auto entity : m_new_aabb_entities) {
         // Entity might've been cleared.
         if (!aabb_view.contains(entity)) continue;
 
-        auto &aabb = aabb_view.get<AABB>(entity);
-        bool procedural = procedural_view.contains(entity);
+        auto procedural = procedural_view.contains(entity);
+        entities[procedural].push_back(entity);
+        aabbs[procedural].push_back(aabb_view.get<AABB>(entity));
+    }
+
+    // Create all nodes of each tree at once, which builds the tree in one go
+    // when it's empty, e.g. after a world snapshot is loaded.
+    for (auto procedural : {false, true}) {
         auto &tree = procedural ? m_tree : m_np_tree;
-        tree_node_id_t id = tree.create(aabb, entity);
-        m_registry->emplace<tree_resident>(entity, id, procedural);
+        auto count = entities[procedural].size();
+        ids.resize(count);
+        tree.create(aabbs[procedural].data(), entities[procedural].data(), count, ids.data());
+
+        for (size_t i = 0; i < count; ++i) {
+            m_registry->emplace<tree_resident>(entities[procedural][i], ids[i], procedural);
+        }
     }
 
     m_new_aabb_entities.clear();
@@ -178,10 +205,12 @@ void broadphase::update(bool mt) {
 
     // Search for new AABB intersections and create manifolds.
     auto aabb_proc_view = m_registry->view<AABB, procedural_tag>(exclude_sleeping_disabled);
+    auto deterministic = m_registry->ctx().at<settings>().deterministic;
+    auto parallel = mt && calculate_view_size(aabb_proc_view) > m_max_sequential_size;
 
-    if (mt && calculate_view_size(aabb_proc_view) > m_max_sequential_size) {
-        collide_parallel();
-        finish_collide();
+    if (parallel || deterministic) {
+        collide_deferred(parallel);
+        finish_collide(deterministic);
     } else {
         for (auto [entity, aabb] : aabb_proc_view.each()) {
             auto offset_aabb = aabb.inset(m_aabb_offset);
@@ -191,10 +220,9 @@ void broadphase::update(bool mt) {
     }
 }
 
-void broadphase::collide_parallel() {
+void broadphase::collide_deferred(bool mt) {
     auto aabb_proc_view = m_registry->view<AABB, procedural_tag>(exclude_sleeping_disabled);
     m_pair_results.resize(calculate_view_size(aabb_proc_view));
-    auto &dispatcher = job_dispatcher::global();
 
     auto for_loop_body = [this, aabb_proc_view](entt::entity entity, size_t index) {
         auto &aabb = aabb_proc_view.get<AABB>(entity);
@@ -203,12 +231,43 @@ void broadphase::collide_parallel() {
         collide_tree_async(m_np_tree, entity, offset_aabb, index);
     };
 
-    parallel_for_each(dispatcher, aabb_proc_view.begin(), aabb_proc_view.end(), for_loop_body);
+    if (mt) {
+        auto &dispatcher = job_dispatcher::global();
+        parallel_for_each(dispatcher, aabb_proc_view.begin(), aabb_proc_view.end(), for_loop_body);
+    } else {
+        size_t index = 0;
+
+        for (auto entity : aabb_proc_view) {
+            for_loop_body(entity, index++);
+        }
+    }
 }
 
-void broadphase::finish_collide() {
+void broadphase::finish_collide(bool canonical) {
     auto &manifold_map = m_registry->ctx().at<contact_manifold_map>();
 
+    if (canonical) {
+        // Create manifolds sorted by entity so the resulting entities and
+        // their order in the pools do not depend on the order in which
+        // procedural entities were visited.
+        auto pairs = std::vector<entity_pair>{};
+
+        for (auto &results : m_pair_results) {
+            pairs.insert(pairs.end(), results.begin(), results.end());
+            results.clear();
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+
+        for (auto &pair : pairs) {
+            if (!manifold_map.contains(pair.first, pair.second)) {
+                make_contact_manifold(*m_registry, pair.first, pair.second, m_separation_threshold);
+            }
+        }
+
+        return;
+    }
+
     for (auto &pairs : m_pair_results) {
         for (auto &pair : pairs) {
             if (!manifold_map.contains(pair.first, pair.second)) {
@@ -11,8 +11,9 @@
 
 namespace edyn {
 
+template<typename Mesh>
 static void collide_box_triangle(
-    const box_shape &box, const triangle_mesh &mesh, size_t tri_idx,
+    const box_shape &box, const Mesh &mesh, size_t tri_idx,
     const std::array<vector3, 3> &box_axes,
     const collision_context &ctx, collision_result &result) {
 
@@ -393,8 +394,9 @@ static void collide_box_triangle(
     }
 }
 
-void collide(const box_shape &box, const triangle_mesh &mesh,
-             const collision_context &ctx, collision_result &result) {
+template<typename Mesh>
+static void collide_box_mesh(const box_shape &box, const Mesh &mesh,
+                             const collision_context &ctx, collision_result &result) {
     const auto box_axes = std::array<vector3, 3> {
         quaternion_x(ctx.ornA),
         quaternion_y(ctx.ornA),
@@ -409,4 +411,14 @@ void collide(const box_shape &box, const triangle_mesh &mesh,
     });
 }
 
+void collide(const box_shape &box, const triangle_mesh &mesh,
+             const collision_context &ctx, collision_result &result) {
+    collide_box_mesh(box, mesh, ctx, result);
+}
+
+void collide(const box_shape &box, const heightfield &field,
+             const collision_context &ctx, collision_result &result) {
+    collide_box_mesh(box, field, ctx, result);
+}
+
 }
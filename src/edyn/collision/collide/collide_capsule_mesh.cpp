@@ -7,8 +7,9 @@
 
 namespace edyn {
 
+template<typename Mesh>
 static void collide_capsule_triangle(
-    const capsule_shape &capsule, const triangle_mesh &mesh, size_t tri_idx,
+    const capsule_shape &capsule, const Mesh &mesh, size_t tri_idx,
     const std::array<vector3, 2> &capsule_vertices,
     const collision_context &ctx, collision_result &result) {
 
@@ -250,8 +251,9 @@ static void collide_capsule_triangle(
     }
 }
 
-void collide(const capsule_shape &capsule, const triangle_mesh &mesh,
-             const collision_context &ctx, collision_result &result) {
+template<typename Mesh>
+static void collide_capsule_mesh(const capsule_shape &capsule, const Mesh &mesh,
+                                 const collision_context &ctx, collision_result &result) {
     const auto &posA = ctx.posA;
     const auto &ornA = ctx.ornA;
     const auto capsule_vertices = capsule.get_vertices(posA, ornA);
@@ -264,4 +266,14 @@ void collide(const capsule_shape &capsule, const triangle_mesh &mesh,
     });
 }
 
+void collide(const capsule_shape &capsule, const triangle_mesh &mesh,
+             const collision_context &ctx, collision_result &result) {
+    collide_capsule_mesh(capsule, mesh, ctx, result);
+}
+
+void collide(const capsule_shape &capsule, const heightfield &field,
+             const collision_context &ctx, collision_result &result) {
+    collide_capsule_mesh(capsule, field, ctx, result);
+}
+
 }
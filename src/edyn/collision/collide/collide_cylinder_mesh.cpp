@@ -14,8 +14,9 @@
 
 namespace edyn {
 
-void collide_cylinder_triangle(
-    const cylinder_shape &cylinder, const triangle_mesh &mesh, size_t tri_idx,
+template<typename Mesh>
+static void collide_cylinder_triangle(
+    const cylinder_shape &cylinder, const Mesh &mesh, size_t tri_idx,
     const vector3 &cylinder_axis, const std::array<vector3, 2> &cylinder_vertices,
     const collision_context &ctx, collision_result &result) {
 
@@ -422,8 +423,9 @@ void collide_cylinder_triangle(
     }
 }
 
-void collide(const cylinder_shape &cylinder, const triangle_mesh &mesh,
-             const collision_context &ctx, collision_result &result) {
+template<typename Mesh>
+static void collide_cylinder_mesh(const cylinder_shape &cylinder, const Mesh &mesh,
+                                  const collision_context &ctx, collision_result &result) {
     const auto cylinder_axis = coordinate_axis_vector(cylinder.axis, ctx.ornA);
     const auto cylinder_vertices = std::array<vector3, 2>{
         ctx.posA + cylinder_axis * cylinder.half_length,
@@ -439,4 +441,14 @@ void collide(const cylinder_shape &cylinder, const triangle_mesh &mesh,
     });
 }
 
+void collide(const cylinder_shape &cylinder, const triangle_mesh &mesh,
+             const collision_context &ctx, collision_result &result) {
+    collide_cylinder_mesh(cylinder, mesh, ctx, result);
+}
+
+void collide(const cylinder_shape &cylinder, const heightfield &field,
+             const collision_context &ctx, collision_result &result) {
+    collide_cylinder_mesh(cylinder, field, ctx, result);
+}
+
 }
@@ -10,8 +10,9 @@
 
 namespace edyn {
 
+template<typename Mesh>
 static void collide_polyhedron_triangle(
-    const polyhedron_shape &poly, const triangle_mesh &tri_mesh, size_t tri_idx,
+    const polyhedron_shape &poly, const Mesh &tri_mesh, size_t tri_idx,
     const collision_context &ctx, collision_result &result) {
 
     // The triangle vertices are shifted by the polyhedron's position so all
@@ -260,8 +261,9 @@ static void collide_polyhedron_triangle(
     }
 }
 
-void collide(const polyhedron_shape &poly, const triangle_mesh &mesh,
-             const collision_context &ctx, collision_result &result) {
+template<typename Mesh>
+static void collide_polyhedron_mesh(const polyhedron_shape &poly, const Mesh &mesh,
+                                    const collision_context &ctx, collision_result &result) {
     const auto inset = vector3_one * -contact_breaking_threshold;
     const auto visit_aabb = ctx.aabbA.inset(inset);
 
@@ -270,4 +272,14 @@ void collide(const polyhedron_shape &poly, const triangle_mesh &mesh,
     });
 }
 
+void collide(const polyhedron_shape &poly, const triangle_mesh &mesh,
+             const collision_context &ctx, collision_result &result) {
+    collide_polyhedron_mesh(poly, mesh, ctx, result);
+}
+
+void collide(const polyhedron_shape &poly, const heightfield &field,
+             const collision_context &ctx, collision_result &result) {
+    collide_polyhedron_mesh(poly, field, ctx, result);
+}
+
 }
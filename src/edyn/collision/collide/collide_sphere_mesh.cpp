@@ -9,8 +9,9 @@
 
 namespace edyn {
 
+template<typename Mesh>
 static void collide_sphere_triangle(
-    const sphere_shape &sphere, const triangle_mesh &mesh, size_t tri_idx,
+    const sphere_shape &sphere, const Mesh &mesh, size_t tri_idx,
     const collision_context &ctx, collision_result &result) {
 
     const auto &sphere_pos = ctx.posA;
@@ -114,8 +115,9 @@ static void collide_sphere_triangle(
     }
 }
 
-void collide(const sphere_shape &sphere, const triangle_mesh &mesh,
-             const collision_context &ctx, collision_result &result) {
+template<typename Mesh>
+static void collide_sphere_mesh(const sphere_shape &sphere, const Mesh &mesh,
+                                const collision_context &ctx, collision_result &result) {
     const auto inset = vector3_one * -contact_breaking_threshold;
     const auto visit_aabb = ctx.aabbA.inset(inset);
 
@@ -124,4 +126,14 @@ void collide(const sphere_shape &sphere, const triangle_mesh &mesh,
     });
 }
 
+void collide(const sphere_shape &sphere, const triangle_mesh &mesh,
+             const collision_context &ctx, collision_result &result) {
+    collide_sphere_mesh(sphere, mesh, ctx, result);
+}
+
+void collide(const sphere_shape &sphere, const heightfield &field,
+             const collision_context &ctx, collision_result &result) {
+    collide_sphere_mesh(sphere, field, ctx, result);
+}
+
 }
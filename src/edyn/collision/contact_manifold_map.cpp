@@ -33,6 +33,14 @@ entt::entity contact_manifold_map::get(entt::entity first, entt::entity second)
 
 void contact_manifold_map::on_construct_contact_manifold(entt::registry &registry, entt::entity entity) {
     auto &manifold = registry.get<contact_manifold>(entity);
+
+    // Manifolds replicated from a simulation worker can momentarily refer to
+    // bodies which have already moved to another worker, which maps them to
+    // null. These are destroyed right after import and must not be cached.
+    if (manifold.body[0] == entt::null || manifold.body[1] == entt::null) {
+        return;
+    }
+
     // Insert all permutations.
     auto p = std::make_pair(manifold.body[0], manifold.body[1]);
     auto q = std::make_pair(manifold.body[1], manifold.body[0]);
@@ -46,8 +54,11 @@ void contact_manifold_map::on_destroy_contact_manifold(entt::registry &registry,
     // Cleanup cached info.
     auto p = std::make_pair(manifold.body[0], manifold.body[1]);
     auto q = std::make_pair(manifold.body[1], manifold.body[0]);
-    m_pair_map.erase(p);
-    m_pair_map.erase(q);
+
+    if (auto it = m_pair_map.find(p); it != m_pair_map.end() && it->second == entity) {
+        m_pair_map.erase(p);
+        m_pair_map.erase(q);
+    }
 }
 
 void contact_manifold_map::clear() {
@@ -1,5 +1,6 @@
 #include "edyn/collision/dynamic_tree.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 
 namespace edyn {
 
@@ -50,6 +51,76 @@ tree_node_id_t dynamic_tree::create(const AABB &aabb, entt::entity entity) {
     return id;
 }
 
+void dynamic_tree::create(const AABB *aabbs, const entt::entity *entities, size_t count,
+                          tree_node_id_t *ids) {
+    for (size_t i = 0; i < count; ++i) {
+        auto id = allocate();
+        auto &node = m_nodes[id];
+        node.entity = entities[i];
+        node.aabb = aabbs[i].inset(aabb_inset);
+        ids[i] = id;
+    }
+
+    if (m_root != null_tree_node_id) {
+        for (size_t i = 0; i < count; ++i) {
+            insert(ids[i]);
+        }
+        return;
+    }
+
+    if (count > 0) {
+        // A tree with `count` leaves has `count - 1` internal nodes.
+        m_nodes.reserve(m_nodes.size() + count - 1);
+        auto leaves = std::vector<build_leaf>(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            leaves[i] = {m_nodes[ids[i]].aabb.center(), ids[i]};
+        }
+
+        m_root = build(leaves.data(), count);
+        m_nodes[m_root].parent = null_tree_node_id;
+    }
+}
+
+tree_node_id_t dynamic_tree::build(build_leaf *leaves, size_t count) {
+    if (count == 1) {
+        return leaves[0].id;
+    }
+
+    // Split at the median along the axis where the centers of the leaves
+    // are the most spread out.
+    auto center_min = vector3_max;
+    auto center_max = vector3_min;
+
+    for (size_t i = 0; i < count; ++i) {
+        center_min = min(center_min, leaves[i].center);
+        center_max = max(center_max, leaves[i].center);
+    }
+
+    auto axis = max_index_abs(center_max - center_min);
+    auto half = count / 2;
+
+    std::nth_element(leaves, leaves + half, leaves + count, [axis](const build_leaf &a, const build_leaf &b) {
+        return a.center[axis] < b.center[axis];
+    });
+
+    auto child1 = build(leaves, half);
+    auto child2 = build(leaves + half, count - half);
+
+    auto id = allocate();
+    auto &node = m_nodes[id];
+    auto &child_node1 = m_nodes[child1];
+    auto &child_node2 = m_nodes[child2];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.aabb = enclosing_aabb(child_node1.aabb, child_node2.aabb);
+    node.height = std::max(child_node1.height, child_node2.height) + 1;
+    child_node1.parent = id;
+    child_node2.parent = id;
+
+    return id;
+}
+
 void dynamic_tree::destroy(tree_node_id_t id) {
     EDYN_ASSERT(m_nodes[id].leaf());
     remove(id);
@@ -26,15 +26,21 @@ void narrowphase::update(bool mt) {
     auto manifold_view = m_registry->view<contact_manifold>(exclude_sleeping_disabled);
     auto num_active_manifolds = calculate_view_size(manifold_view);
 
-    if (mt && num_active_manifolds > m_max_sequential_size) {
-        detect_collision_parallel();
+    auto deterministic = m_registry->ctx().at<settings>().deterministic;
+    auto parallel = mt && num_active_manifolds > m_max_sequential_size;
+
+    // In deterministic mode, contact points are always created and destroyed
+    // after all manifolds are processed, as in the parallel path, so that
+    // point ids are assigned in the same order regardless of thread count.
+    if (parallel || deterministic) {
+        detect_collision_deferred(parallel);
         finish_detect_collision();
     } else {
         update_contact_manifolds(manifold_view.begin(), manifold_view.end());
     }
 }
 
-void narrowphase::detect_collision_parallel() {
+void narrowphase::detect_collision_deferred(bool mt) {
     auto manifold_view = m_registry->view<contact_manifold>();
     auto events_view = m_registry->view<contact_manifold_events>();
     auto body_view = m_registry->view<AABB, shape_index, position, orientation>();
@@ -49,11 +55,9 @@ void narrowphase::detect_collision_parallel() {
     auto shapes_views_tuple = get_tuple_of_shape_views(*m_registry);
     auto dt = m_registry->ctx().at<settings>().fixed_dt;
 
-    // Resize result collection vectors to allocate one slot for each iteration
-    // of the parallel_for.
+    // Resize result collection vectors to allocate one slot for each manifold.
     m_cp_construction_infos.resize(manifold_view.size());
     m_cp_destruction_infos.resize(manifold_view.size());
-    auto &dispatcher = job_dispatcher::global();
 
     auto for_loop_body = [this, body_view, tr_view, vel_view, rolling_view, origin_view,
              manifold_view, events_view, orn_view, material_view, mesh_shape_view,
@@ -77,7 +81,14 @@ void narrowphase::detect_collision_parallel() {
         });
     };
 
-    parallel_for(dispatcher, size_t{}, manifold_view.size(), size_t{1}, for_loop_body);
+    if (mt) {
+        auto &dispatcher = job_dispatcher::global();
+        parallel_for(dispatcher, size_t{}, manifold_view.size(), size_t{1}, for_loop_body);
+    } else {
+        for (size_t i = 0; i < manifold_view.size(); ++i) {
+            for_loop_body(i);
+        }
+    }
 }
 
 void narrowphase::finish_detect_collision() {
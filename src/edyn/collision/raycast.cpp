@@ -424,4 +424,30 @@ shape_raycast_result shape_raycast(const paged_mesh_shape &paged_mesh, const ray
     return result;
 }
 
+shape_raycast_result shape_raycast(const heightfield_shape &sh, const raycast_context &ctx) {
+    shape_raycast_result result;
+
+    // Cells are visited in order along the ray thus it's safe to stop at the
+    // first cell where the ray hits one of its triangles.
+    sh.field->raycast(ctx.p0, ctx.p1, [&](auto tri_idx) {
+        auto vertices = sh.field->get_triangle_vertices(tri_idx);
+        auto normal = sh.field->get_triangle_normal(tri_idx);
+        auto t = scalar(0);
+
+        if (!intersect_segment_triangle(ctx.p0, ctx.p1, vertices, normal, t)) {
+            return false;
+        }
+
+        if (t < result.fraction) {
+            result.fraction = t;
+            result.normal = normal;
+            result.info_var = heightfield_raycast_info{tri_idx};
+        }
+
+        return true;
+    });
+
+    return result;
+}
+
 }
@@ -65,7 +65,9 @@ void set_should_collide(entt::registry &registry, should_collide_func_t func) {
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
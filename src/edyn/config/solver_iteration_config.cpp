@@ -19,7 +19,9 @@ void set_solver_velocity_iterations(entt::registry &registry, unsigned iteration
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -36,7 +38,9 @@ void set_solver_position_iterations(entt::registry &registry, unsigned iteration
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -53,7 +57,9 @@ void set_solver_restitution_iterations(entt::registry &registry, unsigned iterat
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -70,7 +76,9 @@ void set_solver_individual_restitution_iterations(entt::registry &registry, unsi
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
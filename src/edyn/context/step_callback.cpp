@@ -13,7 +13,9 @@ namespace internal {
         }
 
         if (auto *ctx = registry.ctx().find<client_network_context>()) {
-            ctx->extrapolator->set_settings(settings);
+            for (auto &extrapolator : ctx->extrapolators) {
+                extrapolator->set_settings(settings);
+            }
         }
     }
 }
@@ -12,6 +12,7 @@
 #include "edyn/config/config.h"
 #include "edyn/config/constants.hpp"
 #include "edyn/config/execution_mode.hpp"
+#include "edyn/context/settings.hpp"
 #include "edyn/constraints/constraint.hpp"
 #include "edyn/constraints/constraint_row_friction.hpp"
 #include "edyn/constraints/contact_constraint.hpp"
@@ -32,6 +33,7 @@
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/registry.hpp>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <tuple>
 #include <type_traits>
@@ -194,6 +196,15 @@ void insert_rows(entt::registry &registry, row_cache &cache, const entt::sparse_
     }
 }
 
+// In deterministic mode, sort the constraints of an island by entity so rows
+// are packed in the same order regardless of the order in which they were
+// inserted into the island.
+static void canonicalize_edges(entt::registry &registry, island &island) {
+    if (registry.ctx().at<settings>().deterministic) {
+        island.edges.sort(std::less<entt::entity>{});
+    }
+}
+
 void pack_rows(entt::registry &registry, row_cache &cache, const entt::sparse_set &entities,
                island_constraint_entities &constraint_entities) {
     cache.clear();
@@ -464,6 +475,7 @@ static void island_solver_update(island_solver_context &ctx) {
         auto &island = ctx.registry->get<edyn::island>(ctx.island_entity);
         auto &constraint_entities = ctx.registry->get<island_constraint_entities>(ctx.island_entity);
         auto &cache = ctx.registry->get<row_cache>(ctx.island_entity);
+        canonicalize_edges(*ctx.registry, island);
         pack_rows(*ctx.registry, cache, island.edges, constraint_entities);
 
         ctx.state = island_solver_state::solve_constraints;
@@ -537,6 +549,7 @@ void run_island_solver_seq(entt::registry &registry, entt::entity island_entity,
     auto &island = registry.get<edyn::island>(island_entity);
     auto &constraint_entities = registry.get<island_constraint_entities>(island_entity);
     auto &cache = registry.get<row_cache>(island_entity);
+    canonicalize_edges(registry, island);
     pack_rows(registry, cache, island.edges, constraint_entities);
 
     for (unsigned i = 0; i < num_iterations; ++i) {
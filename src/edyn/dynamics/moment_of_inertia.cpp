@@ -4,6 +4,7 @@
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/coordinate_axis.hpp"
 #include "edyn/math/shape_volume.hpp"
+#include "edyn/shapes/mesh_asset_cache.hpp"
 #include <variant>
 
 namespace edyn {
@@ -181,6 +182,11 @@ matrix3x3 moment_of_inertia(const box_shape &sh, scalar mass) {
 }
 
 matrix3x3 moment_of_inertia(const polyhedron_shape &sh, scalar mass) {
+    // Interned meshes have their inertia precalculated.
+    if (matrix3x3 unit_inertia; mesh_asset_cache::global().get_unit_inertia(sh.mesh.get(), unit_inertia)) {
+        return unit_inertia * mass;
+    }
+
     return moment_of_inertia_polyhedron(mass, sh.mesh->vertices, sh.mesh->indices, sh.mesh->faces);
 }
 
@@ -206,6 +212,10 @@ matrix3x3 moment_of_inertia(const paged_mesh_shape &sh, scalar mass) {
     return diagonal_matrix(vector3_max);
 }
 
+matrix3x3 moment_of_inertia(const heightfield_shape &sh, scalar mass) {
+    return diagonal_matrix(vector3_max);
+}
+
 matrix3x3 moment_of_inertia(const shapes_variant_t &var, scalar mass) {
     matrix3x3 inertia;
     std::visit([&](auto &&shape) {
@@ -80,18 +80,21 @@ void attach(entt::registry &registry, const init_config &config) {
         case execution_mode::asynchronous:
             num_workers = config.num_worker_threads > 0 ?
                           config.num_worker_threads :
-                          std::max(std::thread::hardware_concurrency(), 3u) - 2;
-                          // Subtract one for the main thread and another for the
+                          std::max(std::thread::hardware_concurrency(),
+                                   config.num_simulation_workers + 2) -
+                          config.num_simulation_workers - 1;
+                          // Subtract one for the main thread and one for each
                           // dedicated simulation worker thread.
             break;
         }
 
-        dispatcher.start(num_workers);
+        dispatcher.start(num_workers, config.dispatcher_config);
     }
 
     auto &settings = registry.ctx().emplace<edyn::settings>();
     settings.execution_mode = config.execution_mode;
     settings.fixed_dt = config.fixed_dt;
+    settings.deterministic = config.deterministic;
 
     registry.ctx().emplace<entity_graph>();
     registry.ctx().emplace<material_mix_table>();
@@ -109,7 +112,10 @@ void attach(entt::registry &registry, const init_config &config) {
                                                    config.execution_mode == execution_mode::sequential_multithreaded);
         break;
     case execution_mode::asynchronous:
-        registry.ctx().emplace<stepper_async>(registry, timestamp);
+        registry.ctx().emplace<stepper_async>(registry, timestamp,
+                                              std::max(config.num_simulation_workers, 1u),
+                                              config.partition_region_size,
+                                              config.partition_margin);
         break;
     }
 
@@ -184,7 +190,9 @@ void set_fixed_dt(entt::registry &registry, scalar dt) {
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -197,7 +205,9 @@ void set_max_steps_per_update(entt::registry &registry, unsigned max_steps) {
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -273,7 +283,9 @@ void set_time_source(entt::registry &registry, double(*time_func)(void)) {
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -295,4 +307,12 @@ double get_simulation_timestamp(entt::registry &registry) {
     return 0;
 }
 
+tick_lateness get_simulation_tick_lateness(entt::registry &registry) {
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        return stepper->get_tick_lateness();
+    }
+
+    return {};
+}
+
 }
@@ -1,6 +1,7 @@
 #include "edyn/math/triangle.hpp"
 #include "edyn/math/constants.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
+#include "edyn/shapes/heightfield.hpp"
 
 namespace edyn {
 
@@ -133,10 +134,11 @@ AABB get_triangle_aabb(const triangle_vertices &vertices) {
     return {tri_min, tri_max};
 }
 
-vector3 clip_triangle_separating_axis(vector3 sep_axis, const triangle_mesh &mesh,
-                                      size_t tri_idx, const triangle_vertices &tri_vertices,
-                                      const vector3 &tri_normal, triangle_feature tri_feature,
-                                      size_t tri_feature_index) {
+template<typename Mesh>
+static vector3 clip_triangle_separating_axis_impl(vector3 sep_axis, const Mesh &mesh,
+                                                  size_t tri_idx, const triangle_vertices &tri_vertices,
+                                                  const vector3 &tri_normal, triangle_feature tri_feature,
+                                                  size_t tri_feature_index) {
     // Project separating axis into voronoi region of triangle feature.
     // Return zero if the axis should be ignored, which happens in case the
     // feature is a vertex and the axis does not lie in the voronoi region.
@@ -203,4 +205,20 @@ vector3 clip_triangle_separating_axis(vector3 sep_axis, const triangle_mesh &mes
     return sep_axis;
 }
 
+vector3 clip_triangle_separating_axis(vector3 sep_axis, const triangle_mesh &mesh,
+                                      size_t tri_idx, const triangle_vertices &tri_vertices,
+                                      const vector3 &tri_normal, triangle_feature tri_feature,
+                                      size_t tri_feature_index) {
+    return clip_triangle_separating_axis_impl(sep_axis, mesh, tri_idx, tri_vertices,
+                                              tri_normal, tri_feature, tri_feature_index);
+}
+
+vector3 clip_triangle_separating_axis(vector3 sep_axis, const heightfield &field,
+                                      size_t tri_idx, const triangle_vertices &tri_vertices,
+                                      const vector3 &tri_normal, triangle_feature tri_feature,
+                                      size_t tri_feature_index) {
+    return clip_triangle_separating_axis_impl(sep_axis, field, tri_idx, tri_vertices,
+                                              tri_normal, tri_feature, tri_feature_index);
+}
+
 }
@@ -35,6 +35,8 @@
 #include "edyn/util/island_util.hpp"
 #include <entt/entity/registry.hpp>
 #include <entt/entity/utility.hpp>
+#include <algorithm>
+#include <iterator>
 
 namespace edyn {
 
@@ -45,7 +47,7 @@ extrapolation_worker::extrapolation_worker(const settings &settings,
     : m_solver(m_registry)
     , m_poly_initializer(m_registry)
     , m_island_manager(m_registry)
-    , m_message_queue(message_dispatcher::global().make_queue<
+    , m_message_queue(message_dispatcher::global().make_unique_queue<
         extrapolation_request,
         extrapolation_operation_create,
         extrapolation_operation_destroy,
@@ -76,6 +78,7 @@ extrapolation_worker::extrapolation_worker(const settings &settings,
 
 extrapolation_worker::~extrapolation_worker() {
     stop();
+    message_dispatcher::global().remove_queue(m_message_queue.identifier);
 }
 
 void extrapolation_worker::init() {
@@ -134,8 +137,17 @@ void extrapolation_worker::set_context_settings(std::shared_ptr<input_state_hist
 }
 
 void extrapolation_worker::on_extrapolation_request(message<extrapolation_request> &msg) {
+    if (!msg.content.remote_state.entities.empty()) {
+        import_remote_state(msg.content.remote_state);
+    }
+
+    // Requests could carry only remote state.
+    if (msg.content.snapshot.entities.empty()) {
+        return;
+    }
+
     if (m_requests.size() == m_max_requests) {
-        m_requests.erase(m_requests.begin());
+        m_requests.pop_front();
     }
 
     m_requests.emplace_back(std::move(msg.content));
@@ -285,10 +297,47 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
     m_step_count = 0;
     m_island_manager.set_last_time(m_current_time);
     m_terminated_early = false;
+    m_extrapolated_entities.clear();
 
     // Initialize new nodes and edges and create islands.
     m_island_manager.update(m_current_time);
 
+    return import_snapshot(request.snapshot, true);
+}
+
+void extrapolation_worker::import_remote_state(const packet::registry_snapshot &snapshot) {
+    auto snapshot_entities = entt::sparse_set{};
+
+    for (auto remote_entity : snapshot.entities) {
+        // Ignore state if it contains unknown entities.
+        if (!m_entity_map.contains(remote_entity)) {
+            return;
+        }
+
+        auto local_entity = m_entity_map.at(remote_entity);
+
+        if (!snapshot_entities.contains(local_entity)) {
+            snapshot_entities.emplace(local_entity);
+        }
+    }
+
+    // Changes are not being observed at this point since no extrapolation is
+    // running, thus this will not be included in any result.
+    for (auto &pool : snapshot.pools) {
+        pool.ptr->replace_into_registry(m_registry, snapshot.entities, m_entity_map);
+    }
+
+    m_modified_comp->export_remote_state(snapshot_entities);
+}
+
+bool extrapolation_worker::import_snapshot(const packet::registry_snapshot &snapshot, bool initial) {
+    // Abort if snapshot contains unknown entities.
+    for (auto remote_entity : snapshot.entities) {
+        if (!m_entity_map.contains(remote_entity)) {
+            return false;
+        }
+    }
+
     // Collect indices of nodes present in the snapshot.
     auto &graph = m_registry.ctx().at<entity_graph>();
     std::set<entity_graph::index_type> node_indices;
@@ -299,12 +348,7 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
     // changed recently. Though the extrapolation must include all entities
     // that belong in the same island because entities cannot be simulated in
     // isolation from their island. An island is always simulated as one unit.
-    for (auto remote_entity : request.snapshot.entities) {
-        // Abort if snapshot contains unknown entities.
-        if (!m_entity_map.contains(remote_entity)) {
-            return false;
-        }
-
+    for (auto remote_entity : snapshot.entities) {
         auto local_entity = m_entity_map.at(remote_entity);
         snapshot_entities.emplace(local_entity);
 
@@ -317,20 +361,21 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
         }
     }
 
-    // Collection of entities in all involved islands.
+    // Collection of entities in all involved islands which were not part of
+    // this extrapolation yet. Entities which are already being extrapolated
+    // keep their current state.
     auto entities = entt::sparse_set{};
 
+    auto insert_entity = [&](entt::entity entity) {
+        if (!entities.contains(entity) && !m_extrapolated_entities.contains(entity)) {
+            entities.emplace(entity);
+        }
+    };
+
     graph.reach(
         node_indices.begin(), node_indices.end(),
-        [&](entt::entity entity) {
-            if (!entities.contains(entity)) {
-                entities.emplace(entity);
-            }
-        }, [&](entt::entity entity) {
-            if (!entities.contains(entity)) {
-                entities.emplace(entity);
-            }
-        }, [](auto) { return true; }, []() {});
+        insert_entity, insert_entity,
+        [](auto) { return true; }, []() {});
 
     // Wake up all involved islands.
     auto resident_view = m_registry.view<island_resident>();
@@ -345,7 +390,7 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
     // Apply last known remote state as the initial state for extrapolation.
     m_modified_comp->import_remote_state(entities);
 
-    if (m_input_history) {
+    if (initial && m_input_history) {
         // Apply inputs that happened before the start time.
         m_input_history->import_latest(m_current_time, m_registry, m_entity_map);
     }
@@ -356,8 +401,8 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
 
     // Replace client component state by latest server state. The snapshot
     // only contains components which have changed since the last update.
-    for (auto &pool : request.snapshot.pools) {
-        pool.ptr->replace_into_registry(m_registry, request.snapshot.entities, m_entity_map);
+    for (auto &pool : snapshot.pools) {
+        pool.ptr->replace_into_registry(m_registry, snapshot.entities, m_entity_map);
     }
 
     // Assign current state as the last known remote state which will be used
@@ -367,12 +412,19 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
     m_modified_comp->export_remote_state(snapshot_entities);
 
     // Invoke pre-extrapolation callback after setting up initial state.
+    auto &settings = m_registry.ctx().at<edyn::settings>();
     auto &client_settings = std::get<client_network_settings>(settings.network_settings);
 
-    if (client_settings.extrapolation_begin_callback) {
+    if (initial && client_settings.extrapolation_begin_callback) {
         (*client_settings.extrapolation_begin_callback)(m_registry);
     }
 
+    for (auto entity : snapshot_entities) {
+        if (!entities.contains(entity)) {
+            entities.emplace(entity);
+        }
+    }
+
     // Recalculate properties after setting initial state from server.
     auto origin_view = m_registry.view<position, orientation, center_of_mass, origin>();
 
@@ -393,6 +445,10 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
         if (m_registry.any_of<rotated_mesh_list>(entity)) {
             update_rotated_mesh(m_registry, entity);
         }
+
+        if (!m_extrapolated_entities.contains(entity)) {
+            m_extrapolated_entities.emplace(entity);
+        }
     }
 
     return true;
@@ -429,6 +485,7 @@ void extrapolation_worker::finish_extrapolation(const extrapolation_request &req
 
     auto result = extrapolation_result{};
     result.ops = std::move(builder->finish());
+    result.terminated_early = m_terminated_early;
     EDYN_ASSERT(!result.ops.empty());
 
     // All manifolds that are not sleeping have been involved in the
@@ -458,11 +515,11 @@ void extrapolation_worker::finish_extrapolation(const extrapolation_request &req
     dispatcher.send<extrapolation_result>(request.destination, m_message_queue.identifier, std::move(result));
 }
 
-bool extrapolation_worker::should_step(const extrapolation_request &request) {
+bool extrapolation_worker::should_step(double execution_time_limit) {
     auto &settings = m_registry.ctx().at<edyn::settings>();
     auto time = (*settings.time_func)();
 
-    if (time - m_init_time > request.execution_time_limit) {
+    if (time - m_init_time > execution_time_limit) {
         // Timeout.
         m_terminated_early = true;
         return false;
@@ -508,15 +565,41 @@ void extrapolation_worker::finish_step() {
     ++m_step_count;
 }
 
-void extrapolation_worker::extrapolate(const extrapolation_request &request) {
-    if (!begin_extrapolation(request)) {
+void extrapolation_worker::extrapolate(std::vector<extrapolation_request> &batch) {
+    EDYN_ASSERT(!batch.empty());
+
+    // Start from the earliest request. Skip those which cannot be started,
+    // which happens if they contain unknown entities.
+    auto next = batch.begin();
+
+    while (next != batch.end() && !begin_extrapolation(*next)) {
+        ++next;
+    }
+
+    if (next == batch.end()) {
         return;
     }
 
+    const auto &request = *next;
+    ++next;
+
+    auto execution_time_limit = request.execution_time_limit;
+
+    for (auto it = next; it != batch.end(); ++it) {
+        execution_time_limit = std::min(execution_time_limit, it->execution_time_limit);
+    }
+
     auto &bphase = m_registry.ctx().at<broadphase>();
     auto &nphase = m_registry.ctx().at<narrowphase>();
 
-    while (should_step(request)) {
+    while (should_step(execution_time_limit)) {
+        // Import snapshots of the remaining requests as the extrapolation
+        // reaches their start time, which pulls their islands into it.
+        while (next != batch.end() && next->start_time <= m_current_time) {
+            import_snapshot(next->snapshot, false);
+            ++next;
+        }
+
         begin_step();
         bphase.update(true);
         m_island_manager.update(m_current_time);
@@ -525,10 +608,44 @@ void extrapolation_worker::extrapolate(const extrapolation_request &request) {
         finish_step();
     }
 
+    // Emit the state reached so far even if the extrapolation was cut short.
     finish_extrapolation(request);
+
+    // Requests which were not reached due to a timeout are put back in the
+    // queue to be extrapolated in the next run.
+    m_requests.insert(m_requests.begin(),
+                      std::make_move_iterator(next),
+                      std::make_move_iterator(batch.end()));
+}
+
+std::vector<extrapolation_request> extrapolation_worker::take_batch() {
+    // Coalesce all pending requests that share the same destination into a
+    // single extrapolation which starts at the earliest time. Islands involved
+    // in multiple requests are thus only simulated once and disjoint islands
+    // share the same broadphase, narrowphase and solver updates.
+    auto &front = m_requests.front();
+    auto destination = front.destination;
+    auto should_remap = front.should_remap;
+    auto batch = std::vector<extrapolation_request>{};
+
+    for (auto it = m_requests.begin(); it != m_requests.end();) {
+        if (it->destination.value == destination.value && it->should_remap == should_remap) {
+            batch.emplace_back(std::move(*it));
+            it = m_requests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::stable_sort(batch.begin(), batch.end(), [](auto &lhs, auto &rhs) {
+        return lhs.start_time < rhs.start_time;
+    });
+
+    return batch;
 }
 
 void extrapolation_worker::run() {
+    job_dispatcher::global().apply_low_latency_config("edyn-extrap");
     init();
 
     while (m_running.load(std::memory_order_relaxed)) {
@@ -544,11 +661,11 @@ void extrapolation_worker::run() {
             m_message_queue.update();
 
             if (!m_requests.empty()) {
-                auto req = std::move(m_requests.front());
-                m_requests.erase(m_requests.begin());
-                extrapolate(req);
+                auto batch = take_batch();
+                extrapolate(batch);
             }
-        } while (!m_requests.empty() && m_has_messages.exchange(false, std::memory_order_relaxed));
+        } while (m_running.load(std::memory_order_relaxed) &&
+                 (!m_requests.empty() || m_has_messages.exchange(false, std::memory_order_relaxed)));
     }
 
     deinit();
@@ -29,7 +29,10 @@ void edit_client_settings(entt::registry &registry, Func func) {
 
         if (auto *ctx = registry.ctx().find<client_network_context>()) {
             auto &settings = registry.ctx().at<edyn::settings>();
-            ctx->extrapolator->set_settings(settings);
+
+            for (auto &extrapolator : ctx->extrapolators) {
+                extrapolator->set_settings(settings);
+            }
         }
     }
 }
@@ -116,6 +119,12 @@ network_client_extrapolation_timeout_sink(entt::registry &registry) {
     return ctx.extrapolation_timeout_sink();
 }
 
+entt::sink<entt::sigh<void(double)>>
+network_client_extrapolation_finished_sink(entt::registry &registry) {
+    auto &ctx = registry.ctx().at<client_network_context>();
+    return ctx.extrapolation_finished_sink();
+}
+
 entt::sink<entt::sigh<void(entt::entity)>>
 network_client_entity_entered_sink(entt::registry &registry) {
     auto &ctx = registry.ctx().at<client_network_context>();
@@ -134,4 +143,15 @@ network_server_packet_sink(entt::registry &registry) {
     return ctx.packet_sink();
 }
 
+raycast_result raycast_at(entt::registry &registry, double time, vector3 p0, vector3 p1,
+                          const std::vector<entt::entity> &ignore_entities) {
+    auto &ctx = registry.ctx().at<server_network_context>();
+    return ctx.lag_compensation.raycast(registry, time, p0, p1, ignore_entities);
+}
+
+std::vector<entt::entity> query_aabb_at(entt::registry &registry, double time, const AABB &aabb) {
+    auto &ctx = registry.ctx().at<server_network_context>();
+    return ctx.lag_compensation.query_aabb(registry, time, aabb);
+}
+
 }
@@ -20,6 +20,7 @@
 #include "edyn/networking/util/component_index_type.hpp"
 #include "edyn/networking/util/process_extrapolation_result.hpp"
 #include "edyn/networking/util/process_update_entity_map_packet.hpp"
+#include "edyn/networking/util/split_extrapolation_request.hpp"
 #include "edyn/core/entity_graph.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/graph_node.hpp"
@@ -39,7 +40,10 @@
 #include "edyn/util/aabb_util.hpp"
 #include "edyn/time/simulation_time.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 #include <set>
+#include <string>
+#include <unordered_map>
 
 namespace edyn {
 
@@ -110,27 +114,47 @@ static void update_input_history(entt::registry &registry, double timestamp) {
 }
 
 static void on_extrapolation_result(entt::registry &registry, message<extrapolation_result> &msg) {
-    auto &result = msg.content;
+    auto &ctx = registry.ctx().at<client_network_context>();
+    ctx.extrapolation_results.emplace_back(std::move(msg.content));
+}
 
-    if (result.terminated_early) {
-        auto &ctx = registry.ctx().at<client_network_context>();
-        ctx.extrapolation_timeout_signal.publish();
+static void process_extrapolation_results(entt::registry &registry) {
+    auto &ctx = registry.ctx().at<client_network_context>();
+
+    if (ctx.extrapolation_results.empty()) {
+        return;
     }
 
+    // Results of different extrapolators could involve the same entities in
+    // case their islands merged. Apply in order so the latest state prevails.
+    std::stable_sort(ctx.extrapolation_results.begin(), ctx.extrapolation_results.end(),
+                     [](auto &&lhs, auto &&rhs) { return lhs.timestamp < rhs.timestamp; });
+
     auto &settings = registry.ctx().at<edyn::settings>();
 
-    if (settings.execution_mode == edyn::execution_mode::asynchronous) {
-        auto &stepper = registry.ctx().at<stepper_async>();
-        stepper.send_message_to_worker<extrapolation_result>(std::move(result));
-    } else {
-        auto &ctx = registry.ctx().at<client_network_context>();
-        ctx.snapshot_exporter->set_observer_enabled(false);
-        process_extrapolation_result(registry, result);
-        ctx.snapshot_exporter->set_observer_enabled(true);
+    for (auto &result : ctx.extrapolation_results) {
+        if (result.terminated_early) {
+            ctx.extrapolation_timeout_signal.publish();
+        }
+
+        ctx.extrapolation_finished_signal.publish(result.timestamp);
+
+        if (settings.execution_mode == edyn::execution_mode::asynchronous) {
+            auto &stepper = registry.ctx().at<stepper_async>();
+            stepper.send_message_to_worker<extrapolation_result>(std::move(result));
+        } else {
+            ctx.snapshot_exporter->set_observer_enabled(false);
+            process_extrapolation_result(registry, result);
+            ctx.snapshot_exporter->set_observer_enabled(true);
+        }
     }
+
+    ctx.extrapolation_results.clear();
 }
 
-void init_network_client(entt::registry &registry) {
+void init_network_client(entt::registry &registry, unsigned num_extrapolation_workers) {
+    EDYN_ASSERT(num_extrapolation_workers > 0);
+
     auto &ctx = registry.ctx().emplace<client_network_context>(registry);
 
     registry.on_construct<networked_tag>().connect<&on_construct_networked_entity>();
@@ -152,15 +176,22 @@ void init_network_client(entt::registry &registry) {
 
     auto &reg_op_ctx = registry.ctx().at<registry_operation_context>();
     auto &material_table = registry.ctx().at<material_mix_table>();
-    ctx.extrapolator = std::make_unique<extrapolation_worker>(settings, reg_op_ctx, material_table,
-                                                              ctx.make_extrapolation_modified_comp);
-    ctx.extrapolator->start();
+
+    for (unsigned i = 0; i < num_extrapolation_workers; ++i) {
+        auto &extrapolator = ctx.extrapolators.emplace_back(
+            std::make_unique<extrapolation_worker>(settings, reg_op_ctx, material_table,
+                                                   ctx.make_extrapolation_modified_comp));
+        extrapolator->start();
+    }
 
     ctx.message_queue.sink<extrapolation_result>().connect<&on_extrapolation_result>(registry);
 }
 
 void deinit_network_client(entt::registry &registry) {
+    // Extrapolators are stopped with the context before its queue is removed.
+    auto queue_id = registry.ctx().at<client_network_context>().message_queue.identifier;
     registry.ctx().erase<client_network_context>();
+    message_dispatcher::global().remove_queue(queue_id);
 
     registry.on_construct<networked_tag>().disconnect<&on_construct_networked_entity>();
     registry.on_destroy<networked_tag>().disconnect<&on_destroy_networked_entity>();
@@ -178,33 +209,42 @@ void add_entities_to_extrapolator(entt::registry &registry,
                                   const std::vector<entt::entity> &owned_entities) {
     auto &ctx = registry.ctx().at<client_network_context>();
     auto &reg_op_ctx = registry.ctx().at<registry_operation_context>();
-    auto builder = (*reg_op_ctx.make_reg_op_builder)(registry);
+    auto &dispatcher = message_dispatcher::global();
 
-    // Add all _create_ operations first so all entities are created in the extrapolator
-    // before components are inserted. This will ensure entities will be available in the
-    // entity map ready to be used in child entity mapping for all entity properties of
-    // all components.
-    for (auto entity : entities) {
-        builder->create(entity);
-    }
+    // All extrapolators hold a copy of all entities, since islands can be
+    // assigned to any of them. Registry operations cannot be copied, thus
+    // build one for each.
+    for (auto &extrapolator : ctx.extrapolators) {
+        auto builder = (*reg_op_ctx.make_reg_op_builder)(registry);
+
+        // Add all _create_ operations first so all entities are created in the extrapolator
+        // before components are inserted. This will ensure entities will be available in the
+        // entity map ready to be used in child entity mapping for all entity properties of
+        // all components.
+        for (auto entity : entities) {
+            builder->create(entity);
+        }
 
-    for (auto entity : entities) {
-        builder->emplace_all(entity);
-    }
+        for (auto entity : entities) {
+            builder->emplace_all(entity);
+        }
 
-    auto op = builder->finish();
-    auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<extrapolation_operation_create>(
-        {"extrapolation_worker"}, ctx.message_queue.identifier,
-        std::move(op), owned_entities);
+        auto op = builder->finish();
+        dispatcher.send<extrapolation_operation_create>(
+            extrapolator->identifier(), ctx.message_queue.identifier,
+            std::move(op), owned_entities);
+    }
 }
 
 void remove_entities_from_extrapolator(entt::registry &registry,
                                        const std::vector<entt::entity> &entities) {
     auto &ctx = registry.ctx().at<client_network_context>();
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<extrapolation_operation_destroy>(
-        {"extrapolation_worker"}, ctx.message_queue.identifier, entities);
+
+    for (auto &extrapolator : ctx.extrapolators) {
+        dispatcher.send<extrapolation_operation_destroy>(
+            extrapolator->identifier(), ctx.message_queue.identifier, entities);
+    }
 }
 
 static void process_created_entities(entt::registry &registry) {
@@ -292,9 +332,26 @@ static void dispatch_extrapolations(entt::registry &registry) {
     auto &dispatcher = message_dispatcher::global();
 
     for (auto &req : ctx.pending_extrapolations) {
-        dispatcher.send<extrapolation_request>({"extrapolation_worker"},
-                                               ctx.message_queue.identifier,
-                                               std::move(req));
+        if (ctx.extrapolators.size() == 1) {
+            dispatcher.send<extrapolation_request>(ctx.extrapolators.front()->identifier(),
+                                                   ctx.message_queue.identifier,
+                                                   std::move(req));
+            continue;
+        }
+
+        auto parts = split_extrapolation_request(registry, req, ctx.extrapolators.size());
+
+        for (size_t i = 0; i < parts.size(); ++i) {
+            auto &part = parts[i];
+
+            if (part.snapshot.entities.empty() && part.remote_state.entities.empty()) {
+                continue;
+            }
+
+            dispatcher.send<extrapolation_request>(ctx.extrapolators[i]->identifier(),
+                                                   ctx.message_queue.identifier,
+                                                   std::move(part));
+        }
     }
 
     ctx.pending_extrapolations.clear();
@@ -360,6 +417,7 @@ void update_network_client(entt::registry &registry) {
     update_client_snapshot_exporter(registry, time);
     maybe_publish_registry_snapshot(registry, time);
     registry.ctx().at<client_network_context>().message_queue.update();
+    process_extrapolation_results(registry);
     trim_and_insert_actions(registry, time);
     update_input_history(registry, time);
 }
@@ -754,18 +812,31 @@ static void process_packet(entt::registry &registry, packet::registry_snapshot &
     // the entities involved in this extrapolation.
     auto &req = ctx.pending_extrapolations.emplace_back();
     req.start_time = snapshot_time;
-
-    if (settings.execution_mode == edyn::execution_mode::asynchronous) {
-        // Send extrapolation result directly to simulation worker.
-        req.destination = {"worker"};
-    } else {
-        req.destination = ctx.message_queue.identifier;
-    }
+    // Results are always sent back here to be sorted by timestamp before
+    // being applied or forwarded to the simulation worker.
+    req.destination = ctx.message_queue.identifier;
 
     req.snapshot = std::move(snapshot);
+    req.execution_time_limit = client_settings.extrapolation_time_budget;
     req.should_remap = true;
 }
 
+static void process_packet(entt::registry &registry, const packet::compact_registry_snapshot &compact) {
+    auto &ctx = registry.ctx().at<client_network_context>();
+    auto snapshot = packet::registry_snapshot{};
+
+    // Drop it if its baseline is unknown or the data is malformed. It is an
+    // unreliable packet thus it is fine to lose it.
+    if (!ctx.compact_snapshot_decoder.decode(compact, ctx.compact_snapshot_quantization, snapshot)) {
+        return;
+    }
+
+    // Acknowledge so it can be used as baseline by the server.
+    ctx.packet_signal.publish(packet::edyn_packet{packet::snapshot_ack{compact.sequence}});
+
+    process_packet(registry, snapshot);
+}
+
 static void process_packet(entt::registry &registry, packet::set_playout_delay &delay) {
     auto &ctx = registry.ctx().at<client_network_context>();
     ctx.server_playout_delay = delay.value;
@@ -796,7 +867,11 @@ static void process_packet(entt::registry &registry, const packet::server_settin
 
     auto &ctx = registry.ctx().at<client_network_context>();
     ctx.allow_full_ownership = server.allow_full_ownership;
-    ctx.extrapolator->set_settings(settings);
+    ctx.compact_snapshot_quantization = server.quantization;
+
+    for (auto &extrapolator : ctx.extrapolators) {
+        extrapolator->set_settings(settings);
+    }
 
     if (auto *stepper = registry.ctx().find<stepper_async>()) {
         stepper->settings_changed();
@@ -828,6 +903,16 @@ static void process_packet(entt::registry &registry, packet::asset_sync_response
 static void process_packet(entt::registry &, const packet::set_aabb_of_interest &) {}
 static void process_packet(entt::registry &, const packet::query_entity &) {}
 static void process_packet(entt::registry &, const packet::asset_sync &) {}
+static void process_packet(entt::registry &, const packet::snapshot_ack &) {}
+
+static void process_packet(entt::registry &registry, const packet::packet_fragment &fragment) {
+    auto &ctx = registry.ctx().at<client_network_context>();
+    auto packet = packet::edyn_packet{};
+
+    if (ctx.packet_fragment_assembler.insert(fragment, packet)) {
+        client_receive_packet(registry, packet);
+    }
+}
 
 void client_receive_packet(entt::registry &registry, packet::edyn_packet &packet) {
     std::visit([&](auto &&inner_packet) {
@@ -28,8 +28,11 @@
 #include "edyn/networking/context/server_network_context.hpp"
 #include "edyn/networking/util/process_update_entity_map_packet.hpp"
 #include "edyn/networking/util/snap_to_pool_snapshot.hpp"
+#include "edyn/networking/util/packet_fragmentation.hpp"
+#include "edyn/networking/util/prioritize_snapshot.hpp"
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/parallel/message.hpp"
+#include "edyn/parallel/parallel_for.hpp"
 #include "edyn/replication/entity_map.hpp"
 #include "edyn/util/island_util.hpp"
 #include "edyn/util/vector_util.hpp"
@@ -41,6 +44,32 @@
 
 namespace edyn {
 
+static size_t get_max_packet_size(const entt::registry &registry) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    return std::get<server_network_settings>(settings.network_settings).max_packet_size;
+}
+
+// Publishes a packet which must be delivered reliably, splitting it into
+// fragments if it exceeds the maximum packet size.
+static void publish_reliable_packet(entt::registry &registry, entt::entity client_entity,
+                                    packet::edyn_packet &&packet) {
+    auto &ctx = registry.ctx().at<server_network_context>();
+    auto max_size = get_max_packet_size(registry);
+    auto fragment_overhead = serialized_packet_size(packet::edyn_packet{packet::packet_fragment{}});
+
+    if (max_size <= fragment_overhead || serialized_packet_size(packet) <= max_size) {
+        ctx.packet_signal.publish(client_entity, packet);
+        return;
+    }
+
+    auto &client = registry.get<remote_client>(client_entity);
+    auto message_id = client.next_fragment_message_id++;
+
+    for (auto &fragment : fragment_packet(packet, message_id, max_size - fragment_overhead)) {
+        ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(fragment)});
+    }
+}
+
 static void process_packet(entt::registry &registry, entt::entity client_entity, packet::registry_snapshot &snapshot) {
     if (auto *stepper = registry.ctx().find<stepper_async>()) {
         stepper->send_message_to_worker<msg::apply_network_pools>(std::move(snapshot.entities), std::move(snapshot.pools), false);
@@ -242,7 +271,7 @@ static void process_packet(entt::registry &registry, entt::entity client_entity,
         return lhs.component_index < rhs.component_index;
     });
 
-    ctx.packet_signal.publish(client_entity, packet::edyn_packet{res});
+    publish_reliable_packet(registry, client_entity, packet::edyn_packet{std::move(res)});
 }
 
 static void process_packet(entt::registry &registry, entt::entity client_entity, const packet::asset_sync &query) {
@@ -270,7 +299,7 @@ static void process_packet(entt::registry &registry, entt::entity client_entity,
         return lhs.component_index < rhs.component_index;
     });
 
-    ctx.packet_signal.publish(client_entity, packet::edyn_packet{res});
+    publish_reliable_packet(registry, client_entity, packet::edyn_packet{std::move(res)});
 }
 
 static void process_packet(entt::registry &, entt::entity, const packet::entity_response &) {}
@@ -280,6 +309,13 @@ static void process_packet(entt::registry &, entt::entity, const packet::server_
 static void process_packet(entt::registry &, entt::entity, const packet::entity_entered &) {}
 static void process_packet(entt::registry &, entt::entity, const packet::entity_exited &) {}
 static void process_packet(entt::registry &, entt::entity, const packet::asset_sync_response &) {}
+static void process_packet(entt::registry &, entt::entity, const packet::compact_registry_snapshot &) {}
+static void process_packet(entt::registry &, entt::entity, const packet::packet_fragment &) {}
+
+static void process_packet(entt::registry &registry, entt::entity client_entity, const packet::snapshot_ack &ack) {
+    auto &client = registry.get<remote_client>(client_entity);
+    client.compact_snapshot_encoder.acknowledge(ack.sequence);
+}
 
 void init_network_server(entt::registry &registry) {
     registry.ctx().emplace<server_network_context>(registry);
@@ -431,7 +467,15 @@ static void process_aabb_of_interest_entities_entered(entt::registry &registry,
             });
         }
 
-        ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(packet)});
+        // Entries are independent thus the client can apply each part as soon
+        // as it arrives.
+        if (auto max_size = get_max_packet_size(registry); max_size > 0) {
+            for (auto &part : split_entity_entered(std::move(packet), max_size)) {
+                publish_reliable_packet(registry, client_entity, packet::edyn_packet{std::move(part)});
+            }
+        } else {
+            ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(packet)});
+        }
     }
 
     if (!entities.empty()) {
@@ -445,30 +489,45 @@ static void process_aabb_of_interest_entities_entered(entt::registry &registry,
             return lhs.component_index < rhs.component_index;
         });
 
-        ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(packet)});
+        // Entities might refer to one another thus they must be created at
+        // once on the other end, which means this packet can be fragmented
+        // but not split.
+        publish_reliable_packet(registry, client_entity, packet::edyn_packet{std::move(packet)});
     }
 
     // Do not forget to clear it after processing.
     aabboi.entities_entered.clear();
 }
 
-static void maybe_publish_client_registry_snapshot(entt::registry &registry,
-                                                   entt::entity client_entity,
-                                                   remote_client &client,
-                                                   aabb_of_interest &aabboi,
-                                                   double time) {
-    if (time - client.last_snapshot_time < 1 / client.snapshot_rate) {
+static void publish_client_registry_snapshot(entt::registry &registry,
+                                             entt::entity client_entity,
+                                             remote_client &client,
+                                             aabb_of_interest &aabboi,
+                                             packet::registry_snapshot &packet) {
+    if (packet.entities.empty() || packet.pools.empty()) {
         return;
     }
 
-    client.last_snapshot_time = time;
+    packet.timestamp = get_simulation_timestamp(registry);
 
     auto &ctx = registry.ctx().at<server_network_context>();
-    auto packet = packet::registry_snapshot{};
-    ctx.snapshot_exporter->export_modified(packet, aabboi.entities, client_entity);
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
 
-    if (!packet.entities.empty() && !packet.pools.empty()) {
-        packet.timestamp = get_simulation_timestamp(registry);
+    if (server_settings.compact_snapshots) {
+        // Positions are encoded relative to the center of the AABB of
+        // interest, where most entities are expected to be. Compact snapshots
+        // are not split since each is delta-encoded against a single baseline.
+        auto origin = (aabboi.aabb.min + aabboi.aabb.max) / scalar(2);
+        auto compact = client.compact_snapshot_encoder.encode(packet, origin, server_settings.quantization);
+        ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(compact)});
+    } else if (server_settings.max_packet_size > 0) {
+        // Each part holds all components of its entities thus it can be
+        // applied on its own and losing one does not affect the others.
+        for (auto &part : split_registry_snapshot(packet, server_settings.max_packet_size)) {
+            ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(part)});
+        }
+    } else {
         ctx.packet_signal.publish(client_entity, packet::edyn_packet{packet});
     }
 }
@@ -508,10 +567,46 @@ static void calculate_client_playout_delay(entt::registry &registry,
 }
 
 static void process_aabbs_of_interest(entt::registry &registry, double time) {
-    for (auto [client_entity, client, aabboi] : registry.view<remote_client, aabb_of_interest>().each()) {
+    auto client_view = registry.view<remote_client, aabb_of_interest>();
+    auto snapshot_clients = std::vector<entt::entity>{};
+
+    for (auto [client_entity, client, aabboi] : client_view.each()) {
         process_aabb_of_interest_entities_exited(registry, client_entity, aabboi);
         process_aabb_of_interest_entities_entered(registry, client_entity, aabboi);
-        maybe_publish_client_registry_snapshot(registry, client_entity, client, aabboi, time);
+
+        if (time - client.last_snapshot_time >= 1 / client.snapshot_rate) {
+            client.last_snapshot_time = time;
+            snapshot_clients.push_back(client_entity);
+        }
+    }
+
+    // Exporting and prioritizing a snapshot only reads from the registry and
+    // writes to the client, thus the snapshots of all clients can be exported
+    // in parallel.
+    auto &ctx = registry.ctx().at<server_network_context>();
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &priority = std::get<server_network_settings>(settings.network_settings).priority;
+    auto snapshots = std::vector<packet::registry_snapshot>(snapshot_clients.size());
+    const auto &const_registry = registry;
+
+    if (!snapshot_clients.empty()) {
+        parallel_for(size_t{}, snapshot_clients.size(), [&](size_t index) {
+            auto client_entity = snapshot_clients[index];
+            auto [client, aabboi] = client_view.get(client_entity);
+            ctx.snapshot_exporter->export_modified(snapshots[index], aabboi.entities, client_entity);
+            insert_pending_snapshot_components(const_registry, *ctx.snapshot_exporter, client,
+                                               aabboi.entities, snapshots[index]);
+            prioritize_snapshot(const_registry, client_entity, client, snapshots[index], priority);
+        });
+    }
+
+    for (size_t i = 0; i < snapshot_clients.size(); ++i) {
+        auto client_entity = snapshot_clients[i];
+        auto [client, aabboi] = client_view.get(client_entity);
+        publish_client_registry_snapshot(registry, client_entity, client, aabboi, snapshots[i]);
+    }
+
+    for (auto [client_entity, client, aabboi] : client_view.each()) {
         calculate_client_playout_delay(registry, client_entity, client, aabboi);
     }
 }
@@ -563,9 +658,29 @@ void update_server_snapshot_exporter(entt::registry &registry, double time) {
     ctx.snapshot_exporter->update(time);
 }
 
+static void update_lag_compensation_history(entt::registry &registry) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    auto &history = registry.ctx().at<server_network_context>().lag_compensation;
+
+    if (!(server_settings.lag_compensation_duration > 0)) {
+        if (!history.empty()) {
+            history = {};
+        }
+
+        return;
+    }
+
+    auto timestamp = get_simulation_timestamp(registry);
+    history.set_chunk_size(server_settings.lag_compensation_chunk_size);
+    history.record_frame(registry, timestamp);
+    history.erase_until(timestamp - server_settings.lag_compensation_duration);
+}
+
 void update_network_server(entt::registry &registry) {
     auto &settings = registry.ctx().at<edyn::settings>();
     const auto time = (*settings.time_func)();
+    update_lag_compensation_history(registry);
     server_update_clock_sync(registry, time);
     server_process_timed_packets(registry, time);
     update_server_snapshot_exporter(registry, time);
@@ -13,6 +13,9 @@
 #include "edyn/networking/comp/aabb_oi_follow.hpp"
 #include "edyn/networking/comp/entity_owner.hpp"
 #include "edyn/collision/query_aabb.hpp"
+#include "edyn/networking/settings/server_network_settings.hpp"
+#include "edyn/networking/util/interest_grid.hpp"
+#include "edyn/parallel/parallel_for.hpp"
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/registry.hpp>
 #include <entt/signal/delegate.hpp>
@@ -31,52 +34,109 @@ void follow_aabb_of_interest(entt::registry &registry) {
     });
 }
 
-void update_aabbs_of_interest_seq(entt::registry &registry) {
+static uint64_t hash_entity(entt::entity entity) {
+    // SplitMix64 finalizer.
+    auto x = static_cast<uint64_t>(entt::to_integral(entity)) + 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static void update_interest_grid(entt::registry &registry, interest_grid &grid) {
     auto networked_view = registry.view<networked_tag>();
-    auto &bphase = registry.ctx().at<broadphase>();
+    grid.begin_update();
+
+    // Islands are inserted as a whole, containing all networked nodes and
+    // edges. The hash is independent of order thus it only changes if the
+    // island's contents change.
+    for (auto [island_entity, island, aabb] : registry.view<edyn::island, island_AABB>().each()) {
+        auto entities = std::vector<entt::entity>{};
+        auto hash = uint64_t{0};
+
+        auto insert = [&](entt::entity entity) {
+            if (networked_view.contains(entity)) {
+                entities.push_back(entity);
+                hash += hash_entity(entity);
+            }
+        };
 
-    registry.view<aabb_of_interest>().each([&](aabb_of_interest &aabboi) {
-        entt::sparse_set contained_entities;
+        for (auto entity : island.nodes) {
+            insert(entity);
+        }
 
-        // Collect entities of islands which intersect the AABB of interest.
-        bphase.query_islands(aabboi.aabb, [&](entt::entity island_entity) {
-            auto &island = registry.get<edyn::island>(island_entity);
+        for (auto entity : island.edges) {
+            insert(entity);
+        }
 
-            for (auto entity : island.nodes) {
-                if (networked_view.contains(entity) && !contained_entities.contains(entity)) {
-                    contained_entities.emplace(entity);
-                }
-            }
+        if (!entities.empty()) {
+            grid.update_item(island_entity, aabb, std::move(entities), hash);
+        }
+    }
 
-            for (auto entity : island.edges) {
-                if (networked_view.contains(entity) && !contained_entities.contains(entity)) {
-                    contained_entities.emplace(entity);
-                }
-            }
-        });
+    for (auto [entity, aabb] : registry.view<networked_tag, AABB>(entt::exclude<procedural_tag>).each()) {
+        grid.update_item(entity, aabb, {entity}, 0);
+    }
 
-        bphase.query_non_procedural(aabboi.aabb, [&](entt::entity np_entity) {
-            if (networked_view.contains(np_entity) && !contained_entities.contains(np_entity)) {
-                contained_entities.emplace(np_entity);
-            }
-        });
+    grid.end_update();
+}
 
-        // Calculate which entities have entered and exited the AABB of interest.
-        for (auto entity : aabboi.entities) {
-            if (!contained_entities.contains(entity)) {
-                aabboi.entities_exited.push_back(entity);
-            }
+static void update_aabb_of_interest(const interest_grid &grid, aabb_of_interest &aabboi) {
+    // Entities can only enter or exit if the AABB of interest moved or if
+    // items in the cells it overlaps changed.
+    if (aabboi.aabb.min == aabboi.query_aabb.min &&
+        aabboi.aabb.max == aabboi.query_aabb.max &&
+        !grid.is_dirty(aabboi.aabb)) {
+        return;
+    }
+
+    aabboi.query_aabb = aabboi.aabb;
+
+    entt::sparse_set contained_entities;
+
+    grid.each_entity(aabboi.aabb, [&](entt::entity entity) {
+        if (!contained_entities.contains(entity)) {
+            contained_entities.emplace(entity);
         }
+    });
 
-        for (auto entity : contained_entities) {
-            if (!aabboi.entities.contains(entity)) {
-                aabboi.entities_entered.push_back(entity);
-            }
+    // Calculate which entities have entered and exited the AABB of interest.
+    for (auto entity : aabboi.entities) {
+        if (!contained_entities.contains(entity)) {
+            aabboi.entities_exited.push_back(entity);
+        }
+    }
+
+    for (auto entity : contained_entities) {
+        if (!aabboi.entities.contains(entity)) {
+            aabboi.entities_entered.push_back(entity);
         }
+    }
+
+    aabboi.entities = std::move(contained_entities);
+}
+
+void update_aabbs_of_interest_seq(entt::registry &registry) {
+    if (!registry.ctx().contains<interest_grid>()) {
+        auto &settings = registry.ctx().at<edyn::settings>();
+        auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+        registry.ctx().emplace<interest_grid>(server_settings.interest_cell_size);
+    }
+
+    auto &grid = registry.ctx().at<interest_grid>();
+    update_interest_grid(registry, grid);
+
+    // Clients only read from the grid and write to their own AABB of interest
+    // thus they can be updated in parallel.
+    auto aabboi_view = registry.view<aabb_of_interest>();
+    auto clients = std::vector<entt::entity>(aabboi_view.begin(), aabboi_view.end());
+
+    if (clients.empty()) {
+        return;
+    }
 
-        // Assign the current set of entities which are in an island that
-        // intersects the AABB of interest.
-        aabboi.entities = std::move(contained_entities);
+    parallel_for(size_t{}, clients.size(), [&](size_t index) {
+        auto [aabboi] = aabboi_view.get(clients[index]);
+        update_aabb_of_interest(grid, aabboi);
     });
 }
 
@@ -0,0 +1,254 @@
+#include "edyn/networking/util/interest_grid.hpp"
+#include "edyn/config/config.h"
+#include "edyn/util/vector_util.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace edyn {
+
+interest_grid::interest_grid(scalar cell_size)
+    : m_cell_size(cell_size)
+{
+    EDYN_ASSERT(cell_size > 0);
+}
+
+static int32_t to_cell_coordinate(scalar value, scalar cell_size) {
+    auto coord = std::floor(value / cell_size);
+    auto limit = static_cast<scalar>(interest_grid::max_cell_coordinate);
+    return static_cast<int32_t>(std::clamp(coord, -limit, limit));
+}
+
+interest_cell_range interest_grid::get_cell_range(const AABB &aabb) const {
+    auto range = interest_cell_range{};
+
+    for (int i = 0; i < 3; ++i) {
+        range.min[i] = to_cell_coordinate(aabb.min[i], m_cell_size);
+        range.max[i] = to_cell_coordinate(aabb.max[i], m_cell_size);
+    }
+
+    return range;
+}
+
+interest_grid::cell_key_type interest_grid::make_key(int32_t x, int32_t y, int32_t z) {
+    // Pack biased coordinates into 21 bits each.
+    auto bias = static_cast<int64_t>(max_cell_coordinate);
+    auto ux = static_cast<cell_key_type>(x + bias);
+    auto uy = static_cast<cell_key_type>(y + bias);
+    auto uz = static_cast<cell_key_type>(z + bias);
+    return ux | (uy << 21) | (uz << 42);
+}
+
+std::array<int32_t, 3> interest_grid::key_to_cell(cell_key_type key) {
+    constexpr auto mask = (cell_key_type{1} << 21) - 1;
+    auto bias = static_cast<int64_t>(max_cell_coordinate);
+    return {
+        static_cast<int32_t>(static_cast<int64_t>(key & mask) - bias),
+        static_cast<int32_t>(static_cast<int64_t>((key >> 21) & mask) - bias),
+        static_cast<int32_t>(static_cast<int64_t>((key >> 42) & mask) - bias)
+    };
+}
+
+void interest_grid::insert_into_cells(entt::entity item, const interest_cell_range &range) {
+    for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+        for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+            for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                auto key = make_key(x, y, z);
+                m_cells[key].push_back(item);
+                m_dirty_cells.insert(key);
+            }
+        }
+    }
+}
+
+void interest_grid::remove_from_cells(entt::entity item, const interest_cell_range &range) {
+    for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+        for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+            for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                auto key = make_key(x, y, z);
+                auto it = m_cells.find(key);
+                EDYN_ASSERT(it != m_cells.end());
+                vector_erase(it->second, item);
+
+                if (it->second.empty()) {
+                    m_cells.erase(it);
+                }
+
+                m_dirty_cells.insert(key);
+            }
+        }
+    }
+}
+
+void interest_grid::mark_dirty(const interest_cell_range &range) {
+    for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+        for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+            for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                m_dirty_cells.insert(make_key(x, y, z));
+            }
+        }
+    }
+}
+
+void interest_grid::mark_moved(const interest_cell_range &range) {
+    for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+        for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+            for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                m_moved_cells.insert(make_key(x, y, z));
+            }
+        }
+    }
+}
+
+void interest_grid::begin_update() {
+    m_dirty_cells.clear();
+    m_moved_cells.clear();
+    m_large_items_dirty = false;
+    ++m_generation;
+}
+
+void interest_grid::update_item(entt::entity item, const AABB &aabb,
+                                std::vector<entt::entity> &&entities, uint64_t content_hash) {
+    auto range = get_cell_range(aabb);
+    auto large = range.volume() > max_item_cells;
+    auto it = m_items.find(item);
+
+    if (it == m_items.end()) {
+        if (large) {
+            m_large_items.push_back(item);
+            m_large_items_dirty = true;
+        } else {
+            insert_into_cells(item, range);
+        }
+
+        m_items.emplace(item, item_info{aabb, range, std::move(entities), content_hash, m_generation, large});
+        return;
+    }
+
+    auto &info = it->second;
+    auto moved = info.aabb.min != aabb.min || info.aabb.max != aabb.max;
+    info.aabb = aabb;
+    info.generation = m_generation;
+    info.entities = std::move(entities);
+
+    if (info.range != range || info.large != large) {
+        if (info.large) {
+            vector_erase(m_large_items, item);
+            m_large_items_dirty = true;
+        } else {
+            remove_from_cells(item, info.range);
+        }
+
+        if (large) {
+            m_large_items.push_back(item);
+            m_large_items_dirty = true;
+        } else {
+            insert_into_cells(item, range);
+        }
+
+        info.range = range;
+        info.large = large;
+    } else if (info.content_hash != content_hash) {
+        if (large) {
+            m_large_items_dirty = true;
+        } else {
+            mark_dirty(range);
+        }
+    } else if (moved) {
+        // It might have entered or exited AABBs of interest which partially
+        // overlap its cells.
+        if (large) {
+            m_large_items_dirty = true;
+        } else {
+            mark_moved(range);
+        }
+    }
+
+    info.content_hash = content_hash;
+}
+
+void interest_grid::end_update() {
+    for (auto it = m_items.begin(); it != m_items.end();) {
+        auto &[item, info] = *it;
+
+        if (info.generation == m_generation) {
+            ++it;
+            continue;
+        }
+
+        if (info.large) {
+            vector_erase(m_large_items, item);
+            m_large_items_dirty = true;
+        } else {
+            remove_from_cells(item, info.range);
+        }
+
+        it = m_items.erase(it);
+    }
+}
+
+bool interest_grid::is_dirty(const interest_cell_range &range) const {
+    if (m_large_items_dirty) {
+        return true;
+    }
+
+    if (range.volume() <= m_dirty_cells.size()) {
+        for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+            for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+                for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                    if (m_dirty_cells.count(make_key(x, y, z))) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    return std::any_of(m_dirty_cells.begin(), m_dirty_cells.end(), [&](auto key) {
+        return range.contains(key_to_cell(key));
+    });
+}
+
+bool interest_grid::cell_inside(const std::array<int32_t, 3> &cell, const AABB &aabb) const {
+    for (int i = 0; i < 3; ++i) {
+        if (cell[i] * m_cell_size < aabb.min[i] || (cell[i] + 1) * m_cell_size > aabb.max[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool interest_grid::is_dirty(const AABB &aabb) const {
+    auto range = get_cell_range(aabb);
+
+    if (is_dirty(range)) {
+        return true;
+    }
+
+    // Items in cells entirely inside the AABB intersect it wherever they move.
+    auto moved = [&](const std::array<int32_t, 3> &cell) {
+        return range.contains(cell) && !cell_inside(cell, aabb);
+    };
+
+    if (range.volume() <= m_moved_cells.size()) {
+        for (auto x = range.min[0]; x <= range.max[0]; ++x) {
+            for (auto y = range.min[1]; y <= range.max[1]; ++y) {
+                for (auto z = range.min[2]; z <= range.max[2]; ++z) {
+                    if (m_moved_cells.count(make_key(x, y, z)) && moved({x, y, z})) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    return std::any_of(m_moved_cells.begin(), m_moved_cells.end(), [&](auto key) {
+        return moved(key_to_cell(key));
+    });
+}
+
+}
@@ -0,0 +1,265 @@
+#include "edyn/networking/util/lag_compensation_history.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/shape_index.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/config/config.h"
+#include "edyn/math/geom.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/util/vector_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+namespace edyn {
+
+static const lag_compensation_history::record *
+find_record(const std::vector<lag_compensation_history::record> &records, entt::entity entity) {
+    auto it = std::lower_bound(records.begin(), records.end(), entity, [](auto &&rec, entt::entity e) {
+        return entt::to_integral(rec.entity) < entt::to_integral(e);
+    });
+
+    if (it == records.end() || it->entity != entity) {
+        return nullptr;
+    }
+
+    return &*it;
+}
+
+void lag_compensation_history::record_frame(entt::registry &registry, double timestamp) {
+    if (!m_frames.empty() && !(timestamp > m_frames.back().timestamp)) {
+        return;
+    }
+
+    auto &fr = m_frames.emplace_back();
+    fr.timestamp = timestamp;
+
+    auto view = registry.view<networked_tag, procedural_tag, position, orientation, AABB>();
+    auto origin_view = registry.view<origin>();
+
+    for (auto entity : view) {
+        auto [pos, orn, aabb] = view.get<position, orientation, AABB>(entity);
+        auto shape_pos = origin_view.contains(entity) ?
+            static_cast<vector3>(origin_view.get<origin>(entity)) :
+            static_cast<vector3>(pos);
+        fr.records.push_back({entity, shape_pos, orn, aabb});
+    }
+
+    std::sort(fr.records.begin(), fr.records.end(), [](auto &&lhs, auto &&rhs) {
+        return entt::to_integral(lhs.entity) < entt::to_integral(rhs.entity);
+    });
+
+    // Build a chunk once the frame that follows it is available, so that
+    // queries between its last frame and the next are covered by its tree.
+    auto next_chunk_first = m_chunks.empty() ? m_frame_offset : m_chunks.back().first_frame + m_chunk_size;
+
+    if (m_frame_offset + m_frames.size() > next_chunk_first + m_chunk_size) {
+        build_chunk(next_chunk_first);
+    }
+}
+
+void lag_compensation_history::build_chunk(uint64_t first_frame) {
+    auto &ch = m_chunks.emplace_back();
+    ch.first_frame = first_frame;
+
+    auto entity_index = std::unordered_map<entt::entity, size_t>{};
+    auto aabbs = std::vector<AABB>{};
+
+    for (auto index = first_frame; index <= first_frame + m_chunk_size; ++index) {
+        for (auto &rec : get_frame(index).records) {
+            auto [it, inserted] = entity_index.emplace(rec.entity, ch.entities.size());
+
+            if (inserted) {
+                ch.entities.push_back(rec.entity);
+                aabbs.push_back(rec.aabb);
+            } else {
+                aabbs[it->second] = enclosing_aabb(aabbs[it->second], rec.aabb);
+            }
+        }
+    }
+
+    if (aabbs.empty()) {
+        return;
+    }
+
+    auto report_leaf = [](static_tree::tree_node &node, auto ids_begin, auto ids_end) {
+        node.id = *ids_begin;
+    };
+    ch.tree.build(aabbs.begin(), aabbs.end(), report_leaf);
+}
+
+void lag_compensation_history::erase_until(double timestamp) {
+    // Only erase chunks whose frames, including the first frame of the next
+    // chunk, are all older than the given time.
+    while (!m_chunks.empty()) {
+        auto last_frame = m_chunks.front().first_frame + m_chunk_size;
+
+        if (get_frame(last_frame).timestamp > timestamp) {
+            break;
+        }
+
+        m_chunks.pop_front();
+
+        auto first_kept = m_chunks.empty() ? last_frame : m_chunks.front().first_frame;
+        m_frames.erase(m_frames.begin(), m_frames.begin() + (first_kept - m_frame_offset));
+        m_frame_offset = first_kept;
+    }
+}
+
+void lag_compensation_history::set_chunk_size(unsigned chunk_size) {
+    EDYN_ASSERT(chunk_size > 0);
+
+    if (chunk_size == m_chunk_size) {
+        return;
+    }
+
+    // Existing chunks cannot be rebuilt with a different size.
+    m_frame_offset += m_frames.size();
+    m_frames.clear();
+    m_chunks.clear();
+    m_chunk_size = chunk_size;
+}
+
+double lag_compensation_history::oldest_timestamp() const {
+    EDYN_ASSERT(!m_frames.empty());
+    return m_frames.front().timestamp;
+}
+
+double lag_compensation_history::newest_timestamp() const {
+    EDYN_ASSERT(!m_frames.empty());
+    return m_frames.back().timestamp;
+}
+
+const lag_compensation_history::frame & lag_compensation_history::get_frame(uint64_t index) const {
+    EDYN_ASSERT(index >= m_frame_offset && index - m_frame_offset < m_frames.size());
+    return m_frames[index - m_frame_offset];
+}
+
+uint64_t lag_compensation_history::find_frame(double time) const {
+    EDYN_ASSERT(!m_frames.empty());
+    auto it = std::upper_bound(m_frames.begin(), m_frames.end(), time, [](double t, auto &&fr) {
+        return t < fr.timestamp;
+    });
+
+    auto index = it == m_frames.begin() ? 0 : std::distance(m_frames.begin(), it) - 1;
+    return m_frame_offset + index;
+}
+
+template<typename TreeFunc, typename VisitFunc>
+void lag_compensation_history::visit_candidates(double time, TreeFunc tree_func, VisitFunc visit_func) const {
+    if (m_frames.empty()) {
+        return;
+    }
+
+    auto frame_index = find_frame(time);
+    auto &frame0 = get_frame(frame_index);
+    auto *frame1 = frame_index + 1 < m_frame_offset + m_frames.size() ? &get_frame(frame_index + 1) : nullptr;
+    auto fraction = scalar(0);
+
+    if (frame1 != nullptr) {
+        fraction = std::clamp(scalar((time - frame0.timestamp) / (frame1->timestamp - frame0.timestamp)),
+                              scalar(0), scalar(1));
+    }
+
+    auto visit_interpolated = [&](const record &rec0) {
+        auto *rec1 = frame1 != nullptr ? find_record(frame1->records, rec0.entity) : nullptr;
+
+        if (rec1 == nullptr) {
+            visit_func(rec0);
+            return;
+        }
+
+        auto rec = record{};
+        rec.entity = rec0.entity;
+        rec.pos = lerp(rec0.pos, rec1->pos, fraction);
+        rec.orn = slerp(rec0.orn, rec1->orn, fraction);
+        rec.aabb.min = lerp(rec0.aabb.min, rec1->aabb.min, fraction);
+        rec.aabb.max = lerp(rec0.aabb.max, rec1->aabb.max, fraction);
+        visit_func(rec);
+    };
+
+    // Use the tree of the chunk containing this frame if it has been built.
+    // Otherwise, scan all bodies in the frame.
+    if (!m_chunks.empty() && frame_index < m_chunks.back().first_frame + m_chunk_size) {
+        auto &ch = m_chunks[(frame_index - m_chunks.front().first_frame) / m_chunk_size];
+
+        if (ch.tree.empty()) {
+            return;
+        }
+
+        tree_func(ch.tree, [&](uint32_t node_id) {
+            auto entity = ch.entities[ch.tree.get_node(node_id).id];
+
+            if (auto *rec0 = find_record(frame0.records, entity)) {
+                visit_interpolated(*rec0);
+            }
+        });
+    } else {
+        for (auto &rec0 : frame0.records) {
+            visit_interpolated(rec0);
+        }
+    }
+}
+
+raycast_result lag_compensation_history::raycast(entt::registry &registry, double time,
+                                                 vector3 p0, vector3 p1,
+                                                 const std::vector<entt::entity> &ignore_entities) const {
+    auto index_view = registry.view<shape_index>();
+    auto shape_views_tuple = get_tuple_of_shape_views(registry);
+
+    entt::entity hit_entity {entt::null};
+    shape_raycast_result result;
+
+    auto tree_func = [&](const static_tree &tree, auto func) {
+        tree.raycast(p0, p1, func);
+    };
+
+    visit_candidates(time, tree_func, [&](const record &rec) {
+        // Bodies could have been destroyed since.
+        if (!index_view.contains(rec.entity) || vector_contains(ignore_entities, rec.entity)) {
+            return;
+        }
+
+        if (!intersect_segment_aabb(p0, p1, rec.aabb.min, rec.aabb.max)) {
+            return;
+        }
+
+        auto sh_idx = index_view.get<shape_index>(rec.entity);
+        auto ctx = raycast_context{rec.pos, rec.orn, p0, p1};
+
+        visit_shape(sh_idx, rec.entity, shape_views_tuple, [&](auto &&shape) {
+            auto res = shape_raycast(shape, ctx);
+
+            if (res.fraction < result.fraction) {
+                result = res;
+                hit_entity = rec.entity;
+            }
+        });
+    });
+
+    return {result, hit_entity};
+}
+
+std::vector<entt::entity> lag_compensation_history::query_aabb(entt::registry &registry, double time,
+                                                               const AABB &aabb) const {
+    auto index_view = registry.view<shape_index>();
+    auto result = std::vector<entt::entity>{};
+
+    auto tree_func = [&](const static_tree &tree, auto func) {
+        tree.query(aabb, func);
+    };
+
+    visit_candidates(time, tree_func, [&](const record &rec) {
+        // Bodies could have been destroyed since.
+        if (index_view.contains(rec.entity) && intersect(rec.aabb, aabb)) {
+            result.push_back(rec.entity);
+        }
+    });
+
+    return result;
+}
+
+}
@@ -0,0 +1,159 @@
+#include "edyn/networking/util/packet_fragmentation.hpp"
+#include "edyn/networking/packet/edyn_packet.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace edyn {
+
+size_t serialized_packet_size(const packet::edyn_packet &packet) {
+    auto buffer = memory_output_archive::buffer_type{};
+    auto archive = memory_output_archive(buffer);
+    archive(packet);
+    return buffer.size();
+}
+
+template<typename T>
+static size_t serialized_size(const T &value) {
+    auto buffer = memory_output_archive::buffer_type{};
+    auto archive = memory_output_archive(buffer);
+    archive(value);
+    return buffer.size();
+}
+
+static void split_registry_snapshot(const packet::registry_snapshot &snapshot,
+                                    size_t size, size_t max_size,
+                                    std::vector<packet::registry_snapshot> &result) {
+    auto num_entities = snapshot.entities.size();
+
+    if (size <= max_size || num_entities < 2) {
+        result.push_back(snapshot);
+        return;
+    }
+
+    // Assume entities take roughly the same space and split further the
+    // parts which are still too large.
+    auto num_parts = std::min((size + max_size - 1) / max_size, num_entities);
+
+    for (size_t i = 0; i < num_parts; ++i) {
+        auto first = num_entities * i / num_parts;
+        auto last = num_entities * (i + 1) / num_parts;
+        auto indices = std::vector<size_t>(last - first);
+        std::iota(indices.begin(), indices.end(), first);
+        auto part = internal::snapshot_subset(snapshot, indices);
+        auto part_size = serialized_packet_size(packet::edyn_packet{part});
+        split_registry_snapshot(part, part_size, max_size, result);
+    }
+}
+
+std::vector<packet::registry_snapshot>
+split_registry_snapshot(const packet::registry_snapshot &snapshot, size_t max_size) {
+    auto result = std::vector<packet::registry_snapshot>{};
+    auto size = serialized_packet_size(packet::edyn_packet{snapshot});
+    split_registry_snapshot(snapshot, size, max_size, result);
+    return result;
+}
+
+std::vector<packet::entity_entered>
+split_entity_entered(packet::entity_entered &&packet, size_t max_size) {
+    const auto empty_size = serialized_packet_size(packet::edyn_packet{packet::entity_entered{}});
+    auto result = std::vector<packet::entity_entered>{};
+    auto size = empty_size;
+
+    for (auto &info : packet.entry) {
+        auto info_size = serialized_size(info);
+
+        if (result.empty() || (size + info_size > max_size && !result.back().entry.empty())) {
+            result.emplace_back();
+            size = empty_size;
+        }
+
+        result.back().entry.push_back(std::move(info));
+        size += info_size;
+    }
+
+    return result;
+}
+
+std::vector<packet::packet_fragment>
+fragment_packet(const packet::edyn_packet &packet, uint16_t message_id, size_t max_size) {
+    EDYN_ASSERT(max_size > 0);
+
+    auto buffer = memory_output_archive::buffer_type{};
+    auto archive = memory_output_archive(buffer);
+    archive(packet);
+
+    auto count = (buffer.size() + max_size - 1) / max_size;
+    EDYN_ASSERT(count <= std::numeric_limits<uint16_t>::max());
+
+    auto result = std::vector<packet::packet_fragment>(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto first = buffer.begin() + i * max_size;
+        auto last = buffer.begin() + std::min((i + 1) * max_size, buffer.size());
+
+        auto &fragment = result[i];
+        fragment.message_id = message_id;
+        fragment.index = static_cast<uint16_t>(i);
+        fragment.count = static_cast<uint16_t>(count);
+        fragment.data.assign(first, last);
+    }
+
+    return result;
+}
+
+bool fragment_assembler::insert(const packet::packet_fragment &fragment, packet::edyn_packet &packet) {
+    if (fragment.index >= fragment.count || fragment.data.empty()) {
+        return false;
+    }
+
+    auto &pending = m_pending[fragment.message_id];
+
+    // A mismatching count means the identifier is being reused for another
+    // packet, in which case the previous one is abandoned.
+    if (pending.fragments.size() != fragment.count) {
+        pending.fragments.clear();
+        pending.fragments.resize(fragment.count);
+        pending.num_received = 0;
+    }
+
+    pending.age = m_counter++;
+
+    auto &data = pending.fragments[fragment.index];
+
+    if (!data.empty()) {
+        return false;
+    }
+
+    data = fragment.data;
+    ++pending.num_received;
+
+    if (pending.num_received < pending.fragments.size()) {
+        if (m_pending.size() > max_pending) {
+            auto oldest = std::min_element(m_pending.begin(), m_pending.end(),
+                                           [](auto &&lhs, auto &&rhs) {
+                                               return lhs.second.age < rhs.second.age;
+                                           });
+            m_pending.erase(oldest);
+        }
+
+        return false;
+    }
+
+    auto buffer = std::vector<uint8_t>{};
+
+    for (auto &part : pending.fragments) {
+        buffer.insert(buffer.end(), part.begin(), part.end());
+    }
+
+    m_pending.erase(fragment.message_id);
+
+    auto archive = memory_input_archive(buffer.data(), buffer.size());
+    archive(packet);
+
+    return !archive.failed();
+}
+
+}
@@ -0,0 +1,198 @@
+#include "edyn/networking/util/prioritize_snapshot.hpp"
+#include "edyn/networking/comp/remote_client.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/aabb_oi_follow.hpp"
+#include "edyn/networking/comp/entity_owner.hpp"
+#include "edyn/networking/util/server_snapshot_exporter.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/tag.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+
+namespace edyn {
+
+static size_t serialized_snapshot_size(const packet::registry_snapshot &snapshot) {
+    auto buffer = memory_output_archive::buffer_type{};
+    auto archive = memory_output_archive(buffer);
+    archive(snapshot);
+    return buffer.size();
+}
+
+// Indices of the components of each entity in the snapshot.
+static std::vector<std::vector<component_index_type>>
+snapshot_entity_components(const packet::registry_snapshot &snapshot) {
+    auto components = std::vector<std::vector<component_index_type>>(snapshot.entities.size());
+
+    for (auto &pool : snapshot.pools) {
+        for (auto idx : pool.ptr->entity_indices) {
+            components[idx].push_back(pool.component_index);
+        }
+    }
+
+    return components;
+}
+
+void insert_pending_snapshot_components(const entt::registry &registry,
+                                        const server_snapshot_exporter &exporter,
+                                        remote_client &client,
+                                        const entt::sparse_set &entities_of_interest,
+                                        packet::registry_snapshot &snapshot) {
+    auto &pending = client.snapshot_pending_components;
+
+    if (pending.empty()) {
+        return;
+    }
+
+    auto components = snapshot_entity_components(snapshot);
+    auto entity_index = std::unordered_map<entt::entity, size_t>{};
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i) {
+        entity_index.emplace(snapshot.entities[i], i);
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        auto entity = it->first;
+
+        if (!registry.valid(entity) || !entities_of_interest.contains(entity)) {
+            it = pending.erase(it);
+            continue;
+        }
+
+        // Skip components which were modified again and are already present.
+        auto indices = it->second;
+
+        if (auto found = entity_index.find(entity); found != entity_index.end()) {
+            auto &present = components[found->second];
+            indices.erase(std::remove_if(indices.begin(), indices.end(), [&](auto index) {
+                return std::find(present.begin(), present.end(), index) != present.end();
+            }), indices.end());
+        }
+
+        if (!indices.empty()) {
+            exporter.export_comp_index(snapshot, entity, indices);
+        }
+
+        ++it;
+    }
+}
+
+void prioritize_snapshot(const entt::registry &registry, entt::entity client_entity,
+                         remote_client &client, packet::registry_snapshot &snapshot,
+                         const snapshot_priority &priority) {
+    if (priority.byte_budget == 0 || snapshot.entities.empty()) {
+        return;
+    }
+
+    auto position_view = registry.view<position>();
+    auto linvel_view = registry.view<linvel>();
+    auto owner_view = registry.view<entity_owner>();
+    auto sleeping_view = registry.view<sleeping_tag>();
+    auto follow_view = registry.view<aabb_oi_follow>();
+
+    auto origin = registry.get<aabb_of_interest>(client_entity).aabb.center();
+
+    if (follow_view.contains(client_entity)) {
+        auto [follow] = follow_view.get(client_entity);
+
+        if (position_view.contains(follow.entity)) {
+            origin = std::get<0>(position_view.get(follow.entity));
+        }
+    }
+
+    // Accumulate priority of all entities in the snapshot. Entities which are
+    // not in it have not been modified and do not need to be kept.
+    auto accumulator = std::unordered_map<entt::entity, scalar>{};
+    auto order = std::vector<std::pair<scalar, size_t>>{};
+    order.reserve(snapshot.entities.size());
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i) {
+        auto entity = snapshot.entities[i];
+        auto value = scalar(1);
+
+        if (position_view.contains(entity)) {
+            auto [pos] = position_view.get(entity);
+            value /= 1 + distance(pos, origin) / priority.half_priority_distance;
+        }
+
+        if (linvel_view.contains(entity)) {
+            auto [vel] = linvel_view.get(entity);
+            value *= 1 + length(vel) * priority.velocity_factor;
+        }
+
+        if (owner_view.contains(entity) &&
+            std::get<0>(owner_view.get(entity)).client_entity != entt::null) {
+            value *= priority.owned_factor;
+        }
+
+        if (sleeping_view.contains(entity)) {
+            value *= priority.sleeping_factor;
+        }
+
+        if (auto it = client.snapshot_priority_accumulator.find(entity);
+            it != client.snapshot_priority_accumulator.end()) {
+            value += it->second;
+        }
+
+        accumulator[entity] = value;
+        order.emplace_back(value, i);
+    }
+
+    auto size = serialized_snapshot_size(snapshot);
+
+    if (size <= priority.byte_budget) {
+        client.snapshot_priority_accumulator.clear();
+        client.snapshot_pending_components.clear();
+        return;
+    }
+
+    std::sort(order.begin(), order.end(), [](auto &&lhs, auto &&rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    // Assume entities take roughly the same space and take fewer entities
+    // until the snapshot fits into the budget.
+    auto count = std::max(order.size() * priority.byte_budget / size, size_t{1});
+    auto indices = std::vector<size_t>{};
+    auto subset = packet::registry_snapshot{};
+
+    while (true) {
+        indices.clear();
+
+        for (size_t i = 0; i < count; ++i) {
+            indices.push_back(order[i].second);
+        }
+
+        // Keep the original order of entities.
+        std::sort(indices.begin(), indices.end());
+        subset = internal::snapshot_subset(snapshot, indices);
+        size = serialized_snapshot_size(subset);
+
+        if (size <= priority.byte_budget || count == 1) {
+            break;
+        }
+
+        count = std::max(count * priority.byte_budget / size, size_t{1});
+    }
+
+    // Components of entities left out remain pending until they're sent. The
+    // snapshot already contains the pending components from previous ones.
+    auto components = snapshot_entity_components(snapshot);
+    auto &pending = client.snapshot_pending_components;
+    pending.clear();
+
+    for (size_t i = 0, j = 0; i < snapshot.entities.size(); ++i) {
+        if (j < indices.size() && indices[j] == i) {
+            ++j;
+            accumulator.erase(snapshot.entities[i]);
+        } else {
+            pending.emplace(snapshot.entities[i], std::move(components[i]));
+        }
+    }
+
+    client.snapshot_priority_accumulator = std::move(accumulator);
+    snapshot = std::move(subset);
+}
+
+}
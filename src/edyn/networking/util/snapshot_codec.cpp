@@ -0,0 +1,474 @@
+#include "edyn/networking/util/snapshot_codec.hpp"
+#include "edyn/networking/util/pool_snapshot.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/serialization/bit_archive.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/math/constants.hpp"
+#include "edyn/math/quaternion.hpp"
+#include <entt/core/type_info.hpp>
+#include <entt/entity/entity.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace edyn {
+
+enum class quantized_kind {
+    none,
+    position,
+    orientation,
+    linvel,
+    angvel
+};
+
+using quantized_value = snapshot_baseline::value_type;
+
+static quantized_kind get_quantized_kind(const pool_snapshot_data &pool) {
+    auto id = pool.get_type_id();
+
+    if (id == entt::type_index<position>::value()) {
+        return quantized_kind::position;
+    } else if (id == entt::type_index<orientation>::value()) {
+        return quantized_kind::orientation;
+    } else if (id == entt::type_index<linvel>::value()) {
+        return quantized_kind::linvel;
+    } else if (id == entt::type_index<angvel>::value()) {
+        return quantized_kind::angvel;
+    }
+
+    return quantized_kind::none;
+}
+
+static unsigned bit_width(uint64_t value) {
+    unsigned width = 0;
+
+    while (value != 0) {
+        ++width;
+        value >>= 1;
+    }
+
+    return width;
+}
+
+// Unsigned integers are written as their bit width in 6 bits followed by
+// their significant bits. Signed integers are zigzag-encoded first so values
+// of small magnitude take few bits regardless of sign.
+static void write_varint(bit_output_archive &archive, uint64_t value) {
+    auto width = bit_width(value);
+    EDYN_ASSERT(width < 64);
+    archive.write_bits(width, 6);
+    archive.write_bits(value, width);
+}
+
+static uint64_t read_varint(bit_input_archive &archive) {
+    auto width = static_cast<unsigned>(archive.read_bits(6));
+    return archive.read_bits(width);
+}
+
+static void write_signed(bit_output_archive &archive, int64_t value) {
+    write_varint(archive, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static int64_t read_signed(bit_input_archive &archive) {
+    auto value = read_varint(archive);
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static int64_t quantize(scalar value, scalar precision) {
+    return static_cast<int64_t>(std::llround(value / precision));
+}
+
+static quantized_value quantize(const vector3 &v, scalar precision) {
+    return {quantize(v.x, precision), quantize(v.y, precision), quantize(v.z, precision), 0};
+}
+
+static vector3 dequantize(const quantized_value &value, scalar precision) {
+    return vector3{scalar(value[0]), scalar(value[1]), scalar(value[2])} * precision;
+}
+
+// Smallest-three encoding. The first element holds the index of the largest
+// component, which is omitted and recovered from the unit length constraint.
+// The quaternion is negated if necessary to make the largest component
+// positive, since both represent the same rotation.
+static quantized_value quantize(const quaternion &q, unsigned bits) {
+    auto components = std::array<scalar, 4>{q.x, q.y, q.z, q.w};
+    auto largest = size_t{0};
+
+    for (size_t i = 1; i < 4; ++i) {
+        if (std::abs(components[i]) > std::abs(components[largest])) {
+            largest = i;
+        }
+    }
+
+    auto sign = components[largest] < 0 ? scalar(-1) : scalar(1);
+    auto max_value = scalar((uint64_t(1) << bits) - 1);
+    auto value = quantized_value{};
+    value[0] = static_cast<int64_t>(largest);
+    auto k = size_t{1};
+
+    for (size_t i = 0; i < 4; ++i) {
+        if (i != largest) {
+            // The remaining components are in [-1/sqrt(2), 1/sqrt(2)].
+            auto normalized = std::clamp((components[i] * sign / half_sqrt2 + 1) / 2, scalar(0), scalar(1));
+            value[k++] = static_cast<int64_t>(std::llround(normalized * max_value));
+        }
+    }
+
+    return value;
+}
+
+static quaternion dequantize_orientation(const quantized_value &value, unsigned bits) {
+    auto largest = static_cast<size_t>(value[0]);
+    auto max_value = scalar((uint64_t(1) << bits) - 1);
+    auto components = std::array<scalar, 4>{};
+    auto sum_sqr = scalar(0);
+    auto k = size_t{1};
+
+    for (size_t i = 0; i < 4; ++i) {
+        if (i != largest) {
+            components[i] = (scalar(value[k++]) / max_value * 2 - 1) * half_sqrt2;
+            sum_sqr += components[i] * components[i];
+        }
+    }
+
+    components[largest] = std::sqrt(std::max(scalar(1) - sum_sqr, scalar(0)));
+
+    return normalize(quaternion{components[0], components[1], components[2], components[3]});
+}
+
+template<typename Component>
+static auto &get_components(pool_snapshot_data &pool) {
+    return static_cast<pool_snapshot_data_impl<Component> &>(pool).components;
+}
+
+static quantized_value quantize_element(pool_snapshot_data &pool, quantized_kind kind,
+                                 size_t index, const snapshot_quantization &quantization) {
+    switch (kind) {
+    case quantized_kind::position:
+        return quantize(get_components<position>(pool)[index], quantization.position_precision);
+    case quantized_kind::orientation:
+        return quantize(get_components<orientation>(pool)[index], quantization.orientation_bits);
+    case quantized_kind::linvel:
+        return quantize(get_components<linvel>(pool)[index], quantization.linvel_precision);
+    case quantized_kind::angvel:
+        return quantize(get_components<angvel>(pool)[index], quantization.angvel_precision);
+    case quantized_kind::none:
+        break;
+    }
+
+    EDYN_ASSERT(false);
+    return {};
+}
+
+static void insert_element(pool_snapshot_data &pool, quantized_kind kind,
+                    const quantized_value &value, const snapshot_quantization &quantization) {
+    switch (kind) {
+    case quantized_kind::position:
+        get_components<position>(pool).push_back({dequantize(value, quantization.position_precision)});
+        break;
+    case quantized_kind::orientation:
+        get_components<orientation>(pool).push_back({dequantize_orientation(value, quantization.orientation_bits)});
+        break;
+    case quantized_kind::linvel:
+        get_components<linvel>(pool).push_back({dequantize(value, quantization.linvel_precision)});
+        break;
+    case quantized_kind::angvel:
+        get_components<angvel>(pool).push_back({dequantize(value, quantization.angvel_precision)});
+        break;
+    case quantized_kind::none:
+        EDYN_ASSERT(false);
+        break;
+    }
+}
+
+static void write_element(bit_output_archive &archive, quantized_kind kind, const quantized_value &value,
+                   const quantized_value &base, const snapshot_quantization &quantization) {
+    if (kind == quantized_kind::orientation) {
+        archive.write_bits(static_cast<uint64_t>(value[0]), 2);
+
+        for (size_t i = 1; i < 4; ++i) {
+            archive.write_bits(static_cast<uint64_t>(value[i]), quantization.orientation_bits);
+        }
+    } else {
+        for (size_t i = 0; i < 3; ++i) {
+            write_signed(archive, value[i] - base[i]);
+        }
+    }
+}
+
+static quantized_value read_element(bit_input_archive &archive, quantized_kind kind,
+                             const quantized_value &base, const snapshot_quantization &quantization) {
+    auto value = quantized_value{};
+
+    if (kind == quantized_kind::orientation) {
+        value[0] = static_cast<int64_t>(archive.read_bits(2));
+
+        for (size_t i = 1; i < 4; ++i) {
+            value[i] = static_cast<int64_t>(archive.read_bits(quantization.orientation_bits));
+        }
+    } else {
+        for (size_t i = 0; i < 3; ++i) {
+            value[i] = base[i] + read_signed(archive);
+        }
+    }
+
+    return value;
+}
+
+// Distance between sequence numbers accounting for wrap-around.
+static int16_t sequence_difference(uint16_t a, uint16_t b) {
+    return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+}
+
+packet::compact_registry_snapshot snapshot_encoder::encode(const packet::registry_snapshot &snapshot,
+                                                           const vector3 &origin,
+                                                           const snapshot_quantization &quantization) {
+    auto compact = packet::compact_registry_snapshot{};
+    compact.timestamp = snapshot.timestamp;
+    compact.sequence = m_next_sequence++;
+
+    // Do not use baselines the client might have discarded already.
+    if (m_acked && sequence_difference(compact.sequence, m_acked->sequence) > max_baseline_age) {
+        m_acked.reset();
+    }
+
+    compact.baseline = m_acked ? m_acked->sequence : compact.sequence;
+
+    auto sent = snapshot_baseline{};
+    sent.sequence = compact.sequence;
+
+    auto archive = bit_output_archive(compact.data);
+    auto origin_value = quantize(origin, quantization.position_precision);
+
+    for (size_t i = 0; i < 3; ++i) {
+        write_signed(archive, origin_value[i]);
+    }
+
+    write_varint(archive, snapshot.entities.size());
+
+    for (auto entity : snapshot.entities) {
+        write_varint(archive, entt::to_integral(entity));
+    }
+
+    auto index_bits = bit_width(snapshot.entities.empty() ? 0 : snapshot.entities.size() - 1);
+    write_varint(archive, snapshot.pools.size());
+
+    for (auto &pool : snapshot.pools) {
+        write_varint(archive, pool.component_index);
+        auto kind = get_quantized_kind(*pool.ptr);
+
+        if (kind == quantized_kind::none) {
+            // Write other components at full precision.
+            auto bytes = std::vector<uint8_t>{};
+            auto output = memory_output_archive(bytes);
+            pool.ptr->write(output);
+            write_varint(archive, bytes.size());
+
+            for (auto byte : bytes) {
+                archive.write_bits(byte, 8);
+            }
+
+            continue;
+        }
+
+        auto &indices = pool.ptr->entity_indices;
+        write_varint(archive, indices.size());
+
+        for (auto index : indices) {
+            archive.write_bits(index, index_bits);
+        }
+
+        for (size_t i = 0; i < indices.size(); ++i) {
+            auto key = snapshot_baseline::key_type{snapshot.entities[indices[i]], pool.component_index};
+            auto value = quantize_element(*pool.ptr, kind, i, quantization);
+            sent.values[key] = value;
+
+            auto base = kind == quantized_kind::position ? origin_value : quantized_value{};
+
+            if (m_acked) {
+                if (auto it = m_acked->values.find(key); it != m_acked->values.end()) {
+                    auto changed = it->second != value;
+                    archive(changed);
+
+                    if (!changed) {
+                        continue;
+                    }
+
+                    base = it->second;
+                }
+            }
+
+            write_element(archive, kind, value, base, quantization);
+        }
+    }
+
+    m_sent.push_back(std::move(sent));
+
+    while (m_sent.size() > max_baseline_age) {
+        m_sent.pop_front();
+    }
+
+    return compact;
+}
+
+void snapshot_encoder::acknowledge(uint16_t sequence) {
+    auto it = std::find_if(m_sent.begin(), m_sent.end(), [sequence](auto &&sent) {
+        return sent.sequence == sequence;
+    });
+
+    if (it == m_sent.end()) {
+        return;
+    }
+
+    if (!m_acked || sequence_difference(sequence, m_acked->sequence) > 0) {
+        m_acked = std::move(*it);
+    }
+
+    // Older snapshots will not be needed anymore.
+    m_sent.erase(m_sent.begin(), std::next(it));
+}
+
+bool snapshot_decoder::decode(const packet::compact_registry_snapshot &compact,
+                              const snapshot_quantization &quantization,
+                              packet::registry_snapshot &snapshot) {
+    const snapshot_baseline *baseline = nullptr;
+
+    if (compact.baseline != compact.sequence) {
+        auto it = std::find_if(m_history.begin(), m_history.end(), [&](auto &&entry) {
+            return entry.sequence == compact.baseline;
+        });
+
+        if (it == m_history.end()) {
+            return false;
+        }
+
+        baseline = &*it;
+    }
+
+    auto received = snapshot_baseline{};
+    received.sequence = compact.sequence;
+
+    auto archive = bit_input_archive(compact.data.data(), compact.data.size());
+    // Each element takes at least one bit, thus counts larger than this
+    // indicate malformed data.
+    const auto max_count = compact.data.size() * 8;
+    auto origin_value = quantized_value{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        origin_value[i] = read_signed(archive);
+    }
+
+    auto num_entities = read_varint(archive);
+
+    if (num_entities > max_count) {
+        return false;
+    }
+
+    snapshot.timestamp = compact.timestamp;
+    snapshot.entities.resize(num_entities);
+
+    for (auto &entity : snapshot.entities) {
+        entity = static_cast<entt::entity>(read_varint(archive));
+    }
+
+    auto index_bits = bit_width(num_entities == 0 ? 0 : num_entities - 1);
+    auto num_pools = read_varint(archive);
+
+    if (num_pools > max_count) {
+        return false;
+    }
+
+    for (size_t p = 0; p < num_pools; ++p) {
+        auto component_index = static_cast<component_index_type>(read_varint(archive));
+        auto ptr = std::shared_ptr<pool_snapshot_data>((*g_make_pool_snapshot_data)(component_index));
+
+        if (!ptr) {
+            return false;
+        }
+
+        auto kind = get_quantized_kind(*ptr);
+
+        if (kind == quantized_kind::none) {
+            auto num_bytes = read_varint(archive);
+
+            if (num_bytes > max_count) {
+                return false;
+            }
+
+            auto bytes = std::vector<uint8_t>(num_bytes);
+
+            for (auto &byte : bytes) {
+                byte = static_cast<uint8_t>(archive.read_bits(8));
+            }
+
+            auto input = memory_input_archive(bytes.data(), bytes.size());
+            ptr->read(input);
+
+            if (input.failed()) {
+                return false;
+            }
+
+            snapshot.pools.push_back(pool_snapshot{component_index, std::move(ptr)});
+            continue;
+        }
+
+        auto num_elements = read_varint(archive);
+
+        if (num_elements > max_count) {
+            return false;
+        }
+
+        auto &indices = ptr->entity_indices;
+        indices.resize(num_elements);
+
+        for (auto &index : indices) {
+            auto value = archive.read_bits(index_bits);
+
+            if (value >= num_entities) {
+                return false;
+            }
+
+            index = static_cast<pool_snapshot_data::index_type>(value);
+        }
+
+        for (auto index : indices) {
+            auto key = snapshot_baseline::key_type{snapshot.entities[index], component_index};
+            auto base = kind == quantized_kind::position ? origin_value : quantized_value{};
+            auto value = quantized_value{};
+            auto changed = true;
+
+            if (baseline) {
+                if (auto it = baseline->values.find(key); it != baseline->values.end()) {
+                    archive(changed);
+                    base = it->second;
+                    value = it->second;
+                }
+            }
+
+            if (changed) {
+                value = read_element(archive, kind, base, quantization);
+            }
+
+            received.values[key] = value;
+            insert_element(*ptr, kind, value, quantization);
+        }
+
+        snapshot.pools.push_back(pool_snapshot{component_index, std::move(ptr)});
+    }
+
+    if (archive.failed()) {
+        return false;
+    }
+
+    m_history.push_back(std::move(received));
+
+    while (m_history.size() > max_history) {
+        m_history.pop_front();
+    }
+
+    return true;
+}
+
+}
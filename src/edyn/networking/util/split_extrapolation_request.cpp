@@ -0,0 +1,92 @@
+#include "edyn/networking/util/split_extrapolation_request.hpp"
+#include "edyn/comp/graph_node.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include <entt/entity/registry.hpp>
+#include <unordered_map>
+
+namespace edyn {
+
+std::vector<extrapolation_request>
+split_extrapolation_request(const entt::registry &registry,
+                            const extrapolation_request &request,
+                            size_t num_extrapolators) {
+    auto &graph = registry.ctx().at<entity_graph>();
+    auto node_view = registry.view<graph_node>();
+    auto node_indices = std::vector<entity_graph::index_type>{};
+
+    for (auto entity : request.snapshot.entities) {
+        if (node_view.contains(entity)) {
+            auto node_index = node_view.get<graph_node>(entity).node_index;
+
+            if (graph.is_connecting_node(node_index)) {
+                node_indices.push_back(node_index);
+            }
+        }
+    }
+
+    // Find connected component of each entity and use the lowest entity id
+    // in it to choose an extrapolator, thus the same island is likely to be
+    // sent to the same extrapolator over time, where its requests coalesce.
+    auto component_of_entity = std::unordered_map<entt::entity, size_t>{};
+    auto component_extrapolator = std::vector<size_t>{};
+    auto component_min_entity = entt::entity{entt::null};
+
+    if (!node_indices.empty()) {
+        auto visit = [&](entt::entity entity) {
+            component_of_entity[entity] = component_extrapolator.size();
+
+            if (component_min_entity == entt::null ||
+                entt::to_integral(entity) < entt::to_integral(component_min_entity)) {
+                component_min_entity = entity;
+            }
+        };
+
+        graph.reach(
+            node_indices.begin(), node_indices.end(),
+            visit, visit, [](auto) { return true; },
+            [&]() {
+                component_extrapolator.push_back(entt::to_integral(component_min_entity) % num_extrapolators);
+                component_min_entity = entt::null;
+            });
+    }
+
+    auto indices = std::vector<std::vector<size_t>>(num_extrapolators);
+
+    for (size_t i = 0; i < request.snapshot.entities.size(); ++i) {
+        auto entity = request.snapshot.entities[i];
+        auto it = component_of_entity.find(entity);
+        // Entities that are not part of an island go to the first extrapolator.
+        auto extrapolator_index = it != component_of_entity.end() ? component_extrapolator[it->second] : 0;
+        indices[extrapolator_index].push_back(i);
+    }
+
+    auto result = std::vector<extrapolation_request>(num_extrapolators);
+
+    for (size_t i = 0; i < num_extrapolators; ++i) {
+        auto &part = result[i];
+        part.destination = request.destination;
+        part.start_time = request.start_time;
+        part.execution_time_limit = request.execution_time_limit;
+        part.should_remap = request.should_remap;
+
+        if (!indices[i].empty()) {
+            part.snapshot = internal::snapshot_subset(request.snapshot, indices[i]);
+        }
+
+        auto remote_indices = std::vector<size_t>{};
+
+        for (size_t j = 0; j < num_extrapolators; ++j) {
+            if (j != i) {
+                remote_indices.insert(remote_indices.end(), indices[j].begin(), indices[j].end());
+            }
+        }
+
+        if (!remote_indices.empty()) {
+            part.remote_state = internal::snapshot_subset(request.snapshot, remote_indices);
+        }
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,86 @@
+#include "edyn/parallel/atomic_counter_sync.hpp"
+#include "edyn/parallel/cpu_relax.hpp"
+#include <climits>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace edyn {
+
+// Number of iterations to spin before parking the waiting thread. Jobs are
+// often short, thus the counter commonly reaches zero during the spin.
+static constexpr unsigned atomic_counter_sync_spin_count = 4096;
+
+#if defined(__linux__)
+
+static void futex_wait(std::atomic<uint32_t> *addr, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT_PRIVATE,
+            expected, nullptr, nullptr, 0);
+}
+
+static void futex_wake_all(std::atomic<uint32_t> *addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE_PRIVATE,
+            INT_MAX, nullptr, nullptr, 0);
+}
+
+void atomic_counter_sync::release() {
+    // The waiting thread might return from `wait()` and destroy this object
+    // right after the exchange. The wake only uses the address as a key and
+    // never dereferences it, so it's harmless if that happens.
+    if (m_state.exchange(state_done, std::memory_order_acq_rel) == state_parked) {
+        futex_wake_all(&m_state);
+    }
+}
+
+void atomic_counter_sync::wait() {
+    for (unsigned i = 0; i < atomic_counter_sync_spin_count; ++i) {
+        if (done()) {
+            return;
+        }
+
+        cpu_relax();
+    }
+
+    auto expected = state_pending;
+
+    if (!m_state.compare_exchange_strong(expected, state_parked, std::memory_order_acq_rel) &&
+        expected == state_done) {
+        return;
+    }
+
+    // Loop to handle spurious wake ups.
+    while (!done()) {
+        futex_wait(&m_state, state_parked);
+    }
+}
+
+#else
+
+void atomic_counter_sync::release() {
+    // Notify under the lock, otherwise the waiting thread could return from
+    // `wait()` and destroy the condition variable before `notify_one` is
+    // called.
+    std::lock_guard lock(m_mutex);
+    m_state.store(state_done, std::memory_order_release);
+    m_cv.notify_one();
+}
+
+void atomic_counter_sync::wait() {
+    for (unsigned i = 0; i < atomic_counter_sync_spin_count; ++i) {
+        if (done()) {
+            return;
+        }
+
+        cpu_relax();
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_cv.wait(lock, [&] { return done(); });
+}
+
+#endif
+
+}
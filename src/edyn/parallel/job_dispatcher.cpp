@@ -2,10 +2,15 @@
 #include "edyn/parallel/job_queue.hpp"
 #include "edyn/parallel/worker.hpp"
 #include "edyn/config/config.h"
+#include <algorithm>
 #include <cstdint>
 
 namespace edyn {
 
+// NUMA node of the current worker thread, or `SIZE_MAX` if the thread does
+// not belong to a dispatcher.
+static thread_local size_t t_worker_node = SIZE_MAX;
+
 job_dispatcher &job_dispatcher::global() {
     static job_dispatcher instance;
     return instance;
@@ -15,23 +20,104 @@ job_dispatcher::~job_dispatcher() {
     stop();
 }
 
-void job_dispatcher::start(size_t num_worker_threads) {
+static std::vector<unsigned> exclude_cpus(const std::vector<unsigned> &cpus,
+                                          const std::vector<unsigned> &excluded) {
+    auto result = std::vector<unsigned>{};
+
+    for (auto cpu : cpus) {
+        if (std::find(excluded.begin(), excluded.end(), cpu) == excluded.end()) {
+            result.push_back(cpu);
+        }
+    }
+
+    // Keep the original set if nothing would be left.
+    return result.empty() ? cpus : result;
+}
+
+void job_dispatcher::start(size_t num_worker_threads, const job_dispatcher_config &config) {
     EDYN_ASSERT(num_worker_threads > 0);
     EDYN_ASSERT(m_workers.empty());
 
+    m_config = config;
+
+    // Split the allowed CPUs into groups, one per NUMA node if enabled.
+    auto node_cpus = std::vector<std::vector<unsigned>>{};
+    auto topology = get_numa_node_cpus();
+    m_cpu_node.clear();
+
+    for (size_t node = 0; node < topology.size(); ++node) {
+        for (auto cpu : topology[node]) {
+            if (cpu >= m_cpu_node.size()) {
+                m_cpu_node.resize(cpu + 1, SIZE_MAX);
+            }
+
+            m_cpu_node[cpu] = node;
+        }
+    }
+
+    if (config.numa_groups) {
+        for (auto &cpus : topology) {
+            auto allowed = std::vector<unsigned>{};
+
+            for (auto cpu : cpus) {
+                if (config.cpus.empty() ||
+                    std::find(config.cpus.begin(), config.cpus.end(), cpu) != config.cpus.end()) {
+                    allowed.push_back(cpu);
+                }
+            }
+
+            node_cpus.push_back(exclude_cpus(allowed, config.low_latency_cpus));
+        }
+    } else {
+        auto all = config.cpus;
+
+        if (all.empty() && !config.low_latency_cpus.empty()) {
+            for (auto &cpus : topology) {
+                all.insert(all.end(), cpus.begin(), cpus.end());
+            }
+        }
+
+        node_cpus.push_back(exclude_cpus(all, config.low_latency_cpus));
+        m_cpu_node.clear();
+    }
+
+    m_node_workers.assign(node_cpus.size(), {});
+
     for (size_t i = 0; i < num_worker_threads; ++i) {
+        // Assign workers to nodes in a round-robin fashion, skipping nodes
+        // that have no allowed CPUs, unless none of them do.
+        auto node = i % node_cpus.size();
+
+        for (size_t k = 0; k < node_cpus.size(); ++k) {
+            auto candidate = (i + k) % node_cpus.size();
+
+            if (!node_cpus[candidate].empty()) {
+                node = candidate;
+                break;
+            }
+        }
+
+        auto thread_cfg = thread_config{};
+        thread_cfg.name = config.name.empty() ? std::string{} : config.name + std::to_string(i);
+        thread_cfg.cpus = node_cpus[node];
+        thread_cfg.priority = config.priority;
+
         auto w = std::make_unique<worker>();
-        auto t = std::make_unique<std::thread>(&worker::run, w.get());
-        auto id = t->get_id();
+        auto t = std::make_unique<std::thread>([w = w.get(), thread_cfg, node] {
+            apply_thread_config(thread_cfg);
+            t_worker_node = node;
+            w->run();
+        });
 
+        m_node_workers[node].push_back(m_workers.size());
         m_threads.push_back(std::move(t));
-        m_workers[id] = std::move(w);
+        m_workers.push_back(std::move(w));
     }
 }
 
 void job_dispatcher::stop() {
-    for (auto &pair : m_workers) {
-        pair.second->stop();
+    for (auto &w : m_workers) {
+        w->stop();
     }
 
     for (auto &t : m_threads) {
@@ -40,52 +126,95 @@ void job_dispatcher::stop() {
 
     m_workers.clear();
     m_threads.clear();
+    m_node_workers.clear();
 }
 
 bool job_dispatcher::running() const {
     return !m_threads.empty();
 }
 
+bool job_dispatcher::is_worker_thread() {
+    return t_worker_node != SIZE_MAX;
+}
+
+size_t job_dispatcher::caller_node() const {
+    if (t_worker_node != SIZE_MAX) {
+        return t_worker_node;
+    }
+
+    auto cpu = get_current_cpu();
+
+    if (cpu >= 0 && static_cast<size_t>(cpu) < m_cpu_node.size()) {
+        return m_cpu_node[cpu];
+    }
+
+    return SIZE_MAX;
+}
+
 void job_dispatcher::async(const job &j) {
     EDYN_ASSERT(!m_workers.empty());
 
     if (m_workers.size() == 1) {
-        m_workers.begin()->second->push_job(j);
+        m_workers.front()->push_job(j);
         return;
     }
 
+    auto start = m_start.fetch_add(1, std::memory_order_relaxed);
+
+    // Prefer an idle worker in the same NUMA node as the caller, which keeps
+    // the job's data local to the node.
+    if (m_node_workers.size() > 1) {
+        auto node = caller_node();
+
+        if (node < m_node_workers.size()) {
+            auto &indices = m_node_workers[node];
+
+            for (size_t i = 0; i < indices.size(); ++i) {
+                auto &w = m_workers[indices[(start + i) % indices.size()]];
+
+                if (w->size() == 0) {
+                    w->push_job(j);
+                    return;
+                }
+            }
+        }
+    }
+
     // Find least busy worker to insert job into. Start search from a different
     // worker each time to create a better spread. This prevents the first
     // worker from being prioritized and getting most jobs.
-    auto best_id = std::thread::id();
+    auto best_index = SIZE_MAX;
     auto min_num_jobs = SIZE_MAX;
-    auto start = m_start.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
-    auto end = start + m_workers.size();
 
-    for (size_t i = start; i < end; ++i) {
-        auto k = i % m_workers.size();
-        auto first = m_workers.begin();
-        std::advance(first, k);
-        auto &pair = *first;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto k = (start + i) % m_workers.size();
+        auto s = m_workers[k]->size();
 
-        auto s = pair.second->size();
         if (s == 0) {
-            pair.second->push_job(j);
+            m_workers[k]->push_job(j);
             return;
         }
         if (s < min_num_jobs) {
             min_num_jobs = s;
-            best_id = pair.first;
+            best_index = k;
         }
     }
 
-    EDYN_ASSERT(m_workers.count(best_id));
+    EDYN_ASSERT(best_index < m_workers.size());
 
-    m_workers[best_id]->push_job(j);
+    m_workers[best_index]->push_job(j);
 }
 
 size_t job_dispatcher::num_workers() const {
     return m_workers.size();
 }
 
+bool job_dispatcher::apply_low_latency_config(const std::string &name) const {
+    auto config = thread_config{};
+    config.name = name;
+    config.cpus = m_config.low_latency_cpus;
+    config.priority = m_config.low_latency_priority;
+    return apply_thread_config(config);
+}
+
 }
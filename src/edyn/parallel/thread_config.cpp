@@ -0,0 +1,238 @@
+#include "edyn/parallel/thread_config.hpp"
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+namespace edyn {
+
+static std::vector<unsigned> all_cpus() {
+    auto cpus = std::vector<unsigned>{};
+    auto count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned i = 0; i < count; ++i) {
+        cpus.push_back(i);
+    }
+
+    return cpus;
+}
+
+#if defined(__linux__)
+
+// Parses lists in the format used by sysfs, e.g. `0-3,8,10-11`.
+static std::vector<unsigned> parse_cpu_list(const std::string &list) {
+    auto result = std::vector<unsigned>{};
+    auto stream = std::istringstream(list);
+    auto range = std::string{};
+
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range[0] < '0' || range[0] > '9') {
+            continue;
+        }
+
+        auto dash = range.find('-');
+        auto first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+        auto last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+
+        for (auto i = first; i <= last; ++i) {
+            result.push_back(i);
+        }
+    }
+
+    return result;
+}
+
+static bool read_cpu_list(const std::string &path, std::vector<unsigned> &list) {
+    auto file = std::ifstream(path);
+    auto line = std::string{};
+
+    if (!file || !std::getline(file, line)) {
+        return false;
+    }
+
+    list = parse_cpu_list(line);
+    return true;
+}
+
+static bool set_thread_name(const std::string &name) {
+    // Names are limited to 16 characters including the null terminator.
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+}
+
+static bool set_thread_affinity(const std::vector<unsigned> &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+static bool set_thread_priority(thread_priority priority) {
+    if (priority == thread_priority::realtime) {
+        auto param = sched_param{};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+
+    // On Linux, the nice value applies to the thread whose id is given.
+    auto nice = priority == thread_priority::low ? 10 : priority == thread_priority::high ? -10 : 0;
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, tid, nice) == 0;
+}
+
+std::vector<unsigned> get_thread_affinity() {
+    auto cpus = std::vector<unsigned>{};
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+
+    for (unsigned i = 0; i < CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &set)) {
+            cpus.push_back(i);
+        }
+    }
+
+    return cpus;
+}
+
+std::vector<std::vector<unsigned>> get_numa_node_cpus() {
+    auto nodes = std::vector<std::vector<unsigned>>{};
+    auto online = std::vector<unsigned>{};
+
+    if (read_cpu_list("/sys/devices/system/node/online", online)) {
+        for (auto node : online) {
+            auto cpus = std::vector<unsigned>{};
+            auto path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+
+            if (read_cpu_list(path, cpus) && !cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        }
+    }
+
+    if (nodes.empty()) {
+        nodes.push_back(all_cpus());
+    }
+
+    return nodes;
+}
+
+int get_current_cpu() {
+    return sched_getcpu();
+}
+
+#elif defined(_WIN32)
+
+static bool set_thread_name(const std::string &) {
+    return false;
+}
+
+static bool set_thread_affinity(const std::vector<unsigned> &cpus) {
+    DWORD_PTR mask = 0;
+
+    for (auto cpu : cpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8) {
+            mask |= DWORD_PTR(1) << cpu;
+        }
+    }
+
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+static bool set_thread_priority(thread_priority priority) {
+    auto value = THREAD_PRIORITY_NORMAL;
+
+    switch (priority) {
+    case thread_priority::low: value = THREAD_PRIORITY_BELOW_NORMAL; break;
+    case thread_priority::normal: value = THREAD_PRIORITY_NORMAL; break;
+    case thread_priority::high: value = THREAD_PRIORITY_ABOVE_NORMAL; break;
+    case thread_priority::realtime: value = THREAD_PRIORITY_TIME_CRITICAL; break;
+    }
+
+    return SetThreadPriority(GetCurrentThread(), value) != 0;
+}
+
+std::vector<unsigned> get_thread_affinity() {
+    return {};
+}
+
+std::vector<std::vector<unsigned>> get_numa_node_cpus() {
+    return {all_cpus()};
+}
+
+int get_current_cpu() {
+    return -1;
+}
+
+#else
+
+static bool set_thread_name([[maybe_unused]] const std::string &name) {
+#if defined(__APPLE__)
+    return pthread_setname_np(name.c_str()) == 0;
+#else
+    return false;
+#endif
+}
+
+static bool set_thread_affinity(const std::vector<unsigned> &) {
+    return false;
+}
+
+static bool set_thread_priority(thread_priority) {
+    return false;
+}
+
+std::vector<unsigned> get_thread_affinity() {
+    return {};
+}
+
+std::vector<std::vector<unsigned>> get_numa_node_cpus() {
+    return {all_cpus()};
+}
+
+int get_current_cpu() {
+    return -1;
+}
+
+#endif
+
+bool apply_thread_config(const thread_config &config) {
+    auto success = true;
+
+    if (!config.name.empty()) {
+        success = set_thread_name(config.name) && success;
+    }
+
+    if (!config.cpus.empty()) {
+        success = set_thread_affinity(config.cpus) && success;
+    }
+
+    if (config.priority != thread_priority::normal) {
+        success = set_thread_priority(config.priority) && success;
+    }
+
+    return success;
+}
+
+}
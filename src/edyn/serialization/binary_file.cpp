@@ -0,0 +1,32 @@
+#include "edyn/serialization/binary_file.hpp"
+#include "edyn/math/scalar.hpp"
+#include <fstream>
+
+namespace edyn {
+
+void write_binary_header(memory_output_archive &archive, uint64_t magic, uint32_t version) {
+    auto scalar_size = static_cast<uint8_t>(sizeof(scalar));
+    archive(magic, version, scalar_size);
+}
+
+bool read_binary_header(memory_input_archive &archive, uint64_t magic, uint32_t version) {
+    uint64_t stored_magic {};
+    uint32_t stored_version {};
+    uint8_t scalar_size {};
+    archive(stored_magic, stored_version, scalar_size);
+
+    if (stored_magic != magic || stored_version != version || scalar_size != sizeof(scalar)) {
+        archive.fail();
+    }
+
+    return !archive.failed();
+}
+
+bool write_binary_file(const std::string &path, const std::vector<uint8_t> &buffer) {
+    auto file = std::ofstream(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+
+    return file.good();
+}
+
+}
@@ -0,0 +1,422 @@
+#include "edyn/serialization/mapped_paged_triangle_mesh.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include "edyn/serialization/static_tree_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/shapes/paged_triangle_mesh.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+#include "edyn/config/config.h"
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+
+namespace edyn {
+
+namespace detail {
+
+// "EDYNPTM" followed by a zero, which also tells apart files written on
+// machines of different endianness.
+constexpr uint64_t mapped_paged_triangle_mesh_magic = 0x004d54504e594445;
+
+// Arrays are aligned to cache lines and submeshes to pages.
+constexpr size_t mapped_array_alignment = 64;
+constexpr size_t mapped_submesh_alignment = 4096;
+
+/**
+ * Writes values in their in-memory representation. Arrays of trivially
+ * copyable elements are written in one go, after their size and aligned
+ * relative to the start of the file.
+ */
+class mapped_output_archive {
+public:
+    using is_input = std::false_type;
+    using is_output = std::true_type;
+
+    mapped_output_archive(std::ofstream &file)
+        : m_file(&file)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            write(&t, sizeof(T));
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename T>
+    void operator()(const T &t) {
+        operator()(const_cast<T &>(t));
+    }
+
+    template<typename T>
+    void operator()(std::vector<T> &vector) {
+        uint64_t size = vector.size();
+        operator()(size);
+
+        if constexpr(std::is_trivially_copyable_v<T>) {
+            align(mapped_array_alignment);
+            write(vector.data(), size * sizeof(T));
+        } else {
+            for (auto &value : vector) {
+                operator()(value);
+            }
+        }
+    }
+
+    void operator()(std::vector<bool> &vector) {
+        uint64_t size = vector.size();
+        operator()(size);
+
+        for (bool value : vector) {
+            auto byte = static_cast<uint8_t>(value);
+            operator()(byte);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    void align(size_t alignment) {
+        static const char zeros[mapped_submesh_alignment] = {};
+        auto padding = (alignment - m_position % alignment) % alignment;
+        write(zeros, padding);
+    }
+
+    size_t position() const {
+        return m_position;
+    }
+
+private:
+    void write(const void *data, size_t size) {
+        m_file->write(reinterpret_cast<const char *>(data), size);
+        m_position += size;
+    }
+
+    std::ofstream *m_file;
+    size_t m_position {0};
+};
+
+/**
+ * Reads values written by `mapped_output_archive` from a region of mapped
+ * memory. Arrays of trivially copyable elements are copied in one go.
+ */
+class mapped_input_archive {
+public:
+    using is_input = std::true_type;
+    using is_output = std::false_type;
+
+    mapped_input_archive(const uint8_t *data, size_t begin, size_t end)
+        : m_data(data)
+        , m_position(begin)
+        , m_end(end)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            read(&t, sizeof(T));
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename T>
+    void operator()(std::vector<T> &vector) {
+        uint64_t size = 0;
+        operator()(size);
+
+        if constexpr(std::is_trivially_copyable_v<T>) {
+            align(mapped_array_alignment);
+
+            if (m_failed || size > remaining() / sizeof(T)) {
+                m_failed = true;
+                return;
+            }
+
+            vector.resize(size);
+            read(vector.data(), size * sizeof(T));
+        } else {
+            if (m_failed || size > remaining()) {
+                m_failed = true;
+                return;
+            }
+
+            vector.resize(size);
+
+            for (auto &value : vector) {
+                operator()(value);
+            }
+        }
+    }
+
+    void operator()(std::vector<bool> &vector) {
+        uint64_t size = 0;
+        operator()(size);
+
+        if (m_failed || size > remaining()) {
+            m_failed = true;
+            return;
+        }
+
+        vector.resize(size);
+
+        for (size_t i = 0; i < size; ++i) {
+            vector[i] = m_data[m_position + i] != 0;
+        }
+
+        m_position += size;
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    void align(size_t alignment) {
+        m_position += (alignment - m_position % alignment) % alignment;
+    }
+
+    void fail() {
+        m_failed = true;
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+private:
+    size_t remaining() const {
+        return m_position < m_end ? m_end - m_position : 0;
+    }
+
+    void read(void *data, size_t size) {
+        if (m_failed || size > remaining()) {
+            m_failed = true;
+            return;
+        }
+
+        if (size > 0) {
+            std::memcpy(data, m_data + m_position, size);
+            m_position += size;
+        }
+    }
+
+    const uint8_t *m_data;
+    size_t m_position;
+    size_t m_end;
+    bool m_failed {false};
+};
+
+struct mapped_header {
+    uint64_t magic {mapped_paged_triangle_mesh_magic};
+    uint32_t version {mapped_paged_triangle_mesh_version};
+    uint32_t scalar_size {sizeof(scalar)};
+    scalar thickness;
+    static_tree tree;
+    std::vector<mapped_paged_triangle_mesh_loader::submesh_entry> submeshes;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, mapped_header &header) {
+    archive(header.magic, header.version, header.scalar_size);
+
+    if constexpr(Archive::is_input::value) {
+        if (header.magic != mapped_paged_triangle_mesh_magic ||
+            header.version != mapped_paged_triangle_mesh_version ||
+            header.scalar_size != sizeof(scalar)) {
+            archive.fail();
+            return;
+        }
+    }
+
+    archive(header.thickness);
+    archive(header.tree);
+    archive(header.submeshes);
+}
+
+struct load_mapped_mesh_context {
+    // Integral value of a pointer to an instance of
+    // `mapped_paged_triangle_mesh_loader`.
+    intptr_t m_loader;
+    // Pointer to paged triangle mesh.
+    intptr_t m_trimesh;
+    // Index of submesh to be loaded.
+    size_t m_index;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, load_mapped_mesh_context &ctx) {
+    archive(ctx.m_loader, ctx.m_trimesh, ctx.m_index);
+}
+
+}
+
+bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                      const paged_triangle_mesh &paged_tri_mesh) {
+    auto header = detail::mapped_header{};
+    header.thickness = paged_tri_mesh.m_thickness;
+    header.tree = paged_tri_mesh.m_tree;
+
+    for (auto &node : paged_tri_mesh.m_cache) {
+        EDYN_ASSERT(node.trimesh);
+
+        if (!node.trimesh) {
+            return false;
+        }
+
+        auto &entry = header.submeshes.emplace_back();
+        entry.num_vertices = node.num_vertices;
+        entry.num_indices = node.num_indices;
+        entry.offset = 0;
+        entry.size = 0;
+        entry.aabb = node.trimesh->get_aabb();
+    }
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::out | std::ios::trunc);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Write the header with placeholder offsets first. It is written again
+    // with the final offsets once submeshes are written, which does not
+    // change its size.
+    auto archive = detail::mapped_output_archive(file);
+    archive(header);
+
+    for (size_t i = 0; i < header.submeshes.size(); ++i) {
+        archive.align(detail::mapped_submesh_alignment);
+        auto &entry = header.submeshes[i];
+        entry.offset = archive.position();
+        archive(*paged_tri_mesh.m_cache[i].trimesh);
+        entry.size = archive.position() - entry.offset;
+    }
+
+    file.seekp(0);
+    auto header_archive = detail::mapped_output_archive(file);
+    header_archive(header);
+
+    return file.good();
+}
+
+mapped_paged_triangle_mesh_loader::mapped_paged_triangle_mesh_loader(const std::string &path)
+    // Submeshes are accessed in no particular order. Disable read-ahead and
+    // rely on explicit prefetching instead.
+    : m_file(path, mapped_file::access_pattern::random)
+{
+    if (m_file.size() == 0) {
+        m_file.close();
+        return;
+    }
+
+    auto header = detail::mapped_header{};
+    auto archive = detail::mapped_input_archive(m_file.data(), 0, m_file.size());
+    archive(header);
+
+    // Leaves of the tree hold submesh indices.
+    auto valid = !archive.failed() && header.tree.is_valid(header.submeshes.size());
+
+    for (auto &entry : header.submeshes) {
+        if (entry.offset > m_file.size() || entry.size > m_file.size() - entry.offset) {
+            valid = false;
+        }
+    }
+
+    if (!valid) {
+        m_file.close();
+        return;
+    }
+
+    m_thickness = header.thickness;
+    m_tree = std::move(header.tree);
+    m_submeshes = std::move(header.submeshes);
+}
+
+bool mapped_paged_triangle_mesh_loader::init(paged_triangle_mesh &paged_tri_mesh) const {
+    EDYN_ASSERT(&paged_tri_mesh.get_page_loader() == this);
+
+    if (!is_open()) {
+        return false;
+    }
+
+    auto num_submeshes = m_submeshes.size();
+    paged_tri_mesh.m_thickness = m_thickness;
+    paged_tri_mesh.m_tree = m_tree;
+    paged_tri_mesh.m_cache.resize(num_submeshes);
+
+    for (size_t i = 0; i < num_submeshes; ++i) {
+        auto &node = paged_tri_mesh.m_cache[i];
+        node.num_vertices = m_submeshes[i].num_vertices;
+        node.num_indices = m_submeshes[i].num_indices;
+        node.trimesh.reset();
+    }
+
+    paged_tri_mesh.init_cache();
+
+    return true;
+}
+
+void mapped_paged_triangle_mesh_loader::load(paged_triangle_mesh *trimesh, size_t index) {
+    EDYN_ASSERT(is_open() && index < m_submeshes.size());
+
+    auto ctx = detail::load_mapped_mesh_context();
+    ctx.m_loader = reinterpret_cast<intptr_t>(this);
+    ctx.m_trimesh = reinterpret_cast<intptr_t>(trimesh);
+    ctx.m_index = index;
+
+    auto j = job();
+    j.func = &load_mapped_mesh_job_func;
+    auto archive = fixed_memory_output_archive(j.data.data(), j.data.size());
+    serialize(archive, ctx);
+    job_dispatcher::global().async(j);
+}
+
+void mapped_paged_triangle_mesh_loader::load_submesh(paged_triangle_mesh *trimesh, size_t index) const {
+    auto &entry = m_submeshes[index];
+    auto archive = detail::mapped_input_archive(m_file.data(), entry.offset, entry.offset + entry.size);
+    auto mesh = std::make_shared<triangle_mesh>();
+    archive(*mesh);
+
+    // Only the header and the location of each submesh were validated when
+    // the file was opened, thus the contents of the submesh must be checked
+    // before use.
+    if (archive.failed() ||
+        mesh->num_vertices() != entry.num_vertices ||
+        mesh->num_triangles() * 3 != entry.num_indices ||
+        !mesh->is_valid()) {
+        trimesh->cancel_loading(index);
+        return;
+    }
+
+    trimesh->assign_mesh(index, mesh);
+    prefetch_neighbors(index);
+}
+
+void mapped_paged_triangle_mesh_loader::prefetch_neighbors(size_t index) const {
+    auto aabb = m_submeshes[index].aabb.inset(vector3_one * -m_prefetch_distance);
+
+    for (size_t i = 0; i < m_submeshes.size(); ++i) {
+        auto &entry = m_submeshes[i];
+
+        if (i != index && intersect(aabb, entry.aabb)) {
+            m_file.prefetch(entry.offset, entry.size);
+        }
+    }
+}
+
+void load_mapped_mesh_job_func(job::data_type &data) {
+    detail::load_mapped_mesh_context ctx;
+    auto archive = memory_input_archive(data.data(), data.size());
+    serialize(archive, ctx);
+
+    auto *loader = reinterpret_cast<mapped_paged_triangle_mesh_loader *>(ctx.m_loader);
+    auto *trimesh = reinterpret_cast<paged_triangle_mesh *>(ctx.m_trimesh);
+    loader->load_submesh(trimesh, ctx.m_index);
+}
+
+}
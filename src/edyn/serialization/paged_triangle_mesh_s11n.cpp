@@ -99,12 +99,7 @@ void serialize(paged_triangle_mesh_file_input_archive &archive,
         archive.m_base_offset = archive.tell_position();
     }
 
-    // Resize LRU queue to have the number of submeshes.
-    paged_tri_mesh.m_lru_indices.resize(num_submeshes);
-    std::iota(paged_tri_mesh.m_lru_indices.begin(),
-              paged_tri_mesh.m_lru_indices.end(), 0);
-
-    paged_tri_mesh.m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(num_submeshes);
+    paged_tri_mesh.init_cache();
 }
 
 template<typename Archive>
@@ -141,6 +136,7 @@ void load_mesh_job_func(job::data_type &data) {
     case paged_triangle_mesh_serialization_mode::external: {
         auto tri_mesh_path = get_submesh_path(input->m_path, ctx.m_index);
         auto tri_mesh_archive = file_input_archive(tri_mesh_path);
+        tri_mesh_archive.set_legacy_size_format(input->legacy_size_format());
         serialize(tri_mesh_archive, *mesh);
         break;
     }
@@ -0,0 +1,733 @@
+#include "edyn/serialization/world_snapshot.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/entt_s11n.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/binary_file.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/collision/contact_manifold_events.hpp"
+#include "edyn/comp/shared_comp.hpp"
+#include "edyn/comp/graph_node.hpp"
+#include "edyn/comp/graph_edge.hpp"
+#include "edyn/comp/present_position.hpp"
+#include "edyn/comp/present_orientation.hpp"
+#include "edyn/config/config.h"
+#include "edyn/context/settings.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/replication/map_child_entity.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/util/mapped_file.hpp"
+#include <entt/entity/registry.hpp>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+namespace edyn {
+
+namespace detail {
+
+// "EDYNWLD" followed by a zero, which also tells apart snapshots written on
+// machines of different endianness.
+constexpr uint64_t world_snapshot_magic = 0x00444c574e594445;
+
+constexpr uint32_t world_snapshot_null_index = std::numeric_limits<uint32_t>::max();
+
+// Components which are stored as they are, in the order they're inserted into
+// the registry when a snapshot is loaded. Entities referenced by them are
+// mapped to the new entities using `entt::meta`.
+using world_snapshot_components_t = decltype(std::tuple_cat(std::tuple<
+    position,
+    orientation,
+    linvel,
+    angvel,
+    mass,
+    mass_inv,
+    inertia,
+    inertia_inv,
+    inertia_world_inv,
+    center_of_mass,
+    origin,
+    gravity,
+    material,
+    present_position,
+    present_orientation,
+    AABB,
+    collision_filter,
+    collision_exclusion,
+    shape_index,
+    roll_direction,
+    child_list,
+    parent_comp,
+    dynamic_tag,
+    kinematic_tag,
+    static_tag,
+    procedural_tag,
+    rolling_tag,
+    sleeping_tag,
+    sleeping_disabled_tag,
+    disabled_tag,
+    external_tag,
+    networked_tag,
+    island_AABB,
+    island_tag,
+    contact_manifold,
+    contact_manifold_with_restitution,
+    null_constraint
+>{}, constraints_tuple_t{}, std::tuple<
+    sphere_shape,
+    cylinder_shape,
+    capsule_shape,
+    box_shape,
+    compound_shape,
+    plane_shape
+>{}));
+
+// Holds a component for each entity, which are referred to by their index
+// in the snapshot.
+template<typename Component>
+struct world_snapshot_pool {
+    std::vector<uint32_t> indices;
+    std::vector<Component> components;
+};
+
+template<typename Archive, typename Component>
+void serialize(Archive &archive, world_snapshot_pool<Component> &pool) {
+    archive(pool.indices);
+
+    if constexpr(!std::is_empty_v<Component>) {
+        archive(pool.components);
+    }
+}
+
+struct world_snapshot_island {
+    std::vector<uint32_t> nodes;
+    std::vector<uint32_t> edges;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, world_snapshot_island &island) {
+    archive(island.nodes);
+    archive(island.edges);
+}
+
+// Heightfields are not default constructible, thus their parameters are
+// stored and they're created once the snapshot is validated.
+struct world_snapshot_heightfield {
+    uint32_t num_columns;
+    uint32_t num_rows;
+    vector2 spacing;
+    vector3 origin;
+    scalar thickness;
+    uint8_t build_pyramid;
+    std::vector<scalar> heights;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, world_snapshot_heightfield &field) {
+    archive(field.num_columns, field.num_rows);
+    archive(field.spacing);
+    archive(field.origin);
+    archive(field.thickness);
+    archive(field.build_pyramid);
+    archive(field.heights);
+}
+
+struct world_snapshot_data {
+    std::vector<entt::entity> entities;
+    std::vector<std::shared_ptr<convex_mesh>> convex_meshes;
+    std::vector<std::shared_ptr<triangle_mesh>> triangle_meshes;
+    std::vector<world_snapshot_heightfield> heightfields;
+    map_tuple<world_snapshot_pool, world_snapshot_components_t>::type pools;
+    // Shapes referring to meshes store an index into the mesh arrays above.
+    world_snapshot_pool<uint32_t> polyhedron_shapes;
+    world_snapshot_pool<uint32_t> mesh_shapes;
+    world_snapshot_pool<uint32_t> heightfield_shapes;
+    world_snapshot_pool<world_snapshot_island> islands;
+    world_snapshot_pool<uint32_t> island_residents;
+    world_snapshot_pool<std::vector<uint32_t>> multi_island_residents;
+    // Whether each graph node is non-connecting, and the entity indices of
+    // the nodes of each graph edge.
+    world_snapshot_pool<uint8_t> graph_nodes;
+    world_snapshot_pool<std::array<uint32_t, 2>> graph_edges;
+    world_snapshot_pool<rigidbody_tag> rigidbodies;
+    world_snapshot_pool<constraint_tag> constraints;
+};
+
+template<typename Archive, typename T>
+void serialize_shared_ptrs(Archive &archive, std::vector<std::shared_ptr<T>> &ptrs) {
+    auto size = internal::serialize_size(archive, ptrs.size(), 1);
+
+    if constexpr(Archive::is_input::value) {
+        ptrs.resize(size);
+
+        for (auto &ptr : ptrs) {
+            ptr = std::make_shared<T>();
+        }
+    }
+
+    for (auto &ptr : ptrs) {
+        archive(*ptr);
+    }
+}
+
+// The serialization of `convex_mesh` initializes it before its faces can be
+// validated, thus only the vertices, indices and faces are read and meshes
+// are initialized after the snapshot is validated.
+template<typename Archive>
+void serialize_convex_meshes(Archive &archive, std::vector<std::shared_ptr<convex_mesh>> &meshes) {
+    auto size = internal::serialize_size(archive, meshes.size(), 1);
+
+    if constexpr(Archive::is_input::value) {
+        meshes.resize(size);
+
+        for (auto &mesh : meshes) {
+            mesh = std::make_shared<convex_mesh>();
+        }
+    }
+
+    for (auto &mesh : meshes) {
+        archive(mesh->vertices);
+        archive(mesh->indices);
+        archive(mesh->faces);
+    }
+}
+
+template<typename Archive>
+void serialize(Archive &archive, world_snapshot_data &data) {
+    archive(data.entities);
+    serialize_convex_meshes(archive, data.convex_meshes);
+    serialize_shared_ptrs(archive, data.triangle_meshes);
+    archive(data.heightfields);
+    std::apply([&](auto &... pools) {
+        (archive(pools), ...);
+    }, data.pools);
+    archive(data.polyhedron_shapes);
+    archive(data.mesh_shapes);
+    archive(data.heightfield_shapes);
+    archive(data.islands);
+    archive(data.island_residents);
+    archive(data.multi_island_residents);
+    archive(data.graph_nodes);
+    archive(data.graph_edges);
+    archive(data.rigidbodies);
+    archive(data.constraints);
+}
+
+template<typename Component>
+void fill_pool(entt::registry &registry, const entt::sparse_set &entities,
+               world_snapshot_pool<Component> &pool) {
+    auto view = registry.view<Component>();
+
+    for (auto entity : view) {
+        if (!entities.contains(entity)) continue;
+
+        pool.indices.push_back(static_cast<uint32_t>(entities.index(entity)));
+
+        if constexpr(!std::is_empty_v<Component>) {
+            pool.components.push_back(std::get<0>(view.get(entity)));
+        }
+    }
+}
+
+// Returns the index of the given shared pointer, inserting it into the array
+// if it's not there yet.
+template<typename T>
+uint32_t insert_shared_ptr(std::vector<std::shared_ptr<T>> &ptrs,
+                           std::map<const T *, uint32_t> &indices,
+                           const std::shared_ptr<T> &ptr) {
+    auto [it, inserted] = indices.emplace(ptr.get(), static_cast<uint32_t>(ptrs.size()));
+
+    if (inserted) {
+        ptrs.push_back(ptr);
+    }
+
+    return it->second;
+}
+
+void fill_world_snapshot(entt::registry &registry, world_snapshot_data &data) {
+    EDYN_ASSERT(registry.view<paged_mesh_shape>().empty(),
+                "Paged mesh shapes cannot be written into a world snapshot.");
+
+    // Assign an index to all physics entities, which is their position in
+    // this set.
+    auto entities = entt::sparse_set{};
+
+    auto insert_entities = [&](auto view) {
+        for (auto entity : view) {
+            if (!entities.contains(entity)) {
+                entities.emplace(entity);
+            }
+        }
+    };
+
+    insert_entities(registry.view<rigidbody_tag>());
+    insert_entities(registry.view<external_tag>());
+    insert_entities(registry.view<constraint_tag>());
+    insert_entities(registry.view<contact_manifold>());
+    insert_entities(registry.view<island_tag>());
+
+    data.entities.assign(entities.data(), entities.data() + entities.size());
+
+    auto index_of = [&](entt::entity entity) {
+        return entities.contains(entity) ?
+            static_cast<uint32_t>(entities.index(entity)) : world_snapshot_null_index;
+    };
+
+    std::apply([&](auto &... pools) {
+        (fill_pool(registry, entities, pools), ...);
+    }, data.pools);
+
+    auto convex_mesh_indices = std::map<const convex_mesh *, uint32_t>{};
+
+    for (auto [entity, shape] : registry.view<polyhedron_shape>().each()) {
+        if (!entities.contains(entity)) continue;
+        data.polyhedron_shapes.indices.push_back(index_of(entity));
+        data.polyhedron_shapes.components.push_back(
+            insert_shared_ptr(data.convex_meshes, convex_mesh_indices, shape.mesh));
+    }
+
+    auto triangle_mesh_indices = std::map<const triangle_mesh *, uint32_t>{};
+
+    for (auto [entity, shape] : registry.view<mesh_shape>().each()) {
+        if (!entities.contains(entity)) continue;
+        data.mesh_shapes.indices.push_back(index_of(entity));
+        data.mesh_shapes.components.push_back(
+            insert_shared_ptr(data.triangle_meshes, triangle_mesh_indices, shape.trimesh));
+    }
+
+    auto heightfield_indices = std::map<const heightfield *, uint32_t>{};
+
+    for (auto [entity, shape] : registry.view<heightfield_shape>().each()) {
+        if (!entities.contains(entity)) continue;
+
+        auto &field = *shape.field;
+        EDYN_ASSERT(!field.is_paged(), "Paged heightfields cannot be written into a world snapshot.");
+        auto [it, inserted] = heightfield_indices.emplace(&field, static_cast<uint32_t>(data.heightfields.size()));
+
+        if (inserted) {
+            auto &snap_field = data.heightfields.emplace_back();
+            snap_field.num_columns = static_cast<uint32_t>(field.num_columns());
+            snap_field.num_rows = static_cast<uint32_t>(field.num_rows());
+            snap_field.spacing = field.get_spacing();
+            snap_field.origin = field.get_origin();
+            snap_field.thickness = field.get_thickness();
+            snap_field.build_pyramid = field.has_pyramid();
+            snap_field.heights = field.get_heights();
+        }
+
+        data.heightfield_shapes.indices.push_back(index_of(entity));
+        data.heightfield_shapes.components.push_back(it->second);
+    }
+
+    for (auto [entity, island] : registry.view<edyn::island>().each()) {
+        if (!entities.contains(entity)) continue;
+
+        auto &snap_island = data.islands.components.emplace_back();
+        data.islands.indices.push_back(index_of(entity));
+
+        for (auto node_entity : island.nodes) {
+            snap_island.nodes.push_back(index_of(node_entity));
+        }
+
+        for (auto edge_entity : island.edges) {
+            snap_island.edges.push_back(index_of(edge_entity));
+        }
+    }
+
+    for (auto [entity, resident] : registry.view<island_resident>().each()) {
+        if (!entities.contains(entity)) continue;
+        data.island_residents.indices.push_back(index_of(entity));
+        data.island_residents.components.push_back(index_of(resident.island_entity));
+    }
+
+    for (auto [entity, resident] : registry.view<multi_island_resident>().each()) {
+        if (!entities.contains(entity)) continue;
+
+        auto &island_indices = data.multi_island_residents.components.emplace_back();
+        data.multi_island_residents.indices.push_back(index_of(entity));
+
+        for (auto island_entity : resident.island_entities) {
+            island_indices.push_back(index_of(island_entity));
+        }
+    }
+
+    auto &graph = registry.ctx().at<entity_graph>();
+
+    for (auto [entity, node] : registry.view<graph_node>().each()) {
+        if (!entities.contains(entity)) continue;
+        data.graph_nodes.indices.push_back(index_of(entity));
+        data.graph_nodes.components.push_back(!graph.is_connecting_node(node.node_index));
+    }
+
+    for (auto [entity, edge] : registry.view<graph_edge>().each()) {
+        if (!entities.contains(entity)) continue;
+        auto node_entities = graph.edge_node_entities(edge.edge_index);
+        data.graph_edges.indices.push_back(index_of(entity));
+        data.graph_edges.components.push_back({index_of(node_entities.first), index_of(node_entities.second)});
+    }
+
+    fill_pool(registry, entities, data.rigidbodies);
+    fill_pool(registry, entities, data.constraints);
+}
+
+template<typename Component>
+bool is_valid_pool(const world_snapshot_pool<Component> &pool, size_t num_entities) {
+    if constexpr(!std::is_empty_v<Component>) {
+        if (pool.components.size() != pool.indices.size()) {
+            return false;
+        }
+    }
+
+    // An entity can only have one component of each type.
+    auto present = std::vector<bool>(num_entities, false);
+
+    for (auto index : pool.indices) {
+        if (index >= num_entities || present[index]) {
+            return false;
+        }
+
+        present[index] = true;
+    }
+
+    return true;
+}
+
+bool is_valid_index(uint32_t index, size_t size) {
+    return index < size || index == world_snapshot_null_index;
+}
+
+bool is_valid_world_snapshot(const world_snapshot_data &data) {
+    auto num_entities = data.entities.size();
+    auto valid = std::apply([&](auto &... pools) {
+        return (is_valid_pool(pools, num_entities) && ...);
+    }, data.pools);
+
+    valid = valid &&
+        is_valid_pool(data.polyhedron_shapes, num_entities) &&
+        is_valid_pool(data.mesh_shapes, num_entities) &&
+        is_valid_pool(data.heightfield_shapes, num_entities) &&
+        is_valid_pool(data.islands, num_entities) &&
+        is_valid_pool(data.island_residents, num_entities) &&
+        is_valid_pool(data.multi_island_residents, num_entities) &&
+        is_valid_pool(data.graph_nodes, num_entities) &&
+        is_valid_pool(data.graph_edges, num_entities) &&
+        is_valid_pool(data.rigidbodies, num_entities) &&
+        is_valid_pool(data.constraints, num_entities);
+
+    if (!valid) {
+        return false;
+    }
+
+    for (auto &mesh : data.convex_meshes) {
+        if (!mesh->has_valid_faces()) return false;
+    }
+
+    for (auto &trimesh : data.triangle_meshes) {
+        if (!trimesh->is_valid()) return false;
+    }
+
+    for (auto index : data.polyhedron_shapes.components) {
+        if (index >= data.convex_meshes.size()) return false;
+    }
+
+    for (auto index : data.mesh_shapes.components) {
+        if (index >= data.triangle_meshes.size()) return false;
+    }
+
+    for (auto &field : data.heightfields) {
+        if (field.num_columns < 2 || field.num_rows < 2 ||
+            field.heights.size() != uint64_t(field.num_columns) * field.num_rows) {
+            return false;
+        }
+    }
+
+    for (auto index : data.heightfield_shapes.components) {
+        if (index >= data.heightfields.size()) return false;
+    }
+
+    for (auto &island : data.islands.components) {
+        for (auto index : island.nodes) {
+            if (index >= num_entities) return false;
+        }
+
+        for (auto index : island.edges) {
+            if (index >= num_entities) return false;
+        }
+    }
+
+    for (auto index : data.island_residents.components) {
+        if (!is_valid_index(index, num_entities)) return false;
+    }
+
+    for (auto &island_indices : data.multi_island_residents.components) {
+        for (auto index : island_indices) {
+            if (index >= num_entities) return false;
+        }
+    }
+
+    // The nodes of every edge must be in the graph.
+    auto is_node = std::vector<bool>(num_entities, false);
+
+    for (auto index : data.graph_nodes.indices) {
+        is_node[index] = true;
+    }
+
+    for (auto &node_indices : data.graph_edges.components) {
+        for (auto index : node_indices) {
+            if (index >= num_entities || !is_node[index]) return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<entt::entity> local_entities(const std::vector<entt::entity> &locals,
+                                         const std::vector<uint32_t> &indices) {
+    auto entities = std::vector<entt::entity>(indices.size());
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        entities[i] = locals[indices[i]];
+    }
+
+    return entities;
+}
+
+template<typename Component>
+void insert_pool(entt::registry &registry, const std::vector<entt::entity> &locals,
+                 const entity_map &emap, world_snapshot_pool<Component> &pool) {
+    if (pool.indices.empty()) return;
+
+    auto entities = local_entities(locals, pool.indices);
+
+    if constexpr(std::is_empty_v<Component>) {
+        registry.insert<Component>(entities.begin(), entities.end());
+    } else {
+        if (auto meta_type = entt::resolve<Component>(); meta_type) {
+            for (auto &component : pool.components) {
+                internal::map_child_entity_meta(emap, meta_type, component);
+            }
+        }
+
+        registry.insert<Component>(entities.begin(), entities.end(), pool.components.begin());
+    }
+}
+
+void load_world_snapshot_data(entt::registry &registry, world_snapshot_data &data,
+                              entity_map &emap) {
+    for (auto &mesh : data.convex_meshes) {
+        mesh->initialize();
+    }
+
+    auto locals = std::vector<entt::entity>(data.entities.size());
+    registry.create(locals.begin(), locals.end());
+
+    for (size_t i = 0; i < locals.size(); ++i) {
+        emap.insert(data.entities[i], locals[i]);
+    }
+
+    auto to_local = [&](uint32_t index) {
+        return index == world_snapshot_null_index ? entt::entity{entt::null} : locals[index];
+    };
+
+    std::apply([&](auto &... pools) {
+        (insert_pool(registry, locals, emap, pools), ...);
+    }, data.pools);
+
+    // Contact events are not stored, since they're consumed after every step.
+    auto &manifold_indices = std::get<world_snapshot_pool<contact_manifold>>(data.pools).indices;
+    auto manifold_entities = local_entities(locals, manifold_indices);
+    registry.insert<contact_manifold_events>(manifold_entities.begin(), manifold_entities.end());
+
+    {
+        auto entities = local_entities(locals, data.polyhedron_shapes.indices);
+        auto shapes = std::vector<polyhedron_shape>{};
+        shapes.reserve(entities.size());
+
+        for (auto index : data.polyhedron_shapes.components) {
+            shapes.emplace_back(data.convex_meshes[index]);
+        }
+
+        registry.insert<polyhedron_shape>(entities.begin(), entities.end(), shapes.begin());
+    }
+
+    {
+        auto entities = local_entities(locals, data.mesh_shapes.indices);
+        auto shapes = std::vector<mesh_shape>{};
+        shapes.reserve(entities.size());
+
+        for (auto index : data.mesh_shapes.components) {
+            shapes.push_back({data.triangle_meshes[index]});
+        }
+
+        registry.insert<mesh_shape>(entities.begin(), entities.end(), shapes.begin());
+    }
+
+    {
+        auto fields = std::vector<std::shared_ptr<heightfield>>{};
+        fields.reserve(data.heightfields.size());
+
+        for (auto &field : data.heightfields) {
+            auto &ptr = fields.emplace_back(std::make_shared<heightfield>(
+                field.num_columns, field.num_rows, field.spacing, field.origin,
+                std::move(field.heights), field.build_pyramid != 0));
+            ptr->set_thickness(field.thickness);
+        }
+
+        auto entities = local_entities(locals, data.heightfield_shapes.indices);
+        auto shapes = std::vector<heightfield_shape>{};
+        shapes.reserve(entities.size());
+
+        for (auto index : data.heightfield_shapes.components) {
+            shapes.push_back({fields[index]});
+        }
+
+        registry.insert<heightfield_shape>(entities.begin(), entities.end(), shapes.begin());
+    }
+
+    // Restore islands before inserting the graph nodes and edges, thus the
+    // island manager sees they already reside in an island.
+    {
+        auto entities = local_entities(locals, data.islands.indices);
+        auto islands = std::vector<island>(entities.size());
+
+        for (size_t i = 0; i < entities.size(); ++i) {
+            auto &snap_island = data.islands.components[i];
+
+            for (auto index : snap_island.nodes) {
+                islands[i].nodes.emplace(locals[index]);
+            }
+
+            for (auto index : snap_island.edges) {
+                islands[i].edges.emplace(locals[index]);
+            }
+        }
+
+        // Islands hold sparse sets, which can only be moved.
+        registry.insert<island>(entities.begin(), entities.end(), std::make_move_iterator(islands.begin()));
+    }
+
+    {
+        auto entities = local_entities(locals, data.island_residents.indices);
+        auto residents = std::vector<island_resident>{};
+        residents.reserve(entities.size());
+
+        for (auto index : data.island_residents.components) {
+            residents.push_back({to_local(index)});
+        }
+
+        registry.insert<island_resident>(entities.begin(), entities.end(), residents.begin());
+    }
+
+    {
+        auto entities = local_entities(locals, data.multi_island_residents.indices);
+        auto residents = std::vector<multi_island_resident>(entities.size());
+
+        for (size_t i = 0; i < entities.size(); ++i) {
+            for (auto index : data.multi_island_residents.components[i]) {
+                residents[i].island_entities.emplace(locals[index]);
+            }
+        }
+
+        registry.insert<multi_island_resident>(entities.begin(), entities.end(), std::make_move_iterator(residents.begin()));
+    }
+
+    auto &graph = registry.ctx().at<entity_graph>();
+    auto node_indices = std::vector<entity_graph::index_type>(locals.size());
+
+    {
+        auto entities = local_entities(locals, data.graph_nodes.indices);
+        auto nodes = std::vector<graph_node>{};
+        nodes.reserve(entities.size());
+
+        for (size_t i = 0; i < entities.size(); ++i) {
+            auto non_connecting = data.graph_nodes.components[i] != 0;
+            auto node_index = graph.insert_node(entities[i], non_connecting);
+            node_indices[data.graph_nodes.indices[i]] = node_index;
+            nodes.push_back({node_index});
+        }
+
+        registry.insert<graph_node>(entities.begin(), entities.end(), nodes.begin());
+    }
+
+    {
+        auto entities = local_entities(locals, data.graph_edges.indices);
+        auto edges = std::vector<graph_edge>{};
+        edges.reserve(entities.size());
+
+        for (size_t i = 0; i < entities.size(); ++i) {
+            auto &edge_nodes = data.graph_edges.components[i];
+            auto edge_index = graph.insert_edge(entities[i], node_indices[edge_nodes[0]], node_indices[edge_nodes[1]]);
+            edges.push_back({edge_index});
+        }
+
+        registry.insert<graph_edge>(entities.begin(), entities.end(), edges.begin());
+    }
+
+    // Assign tags last to signal that construction is complete.
+    insert_pool(registry, locals, emap, data.rigidbodies);
+    insert_pool(registry, locals, emap, data.constraints);
+}
+
+}
+
+void write_world_snapshot(entt::registry &registry, std::vector<uint8_t> &buffer) {
+    EDYN_ASSERT(registry.ctx().at<settings>().execution_mode != execution_mode::asynchronous,
+                "World snapshots are only supported in sequential execution modes.");
+
+    auto data = detail::world_snapshot_data{};
+    detail::fill_world_snapshot(registry, data);
+
+    auto archive = memory_output_archive(buffer);
+    write_binary_header(archive, detail::world_snapshot_magic, world_snapshot_version);
+    archive(data);
+}
+
+bool read_world_snapshot(entt::registry &registry, const uint8_t *data, size_t size,
+                         entity_map *emap) {
+    EDYN_ASSERT(registry.ctx().at<settings>().execution_mode != execution_mode::asynchronous,
+                "World snapshots are only supported in sequential execution modes.");
+
+    auto archive = memory_input_archive(data, size);
+
+    if (!read_binary_header(archive, detail::world_snapshot_magic, world_snapshot_version)) {
+        return false;
+    }
+
+    // Decode and validate everything before creating any entities.
+    auto snapshot = detail::world_snapshot_data{};
+    archive(snapshot);
+
+    if (archive.failed() || !detail::is_valid_world_snapshot(snapshot)) {
+        return false;
+    }
+
+    auto local_emap = entity_map{};
+    detail::load_world_snapshot_data(registry, snapshot, emap ? *emap : local_emap);
+
+    return true;
+}
+
+bool save_world_snapshot(entt::registry &registry, const std::string &path) {
+    auto buffer = std::vector<uint8_t>{};
+    write_world_snapshot(registry, buffer);
+
+    return write_binary_file(path, buffer);
+}
+
+bool load_world_snapshot(entt::registry &registry, const std::string &path,
+                         entity_map *emap) {
+    auto file = mapped_file{};
+
+    if (!file.open(path, mapped_file::access_pattern::sequential)) {
+        return false;
+    }
+
+    return read_world_snapshot(registry, file.data(), file.size(), emap);
+}
+
+}
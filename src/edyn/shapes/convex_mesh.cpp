@@ -21,6 +21,26 @@ void convex_mesh::update_calculated_properties() {
     calculate_relevant_edges();
 }
 
+bool convex_mesh::has_valid_faces() const {
+    if (vertices.size() < 4 || faces.size() < 8 || faces.size() % 2 != 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < faces.size(); i += 2) {
+        if (faces[i + 1] < 3 || size_t(faces[i]) + faces[i + 1] > indices.size()) {
+            return false;
+        }
+    }
+
+    for (auto idx : indices) {
+        if (idx >= vertices.size()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void convex_mesh::shift_to_centroid() {
     auto center = mesh_centroid(vertices, indices, faces);
 
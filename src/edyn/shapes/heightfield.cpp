@@ -0,0 +1,443 @@
+#include "edyn/shapes/heightfield.hpp"
+#include <cmath>
+
+namespace edyn {
+
+// Corners of a cell are numbered `(x, z)`, `(x + 1, z)`, `(x, z + 1)` and
+// `(x + 1, z + 1)`.
+static constexpr std::array<std::array<size_t, 2>, 4> cell_corner_offsets {{
+    {0, 0}, {1, 0}, {0, 1}, {1, 1}
+}};
+
+// Corners of the two triangles of a cell, counter-clockwise when seen from
+// above, i.e. facing the positive y direction.
+static constexpr std::array<std::array<size_t, 3>, 2> cell_triangle_corners {{
+    {0, 3, 1}, {0, 2, 3}
+}};
+
+// Edges are indexed by their first vertex and direction, i.e. the index of
+// an edge is `vertex_idx * 3 + direction`, where the direction is 0 for
+// edges along the x axis, 1 for edges along the z axis and 2 for diagonals.
+enum heightfield_edge_direction : size_t {
+    edge_direction_x,
+    edge_direction_z,
+    edge_direction_diagonal
+};
+
+struct triangle_edge_info {
+    // Corner where the edge index is based.
+    size_t corner;
+    heightfield_edge_direction direction;
+    // Cell offset and triangle of the adjacent triangle.
+    int adjacent_offset[2];
+    size_t adjacent_triangle;
+};
+
+// The i-th edge of a triangle goes from its i-th vertex to the next.
+static constexpr std::array<std::array<triangle_edge_info, 3>, 2> cell_triangle_edges {{
+    {{
+        {0, edge_direction_diagonal, {0, 0}, 1},
+        {1, edge_direction_z, {1, 0}, 1},
+        {0, edge_direction_x, {0, -1}, 1}
+    }},
+    {{
+        {0, edge_direction_z, {-1, 0}, 0},
+        {2, edge_direction_x, {0, 1}, 0},
+        {0, edge_direction_diagonal, {0, 0}, 0}
+    }}
+}};
+
+// Calculated the same way as in `triangle_mesh` so that both give the same
+// results for the same triangles.
+static vector3 calculate_triangle_normal(const triangle_vertices &vertices) {
+    auto e0 = vertices[1] - vertices[0];
+    auto e1 = vertices[2] - vertices[1];
+    return normalize(cross(e0, e1));
+}
+
+heightfield::heightfield(size_t num_columns, size_t num_rows, vector2 spacing, const vector3 &origin,
+                         std::vector<scalar> heights, bool build_pyramid)
+    : m_num_samples{num_columns, num_rows}
+    , m_num_cells{num_columns - 1, num_rows - 1}
+    , m_num_tiles{1, 1}
+    , m_tile_size(std::max(num_columns, num_rows) - 1)
+    , m_spacing(spacing)
+    , m_origin(origin)
+    , m_build_pyramid(build_pyramid)
+{
+    EDYN_ASSERT(num_columns > 1 && num_rows > 1);
+    EDYN_ASSERT(heights.size() == num_columns * num_rows);
+
+    init_tiles();
+
+    auto [min_it, max_it] = std::minmax_element(heights.begin(), heights.end());
+    m_bounds = {*min_it, *max_it};
+
+    m_tile_storage[0] = make_tile(0, std::move(heights));
+    m_tiles[0].store(m_tile_storage[0].get(), std::memory_order_release);
+}
+
+heightfield::heightfield(size_t num_columns, size_t num_rows, vector2 spacing, const vector3 &origin,
+                         height_range bounds, size_t tile_size,
+                         std::shared_ptr<heightfield_tile_loader_base> loader,
+                         bool build_pyramid)
+    : m_num_samples{num_columns, num_rows}
+    , m_num_cells{num_columns - 1, num_rows - 1}
+    , m_num_tiles{(num_columns - 1 + tile_size - 1) / tile_size,
+                  (num_rows - 1 + tile_size - 1) / tile_size}
+    , m_tile_size(tile_size)
+    , m_spacing(spacing)
+    , m_origin(origin)
+    , m_bounds(bounds)
+    , m_build_pyramid(build_pyramid)
+    , m_loader(loader)
+{
+    EDYN_ASSERT(num_columns > 1 && num_rows > 1);
+    EDYN_ASSERT(tile_size > 0);
+    EDYN_ASSERT(bounds.min <= bounds.max);
+    EDYN_ASSERT(m_loader);
+
+    init_tiles();
+}
+
+void heightfield::init_tiles() {
+    auto count = num_tiles();
+    m_tiles = std::make_unique<std::atomic<const tile *>[]>(count);
+    m_is_loading_tile = std::make_unique<std::atomic<bool>[]>(count);
+    m_tile_storage.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        m_tiles[i].store(nullptr, std::memory_order_relaxed);
+        m_is_loading_tile[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+AABB heightfield::get_aabb() const {
+    auto extent = vector3{m_num_cells[0] * m_spacing.x, 0, m_num_cells[1] * m_spacing.y};
+    return {
+        m_origin + vector3{0, m_bounds.min, 0},
+        m_origin + extent + vector3{0, m_bounds.max, 0}
+    };
+}
+
+void heightfield::get_tile_samples(size_t tile_idx, size_t &first_column, size_t &first_row,
+                                   size_t &num_columns, size_t &num_rows) const {
+    EDYN_ASSERT(tile_idx < num_tiles());
+    first_column = (tile_idx % m_num_tiles[0]) * m_tile_size;
+    first_row = (tile_idx / m_num_tiles[0]) * m_tile_size;
+    num_columns = std::min(m_tile_size, m_num_cells[0] - first_column) + 1;
+    num_rows = std::min(m_tile_size, m_num_cells[1] - first_row) + 1;
+}
+
+std::unique_ptr<heightfield::tile> heightfield::make_tile(size_t tile_idx, std::vector<scalar> heights) const {
+    auto result = std::make_unique<tile>();
+    get_tile_samples(tile_idx, result->first_column, result->first_row,
+                     result->num_columns, result->num_rows);
+    EDYN_ASSERT(heights.size() == result->num_columns * result->num_rows);
+
+    auto [min_it, max_it] = std::minmax_element(heights.begin(), heights.end());
+    result->range = {*min_it, *max_it};
+    result->heights = std::move(heights);
+
+    if (!m_build_pyramid) {
+        return result;
+    }
+
+    // The first level is calculated from the heights and each subsequent
+    // level from the previous one.
+    auto num_cells_x = result->num_columns - 1;
+    auto num_cells_z = result->num_rows - 1;
+
+    for (size_t level = 1; (size_t(1) << (level - 1)) < std::max(num_cells_x, num_cells_z); ++level) {
+        auto dim_x = (num_cells_x + (size_t(1) << level) - 1) >> level;
+        auto dim_z = (num_cells_z + (size_t(1) << level) - 1) >> level;
+        auto &blocks = result->pyramid.emplace_back(dim_x * dim_z);
+
+        for (size_t bz = 0; bz < dim_z; ++bz) {
+            for (size_t bx = 0; bx < dim_x; ++bx) {
+                auto range = height_range{EDYN_SCALAR_MAX, -EDYN_SCALAR_MAX};
+
+                if (level == 1) {
+                    // Samples of the 2x2 cells in this block.
+                    for (auto z = bz * 2; z <= std::min(bz * 2 + 2, num_cells_z); ++z) {
+                        for (auto x = bx * 2; x <= std::min(bx * 2 + 2, num_cells_x); ++x) {
+                            auto h = result->heights[z * result->num_columns + x];
+                            range.min = std::min(range.min, h);
+                            range.max = std::max(range.max, h);
+                        }
+                    }
+                } else {
+                    auto &prev = result->pyramid[level - 2];
+                    auto prev_dim_x = (num_cells_x + (size_t(1) << (level - 1)) - 1) >> (level - 1);
+                    auto prev_dim_z = (num_cells_z + (size_t(1) << (level - 1)) - 1) >> (level - 1);
+
+                    for (auto z = bz * 2; z < std::min(bz * 2 + 2, prev_dim_z); ++z) {
+                        for (auto x = bx * 2; x < std::min(bx * 2 + 2, prev_dim_x); ++x) {
+                            auto &child = prev[z * prev_dim_x + x];
+                            range.min = std::min(range.min, child.min);
+                            range.max = std::max(range.max, child.max);
+                        }
+                    }
+                }
+
+                blocks[bz * dim_x + bx] = range;
+            }
+        }
+    }
+
+    return result;
+}
+
+void heightfield::assign_tile(size_t tile_idx, std::vector<scalar> heights) {
+    EDYN_ASSERT(tile_idx < num_tiles());
+    auto new_tile = make_tile(tile_idx, std::move(heights));
+    EDYN_ASSERT(new_tile->range.min >= m_bounds.min && new_tile->range.max <= m_bounds.max,
+                "Heights of tile are outside of the bounds of the heightfield.");
+
+    auto lock = std::lock_guard(m_mutex);
+    m_tiles[tile_idx].store(new_tile.get(), std::memory_order_release);
+    m_tile_storage[tile_idx] = std::move(new_tile);
+    m_is_loading_tile[tile_idx].store(false, std::memory_order_release);
+}
+
+void heightfield::unload_tile(size_t tile_idx) {
+    EDYN_ASSERT(tile_idx < num_tiles());
+    auto lock = std::lock_guard(m_mutex);
+    m_tiles[tile_idx].store(nullptr, std::memory_order_release);
+    m_tile_storage[tile_idx].reset();
+}
+
+void heightfield::prefetch(const AABB &aabb) {
+    std::array<size_t, 2> cell_min, cell_max;
+
+    if (!m_loader || !get_cell_range(aabb, cell_min, cell_max)) {
+        return;
+    }
+
+    for (auto tz = cell_min[1] / m_tile_size; tz <= cell_max[1] / m_tile_size; ++tz) {
+        for (auto tx = cell_min[0] / m_tile_size; tx <= cell_max[0] / m_tile_size; ++tx) {
+            start_loading(tz * m_num_tiles[0] + tx);
+        }
+    }
+}
+
+void heightfield::start_loading(size_t tile_idx) {
+    if (is_tile_loaded(tile_idx)) {
+        return;
+    }
+
+    if (m_is_loading_tile[tile_idx].exchange(true, std::memory_order_acquire)) {
+        return;
+    }
+
+    m_loader->load(this, tile_idx);
+}
+
+bool heightfield::get_cell_range(const AABB &aabb, std::array<size_t, 2> &cell_min,
+                                 std::array<size_t, 2> &cell_max) const {
+    auto min = aabb.min - m_origin;
+    auto max = aabb.max - m_origin;
+    scalar lower[] = {min.x / m_spacing.x, min.z / m_spacing.y};
+    scalar upper[] = {max.x / m_spacing.x, max.z / m_spacing.y};
+
+    for (int i = 0; i < 2; ++i) {
+        auto num_cells = static_cast<scalar>(m_num_cells[i]);
+
+        if (upper[i] < 0 || lower[i] > num_cells) {
+            return false;
+        }
+
+        cell_min[i] = static_cast<size_t>(std::max(std::floor(lower[i]), scalar(0)));
+        cell_max[i] = static_cast<size_t>(std::min(std::floor(upper[i]), num_cells - 1));
+    }
+
+    return true;
+}
+
+const heightfield::tile * heightfield::get_cell_tile(size_t column, size_t row) const {
+    auto tile_idx = (row / m_tile_size) * m_num_tiles[0] + column / m_tile_size;
+    return m_tiles[tile_idx].load(std::memory_order_acquire);
+}
+
+scalar heightfield::get_height(size_t column, size_t row) const {
+    EDYN_ASSERT(column < m_num_samples[0] && row < m_num_samples[1]);
+    // Samples in the last column and row are part of the tiles of the
+    // previous cell.
+    auto cell_column = std::min(column, m_num_cells[0] - 1);
+    auto cell_row = std::min(row, m_num_cells[1] - 1);
+    auto *tile = get_cell_tile(cell_column, cell_row);
+
+    // Samples in the first column or row of a tile are shared with the tiles
+    // of the previous cells, which might be loaded instead.
+    auto on_column_border = column == cell_column && column > 0 && column % m_tile_size == 0;
+    auto on_row_border = row == cell_row && row > 0 && row % m_tile_size == 0;
+
+    if (!tile && on_column_border) {
+        tile = get_cell_tile(cell_column - 1, cell_row);
+    }
+
+    if (!tile && on_row_border) {
+        tile = get_cell_tile(cell_column, cell_row - 1);
+    }
+
+    if (!tile && on_column_border && on_row_border) {
+        tile = get_cell_tile(cell_column - 1, cell_row - 1);
+    }
+
+    EDYN_ASSERT(tile != nullptr);
+    return tile->heights[(row - tile->first_row) * tile->num_columns + column - tile->first_column];
+}
+
+vector3 heightfield::get_vertex_position(size_t vertex_idx) const {
+    auto column = vertex_idx % m_num_samples[0];
+    auto row = vertex_idx / m_num_samples[0];
+    return m_origin + vector3{column * m_spacing.x, get_height(column, row), row * m_spacing.y};
+}
+
+triangle_vertices heightfield::get_triangle_vertices(size_t tri_idx) const {
+    EDYN_ASSERT(tri_idx < num_triangles());
+    auto cell_idx = tri_idx / 2;
+    auto column = cell_idx % m_num_cells[0];
+    auto row = cell_idx / m_num_cells[0];
+    auto *tile = get_cell_tile(column, row);
+    EDYN_ASSERT(tile != nullptr);
+
+    auto heights = get_cell_heights(*tile, column - tile->first_column, row - tile->first_row);
+    auto &corners = cell_triangle_corners[tri_idx % 2];
+    auto vertices = triangle_vertices{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto &offset = cell_corner_offsets[corners[i]];
+        vertices[i] = m_origin + vector3{
+            (column + offset[0]) * m_spacing.x,
+            heights[corners[i]],
+            (row + offset[1]) * m_spacing.y
+        };
+    }
+
+    return vertices;
+}
+
+vector3 heightfield::get_triangle_normal(size_t tri_idx) const {
+    auto vertices = get_triangle_vertices(tri_idx);
+    return calculate_triangle_normal(vertices);
+}
+
+heightfield::index_type heightfield::get_face_vertex_index(size_t tri_idx, size_t vertex_idx) const {
+    EDYN_ASSERT(tri_idx < num_triangles());
+    EDYN_ASSERT(vertex_idx < 3);
+    auto cell_idx = tri_idx / 2;
+    auto column = cell_idx % m_num_cells[0];
+    auto row = cell_idx / m_num_cells[0];
+    auto &offset = cell_corner_offsets[cell_triangle_corners[tri_idx % 2][vertex_idx]];
+    return static_cast<index_type>((row + offset[1]) * m_num_samples[0] + column + offset[0]);
+}
+
+heightfield::index_type heightfield::get_face_edge_index(size_t tri_idx, size_t edge_idx) const {
+    EDYN_ASSERT(tri_idx < num_triangles());
+    EDYN_ASSERT(edge_idx < 3);
+    auto cell_idx = tri_idx / 2;
+    auto column = cell_idx % m_num_cells[0];
+    auto row = cell_idx / m_num_cells[0];
+    auto &edge = cell_triangle_edges[tri_idx % 2][edge_idx];
+    auto &offset = cell_corner_offsets[edge.corner];
+    auto vertex_idx = (row + offset[1]) * m_num_samples[0] + column + offset[0];
+    return static_cast<index_type>(vertex_idx * 3 + edge.direction);
+}
+
+bool heightfield::get_adjacent_triangle(size_t tri_idx, size_t edge_idx, size_t &adj_tri_idx) const {
+    auto cell_idx = tri_idx / 2;
+    auto column = static_cast<int>(cell_idx % m_num_cells[0]);
+    auto row = static_cast<int>(cell_idx / m_num_cells[0]);
+    auto &edge = cell_triangle_edges[tri_idx % 2][edge_idx];
+    auto adj_column = column + edge.adjacent_offset[0];
+    auto adj_row = row + edge.adjacent_offset[1];
+
+    if (adj_column < 0 || adj_row < 0 ||
+        adj_column >= static_cast<int>(m_num_cells[0]) ||
+        adj_row >= static_cast<int>(m_num_cells[1])) {
+        return false;
+    }
+
+    if (get_cell_tile(adj_column, adj_row) == nullptr) {
+        return false;
+    }
+
+    adj_tri_idx = get_cell_triangle_index(adj_column, adj_row) + edge.adjacent_triangle;
+    return true;
+}
+
+vector3 heightfield::get_adjacent_face_normal(size_t tri_idx, size_t edge_idx) const {
+    EDYN_ASSERT(tri_idx < num_triangles());
+    EDYN_ASSERT(edge_idx < 3);
+    size_t adj_tri_idx;
+
+    if (get_adjacent_triangle(tri_idx, edge_idx, adj_tri_idx)) {
+        return get_triangle_normal(adj_tri_idx);
+    }
+
+    // Boundary edge. Make adjacent normal point slightly away in the edge
+    // direction to form a near 180 degree angle, as in `triangle_mesh`.
+    auto vertices = get_triangle_vertices(tri_idx);
+    auto normal = calculate_triangle_normal(vertices);
+    auto edge_dir = vertices[(edge_idx + 1) % 3] - vertices[edge_idx];
+    auto edge_normal = cross(normal, edge_dir);
+    return -normalize(normal + edge_normal * 0.1);
+}
+
+bool heightfield::is_convex_edge(size_t edge_idx) const {
+    auto vertex_idx = edge_idx / 3;
+    auto column = vertex_idx % m_num_samples[0];
+    auto row = vertex_idx / m_num_samples[0];
+
+    // Find a triangle which contains the edge, i.e. the triangle whose edge
+    // is based at the corner of the cell at the first vertex of the edge, or
+    // otherwise, the triangle on the other side.
+    size_t tri_idx, tri_edge_idx;
+
+    switch (static_cast<heightfield_edge_direction>(edge_idx % 3)) {
+    case edge_direction_x:
+        if (column >= m_num_cells[0]) {
+            return true;
+        } else if (row < m_num_cells[1]) {
+            tri_idx = get_cell_triangle_index(column, row);
+            tri_edge_idx = 2;
+        } else {
+            tri_idx = get_cell_triangle_index(column, row - 1) + 1;
+            tri_edge_idx = 1;
+        }
+        break;
+    case edge_direction_z:
+        if (row >= m_num_cells[1]) {
+            return true;
+        } else if (column < m_num_cells[0]) {
+            tri_idx = get_cell_triangle_index(column, row) + 1;
+            tri_edge_idx = 0;
+        } else {
+            tri_idx = get_cell_triangle_index(column - 1, row);
+            tri_edge_idx = 1;
+        }
+        break;
+    default:
+        EDYN_ASSERT(column < m_num_cells[0] && row < m_num_cells[1]);
+        tri_idx = get_cell_triangle_index(column, row);
+        tri_edge_idx = 0;
+    }
+
+    // Boundary edges are always convex.
+    size_t adj_tri_idx;
+
+    if (get_cell_tile(tri_idx / 2 % m_num_cells[0], tri_idx / 2 / m_num_cells[0]) == nullptr ||
+        !get_adjacent_triangle(tri_idx, tri_edge_idx, adj_tri_idx)) {
+        return true;
+    }
+
+    auto vertices = get_triangle_vertices(tri_idx);
+    auto normal = calculate_triangle_normal(vertices);
+    auto edge_dir = vertices[(tri_edge_idx + 1) % 3] - vertices[tri_edge_idx];
+    auto edge_normal = cross(normal, edge_dir);
+
+    return dot(get_triangle_normal(adj_tri_idx), edge_normal) < -EDYN_EPSILON;
+}
+
+}
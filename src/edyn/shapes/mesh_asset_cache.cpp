@@ -0,0 +1,412 @@
+#include "edyn/shapes/mesh_asset_cache.hpp"
+#include "edyn/shapes/convex_mesh.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+#include "edyn/dynamics/moment_of_inertia.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+#include <cstring>
+
+namespace edyn {
+
+namespace {
+
+// Hashes 8 bytes at a time. Not suitable for cryptographic purposes but
+// collisions are improbable enough for content identification.
+class content_hasher {
+public:
+    template<typename T>
+    void add(const std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        add(values.size());
+        add_bytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void add(uint64_t value) {
+        m_hash = (m_hash ^ mix(value)) * 0x9e3779b97f4a7c15ull;
+        m_hash = (m_hash << 29) | (m_hash >> 35);
+    }
+
+    void add_bytes(const void *data, size_t size) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        auto end = bytes + (size & ~size_t(7));
+
+        for (; bytes != end; bytes += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes, 8);
+            add(word);
+        }
+
+        if (auto rest = size & 7; rest > 0) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes, rest);
+            add(word);
+        }
+    }
+
+    uint64_t value() const {
+        return mix(m_hash);
+    }
+
+private:
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    uint64_t m_hash {0x6a09e667f3bcc908ull};
+};
+
+}
+
+mesh_asset_cache::hash_type content_hash(const convex_mesh &mesh) {
+    auto hasher = content_hasher{};
+    hasher.add(mesh.vertices);
+    hasher.add(mesh.indices);
+    hasher.add(mesh.faces);
+    return hasher.value();
+}
+
+mesh_asset_cache::hash_type content_hash(const triangle_mesh &mesh) {
+    auto hasher = content_hasher{};
+    hasher.add(mesh.m_vertices);
+    hasher.add(mesh.m_indices);
+    hasher.add(mesh.m_friction);
+    hasher.add(mesh.m_restitution);
+    hasher.add(mesh.m_material_ids);
+    hasher.add_bytes(&mesh.m_thickness, sizeof(mesh.m_thickness));
+    return hasher.value();
+}
+
+mesh_asset_cache::hash_type content_hash(const std::vector<vector3> &vertices,
+                                         const std::vector<uint32_t> &indices) {
+    auto hasher = content_hasher{};
+    hasher.add(vertices);
+    hasher.add(indices);
+    return hasher.value();
+}
+
+mesh_asset_cache &mesh_asset_cache::global() {
+    static mesh_asset_cache instance;
+    return instance;
+}
+
+bool mesh_asset_cache::same_contents(const convex_mesh &a, const convex_mesh &b) {
+    return a.vertices == b.vertices && a.indices == b.indices && a.faces == b.faces;
+}
+
+bool mesh_asset_cache::same_contents(const triangle_mesh &a, const triangle_mesh &b) {
+    return a.m_vertices == b.m_vertices && a.m_indices == b.m_indices &&
+           a.m_friction == b.m_friction && a.m_restitution == b.m_restitution &&
+           a.m_material_ids == b.m_material_ids && a.m_thickness == b.m_thickness;
+}
+
+std::shared_ptr<convex_mesh> mesh_asset_cache::intern_locked(std::shared_ptr<convex_mesh> mesh,
+                                                             hash_type hash, const matrix3x3 &unit_inertia,
+                                                             bool replicate_by_hash) {
+    auto it = m_convex_meshes.find(hash);
+
+    if (it != m_convex_meshes.end()) {
+        auto &entry = it->second;
+
+        if (auto existing = entry.mesh.lock()) {
+            // Treat hash collisions as distinct meshes which are not interned.
+            if (existing != mesh && !same_contents(*existing, *mesh)) {
+                return mesh;
+            }
+
+            if (replicate_by_hash) {
+                entry.pinned = existing;
+            }
+
+            return existing;
+        }
+
+        // The previous mesh was freed. Take over the entry.
+        m_convex_meshes.erase(it);
+    }
+
+    auto entry = convex_entry{};
+    entry.mesh = mesh;
+    entry.unit_inertia = unit_inertia;
+
+    if (replicate_by_hash) {
+        entry.pinned = mesh;
+    }
+
+    m_convex_meshes.emplace(hash, std::move(entry));
+    m_convex_hashes[mesh.get()] = hash;
+    purge_if_grown_locked();
+
+    return mesh;
+}
+
+std::shared_ptr<triangle_mesh> mesh_asset_cache::intern_locked(std::shared_ptr<triangle_mesh> mesh,
+                                                               hash_type hash) {
+    auto it = m_triangle_meshes.find(hash);
+
+    if (it != m_triangle_meshes.end()) {
+        if (auto existing = it->second.mesh.lock()) {
+            // Treat hash collisions as distinct meshes which are not interned.
+            if (existing != mesh && !same_contents(*existing, *mesh)) {
+                return mesh;
+            }
+
+            return existing;
+        }
+
+        m_triangle_meshes.erase(it);
+    }
+
+    mesh->m_interned.value = true;
+    m_triangle_meshes.emplace(hash, triangle_entry{mesh});
+    purge_if_grown_locked();
+
+    return mesh;
+}
+
+std::shared_ptr<triangle_mesh> mesh_asset_cache::find_same(const triangle_mesh &mesh, hash_type hash) const {
+    auto existing = find_triangle_mesh(hash);
+
+    // Interned meshes are immutable, thus contents can be compared outside of
+    // the lock.
+    if (existing && (existing.get() == &mesh || same_contents(*existing, mesh))) {
+        return existing;
+    }
+
+    return {};
+}
+
+std::shared_ptr<convex_mesh> mesh_asset_cache::intern(std::shared_ptr<convex_mesh> mesh,
+                                                      bool replicate_by_hash) {
+    EDYN_ASSERT(mesh);
+    // Calculate outside of the lock since it's proportional to the mesh size.
+    auto hash = content_hash(*mesh);
+    auto unit_inertia = moment_of_inertia_polyhedron(1, mesh->vertices, mesh->indices, mesh->faces);
+    auto lock = std::lock_guard(m_mutex);
+    return intern_locked(std::move(mesh), hash, unit_inertia, replicate_by_hash);
+}
+
+std::shared_ptr<triangle_mesh> mesh_asset_cache::intern(std::shared_ptr<triangle_mesh> mesh) {
+    EDYN_ASSERT(mesh);
+    auto hash = content_hash(*mesh);
+
+    if (auto existing = find_same(*mesh, hash)) {
+        return existing;
+    }
+
+    auto lock = std::lock_guard(m_mutex);
+    return intern_locked(std::move(mesh), hash);
+}
+
+std::shared_ptr<convex_mesh> mesh_asset_cache::make_convex_mesh(const std::vector<vector3> &vertices,
+                                                                const std::vector<uint32_t> &indices,
+                                                                const std::vector<uint32_t> &faces,
+                                                                bool replicate_by_hash) {
+    auto hasher = content_hasher{};
+    hasher.add(vertices);
+    hasher.add(indices);
+    hasher.add(faces);
+    auto source_hash = hasher.value();
+
+    {
+        auto lock = std::lock_guard(m_mutex);
+        auto source_it = m_convex_sources.find(source_hash);
+
+        if (source_it != m_convex_sources.end()) {
+            auto it = m_convex_meshes.find(source_it->second);
+
+            if (it != m_convex_meshes.end()) {
+                if (auto existing = it->second.mesh.lock()) {
+                    if (replicate_by_hash) {
+                        it->second.pinned = existing;
+                    }
+
+                    return existing;
+                }
+            }
+        }
+    }
+
+    // Initialize outside of the lock. If another thread creates the same mesh
+    // meanwhile, the first one to be interned wins.
+    auto mesh = std::make_shared<convex_mesh>();
+    mesh->vertices = vertices;
+    mesh->indices = indices;
+    mesh->faces = faces;
+    mesh->initialize();
+
+    auto hash = content_hash(*mesh);
+    auto unit_inertia = moment_of_inertia_polyhedron(1, mesh->vertices, mesh->indices, mesh->faces);
+    auto lock = std::lock_guard(m_mutex);
+    mesh = intern_locked(std::move(mesh), hash, unit_inertia, replicate_by_hash);
+    m_convex_sources[source_hash] = hash;
+
+    return mesh;
+}
+
+std::shared_ptr<triangle_mesh> mesh_asset_cache::make_triangle_mesh(const std::vector<vector3> &vertices,
+                                                                    const std::vector<uint32_t> &indices) {
+    EDYN_ASSERT(indices.size() % 3 == 0);
+    auto mesh = std::make_shared<triangle_mesh>();
+    mesh->insert_vertices(vertices.begin(), vertices.end());
+    mesh->insert_indices(indices.begin(), indices.end());
+
+    // Vertices are not modified by initialization, thus the mesh can be
+    // compared before the expensive part.
+    auto hash = content_hash(*mesh);
+
+    if (auto existing = find_same(*mesh, hash)) {
+        return existing;
+    }
+
+    mesh->initialize();
+
+    auto lock = std::lock_guard(m_mutex);
+    return intern_locked(std::move(mesh), hash);
+}
+
+std::shared_ptr<convex_mesh> mesh_asset_cache::find_convex_mesh(hash_type hash) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_convex_meshes.find(hash);
+
+    if (it == m_convex_meshes.end()) {
+        return {};
+    }
+
+    return it->second.mesh.lock();
+}
+
+std::shared_ptr<triangle_mesh> mesh_asset_cache::find_triangle_mesh(hash_type hash) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_triangle_meshes.find(hash);
+
+    if (it == m_triangle_meshes.end()) {
+        return {};
+    }
+
+    return it->second.mesh.lock();
+}
+
+const mesh_asset_cache::convex_entry * mesh_asset_cache::find_entry(const convex_mesh *mesh,
+                                                                    hash_type &hash) const {
+    auto hash_it = m_convex_hashes.find(mesh);
+
+    if (hash_it == m_convex_hashes.end()) {
+        return nullptr;
+    }
+
+    auto it = m_convex_meshes.find(hash_it->second);
+
+    // The address might belong to a freed mesh and have been reused by a mesh
+    // which is not interned.
+    if (it == m_convex_meshes.end() || it->second.mesh.lock().get() != mesh) {
+        return nullptr;
+    }
+
+    hash = hash_it->second;
+    return &it->second;
+}
+
+bool mesh_asset_cache::get_hash(const convex_mesh *mesh, hash_type &hash) const {
+    auto lock = std::lock_guard(m_mutex);
+    return find_entry(mesh, hash) != nullptr;
+}
+
+bool mesh_asset_cache::get_replicated_hash(const convex_mesh *mesh, hash_type &hash) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto entry = find_entry(mesh, hash);
+    return entry != nullptr && entry->pinned;
+}
+
+bool mesh_asset_cache::get_unit_inertia(const convex_mesh *mesh, matrix3x3 &inertia) const {
+    auto lock = std::lock_guard(m_mutex);
+    hash_type hash;
+
+    if (auto entry = find_entry(mesh, hash)) {
+        inertia = entry->unit_inertia;
+        return true;
+    }
+
+    return false;
+}
+
+size_t mesh_asset_cache::purge_expired() {
+    auto lock = std::lock_guard(m_mutex);
+    return purge_expired_locked();
+}
+
+void mesh_asset_cache::purge_if_grown_locked() {
+    // Purge once the number of entries has doubled since the last purge, thus
+    // the cost is amortized over the insertions.
+    if (m_convex_meshes.size() + m_triangle_meshes.size() < m_purge_threshold) {
+        return;
+    }
+
+    purge_expired_locked();
+    m_purge_threshold = std::max(min_purge_threshold,
+                                 2 * (m_convex_meshes.size() + m_triangle_meshes.size()));
+}
+
+size_t mesh_asset_cache::purge_expired_locked() {
+    auto count = size_t{0};
+
+    for (auto it = m_convex_meshes.begin(); it != m_convex_meshes.end();) {
+        if (it->second.mesh.expired()) {
+            it = m_convex_meshes.erase(it);
+            ++count;
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_triangle_meshes.begin(); it != m_triangle_meshes.end();) {
+        if (it->second.mesh.expired()) {
+            it = m_triangle_meshes.erase(it);
+            ++count;
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_convex_hashes.begin(); it != m_convex_hashes.end();) {
+        if (m_convex_meshes.count(it->second) == 0) {
+            it = m_convex_hashes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_convex_sources.begin(); it != m_convex_sources.end();) {
+        if (m_convex_meshes.count(it->second) == 0) {
+            it = m_convex_sources.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return count;
+}
+
+void mesh_asset_cache::clear() {
+    auto lock = std::lock_guard(m_mutex);
+    m_convex_meshes.clear();
+    m_triangle_meshes.clear();
+    m_convex_hashes.clear();
+    m_convex_sources.clear();
+}
+
+size_t mesh_asset_cache::num_convex_meshes() const {
+    auto lock = std::lock_guard(m_mutex);
+    return m_convex_meshes.size();
+}
+
+size_t mesh_asset_cache::num_triangle_meshes() const {
+    auto lock = std::lock_guard(m_mutex);
+    return m_triangle_meshes.size();
+}
+
+}
@@ -1,11 +1,9 @@
 #include "edyn/shapes/paged_triangle_mesh.hpp"
-#include "edyn/parallel/message.hpp"
 #include "edyn/parallel/parallel_for.hpp"
 #include <atomic>
 #include <limits>
 #include <mutex>
 #include <entt/entity/registry.hpp>
-#include "edyn/parallel/message_dispatcher.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/util/paged_mesh_load_reporting.hpp"
 
@@ -30,8 +28,73 @@ size_t paged_triangle_mesh::cache_num_vertices() const {
     return count;
 }
 
+// Estimates the memory taken by a submesh from its number of vertices and
+// indices, which is known before it's loaded. The number of edges is
+// approximated using Euler's formula for a planar graph.
+static size_t estimate_submesh_size(const paged_triangle_mesh::triangle_mesh_node &node) {
+    using index_type = triangle_mesh::index_type;
+    auto num_triangles = node.num_indices / 3;
+    auto num_edges = node.num_vertices + num_triangles;
+
+    auto vertex_size = sizeof(vector3) + sizeof(index_type);
+    auto triangle_size =
+        3 * sizeof(index_type) + // Indices.
+        4 * sizeof(vector3) + // Normal and adjacent normals.
+        3 * sizeof(index_type) + // Edge indices.
+        2 * sizeof(static_tree::tree_node); // Triangle tree.
+    auto edge_size =
+        4 * sizeof(index_type) + // Vertex and face indices.
+        2 * sizeof(index_type) + // Vertex edge indices.
+        1; // Flags.
+
+    return sizeof(triangle_mesh) +
+        node.num_vertices * vertex_size +
+        num_triangles * triangle_size +
+        num_edges * edge_size;
+}
+
+void paged_triangle_mesh::init_cache() {
+    auto num_submeshes = m_cache.size();
+    m_recently_visited = std::make_unique<std::atomic<bool>[]>(num_submeshes);
+    m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(num_submeshes);
+    m_clock_hand = 0;
+
+    size_t cache_size = 0;
+
+    for (auto &node : m_cache) {
+        if (node.trimesh) {
+            cache_size += estimate_submesh_size(node);
+        }
+    }
+
+    m_cache_size.store(cache_size, std::memory_order_relaxed);
+}
+
 void paged_triangle_mesh::load_node_if_needed(size_t trimesh_idx) {
     EDYN_ASSERT(m_is_loading_submesh && trimesh_idx < m_cache.size());
+
+    if (m_cache[trimesh_idx].trimesh) {
+        m_num_hits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_num_misses.fetch_add(1, std::memory_order_relaxed);
+    start_loading(trimesh_idx, false);
+}
+
+void paged_triangle_mesh::prefetch(const AABB &aabb) {
+    m_tree.query(aabb, [&](auto tree_node_idx) {
+        auto mesh_idx = m_tree.get_node(tree_node_idx).id;
+
+        if (m_cache[mesh_idx].trimesh) {
+            mark_recent_visit(mesh_idx);
+        } else {
+            start_loading(mesh_idx, true);
+        }
+    });
+}
+
+void paged_triangle_mesh::start_loading(size_t trimesh_idx, bool prefetch) {
     auto already_loading = m_is_loading_submesh[trimesh_idx].exchange(true, std::memory_order_relaxed);
 
     if (already_loading) {
@@ -47,35 +110,83 @@ void paged_triangle_mesh::load_node_if_needed(size_t trimesh_idx) {
         return;
     }
 
-    EDYN_ASSERT(node.num_vertices < m_max_cache_num_vertices);
+    auto size = estimate_submesh_size(node);
+    EDYN_ASSERT(size < m_max_cache_size);
+
+    // Reserve space for the submesh in the cache before loading it, unloading
+    // the least recently visited submeshes if it would go above the limit.
+    {
+        auto lock = std::lock_guard(m_cache_mutex);
+
+        while (m_cache_size.load(std::memory_order_relaxed) + size > m_max_cache_size) {
+            if (!unload_least_recently_visited_node()) {
+                break;
+            }
+        }
+
+        m_cache_size.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    m_num_loads.fetch_add(1, std::memory_order_relaxed);
+    m_num_loads_in_flight.fetch_add(1, std::memory_order_relaxed);
 
-    // Load triangle mesh into cache. Clear cache if it would go
-    // above limits.
-    while (cache_num_vertices() + node.num_vertices > m_max_cache_num_vertices) {
-        unload_least_recently_visited_node();
+    if (prefetch) {
+        m_num_prefetches.fetch_add(1, std::memory_order_relaxed);
     }
 
     m_page_loader->load(this, trimesh_idx);
 }
 
 void paged_triangle_mesh::mark_recent_visit(size_t trimesh_idx) {
-    auto lock = std::lock_guard(m_lru_mutex);
-    auto it = std::find(m_lru_indices.begin(), m_lru_indices.end(), trimesh_idx);
-    std::rotate(m_lru_indices.begin(), it, it + 1);
+    m_recently_visited[trimesh_idx].store(true, std::memory_order_relaxed);
 }
 
-void paged_triangle_mesh::unload_least_recently_visited_node() {
-    auto lock = std::lock_guard(m_lru_mutex);
+bool paged_triangle_mesh::unload_least_recently_visited_node() {
+    // Must be called with `m_cache_mutex` locked. Each flag is cleared in the
+    // first pass, thus a loaded submesh is found in the second pass, if any.
+    auto num_submeshes = m_cache.size();
 
-    for (auto it = m_lru_indices.rbegin(); it != m_lru_indices.rend(); ++it) {
-        auto &node = m_cache[*it];
+    for (size_t i = 0; i < 2 * num_submeshes; ++i) {
+        auto idx = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % num_submeshes;
+        auto &node = m_cache[idx];
 
-        if (node.trimesh) {
-            node.trimesh.reset();
-            message_dispatcher::global().send<msg::paged_triangle_mesh_load_page>({internal::paged_mesh_load_queue_identifier}, {}, this, *it);
-            break;
+        if (!node.trimesh) {
+            continue;
+        }
+
+        if (m_recently_visited[idx].exchange(false, std::memory_order_relaxed)) {
+            continue;
         }
+
+        node.trimesh.reset();
+        m_cache_size.fetch_sub(estimate_submesh_size(node), std::memory_order_relaxed);
+        m_num_evictions.fetch_add(1, std::memory_order_relaxed);
+        internal::report_paged_mesh_page_load(this, idx);
+        return true;
     }
+
+    return false;
+}
+
+paged_triangle_mesh::cache_stats paged_triangle_mesh::get_cache_stats() const {
+    auto stats = cache_stats{};
+    stats.hits = m_num_hits.load(std::memory_order_relaxed);
+    stats.misses = m_num_misses.load(std::memory_order_relaxed);
+    stats.loads = m_num_loads.load(std::memory_order_relaxed);
+    stats.prefetches = m_num_prefetches.load(std::memory_order_relaxed);
+    stats.evictions = m_num_evictions.load(std::memory_order_relaxed);
+    stats.loads_in_flight = m_num_loads_in_flight.load(std::memory_order_relaxed);
+    stats.cache_size = m_cache_size.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void paged_triangle_mesh::reset_cache_stats() {
+    m_num_hits.store(0, std::memory_order_relaxed);
+    m_num_misses.store(0, std::memory_order_relaxed);
+    m_num_loads.store(0, std::memory_order_relaxed);
+    m_num_prefetches.store(0, std::memory_order_relaxed);
+    m_num_evictions.store(0, std::memory_order_relaxed);
 }
 
 triangle_vertices paged_triangle_mesh::get_triangle_vertices(size_t mesh_idx, size_t tri_idx) const {
@@ -85,19 +196,43 @@ triangle_vertices paged_triangle_mesh::get_triangle_vertices(size_t mesh_idx, si
 }
 
 void paged_triangle_mesh::clear_cache() {
+    auto lock = std::lock_guard(m_cache_mutex);
+
     for (auto &node : m_cache) {
-        node.trimesh.reset();
+        if (node.trimesh) {
+            node.trimesh.reset();
+            m_cache_size.fetch_sub(estimate_submesh_size(node), std::memory_order_relaxed);
+        }
     }
 }
 
 void paged_triangle_mesh::assign_mesh(size_t index, std::shared_ptr<triangle_mesh> mesh) {
     // Use lock to prevent assigning to the same trimesh shared_ptr concurrently
     // if `unload_least_recently_visited_node` is executing in another thread.
-    auto lock = std::lock_guard(m_lru_mutex);
-    m_cache[index].trimesh = mesh;
+    auto lock = std::lock_guard(m_cache_mutex);
+    auto &node = m_cache[index];
+    auto was_loaded = static_cast<bool>(node.trimesh);
+    node.trimesh = mesh;
     mesh->set_thickness(m_thickness);
-    m_is_loading_submesh[index].store(false, std::memory_order_release);
-    message_dispatcher::global().send<msg::paged_triangle_mesh_load_page>({internal::paged_mesh_load_queue_identifier}, {}, this, index);
+    m_recently_visited[index].store(true, std::memory_order_relaxed);
+
+    if (m_is_loading_submesh[index].exchange(false, std::memory_order_release)) {
+        // Space was reserved when the load started.
+        m_num_loads_in_flight.fetch_sub(1, std::memory_order_relaxed);
+    } else if (!was_loaded) {
+        m_cache_size.fetch_add(estimate_submesh_size(node), std::memory_order_relaxed);
+    }
+
+    internal::report_paged_mesh_page_load(this, index);
+}
+
+void paged_triangle_mesh::cancel_loading(size_t index) {
+    auto lock = std::lock_guard(m_cache_mutex);
+
+    if (m_is_loading_submesh[index].exchange(false, std::memory_order_relaxed)) {
+        m_cache_size.fetch_sub(estimate_submesh_size(m_cache[index]), std::memory_order_relaxed);
+        m_num_loads_in_flight.fetch_sub(1, std::memory_order_relaxed);
+    }
 }
 
 bool paged_triangle_mesh::has_per_vertex_friction() const {
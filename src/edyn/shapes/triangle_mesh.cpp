@@ -1,8 +1,11 @@
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/comp/aabb.hpp"
+#include "edyn/parallel/parallel_for.hpp"
 #include <array>
 #include <limits>
-#include <set>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
 
 namespace edyn {
 
@@ -15,21 +18,36 @@ void triangle_mesh::initialize() {
 }
 
 void triangle_mesh::calculate_face_normals() {
-    m_normals.reserve(m_indices.size());
+    m_normals.resize(m_indices.size());
 
-    for (auto indices : m_indices) {
-        auto e0 = m_vertices[indices[1]] - m_vertices[indices[0]];
-        auto e1 = m_vertices[indices[2]] - m_vertices[indices[1]];
-        auto normal = normalize(cross(e0, e1));
-        m_normals.push_back(normal);
-    }
+    parallel_for(size_t{0}, m_indices.size(), [&](size_t tri_idx) {
+        m_normals[tri_idx] = calculate_face_normal(tri_idx);
+    });
+}
+
+vector3 triangle_mesh::calculate_face_normal(size_t tri_idx) const {
+    auto indices = m_indices[tri_idx];
+    auto e0 = m_vertices[indices[1]] - m_vertices[indices[0]];
+    auto e1 = m_vertices[indices[2]] - m_vertices[indices[1]];
+    return normalize(cross(e0, e1));
 }
 
 void triangle_mesh::init_edge_indices() {
     constexpr auto idx_max = std::numeric_limits<index_type>::max();
     m_face_edge_indices.resize(m_indices.size());
-    auto vertex_edge_indices = std::vector<std::set<index_type>>(m_vertices.size());
-
+    m_edge_vertex_indices.clear();
+    m_edge_face_indices.clear();
+    m_vertex_edge_indices = {};
+
+    // Each edge is shared by two faces in a closed mesh, thus there are about
+    // 1.5 edges per face.
+    auto edge_map = std::unordered_map<uint64_t, index_type>{};
+    edge_map.reserve(m_indices.size() * 3 / 2 + 1);
+    m_edge_vertex_indices.reserve(m_indices.size() * 3 / 2 + 1);
+    m_edge_face_indices.reserve(m_indices.size() * 3 / 2 + 1);
+
+    // Edges are indexed in the order they're first found, which keeps the
+    // result independent of the hashing.
     for (size_t face_idx = 0; face_idx < m_indices.size(); ++face_idx) {
         auto indices = m_indices[face_idx];
 
@@ -37,25 +55,16 @@ void triangle_mesh::init_edge_indices() {
             auto j = (i + 1) % 3;
             auto i0 = indices[i];
             auto i1 = indices[j];
-            auto pair = unordered_pair(i0, i1);
-            auto edge_idx = SIZE_MAX;
-
-            for (size_t k = 0; k < m_edge_vertex_indices.size(); ++k) {
-                if (m_edge_vertex_indices[k] == pair) {
-                    edge_idx = k;
-                    break;
-                }
-            }
+            auto key = static_cast<uint64_t>(std::min(i0, i1)) << 32 | std::max(i0, i1);
+            auto next_edge_idx = static_cast<index_type>(m_edge_vertex_indices.size());
+            auto [it, inserted] = edge_map.emplace(key, next_edge_idx);
+            auto edge_idx = it->second;
 
-            if (edge_idx == SIZE_MAX) {
-                edge_idx = m_edge_vertex_indices.size();
-                m_edge_vertex_indices.push_back(pair);
+            if (inserted) {
+                m_edge_vertex_indices.push_back(unordered_pair(i0, i1));
                 m_edge_face_indices.push_back({idx_max, idx_max});
             }
 
-            vertex_edge_indices[i0].insert(edge_idx);
-            vertex_edge_indices[i1].insert(edge_idx);
-
             m_face_edge_indices[face_idx][i] = edge_idx;
 
             auto &edge_face_indices = m_edge_face_indices[edge_idx];
@@ -68,11 +77,35 @@ void triangle_mesh::init_edge_indices() {
         }
     }
 
-    for (auto edge_indices : vertex_edge_indices) {
+    // Group edges by vertex. Visiting edges in order leaves the edge indices
+    // of each vertex sorted.
+    auto vertex_edge_starts = std::vector<size_t>(m_vertices.size() + 1, 0);
+
+    for (auto &pair : m_edge_vertex_indices) {
+        ++vertex_edge_starts[pair.first + 1];
+        ++vertex_edge_starts[pair.second + 1];
+    }
+
+    std::partial_sum(vertex_edge_starts.begin(), vertex_edge_starts.end(), vertex_edge_starts.begin());
+
+    auto vertex_edge_indices = std::vector<index_type>(vertex_edge_starts.back());
+    auto vertex_edge_counts = std::vector<size_t>(m_vertices.size(), 0);
+
+    for (index_type edge_idx = 0; edge_idx < m_edge_vertex_indices.size(); ++edge_idx) {
+        for (auto vertex_idx : {m_edge_vertex_indices[edge_idx].first, m_edge_vertex_indices[edge_idx].second}) {
+            auto pos = vertex_edge_starts[vertex_idx] + vertex_edge_counts[vertex_idx]++;
+            vertex_edge_indices[pos] = edge_idx;
+        }
+    }
+
+    m_vertex_edge_indices.reserve_nested(m_vertices.size());
+    m_vertex_edge_indices.reserve_data(vertex_edge_indices.size());
+
+    for (size_t vertex_idx = 0; vertex_idx < m_vertices.size(); ++vertex_idx) {
         m_vertex_edge_indices.push_array();
 
-        for (auto edge_idx : edge_indices) {
-            m_vertex_edge_indices.push_back(edge_idx);
+        for (auto i = vertex_edge_starts[vertex_idx]; i < vertex_edge_starts[vertex_idx + 1]; ++i) {
+            m_vertex_edge_indices.push_back(vertex_edge_indices[i]);
         }
     }
 
@@ -96,51 +129,147 @@ void triangle_mesh::init_edge_indices() {
 
 void triangle_mesh::calculate_adjacent_normals() {
     m_adjacent_normals.resize(m_indices.size());
-    m_is_convex_edge.resize(m_edge_vertex_indices.size());
 
-    for (size_t face_idx = 0; face_idx < m_indices.size(); ++face_idx) {
-        for (size_t i = 0; i < 3; ++i) {
-            auto edge_idx = m_face_edge_indices[face_idx][i];
-            auto &edge_face_indices = m_edge_face_indices[edge_idx];
-            auto other_face_idx = edge_face_indices[0] == face_idx ? edge_face_indices[1] : edge_face_indices[0];
+    parallel_for(size_t{0}, m_indices.size(), [&](size_t tri_idx) {
+        update_adjacent_normals(tri_idx);
+    });
+
+    // Calculate into bytes first since concurrent writes to a `std::vector<bool>`
+    // would touch the same words.
+    auto is_convex_edge = std::vector<uint8_t>(m_edge_vertex_indices.size());
 
+    parallel_for(size_t{0}, is_convex_edge.size(), [&](size_t edge_idx) {
+        is_convex_edge[edge_idx] = calculate_edge_convexity(edge_idx);
+    });
+
+    m_is_convex_edge.assign(is_convex_edge.begin(), is_convex_edge.end());
+}
+
+void triangle_mesh::update_adjacent_normals(size_t face_idx) {
+    for (size_t i = 0; i < 3; ++i) {
+        auto edge_idx = m_face_edge_indices[face_idx][i];
+        auto &edge_face_indices = m_edge_face_indices[edge_idx];
+        auto other_face_idx = edge_face_indices[0] == face_idx ? edge_face_indices[1] : edge_face_indices[0];
+
+        if (other_face_idx == face_idx) {
+            // This is a boundary edge. Make adjacent normal point slightly
+            // away in the edge direction to form a near 180 degree angle.
             auto vertex_idx0 = m_indices[face_idx][i];
             auto vertex_idx1 = m_indices[face_idx][(i + 1) % 3];
             auto edge_dir = m_vertices[vertex_idx1] - m_vertices[vertex_idx0];
             auto edge_normal = cross(m_normals[face_idx], edge_dir);
-
-            if (other_face_idx == face_idx) {
-                // This is a boundary edge. Make adjacent normal point slightly
-                // away in the edge direction to form a near 180 degree angle.
-                m_adjacent_normals[face_idx][i] = -normalize(m_normals[face_idx] + edge_normal * 0.1);
-                // Boundary edges are always convex.
-                m_is_convex_edge[edge_idx] = true;
-            } else {
-                auto other_normal = m_normals[other_face_idx];
-                m_adjacent_normals[face_idx][i] = other_normal;
-
-                // Calculate edge convexity.
-                auto is_convex = dot(other_normal, edge_normal) < -EDYN_EPSILON;
-                m_is_convex_edge[edge_idx] = is_convex;
-            }
+            m_adjacent_normals[face_idx][i] = -normalize(m_normals[face_idx] + edge_normal * 0.1);
+        } else {
+            m_adjacent_normals[face_idx][i] = m_normals[other_face_idx];
         }
     }
 }
 
+bool triangle_mesh::calculate_edge_convexity(size_t edge_idx) const {
+    // Boundary edges are always convex.
+    if (m_is_boundary_edge[edge_idx]) {
+        return true;
+    }
+
+    // Calculate from the point of view of the second face.
+    auto &edge_face_indices = m_edge_face_indices[edge_idx];
+    auto face_idx = edge_face_indices[1];
+    auto other_face_idx = edge_face_indices[0];
+    auto &face_edge_indices = m_face_edge_indices[face_idx];
+    auto i = static_cast<size_t>(std::distance(face_edge_indices.begin(),
+        std::find(face_edge_indices.begin(), face_edge_indices.end(), edge_idx)));
+    EDYN_ASSERT(i < 3);
+
+    auto vertex_idx0 = m_indices[face_idx][i];
+    auto vertex_idx1 = m_indices[face_idx][(i + 1) % 3];
+    auto edge_dir = m_vertices[vertex_idx1] - m_vertices[vertex_idx0];
+    auto edge_normal = cross(m_normals[face_idx], edge_dir);
+
+    return dot(m_normals[other_face_idx], edge_normal) < -EDYN_EPSILON;
+}
+
 void triangle_mesh::build_triangle_tree() {
-    std::vector<AABB> aabbs;
-    aabbs.reserve(num_triangles());
+    std::vector<AABB> aabbs(num_triangles());
 
-    for (size_t i = 0; i < num_triangles(); ++i) {
-        auto verts = get_triangle_vertices(i);
-        auto tri_aabb = get_triangle_aabb(verts);
-        aabbs.push_back(tri_aabb);
-    }
+    parallel_for(size_t{0}, num_triangles(), [&](size_t i) {
+        aabbs[i] = get_triangle_aabb(get_triangle_vertices(i));
+    });
 
     auto report_leaf = [](static_tree::tree_node &node, auto ids_begin, auto ids_end) {
         node.id = *ids_begin;
     };
     m_triangle_tree.build(aabbs.begin(), aabbs.end(), report_leaf);
+    m_triangle_leaves.clear();
+}
+
+void triangle_mesh::update_triangles(size_t first_tri_idx, size_t last_tri_idx) {
+    EDYN_ASSERT(first_tri_idx <= last_tri_idx && last_tri_idx <= num_triangles());
+    auto tri_indices = std::vector<index_type>(last_tri_idx - first_tri_idx);
+    std::iota(tri_indices.begin(), tri_indices.end(), static_cast<index_type>(first_tri_idx));
+    update_faces(tri_indices);
+}
+
+void triangle_mesh::update_faces(std::vector<index_type> &tri_indices) {
+    EDYN_ASSERT(!is_interned(), "Interned meshes are immutable.");
+    std::sort(tri_indices.begin(), tri_indices.end());
+    tri_indices.erase(std::unique(tri_indices.begin(), tri_indices.end()), tri_indices.end());
+
+    if (tri_indices.empty()) {
+        return;
+    }
+
+    parallel_for(size_t{0}, tri_indices.size(), [&](size_t i) {
+        m_normals[tri_indices[i]] = calculate_face_normal(tri_indices[i]);
+    });
+
+    // Neighbors store the normals of the updated triangles as adjacent
+    // normals and the convexity of the shared edges depends on both.
+    auto neighbor_indices = tri_indices;
+    auto edge_indices = std::vector<index_type>{};
+    edge_indices.reserve(tri_indices.size() * 3);
+
+    for (auto tri_idx : tri_indices) {
+        for (auto edge_idx : m_face_edge_indices[tri_idx]) {
+            auto &edge_face_indices = m_edge_face_indices[edge_idx];
+            neighbor_indices.insert(neighbor_indices.end(), edge_face_indices.begin(), edge_face_indices.end());
+            edge_indices.push_back(edge_idx);
+        }
+    }
+
+    std::sort(neighbor_indices.begin(), neighbor_indices.end());
+    neighbor_indices.erase(std::unique(neighbor_indices.begin(), neighbor_indices.end()), neighbor_indices.end());
+    std::sort(edge_indices.begin(), edge_indices.end());
+    edge_indices.erase(std::unique(edge_indices.begin(), edge_indices.end()), edge_indices.end());
+
+    parallel_for(size_t{0}, neighbor_indices.size(), [&](size_t i) {
+        update_adjacent_normals(neighbor_indices[i]);
+    });
+
+    for (auto edge_idx : edge_indices) {
+        m_is_convex_edge[edge_idx] = calculate_edge_convexity(edge_idx);
+    }
+
+    if (m_triangle_leaves.size() != num_triangles()) {
+        m_triangle_leaves.resize(num_triangles());
+
+        for (uint32_t node_idx = 0; node_idx < m_triangle_tree.num_nodes(); ++node_idx) {
+            auto &node = m_triangle_tree.get_node(node_idx);
+
+            if (node.leaf()) {
+                m_triangle_leaves[node.id] = node_idx;
+            }
+        }
+    }
+
+    auto leaf_indices = std::vector<uint32_t>(tri_indices.size());
+
+    for (size_t i = 0; i < tri_indices.size(); ++i) {
+        leaf_indices[i] = m_triangle_leaves[tri_indices[i]];
+    }
+
+    m_triangle_tree.refit(leaf_indices.begin(), leaf_indices.end(), [&](const static_tree::tree_node &node) {
+        return get_triangle_aabb(get_triangle_vertices(node.id));
+    });
 }
 
 triangle_vertices triangle_mesh::get_triangle_vertices(size_t tri_idx) const {
@@ -153,6 +282,65 @@ triangle_vertices triangle_mesh::get_triangle_vertices(size_t tri_idx) const {
     };
 }
 
+bool triangle_mesh::is_valid() const {
+    auto num_vertices = m_vertices.size();
+    auto num_triangles = m_indices.size();
+    auto num_edges = m_edge_vertex_indices.size();
+
+    if (m_normals.size() != num_triangles ||
+        m_adjacent_normals.size() != num_triangles ||
+        m_face_edge_indices.size() != num_triangles ||
+        m_edge_face_indices.size() != num_edges ||
+        m_is_boundary_edge.size() != num_edges ||
+        m_is_convex_edge.size() != num_edges ||
+        m_vertex_edge_indices.size() != num_vertices ||
+        !m_vertex_edge_indices.is_valid()) {
+        return false;
+    }
+
+    // Per-vertex attributes are optional.
+    for (auto size : {m_friction.size(), m_restitution.size(), m_material_ids.size()}) {
+        if (size != 0 && size != num_vertices) {
+            return false;
+        }
+    }
+
+    auto all_less = [](auto &&indices, size_t count) {
+        return std::all_of(indices.begin(), indices.end(), [count](auto idx) { return idx < count; });
+    };
+
+    for (size_t i = 0; i < num_triangles; ++i) {
+        if (!all_less(m_indices[i], num_vertices) ||
+            !all_less(m_face_edge_indices[i], num_edges)) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < num_edges; ++i) {
+        if (m_edge_vertex_indices[i].first >= num_vertices ||
+            m_edge_vertex_indices[i].second >= num_vertices ||
+            !all_less(m_edge_face_indices[i], num_triangles)) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < num_vertices; ++i) {
+        auto edge_indices = m_vertex_edge_indices[i];
+
+        for (size_t j = 0; j < edge_indices.size(); ++j) {
+            if (edge_indices[j] >= num_edges) {
+                return false;
+            }
+        }
+    }
+
+    if (num_triangles > 0 && m_triangle_tree.empty()) {
+        return false;
+    }
+
+    return m_triangle_tree.is_valid(num_triangles);
+}
+
 bool triangle_mesh::has_per_vertex_friction() const {
     return !m_friction.empty();
 }
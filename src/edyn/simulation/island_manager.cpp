@@ -126,16 +126,26 @@ void island_manager::init_new_nodes_and_edges() {
     auto &graph = m_registry->ctx().at<entity_graph>();
     auto node_view = m_registry->view<graph_node>();
     auto edge_view = m_registry->view<graph_edge>();
+    auto resident_view = m_registry->view<const island_resident>();
     std::set<entity_graph::index_type> procedural_node_indices;
 
+    // Nodes and edges which already reside in an island, such as the ones
+    // loaded from a world snapshot, are skipped.
+    auto is_resident = [&](entt::entity entity) {
+        return resident_view.contains(entity) &&
+            std::get<0>(resident_view.get(entity)).island_entity != entt::null;
+    };
+
     for (auto entity : m_new_graph_nodes) {
-        if (m_registry->any_of<procedural_tag>(entity)) {
+        if (m_registry->any_of<procedural_tag>(entity) && !is_resident(entity)) {
             auto &node = node_view.get<graph_node>(entity);
             procedural_node_indices.insert(node.node_index);
         }
     }
 
     for (auto edge_entity : m_new_graph_edges) {
+        if (is_resident(edge_entity)) continue;
+
         auto &edge = edge_view.get<graph_edge>(edge_entity);
         auto node_entities = graph.edge_node_entities(edge.edge_index);
 
@@ -158,7 +168,6 @@ void island_manager::init_new_nodes_and_edges() {
     std::vector<entt::entity> connected_nodes;
     std::vector<entt::entity> connected_edges;
     std::vector<entt::entity> island_entities;
-    auto resident_view = m_registry->view<const island_resident>();
     auto procedural_view = m_registry->view<procedural_tag>();
 
     graph.reach(
@@ -22,6 +22,7 @@
 #include "edyn/comp/island.hpp"
 #include "edyn/parallel/message_dispatcher.hpp"
 #include "edyn/replication/entity_map.hpp"
+#include "edyn/sys/prefetch_paged_meshes.hpp"
 #include "edyn/sys/update_aabbs.hpp"
 #include "edyn/sys/update_inertias.hpp"
 #include "edyn/sys/update_rotated_meshes.hpp"
@@ -54,7 +55,9 @@ namespace edyn {
 
 simulation_worker::simulation_worker(const settings &settings,
                                      const registry_operation_context &reg_op_ctx,
-                                     const material_mix_table &material_table)
+                                     const material_mix_table &material_table,
+                                     const std::string &queue_name,
+                                     bool report_progress)
     : m_raycast_service(m_registry)
     , m_island_manager(m_registry)
     , m_poly_initializer(m_registry)
@@ -76,8 +79,16 @@ simulation_worker::simulation_worker(const settings &settings,
         msg::raycast_request,
         msg::query_aabb_request,
         msg::query_aabb_of_interest_request,
-        extrapolation_result>("worker"))
+        extrapolation_result>(queue_name))
+    , m_report_progress(report_progress)
 {
+    m_message_queue.push_sink().connect<&tick_scheduler::wake>(m_tick_scheduler);
+
+    // Name thread after the queue, e.g. `edyn-sim1` for queue `worker1`.
+    auto prefix = std::string("worker");
+    m_thread_name = "edyn-sim" + (queue_name.compare(0, prefix.size(), prefix) == 0 ?
+                                  queue_name.substr(prefix.size()) : queue_name);
+
     m_registry.ctx().emplace<contact_manifold_map>(m_registry);
     m_registry.ctx().emplace<broadphase>(m_registry);
     m_registry.ctx().emplace<narrowphase>(m_registry);
@@ -90,6 +101,9 @@ simulation_worker::simulation_worker(const settings &settings,
 simulation_worker::~simulation_worker() {
     stop();
 
+    // The message queue outlives this worker.
+    m_message_queue.push_sink().disconnect<&tick_scheduler::wake>(m_tick_scheduler);
+
     // The destructor of `polyhedron_shape_initializer` touches `m_registry` when
     // destroying `rotated_mesh_list` elements it creates for compound shapes
     // containing polyhedrons. It's called after `stop()` which finishes the
@@ -291,10 +305,14 @@ void simulation_worker::wake_up_affected_islands(const registry_operation &ops)
 }
 
 void simulation_worker::sync() {
-    if (!m_op_builder->empty()) {
+    // When multiple workers are synchronized, also send an update when the
+    // simulation time advances without any changes so the main thread knows
+    // how far this worker has progressed.
+    if (!m_op_builder->empty() || (m_report_progress && m_sim_time != m_last_sync_time)) {
         auto &&ops = std::move(m_op_builder->finish());
         message_dispatcher::global().send<msg::step_update>(
             {"main"}, m_message_queue.identifier, std::move(ops), m_sim_time);
+        m_last_sync_time = m_sim_time;
     }
 }
 
@@ -307,6 +325,7 @@ void simulation_worker::start() {
 void simulation_worker::stop() {
     EDYN_ASSERT(m_thread);
     m_running.store(false, std::memory_order_release);
+    m_tick_scheduler.wake();
     m_thread->join();
     m_thread.reset();
 }
@@ -358,6 +377,7 @@ void simulation_worker::update() {
         }
 
         bphase.update(true);
+        prefetch_paged_meshes(m_registry, settings.paged_mesh_prefetch_time);
         m_island_manager.update(m_sim_time);
         nphase.update(true);
         m_solver.update(true);
@@ -381,27 +401,22 @@ void simulation_worker::update() {
 }
 
 void simulation_worker::run() {
-    // Use a PID to keep updates at a fixed and controlled rate.
-    auto proportional_term = 0.18;
-    auto integral_term = 0.06;
-    auto i_term = 0.0;
-
+    job_dispatcher::global().apply_low_latency_config(m_thread_name);
     m_current_time = (*m_registry.ctx().at<settings>().time_func)();
     init();
 
     while (m_running.load(std::memory_order_relaxed)) {
-        auto t1 = (*m_registry.ctx().at<settings>().time_func)();
-        auto dt = t1 - m_current_time;
-        m_current_time = t1;
+        m_current_time = (*m_registry.ctx().at<settings>().time_func)();
         update();
         sync();
 
-        // Apply delay to maintain a fixed update rate.
-        auto desired_dt = m_registry.ctx().at<settings>().fixed_dt;
-        auto error = desired_dt - dt;
-        i_term = std::max(-1.0, std::min(i_term + integral_term * error, 1.0));
-        auto delay = std::max(0.0, proportional_term * error + i_term);
-        edyn::delay(delay * 1000);
+        // Sleep until the accumulated time is enough for the next step. The
+        // scheduler is woken up earlier when a message arrives so requests
+        // are answered without waiting for the next step. The deadline is in
+        // terms of the configured time source, which might be custom.
+        auto &settings = m_registry.ctx().at<edyn::settings>();
+        auto time_to_next_step = m_paused ? settings.fixed_dt : std::max(settings.fixed_dt - m_accumulated_time, 0.0);
+        m_tick_scheduler.sleep_until(m_current_time + time_to_next_step, settings.time_func);
     }
 
     deinit();
@@ -448,6 +463,7 @@ void simulation_worker::on_step_simulation(message<msg::step_simulation> &) {
 
     m_poly_initializer.init_new_shapes();
     bphase.update(true);
+    prefetch_paged_meshes(m_registry, settings.paged_mesh_prefetch_time);
     m_island_manager.update(m_last_time);
     nphase.update(true);
     m_solver.update(true);
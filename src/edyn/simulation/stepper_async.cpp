@@ -1,9 +1,12 @@
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/collision/contact_event_emitter.hpp"
+#include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_manifold_events.hpp"
 #include "edyn/collision/query_aabb.hpp"
 #include "edyn/comp/child_list.hpp"
 #include "edyn/comp/island.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/simulation_partition.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/constraints/null_constraint.hpp"
 #include "edyn/constraints/constraint.hpp"
@@ -19,11 +22,33 @@
 #include "edyn/dynamics/material_mixing.hpp"
 #include "edyn/util/constraint_util.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <numeric>
+#include <string>
 
 namespace edyn {
 
-stepper_async::stepper_async(entt::registry &registry, double time)
+template<typename Constraint>
+bool constraint_has_valid_bodies(entt::registry &registry, entt::entity entity) {
+    if (auto *con = registry.try_get<Constraint>(entity)) {
+        return std::all_of(con->body.begin(), con->body.end(), [&](entt::entity body) {
+            return registry.valid(body) && registry.all_of<graph_node>(body);
+        });
+    }
+
+    return true;
+}
+
+template<typename... Constraints>
+bool constraint_has_valid_bodies(entt::registry &registry, entt::entity entity,
+                                 [[maybe_unused]] const std::tuple<Constraints...> &) {
+    return (constraint_has_valid_bodies<Constraints>(registry, entity) && ...);
+}
+
+stepper_async::stepper_async(entt::registry &registry, double time, unsigned num_workers,
+                             scalar partition_region_size, scalar partition_margin)
     : m_registry(&registry)
     , m_message_queue_handle(
         message_dispatcher::global().make_queue<
@@ -31,31 +56,199 @@ stepper_async::stepper_async(entt::registry &registry, double time)
             msg::raycast_response,
             msg::query_aabb_response
         >("main"))
-    , m_worker(registry.ctx().at<settings>(),
-               registry.ctx().at<registry_operation_context>(),
-               registry.ctx().at<material_mix_table>())
+    , m_partition_region_size(partition_region_size)
+    , m_partition_margin(partition_margin)
     , m_last_time(time)
     , m_sim_time(time)
 {
-    m_connections.push_back(registry.on_construct<graph_node>().connect<&stepper_async::on_construct_shared>(*this));
+    EDYN_ASSERT(num_workers > 0);
+    EDYN_ASSERT(partition_region_size > 0);
+
+    // Create storage upfront since it's modified in destruction signals.
+    static_cast<void>(registry.storage<simulation_partition>());
+
+    m_connections.push_back(registry.on_construct<graph_node>().connect<&stepper_async::on_construct_graph_node>(*this));
     m_connections.push_back(registry.on_destroy<graph_node>().connect<&stepper_async::on_destroy_graph_node>(*this));
-    m_connections.push_back(registry.on_construct<graph_edge>().connect<&stepper_async::on_construct_shared>(*this));
+    m_connections.push_back(registry.on_construct<graph_edge>().connect<&stepper_async::on_construct_graph_edge>(*this));
     m_connections.push_back(registry.on_destroy<graph_edge>().connect<&stepper_async::on_destroy_graph_edge>(*this));
-    m_connections.push_back(registry.on_construct<child_list>().connect<&stepper_async::on_construct_shared>(*this));
+    m_connections.push_back(registry.on_construct<child_list>().connect<&stepper_async::on_construct_child_list>(*this));
 
     m_message_queue_handle.sink<msg::step_update>().connect<&stepper_async::on_step_update>(*this);
     m_message_queue_handle.sink<msg::raycast_response>().connect<&stepper_async::on_raycast_response>(*this);
     m_message_queue_handle.sink<msg::query_aabb_response>().connect<&stepper_async::on_query_aabb_response>(*this);
 
-    auto &reg_op_ctx = m_registry->ctx().at<registry_operation_context>();
-    m_op_builder = (*reg_op_ctx.make_reg_op_builder)(*m_registry);
-    m_op_observer = (*reg_op_ctx.make_reg_op_observer)(*m_op_builder);
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &reg_op_ctx = registry.ctx().at<registry_operation_context>();
+    auto &material_table = registry.ctx().at<material_mix_table>();
+
+    m_workers.reserve(num_workers);
+
+    for (unsigned i = 0; i < num_workers; ++i) {
+        auto &ctx = m_workers.emplace_back();
+        // The first worker keeps the default name which is used by networking.
+        ctx.queue = {i == 0 ? std::string("worker") : "worker" + std::to_string(i)};
+        ctx.worker = std::make_unique<simulation_worker>(settings, reg_op_ctx, material_table,
+                                                         ctx.queue.value, num_workers > 1);
+        ctx.op_builder = (*reg_op_ctx.make_reg_op_builder)(registry);
+        ctx.op_observer = (*reg_op_ctx.make_reg_op_observer)(*ctx.op_builder);
+        ctx.timestamp = time;
+    }
+
+    for (auto &ctx : m_workers) {
+        ctx.worker->start();
+    }
+}
+
+template<typename Func>
+void stepper_async::each_worker_of(entt::entity entity, Func func) {
+    if (auto *partition = m_registry->try_get<simulation_partition>(entity)) {
+        func(partition->worker_index);
+    } else {
+        for (unsigned i = 0; i < m_workers.size(); ++i) {
+            func(i);
+        }
+    }
+}
+
+unsigned stepper_async::worker_index(const message_queue_identifier &queue) const {
+    for (unsigned i = 0; i < m_workers.size(); ++i) {
+        if (m_workers[i].queue.value == queue.value) {
+            return i;
+        }
+    }
+
+    EDYN_ASSERT(false, "Message received from unknown simulation worker.");
+    return 0;
+}
+
+unsigned stepper_async::region_worker(const vector3 &pos) const {
+    // Space is split in slabs along the x axis which are assigned to workers
+    // in a round-robin fashion.
+    auto num_workers = static_cast<long long>(m_workers.size());
+    auto region = static_cast<long long>(std::floor(pos.x / m_partition_region_size));
+    auto index = region % num_workers;
+
+    if (index < 0) {
+        index += num_workers;
+    }
+
+    return static_cast<unsigned>(index);
+}
+
+void stepper_async::observe_imported(entt::entity entity) {
+    // Entities created by a worker are simulated by that same worker.
+    if (m_workers.size() > 1 && !m_registry->all_of<simulation_partition>(entity)) {
+        m_registry->emplace<simulation_partition>(entity, m_importing_worker);
+    }
 
-    m_worker.start();
+    m_workers[m_importing_worker].op_observer->observe(entity);
 }
 
-void stepper_async::on_construct_shared(entt::registry &registry, entt::entity entity) {
-    m_op_observer->observe(entity);
+void stepper_async::on_construct_graph_node(entt::registry &registry, entt::entity entity) {
+    if (m_importing) {
+        observe_imported(entity);
+        return;
+    }
+
+    if (m_workers.size() == 1 || !registry.all_of<procedural_tag>(entity)) {
+        // Non-procedural entities are present in all workers.
+        for (auto &ctx : m_workers) {
+            ctx.op_observer->observe(entity);
+        }
+        return;
+    }
+
+    auto pos = vector3_zero;
+
+    if (auto *p = registry.try_get<position>(entity)) {
+        pos = *p;
+    }
+
+    auto dest = region_worker(pos);
+    registry.emplace<simulation_partition>(entity, dest);
+    m_workers[dest].op_observer->observe(entity);
+}
+
+void stepper_async::on_construct_graph_edge(entt::registry &registry, entt::entity entity) {
+    if (m_importing) {
+        observe_imported(entity);
+        return;
+    }
+
+    if (m_workers.size() == 1) {
+        m_workers.front().op_observer->observe(entity);
+        return;
+    }
+
+    // Edges are simulated by the worker which owns its procedural nodes.
+    auto &graph = registry.ctx().at<entity_graph>();
+    auto &edge = registry.get<graph_edge>(entity);
+    auto [body0, body1] = graph.edge_node_entities(edge.edge_index);
+    auto partition_view = registry.view<simulation_partition>();
+    auto dest = 0u;
+
+    if (partition_view.contains(body0)) {
+        dest = partition_view.get<simulation_partition>(body0).worker_index;
+
+        if (partition_view.contains(body1) &&
+            partition_view.get<simulation_partition>(body1).worker_index != dest)
+        {
+            // Bodies connected by a constraint must be in the same worker.
+            migrate(body1, dest);
+        }
+    } else if (partition_view.contains(body1)) {
+        dest = partition_view.get<simulation_partition>(body1).worker_index;
+    }
+
+    registry.emplace<simulation_partition>(entity, dest);
+    m_workers[dest].op_observer->observe(entity);
+}
+
+void stepper_async::on_construct_child_list(entt::registry &registry, entt::entity entity) {
+    if (m_importing) {
+        observe_imported(entity);
+        return;
+    }
+
+    // Children follow their parent. Children of non-procedural entities are
+    // present in all workers.
+    auto parent = registry.get<child_list>(entity).parent;
+
+    if (m_workers.size() > 1 && registry.valid(parent)) {
+        if (auto *partition = registry.try_get<simulation_partition>(parent)) {
+            auto dest = partition->worker_index;
+            registry.emplace<simulation_partition>(entity, dest);
+            m_workers[dest].op_observer->observe(entity);
+            return;
+        }
+    }
+
+    for (auto &ctx : m_workers) {
+        ctx.op_observer->observe(entity);
+    }
+}
+
+void stepper_async::forget_entity(entt::entity entity) {
+    for (unsigned i = 0; i < m_workers.size(); ++i) {
+        auto &ctx = m_workers[i];
+
+        if (ctx.op_observer->observes(entity)) {
+            ctx.op_observer->unobserve(entity);
+        }
+
+        // When importing delta, the entity is removed from the entity map of
+        // the worker that sent it as part of the import process. Otherwise,
+        // the removal has to be done here.
+        if (m_importing && i == m_importing_worker) {
+            continue;
+        }
+
+        if (ctx.emap.contains_local(entity)) {
+            ctx.emap.erase_local(entity);
+        }
+    }
+
+    m_registry->remove<simulation_partition>(entity);
 }
 
 void stepper_async::on_destroy_graph_node(entt::registry &registry, entt::entity entity) {
@@ -69,68 +262,91 @@ void stepper_async::on_destroy_graph_node(entt::registry &registry, entt::entity
     graph.visit_edges(node.node_index, [&](auto edge_index) {
         auto edge_entity = graph.edge_entity(edge_index);
         registry.destroy(edge_entity);
-        m_op_observer->unobserve(edge_entity);
-
-        if (!m_importing) {
-            if (m_entity_map.contains_local(edge_entity)) {
-                m_entity_map.erase_local(edge_entity);
-            }
-        }
+        forget_entity(edge_entity);
     });
 
     registry.on_destroy<graph_edge>().connect<&stepper_async::on_destroy_graph_edge>(*this);
 
     graph.remove_all_edges(node.node_index);
     graph.remove_node(node.node_index);
-    m_op_observer->unobserve(entity);
-
-    if (!m_importing) {
-        // When importing delta, the entity is removed from the entity map as part
-        // of the import process. Otherwise, the removal has to be done here.
-        if (m_entity_map.contains_local(entity)) {
-            m_entity_map.erase_local(entity);
-        }
-    }
+    forget_entity(entity);
 }
 
 void stepper_async::on_destroy_graph_edge(entt::registry &registry, entt::entity entity) {
     auto &edge = registry.get<graph_edge>(entity);
     auto &graph = registry.ctx().at<entity_graph>();
     graph.remove_edge(edge.edge_index);
-    m_op_observer->unobserve(entity);
+    forget_entity(entity);
+}
+
+void stepper_async::on_step_update(message<msg::step_update> &msg) {
+    auto &ctx = m_workers[worker_index(msg.sender)];
+    ctx.pending_updates.push_back(std::move(msg.content));
+}
 
-    if (!m_importing) {
-        if (m_entity_map.contains_local(entity)) {
-            m_entity_map.erase_local(entity);
+void stepper_async::apply_step_updates() {
+    // Workers advance independently. Only apply updates up to the time which
+    // all of them have reached so the main registry holds a coherent state.
+    auto coherent_time = std::numeric_limits<double>::max();
+
+    for (auto &ctx : m_workers) {
+        auto latest = ctx.pending_updates.empty() ? ctx.timestamp : ctx.pending_updates.back().timestamp;
+        coherent_time = std::min(coherent_time, latest);
+    }
+
+    auto imported = false;
+
+    for (unsigned i = 0; i < m_workers.size(); ++i) {
+        auto &ctx = m_workers[i];
+
+        while (!ctx.pending_updates.empty() && ctx.pending_updates.front().timestamp <= coherent_time) {
+            import_step_update(i, ctx.pending_updates.front());
+            ctx.pending_updates.pop_front();
+            imported = true;
         }
     }
+
+    if (imported) {
+        m_sim_time = coherent_time;
+        // Only calculate delay if the sim time was set.
+        m_should_calculate_presentation_delay = true;
+    }
 }
 
-void stepper_async::on_step_update(message<msg::step_update> &msg) {
+void stepper_async::import_step_update(unsigned worker_index, msg::step_update &update) {
     auto &registry = *m_registry;
     auto &graph = registry.ctx().at<entity_graph>();
+    auto &ctx = m_workers[worker_index];
+    const auto multiple_workers = m_workers.size() > 1;
 
     m_importing = true;
-    m_op_observer->set_active(false);
+    m_importing_worker = worker_index;
+    ctx.op_observer->set_active(false);
+    ctx.timestamp = update.timestamp;
 
-    m_sim_time = msg.content.timestamp;
-    // Only calculate delay if the sim time was set.
-    m_should_calculate_presentation_delay = true;
+    // Entities referring to bodies which have moved to another worker, which
+    // are destroyed after the import.
+    auto orphans = std::vector<entt::entity>{};
 
-    auto &ops = msg.content.ops;
-    ops.execute(registry, m_entity_map, [&](operation_base *op) {
+    auto &ops = update.ops;
+    ops.execute(registry, ctx.emap, [&](operation_base *op) {
         auto op_type = op->operation_type();
         auto remote_entity = op->entity;
 
         // Insert entity mappings for new entities into the current op.
         if (op_type == registry_operation_type::create) {
-            auto local_entity = m_entity_map.at(remote_entity);
-            m_op_builder->add_entity_mapping(local_entity, remote_entity);
+            auto local_entity = ctx.emap.at(remote_entity);
+            ctx.op_builder->add_entity_mapping(local_entity, remote_entity);
         }
 
+        if (op_type != registry_operation_type::emplace || !ctx.emap.contains(remote_entity)) {
+            return;
+        }
+
+        auto local_entity = ctx.emap.at(remote_entity);
+
         // Insert nodes in the graph for each new rigid body.
-        if (op_type == registry_operation_type::emplace && op->payload_type_any_of<rigidbody_tag, external_tag>()) {
-            auto local_entity = m_entity_map.at(remote_entity);
+        if (op->payload_type_any_of<rigidbody_tag, external_tag>()) {
             auto non_connecting = !registry.any_of<procedural_tag>(local_entity);
             auto node_index = graph.insert_node(local_entity, non_connecting);
             registry.emplace<graph_node>(local_entity, node_index);
@@ -143,22 +359,41 @@ void stepper_async::on_step_update(message<msg::step_update> &msg) {
         }
 
         // Insert edges in the graph for constraints.
-        if (op_type == registry_operation_type::emplace &&
-           (op->payload_type_any_of(constraints_tuple) || op->payload_type_any_of<null_constraint>()))
-        {
-            auto local_entity = m_entity_map.at(remote_entity);
-
-            // There could be multiple constraints (of different types) assigned to
-            // the same entity, which means it could already have an edge.
-            if (!registry.any_of<graph_edge>(local_entity)) {
+        if (op->payload_type_any_of(constraints_tuple) || op->payload_type_any_of<null_constraint>()) {
+            if (!constraint_has_valid_bodies(registry, local_entity, constraints_tuple) ||
+                !constraint_has_valid_bodies<null_constraint>(registry, local_entity)) {
+                orphans.push_back(local_entity);
+            } else if (!registry.any_of<graph_edge>(local_entity)) {
+                // There could be multiple constraints (of different types) assigned to
+                // the same entity, which means it could already have an edge.
                 create_graph_edge_for_constraints(registry, local_entity, graph, constraints_tuple);
                 create_graph_edge_for_constraint<null_constraint>(registry, local_entity, graph);
             }
         }
+
+        if (op->payload_type_any_of<contact_manifold>()) {
+            auto &manifold = registry.get<contact_manifold>(local_entity);
+
+            if (manifold.body[0] == entt::null || manifold.body[1] == entt::null) {
+                orphans.push_back(local_entity);
+            }
+        }
+
+        // Keep track of which worker simulates each island.
+        if (multiple_workers && op->payload_type_any_of<island_tag>()) {
+            registry.emplace_or_replace<simulation_partition>(local_entity, worker_index);
+        }
     });
 
+    for (auto entity : orphans) {
+        if (registry.valid(entity)) {
+            ctx.emap.erase_local(entity);
+            registry.destroy(entity);
+        }
+    }
+
     m_importing = false;
-    m_op_observer->set_active(true);
+    ctx.op_observer->set_active(true);
 
     // Must consume events after each snapshot to avoid losing any event that
     // could be overriden in the next snapshot.
@@ -166,27 +401,281 @@ void stepper_async::on_step_update(message<msg::step_update> &msg) {
     emitter.consume_events();
 }
 
+void stepper_async::destroy_contact_manifolds(const entt::sparse_set &bodies, unsigned keep_worker) {
+    auto &registry = *m_registry;
+    auto manifold_view = registry.view<contact_manifold>();
+    auto &keep_emap = m_workers[keep_worker].emap;
+    auto manifolds = std::vector<entt::entity>{};
+
+    for (auto [entity, manifold] : manifold_view.each()) {
+        if (keep_emap.contains_local(entity)) {
+            continue;
+        }
+
+        if ((manifold.body[0] != entt::null && bodies.contains(manifold.body[0])) ||
+            (manifold.body[1] != entt::null && bodies.contains(manifold.body[1]))) {
+            manifolds.push_back(entity);
+        }
+    }
+
+    for (auto entity : manifolds) {
+        for (auto &ctx : m_workers) {
+            if (ctx.emap.contains_local(entity)) {
+                ctx.emap.erase_local(entity);
+            }
+        }
+
+        registry.destroy(entity);
+    }
+}
+
+void stepper_async::move_to_worker(entt::entity entity, unsigned dest) {
+    auto &partition = m_registry->get<simulation_partition>(entity);
+    auto &source = m_workers[partition.worker_index];
+
+    // Destroy it in the source worker and create it in the destination worker
+    // with the latest state in the main registry.
+    source.op_observer->unobserve(entity);
+
+    if (source.emap.contains_local(entity)) {
+        source.emap.erase_local(entity);
+    }
+
+    partition.worker_index = dest;
+    m_workers[dest].op_observer->observe(entity);
+}
+
+void stepper_async::migrate(entt::entity node_entity, unsigned dest) {
+    auto &registry = *m_registry;
+    auto &graph = registry.ctx().at<entity_graph>();
+    auto partition_view = registry.view<simulation_partition>();
+
+    auto is_foreign = [&](entt::entity entity) {
+        return partition_view.contains(entity) &&
+               partition_view.get<simulation_partition>(entity).worker_index != dest;
+    };
+
+    // Collect the connected component which must be moved as a whole.
+    auto nodes = std::vector<entt::entity>{};
+    auto edges = std::vector<entt::entity>{};
+    auto start_node_index = registry.get<graph_node>(node_entity).node_index;
+
+    graph.traverse(start_node_index, [&](auto node_index) {
+        auto entity = graph.node_entity(node_index);
+
+        if (is_foreign(entity)) {
+            nodes.push_back(entity);
+        }
+    }, [&](auto edge_index) {
+        auto entity = graph.edge_entity(edge_index);
+
+        if (is_foreign(entity)) {
+            edges.push_back(entity);
+        }
+    });
+
+    if (nodes.empty() && edges.empty()) {
+        return;
+    }
+
+    // Contact manifolds are not moved. They're destroyed along with the bodies
+    // in the source worker and the destination worker will create new ones.
+    auto moved = entt::sparse_set{};
+
+    for (auto entity : nodes) {
+        moved.emplace(entity);
+    }
+
+    destroy_contact_manifolds(moved, dest);
+
+    // Nodes must be created before edges in the destination.
+    for (auto entity : nodes) {
+        move_to_worker(entity, dest);
+    }
+
+    auto parent_view = registry.view<parent_comp>();
+    auto child_view = registry.view<child_list>();
+
+    for (auto entity : nodes) {
+        if (!parent_view.contains(entity)) {
+            continue;
+        }
+
+        auto child = parent_view.get<parent_comp>(entity).child;
+
+        while (child != entt::null) {
+            if (is_foreign(child)) {
+                move_to_worker(child, dest);
+            }
+
+            child = child_view.get<child_list>(child).next;
+        }
+    }
+
+    for (auto entity : edges) {
+        move_to_worker(entity, dest);
+    }
+
+    // Moved entities might be asleep and there might be nothing to wake them
+    // up in the destination.
+    auto &wake_up = m_workers[dest].pending_wake_up;
+    wake_up.insert(wake_up.end(), nodes.begin(), nodes.end());
+}
+
+void stepper_async::update_partitions() {
+    if (m_workers.size() < 2) {
+        return;
+    }
+
+    auto &registry = *m_registry;
+    auto island_view = registry.view<island_tag, island_AABB, simulation_partition>();
+    auto resident_view = registry.view<island_resident, graph_node, simulation_partition>();
+    auto sleeping_view = registry.view<sleeping_tag>();
+
+    // Islands with residents which were moved to another worker are stale.
+    // The worker which simulates them hasn't yet processed the move.
+    auto stale_islands = entt::sparse_set{};
+    auto island_nodes = std::map<entt::entity, entt::entity>{};
+
+    for (auto entity : resident_view) {
+        auto island_entity = resident_view.get<island_resident>(entity).island_entity;
+        auto &partition = resident_view.get<simulation_partition>(entity);
+
+        if (island_entity == entt::null || !island_view.contains(island_entity)) {
+            continue;
+        }
+
+        if (island_view.get<simulation_partition>(island_entity).worker_index != partition.worker_index) {
+            if (!stale_islands.contains(island_entity)) {
+                stale_islands.emplace(island_entity);
+            }
+        } else {
+            island_nodes.emplace(island_entity, entity);
+        }
+    }
+
+    struct island_info {
+        entt::entity entity;
+        AABB aabb;
+        unsigned worker_index;
+        bool sleeping;
+        bool overlapping;
+        bool migrated;
+    };
+
+    auto islands = std::vector<island_info>{};
+    auto inflation = vector3_one * m_partition_margin;
+
+    for (auto [entity, aabb, partition] : island_view.each()) {
+        if (stale_islands.contains(entity) || island_nodes.count(entity) == 0) {
+            continue;
+        }
+
+        islands.push_back({entity, aabb.inset(-inflation), partition.worker_index,
+                           sleeping_view.contains(entity), false, false});
+    }
+
+    std::sort(islands.begin(), islands.end(), [](auto &lhs, auto &rhs) {
+        return lhs.aabb.min.x < rhs.aabb.min.x;
+    });
+
+    auto volume = [](const AABB &aabb) {
+        auto size = aabb.max - aabb.min;
+        return size.x * size.y * size.z;
+    };
+
+    // Sweep along the x axis and bring islands that could interact into the
+    // same worker. Awake islands move into the worker of sleeping ones, which
+    // would be expensive to move. Between awake islands, the smallest moves.
+    for (size_t i = 0; i < islands.size(); ++i) {
+        for (size_t j = i + 1; j < islands.size() && islands[j].aabb.min.x <= islands[i].aabb.max.x; ++j) {
+            auto &island0 = islands[i];
+            auto &island1 = islands[j];
+
+            if (!intersect(island0.aabb, island1.aabb)) {
+                continue;
+            }
+
+            island0.overlapping = island1.overlapping = true;
+
+            if (island0.worker_index == island1.worker_index ||
+                island0.migrated || island1.migrated ||
+                (island0.sleeping && island1.sleeping)) {
+                continue;
+            }
+
+            auto move_first = island1.sleeping ||
+                (!island0.sleeping && volume(island0.aabb) < volume(island1.aabb));
+            auto &source = move_first ? island0 : island1;
+            auto &destination = move_first ? island1 : island0;
+
+            migrate(island_nodes.at(source.entity), destination.worker_index);
+            source.worker_index = destination.worker_index;
+            source.migrated = true;
+        }
+    }
+
+    // Gradually move isolated islands into the worker responsible for the
+    // region they're in.
+    constexpr size_t max_rebalanced_islands = 4;
+    size_t num_rebalanced = 0;
+
+    for (auto &island : islands) {
+        if (num_rebalanced == max_rebalanced_islands) {
+            break;
+        }
+
+        if (island.sleeping || island.overlapping || island.migrated) {
+            continue;
+        }
+
+        auto region0 = std::floor(island.aabb.min.x / m_partition_region_size);
+        auto region1 = std::floor(island.aabb.max.x / m_partition_region_size);
+
+        if (region0 != region1) {
+            continue;
+        }
+
+        auto dest = region_worker(island.aabb.min);
+
+        if (dest != island.worker_index) {
+            migrate(island_nodes.at(island.entity), dest);
+            ++num_rebalanced;
+        }
+    }
+}
+
 void stepper_async::on_raycast_response(message<msg::raycast_response> &msg) {
     auto &response = msg.content;
+    auto &emap = m_workers[worker_index(msg.sender)].emap;
     auto result = response.result;
 
     if (result.entity != entt::null) {
-        if (m_entity_map.contains(result.entity)) {
-            result.entity = m_entity_map.at(result.entity);
+        if (emap.contains(result.entity)) {
+            result.entity = emap.at(result.entity);
         } else {
             result.entity = entt::null;
         }
     }
 
     auto &ctx = m_raycast_ctx.at(response.id);
-    ctx.delegate(response.id, result, ctx.p0, ctx.p1);
-    m_raycast_ctx.erase(response.id);
+
+    // Keep the closest hit among all workers.
+    if (result.fraction < ctx.result.fraction) {
+        ctx.result = result;
+    }
+
+    if (--ctx.pending == 0) {
+        ctx.delegate(response.id, ctx.result, ctx.p0, ctx.p1);
+        m_raycast_ctx.erase(response.id);
+    }
 }
 
 void stepper_async::on_query_aabb_response(message<msg::query_aabb_response> &msg) {
     auto &response = msg.content;
-    auto result = query_aabb_result{};
-    auto &emap = m_entity_map;
+    auto &emap = m_workers[worker_index(msg.sender)].emap;
+    auto &ctx = m_query_aabb_ctx.at(response.id);
+    auto &result = ctx.result;
 
     for (auto entity : response.island_entities) {
         if (emap.contains(entity)) {
@@ -206,14 +695,33 @@ void stepper_async::on_query_aabb_response(message<msg::query_aabb_response> &ms
         }
     }
 
-    auto &ctx = m_query_aabb_ctx.at(response.id);
+    if (--ctx.pending > 0) {
+        return;
+    }
+
+    if (m_workers.size() > 1) {
+        // Non-procedural entities are present in all workers.
+        auto &entities = result.non_procedural_entities;
+        std::sort(entities.begin(), entities.end());
+        entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+    }
+
     ctx.delegate(response.id, std::move(result));
     m_query_aabb_ctx.erase(response.id);
 }
 
 void stepper_async::sync() {
-    if (!m_op_builder->empty()) {
-        send_message_to_worker<msg::update_entities>(m_op_builder->finish());
+    for (unsigned i = 0; i < m_workers.size(); ++i) {
+        auto &ctx = m_workers[i];
+
+        if (!ctx.op_builder->empty()) {
+            send_message_to_worker_index<msg::update_entities>(i, ctx.op_builder->finish());
+        }
+
+        if (!ctx.pending_wake_up.empty()) {
+            send_message_to_worker_index<msg::wake_up_residents>(i, std::move(ctx.pending_wake_up));
+            ctx.pending_wake_up.clear();
+        }
     }
 }
 
@@ -258,6 +766,8 @@ void stepper_async::calculate_presentation_delay(double current_time, double ela
 
 void stepper_async::update(double current_time) {
     m_message_queue_handle.update();
+    apply_step_updates();
+    update_partitions();
     sync();
 
     auto &settings = m_registry->ctx().at<edyn::settings>();
@@ -281,6 +791,19 @@ void stepper_async::update(double current_time) {
     m_last_time = current_time;
 }
 
+tick_lateness stepper_async::get_tick_lateness() const {
+    auto lateness = tick_lateness{};
+
+    for (auto &ctx : m_workers) {
+        auto worker_lateness = ctx.worker->get_tick_lateness();
+        lateness.last = std::max(lateness.last, worker_lateness.last);
+        lateness.average = std::max(lateness.average, worker_lateness.average);
+        lateness.max = std::max(lateness.max, worker_lateness.max);
+    }
+
+    return lateness;
+}
+
 void stepper_async::set_paused(bool paused) {
     m_paused = paused;
     m_presentation_delay = 0;
@@ -295,13 +818,19 @@ void stepper_async::step_simulation() {
 
 void stepper_async::settings_changed() {
     auto &settings = m_registry->ctx().at<edyn::settings>();
+    EDYN_ASSERT(m_workers.size() == 1 || std::holds_alternative<std::monostate>(settings.network_settings),
+                "Networking is only supported with a single simulation worker.");
     send_message_to_worker<msg::set_settings>(settings);
 }
 
 void stepper_async::reg_op_ctx_changed() {
     auto &reg_op_ctx = m_registry->ctx().at<registry_operation_context>();
-    m_op_builder = (*reg_op_ctx.make_reg_op_builder)(*m_registry);
-    m_op_observer = (*reg_op_ctx.make_reg_op_observer)(*m_op_builder);
+
+    for (auto &ctx : m_workers) {
+        ctx.op_builder = (*reg_op_ctx.make_reg_op_builder)(*m_registry);
+        ctx.op_observer = (*reg_op_ctx.make_reg_op_observer)(*ctx.op_builder);
+    }
+
     send_message_to_worker<msg::set_registry_operation_context>(reg_op_ctx);
 }
 
@@ -311,13 +840,17 @@ void stepper_async::material_table_changed() {
 }
 
 void stepper_async::set_center_of_mass(entt::entity entity, const vector3 &com) {
-    send_message_to_worker<msg::set_com>(entity, com);
+    each_worker_of(entity, [&](unsigned i) {
+        send_message_to_worker_index<msg::set_com>(i, entity, com);
+    });
 }
 
 void stepper_async::wake_up_entity(entt::entity entity) {
-    auto msg = std::vector<entt::entity>{};
-    msg.push_back(entity);
-    send_message_to_worker<msg::wake_up_residents>(std::move(msg));
+    each_worker_of(entity, [&](unsigned i) {
+        auto msg = std::vector<entt::entity>{};
+        msg.push_back(entity);
+        send_message_to_worker_index<msg::wake_up_residents>(i, std::move(msg));
+    });
 }
 
 void stepper_async::set_rigidbody_kind(entt::entity entity, rigidbody_kind kind) {
@@ -326,7 +859,54 @@ void stepper_async::set_rigidbody_kind(entt::entity entity, rigidbody_kind kind)
     sync();
     auto msg = msg::change_rigidbody_kind{};
     msg.changes.emplace_back(entity, kind);
-    send_message_to_worker<msg::change_rigidbody_kind>(std::move(msg));
+
+    each_worker_of(entity, [&](unsigned i) {
+        send_message_to_worker_index<msg::change_rigidbody_kind>(i, msg);
+    });
+
+    if (m_workers.size() == 1) {
+        return;
+    }
+
+    auto &registry = *m_registry;
+    auto &graph = registry.ctx().at<entity_graph>();
+    auto procedural = kind == rigidbody_kind::rb_dynamic;
+    graph.set_connecting_node(registry.get<graph_node>(entity).node_index, procedural);
+
+    if (procedural && !registry.all_of<simulation_partition>(entity)) {
+        // Keep it only in the worker responsible for its region and bring
+        // anything it's connected to into the same worker.
+        auto dest = region_worker(registry.get<position>(entity));
+
+        for (unsigned i = 0; i < m_workers.size(); ++i) {
+            auto &ctx = m_workers[i];
+
+            if (i != dest) {
+                ctx.op_observer->unobserve(entity);
+
+                if (ctx.emap.contains_local(entity)) {
+                    ctx.emap.erase_local(entity);
+                }
+            }
+        }
+
+        auto bodies = entt::sparse_set{};
+        bodies.emplace(entity);
+        destroy_contact_manifolds(bodies, dest);
+
+        registry.emplace<simulation_partition>(entity, dest);
+        migrate(entity, dest);
+    } else if (!procedural && registry.all_of<simulation_partition>(entity)) {
+        // Non-procedural entities must be present in all workers.
+        auto owner = registry.get<simulation_partition>(entity).worker_index;
+        registry.remove<simulation_partition>(entity);
+
+        for (unsigned i = 0; i < m_workers.size(); ++i) {
+            if (i != owner) {
+                m_workers[i].op_observer->observe(entity);
+            }
+        }
+    }
 }
 
 raycast_id_type stepper_async::raycast(vector3 p0, vector3 p1,
@@ -337,6 +917,7 @@ raycast_id_type stepper_async::raycast(vector3 p0, vector3 p1,
     ctx.delegate = delegate;
     ctx.p0 = p0;
     ctx.p1 = p1;
+    ctx.pending = m_workers.size();
     send_message_to_worker<msg::raycast_request>(id, p0, p1, ignore_entities);
 
     return id;
@@ -351,6 +932,7 @@ query_aabb_id_type stepper_async::query_aabb(const AABB &aabb,
     auto &ctx = m_query_aabb_ctx[id];
     ctx.delegate = delegate;
     ctx.aabb = aabb;
+    ctx.pending = m_workers.size();
     send_message_to_worker<msg::query_aabb_request>(id, aabb, query_procedural, query_non_procedural, query_islands);
 
     return id;
@@ -362,6 +944,7 @@ query_aabb_id_type stepper_async::query_aabb_of_interest(const AABB &aabb,
     auto &ctx = m_query_aabb_ctx[id];
     ctx.delegate = delegate;
     ctx.aabb = aabb;
+    ctx.pending = m_workers.size();
     send_message_to_worker<msg::query_aabb_of_interest_request>(id, aabb);
 
     return id;
@@ -6,6 +6,7 @@
 #include "edyn/collision/narrowphase.hpp"
 #include "edyn/core/entity_graph.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
+#include "edyn/sys/prefetch_paged_meshes.hpp"
 #include "edyn/sys/update_presentation.hpp"
 #include <entt/entity/registry.hpp>
 #include <cstdint>
@@ -66,6 +67,7 @@ void stepper_sequential::update(double time) {
         }
 
         bphase.update(m_multithreaded);
+        prefetch_paged_meshes(*m_registry, settings.paged_mesh_prefetch_time);
         m_island_manager.update(step_time);
         nphase.update(m_multithreaded);
         m_solver.update(m_multithreaded);
@@ -100,6 +102,7 @@ void stepper_sequential::step_simulation(double time) {
 
     m_poly_initializer.init_new_shapes();
     bphase.update(m_multithreaded);
+    prefetch_paged_meshes(*m_registry, settings.paged_mesh_prefetch_time);
     m_island_manager.update(m_last_time);
     nphase.update(m_multithreaded);
     m_solver.update(m_multithreaded);
@@ -0,0 +1,51 @@
+#include "edyn/sys/prefetch_paged_meshes.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/math/constants.hpp"
+#include "edyn/shapes/paged_mesh_shape.hpp"
+#include "edyn/shapes/heightfield_shape.hpp"
+#include "edyn/shapes/paged_triangle_mesh.hpp"
+#include "edyn/util/aabb_util.hpp"
+#include "edyn/util/island_util.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+void prefetch_paged_meshes(entt::registry &registry, scalar time_horizon) {
+    auto paged_mesh_view = registry.view<paged_mesh_shape, position, orientation>();
+    auto heightfield_view = registry.view<heightfield_shape>();
+
+    if ((paged_mesh_view.size_hint() == 0 && heightfield_view.size() == 0) || time_horizon <= 0) {
+        return;
+    }
+
+    auto &bphase = registry.ctx().at<broadphase>();
+    auto body_view = registry.view<AABB, linvel, dynamic_tag>(exclude_sleeping_disabled);
+    constexpr auto margin = vector3_one * contact_breaking_threshold;
+
+    for (auto [entity, aabb, vel] : body_view.each()) {
+        // Region swept by the AABB over the time horizon.
+        auto displacement = vel * time_horizon;
+        auto swept_aabb = AABB{
+            min(aabb.min, aabb.min + displacement) - margin,
+            max(aabb.max, aabb.max + displacement) + margin
+        };
+
+        bphase.query_non_procedural(swept_aabb, [&](entt::entity np_entity) {
+            if (paged_mesh_view.contains(np_entity)) {
+                auto [shape, pos, orn] = paged_mesh_view.get(np_entity);
+                shape.trimesh->prefetch(aabb_to_object_space(swept_aabb, pos, orn));
+            } else if (heightfield_view.contains(np_entity)) {
+                // Heightfields are placed by their origin.
+                auto [shape] = heightfield_view.get(np_entity);
+                shape.field->prefetch(swept_aabb);
+            }
+        });
+    }
+}
+
+}
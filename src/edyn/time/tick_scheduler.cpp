@@ -0,0 +1,208 @@
+#include "edyn/time/tick_scheduler.hpp"
+#include "edyn/parallel/cpu_relax.hpp"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace edyn {
+
+// Bounds of the time spent spinning right before a deadline.
+static constexpr double tick_scheduler_min_spin_time = 50e-6;
+static constexpr double tick_scheduler_max_spin_time = 2e-3;
+
+// Longest time parked before polling a custom time source again.
+static constexpr double tick_scheduler_max_park_time = 10e-3;
+
+// Weight of a new sample in running averages.
+static constexpr double tick_scheduler_smoothing = 0.05;
+
+static double to_seconds(tick_scheduler::clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+static tick_scheduler::clock::duration to_duration(double seconds) {
+    return std::chrono::duration_cast<tick_scheduler::clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+bool tick_scheduler::consume_wake() {
+    auto expected = state_woken;
+    return m_state.compare_exchange_strong(expected, state_running, std::memory_order_acq_rel);
+}
+
+bool tick_scheduler::sleep_until(clock::time_point deadline) {
+    if (consume_wake()) {
+        return false;
+    }
+
+    // Leave the kernel early enough to absorb its usual oversleep and spin
+    // for the remaining time.
+    auto spin_time = std::clamp(2 * m_oversleep, tick_scheduler_min_spin_time, tick_scheduler_max_spin_time);
+    auto park_deadline = deadline - to_duration(spin_time);
+
+    if (clock::now() < park_deadline) {
+        if (!park_until(park_deadline)) {
+            return false;
+        }
+
+        auto oversleep = std::max(to_seconds(clock::now() - park_deadline), 0.0);
+        m_oversleep += (oversleep - m_oversleep) * tick_scheduler_smoothing;
+    }
+
+    auto now = clock::now();
+
+    while (now < deadline) {
+        if (consume_wake()) {
+            return false;
+        }
+
+        cpu_relax();
+        now = clock::now();
+    }
+
+    record_lateness(to_seconds(now - deadline));
+
+    return true;
+}
+
+bool tick_scheduler::sleep_until(double deadline, time_func_t *time_func) {
+    if (consume_wake()) {
+        return false;
+    }
+
+    auto spin_time = std::clamp(2 * m_oversleep, tick_scheduler_min_spin_time, tick_scheduler_max_spin_time);
+    auto spin_start = clock::now();
+    auto now = (*time_func)();
+
+    while (now < deadline) {
+        // Park while far from the deadline, or if the time source did not
+        // advance during a whole spin window, which happens when it stalls.
+        auto remaining = deadline - now;
+        auto stalled = clock::now() - spin_start > to_duration(spin_time);
+
+        if (remaining > spin_time || stalled) {
+            auto park_time = std::clamp(remaining - spin_time, tick_scheduler_min_spin_time, tick_scheduler_max_park_time);
+            auto park_deadline = clock::now() + to_duration(park_time);
+
+            if (!park_until(park_deadline)) {
+                return false;
+            }
+
+            auto oversleep = std::max(to_seconds(clock::now() - park_deadline), 0.0);
+            m_oversleep += (oversleep - m_oversleep) * tick_scheduler_smoothing;
+            spin_time = std::clamp(2 * m_oversleep, tick_scheduler_min_spin_time, tick_scheduler_max_spin_time);
+            spin_start = clock::now();
+        } else {
+            if (consume_wake()) {
+                return false;
+            }
+
+            cpu_relax();
+        }
+
+        now = (*time_func)();
+    }
+
+    record_lateness(now - deadline);
+
+    return true;
+}
+
+void tick_scheduler::record_lateness(double lateness) {
+    // There's a single writer thread thus relaxed load-store pairs suffice.
+    m_last_lateness.store(lateness, std::memory_order_relaxed);
+
+    auto average = m_average_lateness.load(std::memory_order_relaxed);
+    average += (lateness - average) * tick_scheduler_smoothing;
+    m_average_lateness.store(average, std::memory_order_relaxed);
+
+    if (lateness > m_max_lateness.load(std::memory_order_relaxed)) {
+        m_max_lateness.store(lateness, std::memory_order_relaxed);
+    }
+}
+
+tick_lateness tick_scheduler::get_lateness() const {
+    auto lateness = tick_lateness{};
+    lateness.last = m_last_lateness.load(std::memory_order_relaxed);
+    lateness.average = m_average_lateness.load(std::memory_order_relaxed);
+    lateness.max = m_max_lateness.load(std::memory_order_relaxed);
+    return lateness;
+}
+
+#if defined(__linux__)
+
+void tick_scheduler::wake() {
+    if (m_state.exchange(state_woken, std::memory_order_acq_rel) == state_parked) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_state), FUTEX_WAKE_PRIVATE,
+                1, nullptr, nullptr, 0);
+    }
+}
+
+bool tick_scheduler::park_until(clock::time_point deadline) {
+    auto expected = state_running;
+
+    if (!m_state.compare_exchange_strong(expected, state_parked, std::memory_order_acq_rel)) {
+        // Woken up in the meantime.
+        m_state.store(state_running, std::memory_order_release);
+        return false;
+    }
+
+    // `FUTEX_WAIT_BITSET` takes an absolute timeout in `CLOCK_MONOTONIC`,
+    // which is the clock behind `std::chrono::steady_clock`. Unlike
+    // `clock_nanosleep`, the sleep can be interrupted by `wake`.
+    auto since_epoch = deadline.time_since_epoch();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    auto timeout = timespec{};
+    timeout.tv_sec = static_cast<time_t>(seconds.count());
+    timeout.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count());
+
+    // Loop to handle spurious wake ups and interruptions.
+    while (m_state.load(std::memory_order_acquire) == state_parked) {
+        auto result = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_state),
+                              FUTEX_WAIT_BITSET_PRIVATE, state_parked, &timeout,
+                              nullptr, FUTEX_BITSET_MATCH_ANY);
+
+        if (result == -1 && errno == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    return m_state.exchange(state_running, std::memory_order_acq_rel) != state_woken;
+}
+
+#else
+
+void tick_scheduler::wake() {
+    if (m_state.exchange(state_woken, std::memory_order_acq_rel) == state_parked) {
+        // The sleeping thread holds the lock from the moment it parks until it
+        // starts waiting, thus the notification cannot be missed.
+        std::lock_guard lock(m_mutex);
+        m_cv.notify_one();
+    }
+}
+
+bool tick_scheduler::park_until(clock::time_point deadline) {
+    std::unique_lock lock(m_mutex);
+    auto expected = state_running;
+
+    if (!m_state.compare_exchange_strong(expected, state_parked, std::memory_order_acq_rel)) {
+        // Woken up in the meantime.
+        m_state.store(state_running, std::memory_order_release);
+        return false;
+    }
+
+    m_cv.wait_until(lock, deadline, [&] {
+        return m_state.load(std::memory_order_acquire) == state_woken;
+    });
+
+    return m_state.exchange(state_running, std::memory_order_acq_rel) != state_woken;
+}
+
+#endif
+
+}
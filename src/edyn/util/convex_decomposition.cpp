@@ -0,0 +1,1338 @@
+#include "edyn/util/convex_decomposition.hpp"
+#include "edyn/util/shape_util.hpp"
+#include "edyn/math/geom.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/parallel/parallel_for.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/binary_file.hpp"
+#include "edyn/shapes/mesh_asset_cache.hpp"
+#include "edyn/util/mapped_file.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace edyn {
+
+namespace detail {
+
+/* Convex hull */
+
+using hull_triangle = std::array<uint32_t, 3>;
+
+struct hull_face {
+    hull_triangle vertices;
+    vector3 normal;
+    scalar distance;
+    std::vector<uint32_t> outside;
+    uint32_t farthest;
+    scalar farthest_distance;
+    bool removed;
+};
+
+static uint64_t hull_edge_key(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Incremental convex hull in the style of Quickhull. The point farthest from
+// the hull is added in each iteration, which yields a good approximation of
+// the full hull if the number of vertices is limited.
+class convex_hull_builder {
+public:
+    convex_hull_builder(const std::vector<vector3> &points, scalar tolerance)
+        : m_points(&points)
+        , m_tolerance(tolerance)
+    {}
+
+    bool build(size_t max_vertices, std::vector<hull_triangle> &triangles) {
+        triangles.clear();
+
+        if (m_points->size() < 4 || max_vertices < 4 || !create_simplex()) {
+            return false;
+        }
+
+        auto num_vertices = size_t{4};
+
+        while (num_vertices < max_vertices && add_farthest_point()) {
+            ++num_vertices;
+        }
+
+        for (auto &face : m_faces) {
+            if (!face.removed) {
+                triangles.push_back(face.vertices);
+            }
+        }
+
+        return true;
+    }
+
+private:
+    scalar distance(const hull_face &face, uint32_t idx) const {
+        return dot(face.normal, (*m_points)[idx]) - face.distance;
+    }
+
+    uint32_t add_face(uint32_t a, uint32_t b, uint32_t c) {
+        auto &points = *m_points;
+        auto face_idx = static_cast<uint32_t>(m_faces.size());
+        auto &face = m_faces.emplace_back();
+        face.vertices = {a, b, c};
+        face.normal = cross(points[b] - points[a], points[c] - points[a]);
+
+        if (!try_normalize(face.normal)) {
+            face.normal = vector3_zero;
+        }
+
+        face.distance = dot(face.normal, points[a]);
+        face.farthest_distance = 0;
+        face.removed = false;
+
+        m_edges[hull_edge_key(a, b)] = face_idx;
+        m_edges[hull_edge_key(b, c)] = face_idx;
+        m_edges[hull_edge_key(c, a)] = face_idx;
+
+        return face_idx;
+    }
+
+    // Assigns a point to the face it's farthest above, if any.
+    void assign_point(uint32_t idx, const std::vector<uint32_t> &face_indices) {
+        auto best_face = std::numeric_limits<uint32_t>::max();
+        auto best_distance = m_tolerance;
+
+        for (auto face_idx : face_indices) {
+            auto dist = distance(m_faces[face_idx], idx);
+
+            if (dist > best_distance) {
+                best_distance = dist;
+                best_face = face_idx;
+            }
+        }
+
+        if (best_face == std::numeric_limits<uint32_t>::max()) {
+            return;
+        }
+
+        auto &face = m_faces[best_face];
+        face.outside.push_back(idx);
+
+        if (best_distance > face.farthest_distance) {
+            face.farthest_distance = best_distance;
+            face.farthest = idx;
+        }
+    }
+
+    bool create_simplex() {
+        auto &points = *m_points;
+        auto num_points = static_cast<uint32_t>(points.size());
+        auto extremes = std::array<uint32_t, 6>{};
+
+        for (uint32_t i = 0; i < num_points; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                if (points[i][j] < points[extremes[j * 2]][j]) extremes[j * 2] = i;
+                if (points[i][j] > points[extremes[j * 2 + 1]][j]) extremes[j * 2 + 1] = i;
+            }
+        }
+
+        // Most distant pair of extreme points.
+        uint32_t i0 = 0, i1 = 0;
+        scalar max_dist_sqr = 0;
+
+        for (int j = 0; j < 3; ++j) {
+            auto dist_sqr = distance_sqr(points[extremes[j * 2]], points[extremes[j * 2 + 1]]);
+
+            if (dist_sqr > max_dist_sqr) {
+                max_dist_sqr = dist_sqr;
+                i0 = extremes[j * 2];
+                i1 = extremes[j * 2 + 1];
+            }
+        }
+
+        if (max_dist_sqr <= square(m_tolerance)) {
+            return false;
+        }
+
+        // Point farthest from the line.
+        auto dir = points[i1] - points[i0];
+        uint32_t i2 = 0;
+        max_dist_sqr = 0;
+
+        for (uint32_t i = 0; i < num_points; ++i) {
+            auto dist_sqr = distance_sqr_line(points[i0], dir, points[i]);
+
+            if (dist_sqr > max_dist_sqr) {
+                max_dist_sqr = dist_sqr;
+                i2 = i;
+            }
+        }
+
+        if (max_dist_sqr <= square(m_tolerance)) {
+            return false;
+        }
+
+        // Point farthest from the plane.
+        auto normal = normalize(cross(dir, points[i2] - points[i0]));
+        uint32_t i3 = 0;
+        scalar max_dist = 0;
+
+        for (uint32_t i = 0; i < num_points; ++i) {
+            auto dist = std::abs(dot(points[i] - points[i0], normal));
+
+            if (dist > max_dist) {
+                max_dist = dist;
+                i3 = i;
+            }
+        }
+
+        if (max_dist <= m_tolerance) {
+            return false;
+        }
+
+        // Make the base face point away from the apex.
+        if (dot(points[i3] - points[i0], normal) > 0) {
+            std::swap(i1, i2);
+        }
+
+        auto simplex = std::vector<uint32_t>{
+            add_face(i0, i1, i2),
+            add_face(i0, i3, i1),
+            add_face(i1, i3, i2),
+            add_face(i2, i3, i0)
+        };
+
+        for (uint32_t i = 0; i < num_points; ++i) {
+            if (i != i0 && i != i1 && i != i2 && i != i3) {
+                assign_point(i, simplex);
+            }
+        }
+
+        return true;
+    }
+
+    bool add_farthest_point() {
+        auto seed = std::numeric_limits<uint32_t>::max();
+        scalar max_dist = 0;
+
+        for (uint32_t i = 0; i < m_faces.size(); ++i) {
+            auto &face = m_faces[i];
+
+            if (!face.removed && !face.outside.empty() && face.farthest_distance > max_dist) {
+                max_dist = face.farthest_distance;
+                seed = i;
+            }
+        }
+
+        if (seed == std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+
+        auto point_idx = m_faces[seed].farthest;
+
+        // Find faces visible from the point by flood fill starting at the face
+        // it's assigned to. Edges leading to faces which are not visible form
+        // the horizon.
+        m_visibility.assign(m_faces.size(), visibility_unknown);
+        m_visibility[seed] = visibility_visible;
+        m_stack.assign(1, seed);
+        m_visible.clear();
+        m_horizon.clear();
+
+        while (!m_stack.empty()) {
+            auto face_idx = m_stack.back();
+            m_stack.pop_back();
+            m_visible.push_back(face_idx);
+
+            for (int i = 0; i < 3; ++i) {
+                auto a = m_faces[face_idx].vertices[i];
+                auto b = m_faces[face_idx].vertices[(i + 1) % 3];
+                auto it = m_edges.find(hull_edge_key(b, a));
+                EDYN_ASSERT(it != m_edges.end());
+                auto neighbor_idx = it->second;
+                auto &state = m_visibility[neighbor_idx];
+
+                if (state == visibility_unknown) {
+                    if (distance(m_faces[neighbor_idx], point_idx) > 0) {
+                        state = visibility_visible;
+                        m_stack.push_back(neighbor_idx);
+                        continue;
+                    }
+
+                    state = visibility_hidden;
+                }
+
+                if (state == visibility_hidden) {
+                    m_horizon.push_back({a, b});
+                }
+            }
+        }
+
+        m_orphans.clear();
+
+        for (auto face_idx : m_visible) {
+            auto &face = m_faces[face_idx];
+            face.removed = true;
+            m_orphans.insert(m_orphans.end(), face.outside.begin(), face.outside.end());
+            face.outside = {};
+
+            for (int i = 0; i < 3; ++i) {
+                auto key = hull_edge_key(face.vertices[i], face.vertices[(i + 1) % 3]);
+                auto it = m_edges.find(key);
+
+                if (it != m_edges.end() && it->second == face_idx) {
+                    m_edges.erase(it);
+                }
+            }
+        }
+
+        m_new_faces.clear();
+
+        for (auto [a, b] : m_horizon) {
+            m_new_faces.push_back(add_face(a, b, point_idx));
+        }
+
+        for (auto idx : m_orphans) {
+            if (idx != point_idx) {
+                assign_point(idx, m_new_faces);
+            }
+        }
+
+        return true;
+    }
+
+    enum visibility : uint8_t {
+        visibility_unknown,
+        visibility_visible,
+        visibility_hidden
+    };
+
+    const std::vector<vector3> *m_points;
+    scalar m_tolerance;
+    std::vector<hull_face> m_faces;
+    std::unordered_map<uint64_t, uint32_t> m_edges;
+
+    // Scratch buffers.
+    std::vector<uint8_t> m_visibility;
+    std::vector<uint32_t> m_stack;
+    std::vector<uint32_t> m_visible;
+    std::vector<std::array<uint32_t, 2>> m_horizon;
+    std::vector<uint32_t> m_orphans;
+    std::vector<uint32_t> m_new_faces;
+};
+
+static scalar hull_volume(const std::vector<vector3> &points,
+                          const std::vector<hull_triangle> &triangles) {
+    if (triangles.empty()) {
+        return 0;
+    }
+
+    auto origin = points[triangles.front()[0]];
+    scalar volume = 0;
+
+    for (auto &tri : triangles) {
+        volume += triple_product(points[tri[0]] - origin, points[tri[1]] - origin, points[tri[2]] - origin);
+    }
+
+    return volume / 6;
+}
+
+static void hull_vertex_positions(const std::vector<vector3> &points,
+                                  const std::vector<hull_triangle> &triangles,
+                                  std::vector<vector3> &positions) {
+    auto used = std::vector<bool>(points.size(), false);
+    positions.clear();
+
+    for (auto &tri : triangles) {
+        for (auto idx : tri) {
+            if (!used[idx]) {
+                used[idx] = true;
+                positions.push_back(points[idx]);
+            }
+        }
+    }
+}
+
+// Creates a polyhedron from the triangles of a convex hull, merging coplanar
+// triangles into polygons.
+static polyhedron_with_center make_hull_polyhedron(const std::vector<vector3> &points,
+                                                   const std::vector<hull_triangle> &triangles) {
+    auto num_triangles = triangles.size();
+    auto normals = std::vector<vector3>(num_triangles);
+    auto edges = std::unordered_map<uint64_t, uint32_t>{};
+
+    for (uint32_t i = 0; i < num_triangles; ++i) {
+        auto &tri = triangles[i];
+        normals[i] = cross(points[tri[1]] - points[tri[0]], points[tri[2]] - points[tri[0]]);
+        try_normalize(normals[i]);
+
+        for (int j = 0; j < 3; ++j) {
+            edges[hull_edge_key(tri[j], tri[(j + 1) % 3])] = i;
+        }
+    }
+
+    // Group coplanar neighbors using union-find.
+    auto group = std::vector<uint32_t>(num_triangles);
+    std::iota(group.begin(), group.end(), 0);
+
+    auto find = [&](uint32_t i) {
+        while (group[i] != i) {
+            group[i] = group[group[i]];
+            i = group[i];
+        }
+        return i;
+    };
+
+    constexpr auto coplanar_tolerance = scalar(1e-5);
+
+    for (uint32_t i = 0; i < num_triangles; ++i) {
+        auto &tri = triangles[i];
+
+        for (int j = 0; j < 3; ++j) {
+            auto it = edges.find(hull_edge_key(tri[(j + 1) % 3], tri[j]));
+
+            if (it != edges.end() && dot(normals[i], normals[it->second]) > 1 - coplanar_tolerance) {
+                group[find(i)] = find(it->second);
+            }
+        }
+    }
+
+    auto group_triangles = std::unordered_map<uint32_t, std::vector<uint32_t>>{};
+
+    for (uint32_t i = 0; i < num_triangles; ++i) {
+        group_triangles[find(i)].push_back(i);
+    }
+
+    auto next = std::unordered_map<uint32_t, uint32_t>{};
+    auto loops = std::vector<std::vector<uint32_t>>{};
+
+    for (auto &[root, tri_indices] : group_triangles) {
+        // The boundary of the group is formed by the edges shared with
+        // triangles of other groups.
+        next.clear();
+
+        for (auto tri_idx : tri_indices) {
+            auto &tri = triangles[tri_idx];
+
+            for (int j = 0; j < 3; ++j) {
+                auto it = edges.find(hull_edge_key(tri[(j + 1) % 3], tri[j]));
+
+                if (it == edges.end() || find(it->second) != root) {
+                    next[tri[j]] = tri[(j + 1) % 3];
+                }
+            }
+        }
+
+        auto loop = std::vector<uint32_t>{};
+        auto start = next.begin()->first;
+        auto curr = start;
+
+        do {
+            loop.push_back(curr);
+            auto it = next.find(curr);
+            curr = it != next.end() ? it->second : start;
+        } while (curr != start && loop.size() <= next.size());
+
+        if (loop.size() == next.size() && loop.size() >= 3) {
+            loops.push_back(std::move(loop));
+        } else {
+            // Not a simple polygon. Keep the triangles.
+            for (auto tri_idx : tri_indices) {
+                auto &tri = triangles[tri_idx];
+                loops.push_back({tri[0], tri[1], tri[2]});
+            }
+        }
+    }
+
+    // Vertices shared by less than three faces lie in the middle of an edge.
+    auto face_count = std::unordered_map<uint32_t, uint32_t>{};
+
+    for (auto &loop : loops) {
+        for (auto idx : loop) {
+            ++face_count[idx];
+        }
+    }
+
+    auto redundant = [&](uint32_t idx) { return face_count[idx] < 3; };
+    auto can_remove = std::all_of(loops.begin(), loops.end(), [&](auto &loop) {
+        return loop.size() - std::count_if(loop.begin(), loop.end(), redundant) >= 3;
+    });
+
+    auto result = polyhedron_with_center{};
+    result.shape.mesh = std::make_shared<convex_mesh>();
+    auto &mesh = *result.shape.mesh;
+    auto vertex_map = std::unordered_map<uint32_t, uint32_t>{};
+
+    for (auto &loop : loops) {
+        auto first_index = static_cast<uint32_t>(mesh.indices.size());
+
+        for (auto idx : loop) {
+            if (can_remove && redundant(idx)) {
+                continue;
+            }
+
+            auto [it, inserted] = vertex_map.emplace(idx, static_cast<uint32_t>(mesh.vertices.size()));
+
+            if (inserted) {
+                mesh.vertices.push_back(points[idx]);
+            }
+
+            mesh.indices.push_back(it->second);
+        }
+
+        mesh.faces.push_back(first_index);
+        mesh.faces.push_back(static_cast<uint32_t>(mesh.indices.size()) - first_index);
+    }
+
+    // Make all vertices to be positioned with respect to the centroid as in
+    // `load_convex_polyhedrons_from_obj`.
+    result.center = mesh_centroid(mesh.vertices, mesh.indices, mesh.faces);
+
+    for (auto &v : mesh.vertices) {
+        v -= result.center;
+    }
+
+    mesh.update_calculated_properties();
+
+#ifdef EDYN_DEBUG
+    mesh.validate();
+#endif
+
+    return result;
+}
+
+/* Voxelization */
+
+using voxel = std::array<uint16_t, 3>;
+
+struct voxel_grid {
+    vector3 origin;
+    scalar voxel_size;
+    std::array<int, 3> size;
+    std::vector<uint8_t> cells;
+
+    // Triangles which intersect each voxel. The triangles of the i-th voxel
+    // are in the range [triangle_start[i], triangle_start[i + 1]).
+    std::vector<uint32_t> triangle_start;
+    std::vector<uint32_t> triangle_indices;
+
+    size_t index(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * size[1] + y) * size[0] + x;
+    }
+};
+
+struct voxel_part {
+    std::vector<voxel> voxels;
+    std::array<int, 3> min;
+    std::array<int, 3> max;
+
+    void update_bounds() {
+        min = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+        max = {-1, -1, -1};
+
+        for (auto &v : voxels) {
+            for (int i = 0; i < 3; ++i) {
+                min[i] = std::min(min[i], int(v[i]));
+                max[i] = std::max(max[i], int(v[i]));
+            }
+        }
+    }
+};
+
+enum voxel_state : uint8_t {
+    voxel_unknown,
+    voxel_surface,
+    voxel_outside
+};
+
+static bool intersect_triangle_voxel(vector3 v0, vector3 v1, vector3 v2,
+                                     const vector3 &center, scalar half_size) {
+    // Separating axis test as in "Fast 3D Triangle-Box Overlap Testing" by
+    // Tomas Akenine-Möller.
+    v0 -= center;
+    v1 -= center;
+    v2 -= center;
+
+    for (int i = 0; i < 3; ++i) {
+        if (std::min({v0[i], v1[i], v2[i]}) > half_size ||
+            std::max({v0[i], v1[i], v2[i]}) < -half_size) {
+            return false;
+        }
+    }
+
+    auto separated = [&](const vector3 &axis) {
+        auto p0 = dot(axis, v0);
+        auto p1 = dot(axis, v1);
+        auto p2 = dot(axis, v2);
+        auto radius = half_size * (std::abs(axis.x) + std::abs(axis.y) + std::abs(axis.z));
+        return std::min({p0, p1, p2}) > radius || std::max({p0, p1, p2}) < -radius;
+    };
+
+    auto e0 = v1 - v0;
+    auto e1 = v2 - v1;
+    auto e2 = v0 - v2;
+
+    if (separated(cross(e0, e1))) {
+        return false;
+    }
+
+    constexpr vector3 box_axes[] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    for (auto &axis : box_axes) {
+        if (separated(cross(axis, e0)) || separated(cross(axis, e1)) || separated(cross(axis, e2))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static voxel_grid voxelize(const std::vector<vector3> &vertices,
+                           const std::vector<uint32_t> &indices,
+                           uint32_t resolution) {
+    auto aabb_min = vertices.front();
+    auto aabb_max = vertices.front();
+
+    for (auto &v : vertices) {
+        aabb_min = min(aabb_min, v);
+        aabb_max = max(aabb_max, v);
+    }
+
+    auto extent = aabb_max - aabb_min;
+    auto grid = voxel_grid{};
+    grid.voxel_size = std::max(extent.x, std::max(extent.y, extent.z)) / resolution;
+
+    if (!(grid.voxel_size > 0)) {
+        return grid;
+    }
+
+    // Leave two empty layers around the mesh so that the outside is
+    // connected and contains the first voxel.
+    constexpr int padding = 2;
+    grid.origin = aabb_min - vector3_one * (grid.voxel_size * padding);
+
+    for (int i = 0; i < 3; ++i) {
+        grid.size[i] = std::max(1, int(std::ceil(extent[i] / grid.voxel_size))) + padding * 2;
+    }
+
+    grid.cells.assign(size_t(grid.size[0]) * grid.size[1] * grid.size[2], voxel_unknown);
+
+    auto voxel_coord = [&](const vector3 &p, int axis) {
+        auto c = int(std::floor((p[axis] - grid.origin[axis]) / grid.voxel_size));
+        return std::clamp(c, 0, grid.size[axis] - 1);
+    };
+
+    // Bin triangles by the layers along z they overlap so that layers can be
+    // rasterized in parallel.
+    auto num_triangles = indices.size() / 3;
+    auto layer_triangles = std::vector<std::vector<uint32_t>>(grid.size[2]);
+
+    for (size_t i = 0; i < num_triangles; ++i) {
+        auto z0 = vertices[indices[i * 3 + 0]].z;
+        auto z1 = vertices[indices[i * 3 + 1]].z;
+        auto z2 = vertices[indices[i * 3 + 2]].z;
+        auto first = voxel_coord({0, 0, std::min({z0, z1, z2})}, 2);
+        auto last = voxel_coord({0, 0, std::max({z0, z1, z2})}, 2);
+
+        for (auto z = first; z <= last; ++z) {
+            layer_triangles[z].push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    auto half_size = grid.voxel_size / 2;
+    auto layer_overlaps = std::vector<std::vector<std::array<uint32_t, 2>>>(grid.size[2]);
+
+    parallel_for(size_t{0}, layer_triangles.size(), [&](size_t z) {
+        auto &overlaps = layer_overlaps[z];
+
+        for (auto tri_idx : layer_triangles[z]) {
+            auto &v0 = vertices[indices[tri_idx * 3 + 0]];
+            auto &v1 = vertices[indices[tri_idx * 3 + 1]];
+            auto &v2 = vertices[indices[tri_idx * 3 + 2]];
+            auto tri_min = min(min(v0, v1), v2);
+            auto tri_max = max(max(v0, v1), v2);
+
+            for (auto y = voxel_coord(tri_min, 1); y <= voxel_coord(tri_max, 1); ++y) {
+                for (auto x = voxel_coord(tri_min, 0); x <= voxel_coord(tri_max, 0); ++x) {
+                    auto cell_idx = grid.index(x, y, z);
+                    auto center = grid.origin + vector3{x + scalar(0.5), y + scalar(0.5), z + scalar(0.5)} * grid.voxel_size;
+
+                    if (intersect_triangle_voxel(v0, v1, v2, center, half_size)) {
+                        grid.cells[cell_idx] = voxel_surface;
+                        overlaps.push_back({static_cast<uint32_t>(cell_idx), tri_idx});
+                    }
+                }
+            }
+        }
+    });
+
+    grid.triangle_start.assign(grid.cells.size() + 1, 0);
+
+    for (auto &overlaps : layer_overlaps) {
+        for (auto [cell_idx, tri_idx] : overlaps) {
+            ++grid.triangle_start[cell_idx + 1];
+        }
+    }
+
+    std::partial_sum(grid.triangle_start.begin(), grid.triangle_start.end(), grid.triangle_start.begin());
+    grid.triangle_indices.resize(grid.triangle_start.back());
+    auto fill = std::vector<uint32_t>(grid.triangle_start.begin(), grid.triangle_start.end() - 1);
+
+    for (auto &overlaps : layer_overlaps) {
+        for (auto [cell_idx, tri_idx] : overlaps) {
+            grid.triangle_indices[fill[cell_idx]++] = tri_idx;
+        }
+    }
+
+    // Flood fill the outside. The remaining unknown voxels are inside.
+    auto stack = std::vector<std::array<int, 3>>{{0, 0, 0}};
+    grid.cells[0] = voxel_outside;
+
+    while (!stack.empty()) {
+        auto [x, y, z] = stack.back();
+        stack.pop_back();
+
+        const std::array<int, 3> neighbors[] = {
+            {x - 1, y, z}, {x + 1, y, z},
+            {x, y - 1, z}, {x, y + 1, z},
+            {x, y, z - 1}, {x, y, z + 1}
+        };
+
+        for (auto &n : neighbors) {
+            if (n[0] < 0 || n[1] < 0 || n[2] < 0 ||
+                n[0] >= grid.size[0] || n[1] >= grid.size[1] || n[2] >= grid.size[2]) {
+                continue;
+            }
+
+            auto &cell = grid.cells[grid.index(n[0], n[1], n[2])];
+
+            if (cell == voxel_unknown) {
+                cell = voxel_outside;
+                stack.push_back(n);
+            }
+        }
+    }
+
+    return grid;
+}
+
+// Collects points whose convex hull is the convex hull of the voxels of a
+// part, or of the voxels on one side of a cut along an axis if `axis` is in
+// [0, 3). Only the points at the ends of each line of voxel corners parallel
+// to the x axis can be on the hull.
+// Returns the number of voxels included.
+static size_t voxel_hull_points(const voxel_grid &grid, const voxel_part &part,
+                                int axis, int cut, bool below,
+                                std::vector<vector3> &points) {
+    auto num_y = part.max[1] - part.min[1] + 2;
+    auto num_z = part.max[2] - part.min[2] + 2;
+    auto line_min = std::vector<int>(size_t(num_y) * num_z, std::numeric_limits<int>::max());
+    auto line_max = std::vector<int>(size_t(num_y) * num_z, -1);
+    auto count = size_t{0};
+
+    for (auto &v : part.voxels) {
+        if (axis >= 0 && (v[axis] < cut) != below) {
+            continue;
+        }
+
+        ++count;
+        auto y = v[1] - part.min[1];
+        auto z = v[2] - part.min[2];
+
+        for (int dz = 0; dz < 2; ++dz) {
+            for (int dy = 0; dy < 2; ++dy) {
+                auto line = size_t(z + dz) * num_y + y + dy;
+                line_min[line] = std::min(line_min[line], int(v[0]));
+                line_max[line] = std::max(line_max[line], int(v[0]) + 1);
+            }
+        }
+    }
+
+    points.clear();
+
+    for (int z = 0; z < num_z; ++z) {
+        for (int y = 0; y < num_y; ++y) {
+            auto line = size_t(z) * num_y + y;
+
+            if (line_max[line] < 0) {
+                continue;
+            }
+
+            auto corner_y = scalar(part.min[1] + y);
+            auto corner_z = scalar(part.min[2] + z);
+            points.push_back(grid.origin + vector3{scalar(line_min[line]), corner_y, corner_z} * grid.voxel_size);
+            points.push_back(grid.origin + vector3{scalar(line_max[line]), corner_y, corner_z} * grid.voxel_size);
+        }
+    }
+
+    return count;
+}
+
+static vector3 closest_point_triangle(const vector3 &p, const vector3 &a,
+                                      const vector3 &b, const vector3 &c) {
+    // Reference: Real-Time Collision Detection - Christer Ericson, Section 5.1.5.
+    auto ab = b - a;
+    auto ac = c - a;
+    auto ap = p - a;
+    auto d1 = dot(ab, ap);
+    auto d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+
+    auto bp = p - b;
+    auto d3 = dot(ab, bp);
+    auto d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) return b;
+
+    auto vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab * (d1 / (d1 - d3));
+
+    auto cp = p - c;
+    auto d5 = dot(ab, cp);
+    auto d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+
+    auto vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac * (d2 / (d2 - d6));
+
+    auto va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    auto denom = va + vb + vc;
+
+    if (!(denom > 0)) {
+        return a;
+    }
+
+    return a + ab * (vb / denom) + ac * (vc / denom);
+}
+
+// Moves voxel corners to the closest point on the triangles in the voxels
+// around them, which removes the error introduced by voxelization where the
+// part borders the surface of the mesh.
+static void snap_to_surface(const voxel_grid &grid, const std::vector<vector3> &vertices,
+                            const std::vector<uint32_t> &indices, std::vector<vector3> &points) {
+    for (auto &p : points) {
+        auto corner = std::array<int, 3>{};
+
+        for (int i = 0; i < 3; ++i) {
+            corner[i] = int(std::round((p[i] - grid.origin[i]) / grid.voxel_size));
+        }
+
+        auto closest = p;
+        auto min_dist_sqr = std::numeric_limits<scalar>::max();
+
+        for (int z = corner[2] - 1; z <= corner[2]; ++z) {
+            for (int y = corner[1] - 1; y <= corner[1]; ++y) {
+                for (int x = corner[0] - 1; x <= corner[0]; ++x) {
+                    if (x < 0 || y < 0 || z < 0 ||
+                        x >= grid.size[0] || y >= grid.size[1] || z >= grid.size[2]) {
+                        continue;
+                    }
+
+                    auto cell_idx = grid.index(x, y, z);
+
+                    for (auto i = grid.triangle_start[cell_idx]; i < grid.triangle_start[cell_idx + 1]; ++i) {
+                        auto tri_idx = grid.triangle_indices[i];
+                        auto q = closest_point_triangle(p, vertices[indices[tri_idx * 3 + 0]],
+                                                        vertices[indices[tri_idx * 3 + 1]],
+                                                        vertices[indices[tri_idx * 3 + 2]]);
+                        auto dist_sqr = distance_sqr(p, q);
+
+                        if (dist_sqr < min_dist_sqr) {
+                            min_dist_sqr = dist_sqr;
+                            closest = q;
+                        }
+                    }
+                }
+            }
+        }
+
+        p = closest;
+    }
+}
+
+struct split_candidate {
+    uint32_t part_idx;
+    int axis;
+    int cut;
+    scalar cost;
+};
+
+struct decomposition_hull {
+    std::vector<vector3> points;
+    scalar volume;
+    vector3 min;
+    vector3 max;
+    bool alive;
+};
+
+struct merge_candidate {
+    uint32_t hull_idx[2];
+    scalar cost;
+};
+
+// Weight of the difference in volume of both sides of a cut in its cost,
+// which favors balanced cuts among those of similar concavity.
+constexpr scalar split_balance_weight = scalar(0.05);
+
+// Maximum number of vertices of the hulls used to evaluate cuts. Estimates of
+// the hull volume are sufficient to compare cuts.
+constexpr size_t split_hull_max_vertices = 128;
+
+static std::vector<voxel_part> split_voxels(const voxel_grid &grid, scalar total_volume,
+                                            const convex_decomposition_settings &settings) {
+    auto voxel_volume = grid.voxel_size * grid.voxel_size * grid.voxel_size;
+    auto tolerance = grid.voxel_size * scalar(1e-3);
+
+    auto parts = std::vector<voxel_part>(1);
+
+    for (int z = 0; z < grid.size[2]; ++z) {
+        for (int y = 0; y < grid.size[1]; ++y) {
+            for (int x = 0; x < grid.size[0]; ++x) {
+                if (grid.cells[grid.index(x, y, z)] != voxel_outside) {
+                    parts.front().voxels.push_back({uint16_t(x), uint16_t(y), uint16_t(z)});
+                }
+            }
+        }
+    }
+
+    parts.front().update_bounds();
+    auto leaves = std::vector<voxel_part>{};
+
+    for (uint32_t depth = 0; !parts.empty(); ++depth) {
+        if (depth >= settings.max_depth) {
+            std::move(parts.begin(), parts.end(), std::back_inserter(leaves));
+            break;
+        }
+
+        // Parts which are concave enough are split.
+        auto concavity = std::vector<scalar>(parts.size());
+
+        parallel_for(size_t{0}, parts.size(), [&](size_t i) {
+            auto points = std::vector<vector3>{};
+            auto triangles = std::vector<hull_triangle>{};
+            auto count = voxel_hull_points(grid, parts[i], -1, 0, false, points);
+            convex_hull_builder(points, tolerance).build(points.size(), triangles);
+            concavity[i] = hull_volume(points, triangles) - count * voxel_volume;
+        });
+
+        auto splitting = std::vector<voxel_part>{};
+
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (concavity[i] > settings.max_concavity * total_volume && parts[i].voxels.size() > 1) {
+                splitting.push_back(std::move(parts[i]));
+            } else {
+                leaves.push_back(std::move(parts[i]));
+            }
+        }
+
+        // Evaluate cuts of all parts at once.
+        auto candidates = std::vector<split_candidate>{};
+
+        for (uint32_t i = 0; i < splitting.size(); ++i) {
+            auto &part = splitting[i];
+
+            for (int axis = 0; axis < 3; ++axis) {
+                auto first = part.min[axis] + 1;
+                auto last = part.max[axis];
+                auto num_cuts = last - first + 1;
+                auto step = std::max(1, int(std::ceil(scalar(num_cuts) / std::max(1u, settings.planes_per_axis))));
+
+                for (auto cut = first; cut <= last; cut += step) {
+                    candidates.push_back({i, axis, cut, std::numeric_limits<scalar>::max()});
+                }
+            }
+        }
+
+        if (candidates.empty()) {
+            std::move(splitting.begin(), splitting.end(), std::back_inserter(leaves));
+            break;
+        }
+
+        parallel_for(size_t{0}, candidates.size(), [&](size_t i) {
+            auto &candidate = candidates[i];
+            auto &part = splitting[candidate.part_idx];
+            auto points = std::vector<vector3>{};
+            auto triangles = std::vector<hull_triangle>{};
+            scalar cost = 0;
+            scalar side_volume[2];
+
+            for (int side = 0; side < 2; ++side) {
+                auto count = voxel_hull_points(grid, part, candidate.axis, candidate.cut, side == 0, points);
+
+                if (count == 0) {
+                    return;
+                }
+
+                convex_hull_builder(points, tolerance).build(split_hull_max_vertices, triangles);
+                side_volume[side] = count * voxel_volume;
+                cost += std::max(scalar(0), hull_volume(points, triangles) - side_volume[side]);
+            }
+
+            cost += split_balance_weight * std::abs(side_volume[0] - side_volume[1]);
+            candidate.cost = cost / total_volume;
+        });
+
+        auto best = std::vector<const split_candidate *>(splitting.size(), nullptr);
+
+        for (auto &candidate : candidates) {
+            auto &curr = best[candidate.part_idx];
+
+            if (candidate.cost < std::numeric_limits<scalar>::max() &&
+                (curr == nullptr || candidate.cost < curr->cost)) {
+                curr = &candidate;
+            }
+        }
+
+        auto next = std::vector<voxel_part>{};
+
+        for (size_t i = 0; i < splitting.size(); ++i) {
+            auto &part = splitting[i];
+
+            if (best[i] == nullptr) {
+                leaves.push_back(std::move(part));
+                continue;
+            }
+
+            next.resize(next.size() + 2);
+            auto &below = next[next.size() - 2];
+            auto &above = next.back();
+            auto axis = best[i]->axis;
+            auto cut = best[i]->cut;
+
+            for (auto &v : part.voxels) {
+                (v[axis] < cut ? below : above).voxels.push_back(v);
+            }
+
+            below.update_bounds();
+            above.update_bounds();
+        }
+
+        parts = std::move(next);
+    }
+
+    return leaves;
+}
+
+static void merge_hulls(std::vector<decomposition_hull> &hulls, scalar tolerance,
+                        scalar margin, size_t max_hulls) {
+    auto num_alive = hulls.size();
+
+    if (num_alive <= max_hulls) {
+        return;
+    }
+
+    auto merge = [&](uint32_t i, uint32_t j, decomposition_hull &result) {
+        auto triangles = std::vector<hull_triangle>{};
+        auto points = hulls[i].points;
+        points.insert(points.end(), hulls[j].points.begin(), hulls[j].points.end());
+        convex_hull_builder(points, tolerance).build(points.size(), triangles);
+        hull_vertex_positions(points, triangles, result.points);
+        result.volume = hull_volume(points, triangles);
+        result.min = min(hulls[i].min, hulls[j].min);
+        result.max = max(hulls[i].max, hulls[j].max);
+        result.alive = true;
+    };
+
+    auto touching = [&](uint32_t i, uint32_t j) {
+        return intersect_aabb(hulls[i].min - vector3_one * margin, hulls[i].max + vector3_one * margin,
+                              hulls[j].min, hulls[j].max);
+    };
+
+    // Merging adjacent hulls is preferred, thus only pairs of hulls which
+    // touch are considered unless there are none.
+    auto candidates = std::vector<merge_candidate>{};
+    auto evaluate = [&](size_t first) {
+        if (first == candidates.size()) {
+            return;
+        }
+
+        parallel_for(first, candidates.size(), [&](size_t k) {
+            auto &candidate = candidates[k];
+            auto merged = decomposition_hull{};
+            merge(candidate.hull_idx[0], candidate.hull_idx[1], merged);
+            candidate.cost = merged.volume - hulls[candidate.hull_idx[0]].volume -
+                                             hulls[candidate.hull_idx[1]].volume;
+        });
+    };
+
+    auto add_candidates = [&](uint32_t i, bool all) {
+        for (uint32_t j = 0; j < i; ++j) {
+            if (hulls[j].alive && (all || touching(i, j))) {
+                candidates.push_back({{j, i}, 0});
+            }
+        }
+    };
+
+    for (uint32_t i = 0; i < hulls.size(); ++i) {
+        add_candidates(i, false);
+    }
+
+    evaluate(0);
+
+    while (num_alive > max_hulls) {
+        auto best = candidates.end();
+
+        for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+            if (best == candidates.end() || it->cost < best->cost) {
+                best = it;
+            }
+        }
+
+        if (best == candidates.end()) {
+            // The remaining hulls are disjoint.
+            for (uint32_t i = 0; i < hulls.size(); ++i) {
+                if (hulls[i].alive) {
+                    add_candidates(i, true);
+                }
+            }
+
+            evaluate(0);
+            continue;
+        }
+
+        auto i = best->hull_idx[0];
+        auto j = best->hull_idx[1];
+        auto merged = decomposition_hull{};
+        merge(i, j, merged);
+        hulls[i].alive = false;
+        hulls[j].alive = false;
+        hulls.push_back(std::move(merged));
+        --num_alive;
+
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](auto &candidate) {
+            return candidate.hull_idx[0] == i || candidate.hull_idx[1] == i ||
+                   candidate.hull_idx[0] == j || candidate.hull_idx[1] == j;
+        }), candidates.end());
+
+        auto first = candidates.size();
+        add_candidates(static_cast<uint32_t>(hulls.size() - 1), false);
+        evaluate(first);
+    }
+
+    hulls.erase(std::remove_if(hulls.begin(), hulls.end(), [](auto &hull) {
+        return !hull.alive;
+    }), hulls.end());
+}
+
+// "EDYNCVX" followed by a zero. The triangle mesh formats cannot hold a set of
+// hulls, and the serialization of `convex_mesh` initializes the mesh before its
+// indices can be validated, thus hulls are written as raw arrays.
+constexpr uint64_t convex_decomposition_magic = 0x005856434e594445;
+constexpr uint32_t convex_decomposition_version = 1;
+
+template<typename Archive>
+void serialize_settings(Archive &archive, convex_decomposition_settings &settings) {
+    archive(settings.resolution);
+    archive(settings.max_concavity);
+    archive(settings.max_depth);
+    archive(settings.planes_per_axis);
+    archive(settings.max_hulls);
+    archive(settings.max_vertices_per_hull);
+}
+
+}
+
+std::vector<polyhedron_with_center> decompose_into_convex_polyhedrons(
+    const std::vector<vector3> &vertices,
+    const std::vector<uint32_t> &indices,
+    const convex_decomposition_settings &settings) {
+
+    EDYN_ASSERT(indices.size() % 3 == 0);
+    EDYN_ASSERT(settings.resolution > 1 && settings.resolution < 4096);
+    EDYN_ASSERT(settings.max_vertices_per_hull >= 4);
+
+    if (vertices.empty() || indices.empty()) {
+        return {};
+    }
+
+    auto grid = detail::voxelize(vertices, indices, settings.resolution);
+
+    if (grid.cells.empty()) {
+        return {};
+    }
+
+    auto voxel_volume = grid.voxel_size * grid.voxel_size * grid.voxel_size;
+    auto num_voxels = std::count_if(grid.cells.begin(), grid.cells.end(), [](auto cell) {
+        return cell != detail::voxel_outside;
+    });
+    auto total_volume = num_voxels * voxel_volume;
+    auto parts = detail::split_voxels(grid, total_volume, settings);
+
+    // Compute the hull of each part, then merge hulls down to the maximum.
+    auto tolerance = grid.voxel_size * scalar(1e-3);
+    auto hulls = std::vector<detail::decomposition_hull>(parts.size());
+
+    parallel_for(size_t{0}, parts.size(), [&](size_t i) {
+        auto &hull = hulls[i];
+        auto points = std::vector<vector3>{};
+        auto triangles = std::vector<detail::hull_triangle>{};
+        detail::voxel_hull_points(grid, parts[i], -1, 0, false, points);
+        detail::snap_to_surface(grid, vertices, indices, points);
+        detail::convex_hull_builder(points, tolerance).build(points.size(), triangles);
+        detail::hull_vertex_positions(points, triangles, hull.points);
+        hull.volume = detail::hull_volume(points, triangles);
+        hull.min = hull.max = hull.points.empty() ? vector3_zero : hull.points.front();
+
+        for (auto &p : hull.points) {
+            hull.min = min(hull.min, p);
+            hull.max = max(hull.max, p);
+        }
+
+        hull.alive = !triangles.empty();
+    });
+
+    hulls.erase(std::remove_if(hulls.begin(), hulls.end(), [](auto &hull) {
+        return !hull.alive;
+    }), hulls.end());
+
+    if (hulls.empty()) {
+        return {};
+    }
+
+    detail::merge_hulls(hulls, tolerance, grid.voxel_size / 2, std::max(1u, settings.max_hulls));
+
+    // Simplify hulls to the vertex budget and create polyhedrons.
+    auto polyhedrons = std::vector<polyhedron_with_center>(hulls.size());
+
+    parallel_for(size_t{0}, hulls.size(), [&](size_t i) {
+        auto &points = hulls[i].points;
+        auto triangles = std::vector<detail::hull_triangle>{};
+        detail::convex_hull_builder(points, tolerance).build(settings.max_vertices_per_hull, triangles);
+
+        if (!triangles.empty()) {
+            polyhedrons[i] = detail::make_hull_polyhedron(points, triangles);
+        }
+    });
+
+    polyhedrons.erase(std::remove_if(polyhedrons.begin(), polyhedrons.end(), [](auto &poly) {
+        return !poly.shape.mesh;
+    }), polyhedrons.end());
+
+    return polyhedrons;
+}
+
+static compound_shape make_compound(const std::vector<polyhedron_with_center> &polyhedrons) {
+    auto compound = compound_shape{};
+
+    for (auto &poly : polyhedrons) {
+        compound.add_shape(poly.shape, poly.center, quaternion_identity);
+    }
+
+    if (!compound.nodes.empty()) {
+        compound.finish();
+    }
+
+    return compound;
+}
+
+compound_shape make_convex_decomposition(const std::vector<vector3> &vertices,
+                                         const std::vector<uint32_t> &indices,
+                                         const convex_decomposition_settings &settings) {
+    return make_compound(decompose_into_convex_polyhedrons(vertices, indices, settings));
+}
+
+bool save_convex_decomposition(const std::string &path,
+                               const std::vector<polyhedron_with_center> &polyhedrons,
+                               const std::vector<vector3> &vertices,
+                               const std::vector<uint32_t> &indices,
+                               const convex_decomposition_settings &settings) {
+    auto buffer = memory_output_archive::buffer_type{};
+    auto archive = memory_output_archive(buffer);
+    write_binary_header(archive, detail::convex_decomposition_magic, detail::convex_decomposition_version);
+    auto source_hash = content_hash(vertices, indices);
+    auto settings_copy = settings;
+    archive(source_hash);
+    detail::serialize_settings(archive, settings_copy);
+
+    auto num_polyhedrons = static_cast<uint32_t>(polyhedrons.size());
+    archive(num_polyhedrons);
+
+    for (auto &poly : polyhedrons) {
+        EDYN_ASSERT(poly.shape.mesh);
+        auto &mesh = *poly.shape.mesh;
+        archive(poly.center, mesh.vertices, mesh.indices, mesh.faces);
+    }
+
+    return write_binary_file(path, buffer);
+}
+
+bool load_convex_decomposition(const std::string &path,
+                               const std::vector<vector3> &vertices,
+                               const std::vector<uint32_t> &indices,
+                               const convex_decomposition_settings &settings,
+                               std::vector<polyhedron_with_center> &polyhedrons) {
+    auto file = mapped_file{};
+
+    if (!file.open(path, mapped_file::access_pattern::sequential)) {
+        return false;
+    }
+
+    auto archive = memory_input_archive(file.data(), file.size());
+
+    if (!read_binary_header(archive, detail::convex_decomposition_magic,
+                            detail::convex_decomposition_version)) {
+        return false;
+    }
+
+    uint64_t source_hash {};
+    auto stored_settings = convex_decomposition_settings{};
+    archive(source_hash);
+    detail::serialize_settings(archive, stored_settings);
+
+    if (archive.failed() || source_hash != content_hash(vertices, indices) ||
+        stored_settings.resolution != settings.resolution ||
+        stored_settings.max_concavity != settings.max_concavity ||
+        stored_settings.max_depth != settings.max_depth ||
+        stored_settings.planes_per_axis != settings.planes_per_axis ||
+        stored_settings.max_hulls != settings.max_hulls ||
+        stored_settings.max_vertices_per_hull != settings.max_vertices_per_hull) {
+        return false;
+    }
+
+    uint32_t num_polyhedrons {};
+    archive(num_polyhedrons);
+
+    // Each polyhedron takes at least the size of its center.
+    if (!archive.expect_remaining(num_polyhedrons, sizeof(vector3))) {
+        return false;
+    }
+
+    auto result = std::vector<polyhedron_with_center>(num_polyhedrons);
+
+    for (auto &poly : result) {
+        auto mesh = std::make_shared<convex_mesh>();
+        archive(poly.center, mesh->vertices, mesh->indices, mesh->faces);
+
+        if (archive.failed() || !mesh->has_valid_faces()) {
+            return false;
+        }
+
+        // Vertices were stored relative to the centroid.
+        mesh->update_calculated_properties();
+        poly.shape.mesh = mesh_asset_cache::global().intern(mesh);
+    }
+
+    polyhedrons = std::move(result);
+
+    return true;
+}
+
+compound_shape load_or_make_convex_decomposition(const std::string &cache_path,
+                                                 const std::vector<vector3> &vertices,
+                                                 const std::vector<uint32_t> &indices,
+                                                 const convex_decomposition_settings &settings) {
+    auto polyhedrons = std::vector<polyhedron_with_center>{};
+
+    if (!load_convex_decomposition(cache_path, vertices, indices, settings, polyhedrons)) {
+        polyhedrons = decompose_into_convex_polyhedrons(vertices, indices, settings);
+        save_convex_decomposition(cache_path, polyhedrons, vertices, indices, settings);
+    }
+
+    return make_compound(polyhedrons);
+}
+
+}
@@ -16,7 +16,9 @@ void insert_material_mixing(entt::registry &registry, material::id_type material
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_material_table(material_table);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_material_table(material_table);
+        }
     }
 }
 
@@ -0,0 +1,144 @@
+#include "edyn/util/mapped_file.hpp"
+#include "edyn/config/config.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace edyn {
+
+mapped_file::mapped_file(const std::string &path, access_pattern pattern) {
+    open(path, pattern);
+}
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+bool mapped_file::open(const std::string &path, access_pattern pattern) {
+    close();
+
+#if defined(_WIN32)
+    auto flags = DWORD(FILE_ATTRIBUTE_NORMAL);
+    flags |= pattern == access_pattern::sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, flags, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    m_file_handle = file;
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size)) {
+        close();
+        return false;
+    }
+
+    // Empty files cannot be mapped.
+    if (file_size.QuadPart == 0) {
+        m_open = true;
+        return true;
+    }
+
+    m_mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_mapping_handle == nullptr) {
+        close();
+        return false;
+    }
+
+    auto *view = MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+    if (view == nullptr) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t *>(view);
+    m_size = static_cast<size_t>(file_size.QuadPart);
+    m_open = true;
+#else
+    auto fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Empty files cannot be mapped.
+    if (st.st_size == 0) {
+        ::close(fd);
+        m_open = true;
+        return true;
+    }
+
+    auto *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping remains valid after the descriptor is closed.
+    ::close(fd);
+
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t *>(addr);
+    m_size = static_cast<size_t>(st.st_size);
+    m_open = true;
+
+    madvise(addr, m_size, pattern == access_pattern::sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#endif
+
+    return true;
+}
+
+void mapped_file::close() {
+#if defined(_WIN32)
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping_handle) {
+        CloseHandle(m_mapping_handle);
+    }
+
+    if (m_file_handle) {
+        CloseHandle(m_file_handle);
+    }
+
+    m_mapping_handle = nullptr;
+    m_file_handle = nullptr;
+#else
+    if (m_data) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+void mapped_file::prefetch([[maybe_unused]] size_t offset, [[maybe_unused]] size_t size) const {
+    EDYN_ASSERT(offset <= m_size && size <= m_size - offset);
+
+#if !defined(_WIN32)
+    static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto begin = offset - offset % page_size;
+    madvise(const_cast<uint8_t *>(m_data + begin), offset + size - begin, MADV_WILLNEED);
+#endif
+}
+
+}
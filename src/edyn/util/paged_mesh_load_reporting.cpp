@@ -2,9 +2,18 @@
 #include "edyn/parallel/message.hpp"
 #include "edyn/parallel/message_dispatcher.hpp"
 #include "edyn/shapes/paged_mesh_shape.hpp"
+#include "edyn/config/config.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 namespace edyn::internal {
 
+// Identifiers of the queues of all registries which have Edyn attached.
+static std::vector<message_queue_identifier> paged_mesh_load_queues;
+static std::mutex paged_mesh_load_queues_mutex;
+
 struct paged_mesh_page_load_context {
     message_queue_handle<msg::paged_triangle_mesh_load_page> queue;
     entt::sigh<void(entt::entity, size_t)> load_signal;
@@ -23,8 +32,11 @@ void on_paged_triangle_mesh_load_page(entt::registry &registry, message<msg::pag
 
 void init_paged_mesh_load_reporting(entt::registry &registry) {
     auto &dispatcher = message_dispatcher::global();
-    auto &ctx = registry.ctx().emplace<paged_mesh_page_load_context>(dispatcher.make_queue<msg::paged_triangle_mesh_load_page>(paged_mesh_load_queue_identifier));
+    auto &ctx = registry.ctx().emplace<paged_mesh_page_load_context>(dispatcher.make_unique_queue<msg::paged_triangle_mesh_load_page>(paged_mesh_load_queue_identifier));
     ctx.queue.sink<msg::paged_triangle_mesh_load_page>().connect<&on_paged_triangle_mesh_load_page>(registry);
+
+    auto lock = std::lock_guard(paged_mesh_load_queues_mutex);
+    paged_mesh_load_queues.push_back(ctx.queue.identifier);
 }
 
 void update_paged_mesh_load_reporting(entt::registry &registry) {
@@ -33,7 +45,27 @@ void update_paged_mesh_load_reporting(entt::registry &registry) {
 }
 
 void deinit_paged_mesh_load_reporting(entt::registry &registry) {
+    auto &ctx = registry.ctx().at<paged_mesh_page_load_context>();
+
+    {
+        auto lock = std::lock_guard(paged_mesh_load_queues_mutex);
+        auto it = std::find_if(paged_mesh_load_queues.begin(), paged_mesh_load_queues.end(),
+                               [&](auto &&id) { return id.value == ctx.queue.identifier.value; });
+        EDYN_ASSERT(it != paged_mesh_load_queues.end());
+        paged_mesh_load_queues.erase(it);
+    }
+
+    auto queue_id = ctx.queue.identifier;
     registry.ctx().erase<paged_mesh_page_load_context>();
+    message_dispatcher::global().remove_queue(queue_id);
+}
+
+void report_paged_mesh_page_load(paged_triangle_mesh *trimesh, size_t mesh_index) {
+    auto lock = std::lock_guard(paged_mesh_load_queues_mutex);
+
+    for (auto &id : paged_mesh_load_queues) {
+        message_dispatcher::global().send<msg::paged_triangle_mesh_load_page>(id, {}, trimesh, mesh_index);
+    }
 }
 
 }
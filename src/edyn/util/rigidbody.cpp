@@ -33,6 +33,7 @@
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/dynamics/moment_of_inertia.hpp"
 #include "edyn/util/aabb_util.hpp"
+#include "edyn/sys/update_aabbs.hpp"
 #include "edyn/util/tuple_util.hpp"
 #include "edyn/util/gravity_util.hpp"
 #include "edyn/simulation/stepper_async.hpp"
@@ -468,6 +469,13 @@ void rigidbody_set_shape(entt::registry &registry, entt::entity entity, std::opt
     });
 }
 
+void rigidbody_update_aabb(entt::registry &registry, entt::entity entity) {
+    EDYN_ASSERT(registry.all_of<AABB>(entity));
+    update_aabb(registry, entity);
+    // Trigger update in broadphase and replicate to simulation workers.
+    registry.patch<AABB>(entity);
+}
+
 bool rigidbody_has_shape(const entt::registry &registry, entt::entity entity) {
     return registry.all_of<shape_index>(entity);
 }
@@ -2,145 +2,297 @@
 #include "edyn/shapes/compound_shape.hpp"
 #include "edyn/shapes/polyhedron_shape.hpp"
 #include "edyn/util/shape_util.hpp"
-#include <fstream>
+#include "edyn/util/mapped_file.hpp"
+#include "edyn/parallel/parallel_for.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
 #include <sstream>
+#include <string_view>
 #include <numeric>
+#include <type_traits>
+
+// Floating-point `std::from_chars` is missing in some standard libraries, in
+// which case `strtof` and `strtod` are used instead.
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define EDYN_FLOAT_FROM_CHARS
+#else
+#include <cstdlib>
+#endif
 
 namespace edyn {
 
-static vector3 read_vector3(std::istringstream &iss) {
-    edyn::vector3 v;
-    iss >> v.x >> v.y >> v.z;
-    return v;
+namespace detail {
+
+// Size of the ranges of lines which are parsed in parallel.
+constexpr size_t obj_chunk_size = 1 << 20;
+
+// Range of lines in an obj file with the number of elements it contains and
+// where these elements are placed in the output arrays.
+struct obj_chunk {
+    const char *first;
+    const char *last;
+    size_t num_vertices {0};
+    size_t num_colors {0};
+    size_t num_indices {0};
+    size_t vertex_offset {0};
+    size_t color_offset {0};
+    size_t index_offset {0};
+    bool valid {true};
+};
+
+}
+
+static bool is_obj_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char * skip_obj_space(const char *first, const char *last) {
+    while (first != last && is_obj_space(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+static const char * skip_obj_token(const char *first, const char *last) {
+    while (first != last && !is_obj_space(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+static size_t count_obj_tokens(const char *first, const char *last) {
+    size_t count = 0;
+
+    while ((first = skip_obj_space(first, last)) != last) {
+        first = skip_obj_token(first, last);
+        ++count;
+    }
+
+    return count;
 }
 
-static void read_face_indices(std::istringstream &iss,
-                              std::vector<uint32_t> &indices,
-                              uint32_t offset, bool triangulate) {
-    std::string idx_str;
-    auto count = size_t{};
-    uint32_t first_idx;
-    uint32_t prev_idx;
-
-    while (true) {
-        iss >> idx_str;
-        if (iss.fail()) break;
-
-        // Remove everything after the first slash to keep only the first
-        // element in the "v/vt/vn" sequence.
-        auto pos = idx_str.find_first_of('/');
-        if (pos != std::string::npos) {
-            idx_str.erase(pos);
+// Calls `func(cmd, args_first, args_last)` for each non-empty line in the
+// range, where `cmd` is the first token in the line.
+template<typename Func>
+static void for_each_obj_line(const char *first, const char *last, Func func) {
+    while (first != last) {
+        auto line_end = static_cast<const char *>(std::memchr(first, '\n', last - first));
+
+        if (line_end == nullptr) {
+            line_end = last;
         }
 
-        auto idx = static_cast<uint32_t>(std::stoi(idx_str));
-        EDYN_ASSERT(idx >= 1 + offset);
+        auto cmd_first = skip_obj_space(first, line_end);
+        auto cmd_last = skip_obj_token(cmd_first, line_end);
 
-        if (triangulate && count >= 3) {
-            indices.push_back(first_idx);
-            indices.push_back(prev_idx);
+        if (cmd_first != cmd_last) {
+            func(std::string_view(cmd_first, cmd_last - cmd_first), cmd_last, line_end);
         }
 
-        indices.push_back(idx - 1 - offset);
+        first = line_end == last ? last : line_end + 1;
+    }
+}
+
+#ifndef EDYN_FLOAT_FROM_CHARS
+// Parses a floating-point number at the start of the range. The token is
+// copied since `strtod` requires a null-terminated string. Unlike
+// `from_chars`, the result depends on the current C locale.
+template<typename T>
+static const char * parse_obj_float(const char *first, const char *last, T &value) {
+    char buffer[64];
+    auto length = static_cast<size_t>(skip_obj_token(first, last) - first);
+
+    if (length == 0 || length >= sizeof(buffer)) {
+        return nullptr;
+    }
+
+    std::memcpy(buffer, first, length);
+    buffer[length] = '\0';
+    char *end;
 
-        if (count == 0) {
-            first_idx = indices.back();
+    if constexpr(std::is_same_v<T, float>) {
+        value = std::strtof(buffer, &end);
+    } else {
+        value = static_cast<T>(std::strtod(buffer, &end));
+    }
+
+    return end == buffer ? nullptr : first + (end - buffer);
+}
+#endif
+
+// Parses the next token as a number. Returns whether it succeeded.
+template<typename T>
+static bool read_obj_number(const char *&first, const char *last, T &value) {
+    first = skip_obj_space(first, last);
+
+    if (first != last && *first == '+') {
+        ++first;
+    }
+
+#ifndef EDYN_FLOAT_FROM_CHARS
+    if constexpr(std::is_floating_point_v<T>) {
+        auto ptr = parse_obj_float(first, last, value);
+
+        if (ptr == nullptr) {
+            return false;
         }
 
-        prev_idx = indices.back();
-        ++count;
+        first = ptr;
+        return true;
+    } else
+#endif
+    {
+        auto [ptr, ec] = std::from_chars(first, last, value);
+
+        if (ec != std::errc{}) {
+            return false;
+        }
+
+        first = ptr;
+        return true;
     }
 }
 
-static void read_face(std::istringstream &iss,
-                      std::vector<uint32_t> &indices,
-                      std::vector<uint32_t> &faces,
-                      uint32_t offset, bool triangulate) {
-    // Store where this face starts in the `indices` array.
-    faces.push_back(indices.size());
+static bool read_vector3(const char *&first, const char *last, vector3 &v) {
+    return read_obj_number(first, last, v.x) &&
+           read_obj_number(first, last, v.y) &&
+           read_obj_number(first, last, v.z);
+}
 
-    read_face_indices(iss, indices, offset, triangulate);
+static vector3 transform_obj_vertex(vector3 v, const vector3 &pos,
+                                    const quaternion &orn, const vector3 &scale) {
+    if (scale != vector3_one) {
+        v *= scale;
+    }
+
+    if (orn != quaternion_identity) {
+        v = rotate(orn, v);
+    }
 
-    // Store the number of vertices in this face.
-    auto count = indices.size() - faces.back();
-    faces.push_back(count);
+    if (pos != vector3_zero ) {
+        v += pos;
+    }
+
+    return v;
 }
 
-template<typename Stream>
-void load_meshes_from_obj_stream(Stream &stream,
-                                 std::vector<obj_mesh> &meshes,
-                                 vector3 pos,
-                                 quaternion orn,
-                                 vector3 scale) {
-    std::string line;
-    auto mesh = obj_mesh{};
-    uint32_t index_offset = 0;
+// Parses the vertex indices of a face and calls `func` with each of them,
+// zero-based and relative to the first vertex in the file. Only the first
+// element in the "v/vt/vn" sequence is used. Negative indices are relative to
+// `num_vertices`, the number of vertices read so far. All indices must be
+// smaller than `max_vertices`. Stops at the first invalid index and returns
+// whether all indices are valid.
+template<typename Func>
+static bool read_face_indices(const char *first, const char *last,
+                              size_t num_vertices, size_t max_vertices, Func func) {
+    while ((first = skip_obj_space(first, last)) != last) {
+        int64_t idx;
+        auto [ptr, ec] = std::from_chars(first, last, idx);
+
+        if (ec != std::errc{} || idx == 0) {
+            return false;
+        }
 
-    while (std::getline(stream, line)) {
-        auto pos_space = line.find(" ");
+        idx = idx > 0 ? idx - 1 : int64_t(num_vertices) + idx;
 
-        if (pos_space == std::string::npos) {
-            continue;
+        if (idx < 0 || idx >= int64_t(max_vertices)) {
+            return false;
         }
 
-        auto cmd = line.substr(0, pos_space);
+        func(static_cast<uint32_t>(idx));
+        first = skip_obj_token(ptr, last);
+    }
+
+    return true;
+}
+
+static void load_meshes_from_obj_text(std::string_view text,
+                                      std::vector<obj_mesh> &meshes,
+                                      vector3 pos,
+                                      quaternion orn,
+                                      vector3 scale) {
+    auto mesh = obj_mesh{};
+    uint32_t index_offset = 0;
 
+    for_each_obj_line(text.data(), text.data() + text.size(),
+                      [&](std::string_view cmd, const char *first, const char *last) {
         if (cmd == "o") {
             if (!mesh.vertices.empty()) {
                 index_offset += mesh.vertices.size();
                 meshes.emplace_back(std::move(mesh));
+                mesh = obj_mesh{};
             }
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            mesh.name = iss.str();
-        } else if (cmd == "v") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            auto v = read_vector3(iss);
 
-            if (scale != vector3_one) {
-                v *= scale;
-            }
+            first = skip_obj_space(first, last);
 
-            if (orn != quaternion_identity) {
-                v = rotate(orn, v);
+            while (last != first && is_obj_space(*(last - 1))) {
+                --last;
             }
 
-            if (pos != vector3_zero ) {
-                v += pos;
+            mesh.name = std::string(first, last);
+        } else if (cmd == "v") {
+            auto v = vector3_zero;
+            read_vector3(first, last, v);
+            mesh.vertices.push_back(transform_obj_vertex(v, pos, orn, scale));
+
+            // Try reading vertex color.
+            auto color = vector3{};
+
+            if (read_vector3(first, last, color)) {
+                mesh.colors.push_back(color);
             }
+        } else if (cmd == "f") {
+            auto face_first = mesh.indices.size();
+            auto num_vertices = index_offset + mesh.vertices.size();
 
-            mesh.vertices.push_back(v);
+            // Faces can only refer to vertices of the current object. Invalid
+            // faces are skipped.
+            auto valid = read_face_indices(first, last, num_vertices, num_vertices, [&](uint32_t idx) {
+                mesh.indices.push_back(idx);
+            });
 
-            if (!iss.eof()) {
-                // Try reading vertex color.
-                auto color = read_vector3(iss);
+            valid &= std::all_of(mesh.indices.begin() + face_first, mesh.indices.end(),
+                                 [&](uint32_t idx) { return idx >= index_offset; });
 
-                if (!iss.fail()) {
-                    mesh.colors.push_back(color);
-                }
+            if (!valid) {
+                mesh.indices.resize(face_first);
+                return;
             }
-        } else if (cmd == "f") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            read_face(iss, mesh.indices, mesh.faces, index_offset, false);
+
+            for (auto i = face_first; i < mesh.indices.size(); ++i) {
+                mesh.indices[i] -= index_offset;
+            }
+
+            // Store where this face starts in the `indices` array and the
+            // number of vertices in it.
+            mesh.faces.push_back(face_first);
+            mesh.faces.push_back(mesh.indices.size() - face_first);
         }
-    }
+    });
 
     if (!mesh.vertices.empty()) {
         meshes.emplace_back(std::move(mesh));
     }
 }
 
+static std::string read_remaining(std::stringstream &ss) {
+    return std::string(std::istreambuf_iterator<char>(ss), std::istreambuf_iterator<char>());
+}
+
 bool load_meshes_from_obj(const std::string &path,
                           std::vector<obj_mesh> &meshes,
                           vector3 pos,
                           quaternion orn,
                           vector3 scale) {
-    auto file = std::ifstream(path);
+    auto file = mapped_file(path, mapped_file::access_pattern::sequential);
 
     if (!file.is_open()) {
         return false;
     }
 
-    load_meshes_from_obj_stream(file, meshes, pos, orn, scale);
+    load_meshes_from_obj_text(file.text(), meshes, pos, orn, scale);
 
     return true;
 }
@@ -150,59 +302,158 @@ void load_meshes_from_obj(std::stringstream &ss,
                           vector3 pos,
                           quaternion orn,
                           vector3 scale) {
-    load_meshes_from_obj_stream(ss, meshes, pos, orn, scale);
+    load_meshes_from_obj_text(read_remaining(ss), meshes, pos, orn, scale);
 }
 
-template<typename Stream>
-void load_tri_mesh_from_obj_stream(Stream &stream,
-                                   std::vector<vector3> &vertices,
-                                   std::vector<uint32_t> &indices,
-                                   std::vector<vector3> *colors,
-                                   vector3 pos,
-                                   quaternion orn,
-                                   vector3 scale) {
-    std::string line;
-
-    while (std::getline(stream, line)) {
-        auto pos_space = line.find(" ");
-
-        if (pos_space == std::string::npos) {
-            continue;
+// Splits the text into chunks at line boundaries.
+static std::vector<detail::obj_chunk> split_obj_chunks(std::string_view text) {
+    auto chunks = std::vector<detail::obj_chunk>{};
+    auto first = text.data();
+    auto last = text.data() + text.size();
+
+    while (first != last) {
+        auto chunk_last = first + std::min(detail::obj_chunk_size, size_t(last - first));
+
+        if (chunk_last != last) {
+            auto newline = static_cast<const char *>(std::memchr(chunk_last, '\n', last - chunk_last));
+            chunk_last = newline == nullptr ? last : newline + 1;
         }
 
-        auto cmd = line.substr(0, pos_space);
+        auto &chunk = chunks.emplace_back();
+        chunk.first = first;
+        chunk.last = chunk_last;
+        first = chunk_last;
+    }
 
-        if (cmd == "v") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            auto v = read_vector3(iss);
+    return chunks;
+}
 
-            if (scale != vector3_one) {
-                v *= scale;
-            }
+/**
+ * Vertices and faces are parsed in two passes over chunks of lines, in
+ * parallel. The first pass counts the elements in each chunk, which gives
+ * where each chunk places its elements in the output arrays, then the second
+ * pass parses the elements directly into their final location. Thus no
+ * memory is allocated besides the output.
+ */
+static bool load_tri_mesh_from_obj_text(std::string_view text,
+                                        std::vector<vector3> &vertices,
+                                        std::vector<uint32_t> &indices,
+                                        std::vector<vector3> *colors,
+                                        vector3 pos,
+                                        quaternion orn,
+                                        vector3 scale) {
+    auto chunks = split_obj_chunks(text);
+
+    parallel_for(size_t{0}, chunks.size(), [&](size_t chunk_idx) {
+        auto &chunk = chunks[chunk_idx];
+
+        for_each_obj_line(chunk.first, chunk.last, [&](std::string_view cmd, const char *first, const char *last) {
+            if (cmd == "v") {
+                ++chunk.num_vertices;
+
+                if (count_obj_tokens(first, last) >= 6) {
+                    ++chunk.num_colors;
+                }
+            } else if (cmd == "f") {
+                // Faces are triangulated as a fan.
+                auto count = count_obj_tokens(first, last);
 
-            if (orn != quaternion_identity) {
-                v = rotate(orn, v);
+                if (count >= 3) {
+                    chunk.num_indices += (count - 2) * 3;
+                }
             }
+        });
+    });
+
+    // Indices are relative to the vertices in the file, which are appended
+    // after the existing ones.
+    auto base_vertex = vertices.size();
+    auto vertex_offset = base_vertex;
+    auto color_offset = colors ? colors->size() : size_t{0};
+    auto index_offset = indices.size();
+
+    for (auto &chunk : chunks) {
+        chunk.vertex_offset = vertex_offset;
+        chunk.color_offset = color_offset;
+        chunk.index_offset = index_offset;
+        vertex_offset += chunk.num_vertices;
+        color_offset += chunk.num_colors;
+        index_offset += chunk.num_indices;
+    }
 
-            if (pos != vector3_zero ) {
-                v += pos;
-            }
+    vertices.resize(vertex_offset);
+    indices.resize(index_offset);
+
+    if (colors) {
+        colors->resize(color_offset);
+    }
 
-            vertices.push_back(v);
+    parallel_for(size_t{0}, chunks.size(), [&](size_t chunk_idx) {
+        auto &chunk = chunks[chunk_idx];
+        auto vertex_idx = chunk.vertex_offset;
+        auto color_idx = chunk.color_offset;
+        auto index_idx = chunk.index_offset;
 
-            if (colors != nullptr && !iss.eof()) {
-                // Try reading vertex color.
-                auto color = read_vector3(iss);
+        for_each_obj_line(chunk.first, chunk.last, [&](std::string_view cmd, const char *first, const char *last) {
+            if (cmd == "v") {
+                auto has_color = count_obj_tokens(first, last) >= 6;
+                auto v = vector3_zero;
+                chunk.valid &= read_vector3(first, last, v);
+                vertices[vertex_idx++] = transform_obj_vertex(v, pos, orn, scale);
 
-                if (!iss.fail()) {
-                    colors->push_back(color);
+                if (has_color) {
+                    auto color = vector3_zero;
+                    chunk.valid &= read_vector3(first, last, color);
+
+                    if (colors) {
+                        (*colors)[color_idx] = color;
+                    }
+
+                    ++color_idx;
+                }
+            } else if (cmd == "f") {
+                auto count = count_obj_tokens(first, last);
+
+                if (count < 3) {
+                    chunk.valid = false;
+                    return;
+                }
+
+                auto face_first = index_idx;
+                auto num_face_indices = size_t{0};
+                uint32_t first_idx = 0, prev_idx = 0;
+                auto num_vertices = vertex_idx - base_vertex;
+                auto max_vertices = vertices.size() - base_vertex;
+
+                chunk.valid &= read_face_indices(first, last, num_vertices, max_vertices, [&](uint32_t idx) {
+                    idx += static_cast<uint32_t>(base_vertex);
+
+                    if (num_face_indices == 0) {
+                        first_idx = idx;
+                    } else if (num_face_indices >= 3) {
+                        indices[index_idx++] = first_idx;
+                        indices[index_idx++] = prev_idx;
+                    }
+
+                    indices[index_idx++] = idx;
+                    prev_idx = idx;
+                    ++num_face_indices;
+                });
+
+                // Invalid indices leave the first vertex of the file behind.
+                auto face_last = face_first + (count - 2) * 3;
+
+                while (index_idx < face_last) {
+                    indices[index_idx++] = static_cast<uint32_t>(base_vertex);
                 }
             }
-        } else if (cmd == "f") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            read_face_indices(iss, indices, 0, true);
-        }
-    }
+        });
+
+        EDYN_ASSERT(vertex_idx == chunk.vertex_offset + chunk.num_vertices);
+        EDYN_ASSERT(index_idx == chunk.index_offset + chunk.num_indices);
+    });
+
+    return std::all_of(chunks.begin(), chunks.end(), [](auto &chunk) { return chunk.valid; });
 }
 
 bool load_tri_mesh_from_obj(const std::string &path,
@@ -212,14 +463,13 @@ bool load_tri_mesh_from_obj(const std::string &path,
                             vector3 pos,
                             quaternion orn,
                             vector3 scale) {
-    auto file = std::ifstream(path);
+    auto file = mapped_file(path, mapped_file::access_pattern::sequential);
 
     if (!file.is_open()) {
         return false;
     }
 
-    load_tri_mesh_from_obj_stream(file, vertices, indices, colors, pos, orn, scale);
-    return true;
+    return load_tri_mesh_from_obj_text(file.text(), vertices, indices, colors, pos, orn, scale);
 }
 
 void load_tri_mesh_from_obj(std::stringstream &stream,
@@ -229,19 +479,18 @@ void load_tri_mesh_from_obj(std::stringstream &stream,
                             vector3 pos,
                             quaternion orn,
                             vector3 scale) {
-    load_tri_mesh_from_obj_stream(stream, vertices, indices, colors, pos, orn, scale);
+    load_tri_mesh_from_obj_text(read_remaining(stream), vertices, indices, colors, pos, orn, scale);
 }
 
-template<typename Stream>
-std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj_stream(
-    Stream &stream,
+static std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj_text(
+    std::string_view text,
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
 
     auto meshes = std::vector<obj_mesh>{};
 
-    load_meshes_from_obj_stream(stream, meshes, pos, orn, scale);
+    load_meshes_from_obj_text(text, meshes, pos, orn, scale);
 
     EDYN_ASSERT(!meshes.empty());
     auto polyhedrons = std::vector<polyhedron_with_center>{};
@@ -281,13 +530,13 @@ std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj(
     const quaternion &orn,
     const vector3 &scale) {
 
-    auto file = std::ifstream(path_to_obj);
+    auto file = mapped_file(path_to_obj, mapped_file::access_pattern::sequential);
 
     if (!file.is_open()) {
         return {};
     }
 
-    return load_convex_polyhedrons_from_obj_stream(file, pos, orn, scale);
+    return load_convex_polyhedrons_from_obj_text(file.text(), pos, orn, scale);
 }
 
 std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj(
@@ -295,17 +544,16 @@ std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj(
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
-    return load_convex_polyhedrons_from_obj_stream(ss, pos, orn, scale);
+    return load_convex_polyhedrons_from_obj_text(read_remaining(ss), pos, orn, scale);
 }
 
-template<typename Stream>
-compound_shape load_compound_shape_from_obj_stream(
-    Stream &stream,
+static compound_shape load_compound_shape_from_obj_text(
+    std::string_view text,
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
 
-    auto polyhedrons = load_convex_polyhedrons_from_obj_stream(stream, pos, orn, scale);
+    auto polyhedrons = load_convex_polyhedrons_from_obj_text(text, pos, orn, scale);
     EDYN_ASSERT(!polyhedrons.empty());
 
     auto compound = compound_shape{};
@@ -325,13 +573,13 @@ compound_shape load_compound_shape_from_obj(
     const quaternion &orn,
     const vector3 &scale) {
 
-    auto file = std::ifstream(path_to_obj);
+    auto file = mapped_file(path_to_obj, mapped_file::access_pattern::sequential);
 
     if (!file.is_open()) {
         return {};
     }
 
-    return load_compound_shape_from_obj_stream(file, pos, orn, scale);
+    return load_compound_shape_from_obj_text(file.text(), pos, orn, scale);
 }
 
 compound_shape load_compound_shape_from_obj(
@@ -339,7 +587,7 @@ compound_shape load_compound_shape_from_obj(
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
-    return load_compound_shape_from_obj_stream(ss, pos, orn, scale);
+    return load_compound_shape_from_obj_text(read_remaining(ss), pos, orn, scale);
 }
 
 }
@@ -6,6 +6,7 @@
 #include "edyn/math/math.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
+#include "edyn/shapes/heightfield.hpp"
 
 namespace edyn {
 
@@ -392,8 +393,9 @@ vector3 mesh_centroid(const std::vector<vector3> &vertices,
     return center;
 }
 
-size_t get_triangle_mesh_feature_index(const triangle_mesh &mesh, size_t tri_idx,
-                                       triangle_feature tri_feature, size_t tri_feature_idx) {
+template<typename Mesh>
+static size_t get_mesh_feature_index(const Mesh &mesh, size_t tri_idx,
+                                     triangle_feature tri_feature, size_t tri_feature_idx) {
     switch (tri_feature) {
     case triangle_feature::face:
         return tri_idx;
@@ -406,4 +408,14 @@ size_t get_triangle_mesh_feature_index(const triangle_mesh &mesh, size_t tri_idx
     return SIZE_MAX;
 }
 
+size_t get_triangle_mesh_feature_index(const triangle_mesh &mesh, size_t tri_idx,
+                                       triangle_feature tri_feature, size_t tri_feature_idx) {
+    return get_mesh_feature_index(mesh, tri_idx, tri_feature, tri_feature_idx);
+}
+
+size_t get_triangle_mesh_feature_index(const heightfield &field, size_t tri_idx,
+                                       triangle_feature tri_feature, size_t tri_feature_idx) {
+    return get_mesh_feature_index(field, tri_idx, tri_feature, tri_feature_idx);
+}
+
 }
@@ -0,0 +1,184 @@
+#include "../common/common.hpp"
+#include "edyn/collision/static_tree.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/atomic_counter_sync.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include <random>
+#include <set>
+
+static std::vector<edyn::AABB> make_random_aabbs(size_t count) {
+    auto rng = std::mt19937(7);
+    auto pos_dist = std::uniform_real_distribution<edyn::scalar>(-100, 100);
+    auto size_dist = std::uniform_real_distribution<edyn::scalar>(0.1, 2);
+    std::vector<edyn::AABB> aabbs;
+
+    for (size_t i = 0; i < count; ++i) {
+        auto min = edyn::vector3{pos_dist(rng), pos_dist(rng) * edyn::scalar(0.1), pos_dist(rng)};
+        auto size = edyn::vector3{size_dist(rng), size_dist(rng), size_dist(rng)};
+        aabbs.push_back({min, min + size});
+    }
+
+    return aabbs;
+}
+
+struct leaf_collector {
+    std::vector<std::vector<uint32_t>> leaves;
+
+    template<typename It>
+    void operator()(edyn::static_tree::tree_node &node, It ids_begin, It ids_end) {
+        node.id = leaves.size();
+        leaves.emplace_back(ids_begin, ids_end);
+    }
+};
+
+static void check_tree(const std::vector<edyn::AABB> &aabbs,
+                       const edyn::static_tree_build_config &config) {
+    auto tree = edyn::static_tree{};
+    auto collector = leaf_collector{};
+    tree.build(aabbs.begin(), aabbs.end(), collector, config);
+
+    // Every object must be in exactly one leaf.
+    std::vector<unsigned> counts(aabbs.size(), 0);
+
+    for (auto &leaf : collector.leaves) {
+        ASSERT_FALSE(leaf.empty());
+        ASSERT_LE(leaf.size(), config.max_obj_per_leaf);
+
+        for (auto id : leaf) {
+            ++counts[id];
+        }
+    }
+
+    for (auto count : counts) {
+        ASSERT_EQ(count, 1);
+    }
+
+    // Queries must find the same objects as testing all of them.
+    auto query_aabbs = make_random_aabbs(50);
+
+    for (auto query_aabb : query_aabbs) {
+        query_aabb.max += edyn::vector3_one * 10;
+        std::set<uint32_t> expected, found;
+
+        for (uint32_t i = 0; i < aabbs.size(); ++i) {
+            if (edyn::intersect(aabbs[i], query_aabb)) {
+                expected.insert(i);
+            }
+        }
+
+        tree.query(query_aabb, [&](uint32_t node_idx) {
+            for (auto id : collector.leaves[tree.get_node(node_idx).id]) {
+                if (edyn::intersect(aabbs[id], query_aabb)) {
+                    found.insert(id);
+                }
+            }
+        });
+
+        ASSERT_EQ(expected, found);
+    }
+}
+
+TEST(test_static_tree, build_and_query) {
+    auto aabbs = make_random_aabbs(3000);
+
+    auto config = edyn::static_tree_build_config{};
+    config.parallel_threshold = 0;
+    check_tree(aabbs, config);
+
+    config.max_obj_per_leaf = 8;
+    check_tree(aabbs, config);
+
+    config.wide = true;
+    check_tree(aabbs, config);
+}
+
+TEST(test_static_tree, single_object) {
+    auto aabbs = make_random_aabbs(1);
+    check_tree(aabbs, {});
+
+    auto config = edyn::static_tree_build_config{};
+    config.wide = true;
+    check_tree(aabbs, config);
+}
+
+TEST(test_static_tree, coincident_objects) {
+    // All centers are equal, which requires splitting at the median.
+    auto aabbs = std::vector<edyn::AABB>(100, edyn::AABB{{0, 0, 0}, {1, 1, 1}});
+    check_tree(aabbs, {});
+}
+
+TEST(test_static_tree, parallel_build_is_deterministic) {
+    edyn::job_dispatcher::global().start(4);
+
+    auto aabbs = make_random_aabbs(20000);
+    auto config = edyn::static_tree_build_config{};
+    config.max_obj_per_leaf = 4;
+    config.parallel_threshold = 0;
+
+    auto sequential = edyn::static_tree{};
+    auto sequential_leaves = leaf_collector{};
+    sequential.build(aabbs.begin(), aabbs.end(), sequential_leaves, config);
+
+    config.parallel_threshold = 500;
+    auto parallel = edyn::static_tree{};
+    auto parallel_leaves = leaf_collector{};
+    parallel.build(aabbs.begin(), aabbs.end(), parallel_leaves, config);
+
+    ASSERT_EQ(sequential_leaves.leaves, parallel_leaves.leaves);
+    check_tree(aabbs, config);
+
+    edyn::job_dispatcher::global().stop();
+}
+
+struct build_in_job_context {
+    edyn::atomic_counter_sync counter {1};
+    const std::vector<edyn::AABB> *aabbs;
+    edyn::static_tree_build_config config;
+    leaf_collector leaves;
+    bool in_worker {false};
+};
+
+static void build_in_job(edyn::job::data_type &data) {
+    auto archive = edyn::memory_input_archive(data.data(), data.size());
+    intptr_t ctx_ptr;
+    archive(ctx_ptr);
+    auto *ctx = reinterpret_cast<build_in_job_context *>(ctx_ptr);
+    ctx->in_worker = edyn::job_dispatcher::is_worker_thread();
+
+    auto tree = edyn::static_tree{};
+    tree.build(ctx->aabbs->begin(), ctx->aabbs->end(), ctx->leaves, ctx->config);
+    ctx->counter.decrement();
+}
+
+TEST(test_static_tree, build_in_worker_thread) {
+    // With a single worker, a parallel build inside a job would wait for jobs
+    // that can never run. It must be built in the worker instead.
+    edyn::job_dispatcher::global().start(1);
+
+    auto aabbs = make_random_aabbs(5000);
+    auto ctx = build_in_job_context{};
+    ctx.aabbs = &aabbs;
+    ctx.config.max_obj_per_leaf = 4;
+    ctx.config.parallel_threshold = 500;
+
+    auto j = edyn::job();
+    j.func = &build_in_job;
+    auto archive = edyn::fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto ctx_ptr = reinterpret_cast<intptr_t>(&ctx);
+    archive(ctx_ptr);
+
+    edyn::job_dispatcher::global().async(j);
+    ctx.counter.wait();
+
+    ASSERT_TRUE(ctx.in_worker);
+    ASSERT_FALSE(edyn::job_dispatcher::is_worker_thread());
+
+    auto config = ctx.config;
+    config.parallel_threshold = 0;
+    auto sequential = edyn::static_tree{};
+    auto sequential_leaves = leaf_collector{};
+    sequential.build(aabbs.begin(), aabbs.end(), sequential_leaves, config);
+    ASSERT_EQ(ctx.leaves.leaves, sequential_leaves.leaves);
+
+    edyn::job_dispatcher::global().stop();
+}
@@ -0,0 +1,109 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// FNV-1a hash of the raw bytes of a value.
+template<typename T>
+void hash_bytes(uint64_t &hash, const T &value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+
+    for (auto b : bytes) {
+        hash ^= b;
+        hash *= 0x100000001b3ull;
+    }
+}
+
+static uint64_t hash_world_state(entt::registry &registry, const std::vector<entt::entity> &entities) {
+    auto hash = uint64_t{0xcbf29ce484222325ull};
+
+    for (auto entity : entities) {
+        auto [pos, orn, v, w] = registry.get<edyn::position, edyn::orientation, edyn::linvel, edyn::angvel>(entity);
+        hash_bytes(hash, static_cast<edyn::vector3>(pos));
+        hash_bytes(hash, static_cast<edyn::quaternion>(orn));
+        hash_bytes(hash, static_cast<edyn::vector3>(v));
+        hash_bytes(hash, static_cast<edyn::vector3>(w));
+    }
+
+    return hash;
+}
+
+struct scene_result {
+    // Hash of the world state after each step.
+    std::vector<uint64_t> hashes;
+    // Number of job dispatcher workers which ran the scene.
+    size_t num_workers;
+};
+
+// Runs a scene with two piles of boxes.
+static scene_result run_scene(edyn::execution_mode mode, size_t num_worker_threads) {
+    constexpr auto num_steps = 90;
+
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = mode;
+    config.num_worker_threads = num_worker_threads;
+    config.deterministic = true;
+
+    // The dispatcher is only started by `attach` if not running yet. Stop it
+    // so each run uses the requested number of threads.
+    edyn::job_dispatcher::global().stop();
+    edyn::attach(registry, config);
+    auto num_workers = edyn::job_dispatcher::global().num_workers();
+    edyn::set_paused(registry, true);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(registry, floor_def);
+
+    auto entities = std::vector<entt::entity>{};
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+
+    for (auto pile = 0; pile < 2; ++pile) {
+        for (auto i = 0; i < 4; ++i) {
+            for (auto j = 0; j < 4; ++j) {
+                for (auto k = 0; k < 4; ++k) {
+                    def.position = {pile * edyn::scalar(10) + i * edyn::scalar(0.41) + j * edyn::scalar(0.01),
+                                    edyn::scalar(0.2) + j * edyn::scalar(0.45),
+                                    k * edyn::scalar(0.41)};
+                    entities.push_back(edyn::make_rigidbody(registry, def));
+                }
+            }
+        }
+    }
+
+    auto hashes = std::vector<uint64_t>{};
+    auto time = 0.0;
+
+    for (auto step = 0; step < num_steps; ++step) {
+        time += edyn::get_fixed_dt(registry);
+        edyn::step_simulation(registry, time);
+        hashes.push_back(hash_world_state(registry, entities));
+    }
+
+    edyn::detach(registry);
+
+    return {hashes, num_workers};
+}
+
+TEST(test_determinism, same_state_across_thread_counts) {
+    auto reference = run_scene(edyn::execution_mode::sequential, 1).hashes;
+
+    for (auto num_threads : {size_t{1}, size_t{2}, size_t{4}}) {
+        auto result = run_scene(edyn::execution_mode::sequential_multithreaded, num_threads);
+        ASSERT_EQ(result.num_workers, num_threads);
+
+        auto &hashes = result.hashes;
+        ASSERT_EQ(hashes.size(), reference.size());
+
+        for (size_t step = 0; step < hashes.size(); ++step) {
+            ASSERT_EQ(hashes[step], reference[step]) << "diverged at step " << step
+                << " with " << num_threads << " threads";
+        }
+    }
+}
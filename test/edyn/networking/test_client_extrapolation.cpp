@@ -0,0 +1,160 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/sys/client_side.hpp"
+#include "edyn/networking/util/split_extrapolation_request.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+static edyn::packet::registry_snapshot make_snapshot(entt::registry &registry,
+                                                     const std::vector<entt::entity> &entities) {
+    auto pos_index = edyn::tuple_index_of<edyn::component_index_type, edyn::position>(edyn::networked_components);
+    auto snap = edyn::packet::registry_snapshot{};
+    edyn::internal::snapshot_insert_entities<edyn::position>(registry, entities.begin(), entities.end(), snap, pos_index);
+    return snap;
+}
+
+static entt::entity make_box(entt::registry &registry, edyn::vector3 pos) {
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.position = pos;
+    def.networked = true;
+    return edyn::make_rigidbody(registry, def);
+}
+
+static std::vector<entt::entity> sorted(std::vector<entt::entity> entities) {
+    std::sort(entities.begin(), entities.end());
+    return entities;
+}
+
+TEST(client_extrapolation_test, split_request_by_island) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    floor_def.networked = true;
+    auto floor = edyn::make_rigidbody(registry, floor_def);
+
+    // Two connected bodies and an isolated one.
+    auto body0 = make_box(registry, {0, 1, 0});
+    auto body1 = make_box(registry, {1, 1, 0});
+    auto con = edyn::make_constraint<edyn::null_constraint>(registry, body0, body1);
+    auto body2 = make_box(registry, {5, 1, 0});
+
+    constexpr size_t num_extrapolators = 3;
+    auto request = edyn::extrapolation_request{};
+    request.start_time = 1.5;
+    request.execution_time_limit = 0.2;
+    request.should_remap = false;
+    // Only one of the connected bodies is in the snapshot.
+    request.snapshot = make_snapshot(registry, {floor, body1, body2});
+
+    auto parts = edyn::split_extrapolation_request(registry, request, num_extrapolators);
+    ASSERT_EQ(parts.size(), num_extrapolators);
+
+    // Islands go to the extrapolator given by their lowest entity, including
+    // entities which are not in the snapshot. The floor is not in an island.
+    auto index_of = [&](std::initializer_list<entt::entity> island) {
+        return entt::to_integral(std::min(island)) % num_extrapolators;
+    };
+
+    auto expected = std::vector<std::vector<entt::entity>>(num_extrapolators);
+    expected[0].push_back(floor);
+    expected[index_of({body0, body1, con})].push_back(body1);
+    expected[index_of({body2})].push_back(body2);
+
+    for (size_t i = 0; i < num_extrapolators; ++i) {
+        auto &part = parts[i];
+        ASSERT_EQ(part.destination.value, request.destination.value);
+        ASSERT_EQ(part.start_time, request.start_time);
+        ASSERT_EQ(part.execution_time_limit, request.execution_time_limit);
+        ASSERT_EQ(part.should_remap, request.should_remap);
+        ASSERT_EQ(sorted(part.snapshot.entities), sorted(expected[i]));
+
+        // The others are sent as remote state.
+        auto remote = std::vector<entt::entity>{};
+
+        for (size_t j = 0; j < num_extrapolators; ++j) {
+            if (j != i) {
+                remote.insert(remote.end(), expected[j].begin(), expected[j].end());
+            }
+        }
+
+        ASSERT_EQ(sorted(part.remote_state.entities), sorted(remote));
+    }
+
+    edyn::detach(registry);
+}
+
+TEST(client_extrapolation_test, dispatch_and_process_results) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    constexpr unsigned num_extrapolators = 2;
+    edyn::init_network_client(registry, num_extrapolators);
+    auto &ctx = registry.ctx().at<edyn::client_network_context>();
+
+    auto num_finished = 0;
+    auto on_finished = [&](double) { ++num_finished; };
+    ctx.extrapolation_finished_sink().connect<&decltype(on_finished)::operator()>(on_finished);
+
+    auto body0 = make_box(registry, {0, 10, 0});
+    auto body1 = make_box(registry, {5, 10, 0});
+
+    // Bodies are in separate islands, which might be assigned to the same
+    // extrapolator.
+    auto expected_results = entt::to_integral(body0) % num_extrapolators ==
+                            entt::to_integral(body1) % num_extrapolators ? 1 : 2;
+
+    // Entities are sent to the extrapolators in the next update, before the
+    // request is dispatched.
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &req = ctx.pending_extrapolations.emplace_back();
+    req.start_time = (*settings.time_func)() - 0.2;
+    req.destination = ctx.message_queue.identifier;
+    req.snapshot = make_snapshot(registry, {body0, body1});
+    req.should_remap = true;
+
+    auto start = edyn::performance_time();
+
+    while (num_finished < expected_results && edyn::performance_time() - start < 5) {
+        edyn::update_network_client(registry);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    ASSERT_TRUE(ctx.pending_extrapolations.empty());
+    ASSERT_EQ(num_finished, expected_results);
+
+    // Results were applied. Bodies fell under gravity.
+    ASSERT_LT(registry.get<edyn::position>(body0).y, edyn::scalar(10));
+    ASSERT_LT(registry.get<edyn::position>(body1).y, edyn::scalar(10));
+
+    ctx.extrapolation_finished_sink().disconnect(on_finished);
+    edyn::deinit_network_client(registry);
+    edyn::detach(registry);
+}
+
+TEST(client_extrapolation_test, reinit_reuses_queue_names) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    // Queues are removed in deinit, thus their names are available again.
+    edyn::init_network_client(registry, 2);
+    auto queue_name = registry.ctx().at<edyn::client_network_context>().message_queue.identifier.value;
+    edyn::deinit_network_client(registry);
+
+    edyn::init_network_client(registry, 2);
+    ASSERT_EQ(registry.ctx().at<edyn::client_network_context>().message_queue.identifier.value, queue_name);
+    edyn::deinit_network_client(registry);
+
+    edyn::detach(registry);
+}
@@ -96,3 +96,46 @@ TEST(networking_test, input_state_history) {
     ASSERT_EQ(registry2.get<input>(emap.at(ent0)).value, -98);
     ASSERT_EQ(registry2.get<input>(emap.at(ent2)).value, 77);
 }
+
+TEST(networking_test, input_state_history_ring_buffer) {
+    auto history = edyn::internal::component_history<input>(4);
+
+    for (int i = 0; i < 6; ++i) {
+        history.push(input{i}, i);
+    }
+
+    // Oldest entries are overwritten when full and are counted as lost since
+    // they had not been erased.
+    ASSERT_EQ(history.size(), 4u);
+    ASSERT_EQ(history.num_lost(), 2u);
+
+    auto entry = edyn::internal::component_history<input>::entry{};
+    ASSERT_FALSE(history.latest_before(1.5, entry));
+    ASSERT_TRUE(history.latest_before(3.5, entry));
+    ASSERT_EQ(entry.component.value, 3);
+
+    auto values = std::vector<int>{};
+    history.each(3, 4, [&](auto &e) { values.push_back(e.component.value); });
+    ASSERT_EQ(values, (std::vector<int>{3, 4}));
+
+    history.erase_until(4);
+    ASSERT_EQ(history.size(), 1u);
+    ASSERT_TRUE(history.latest_before(10, entry));
+    ASSERT_EQ(entry.component.value, 5);
+
+    // Entries are not lost if erased before the history fills up.
+    for (int i = 6; i < 10; ++i) {
+        history.erase_until(i - 2);
+        history.push(input{i}, i);
+    }
+
+    ASSERT_EQ(history.size(), 2u);
+    ASSERT_EQ(history.num_lost(), 2u);
+
+    for (int i = 10; i < 15; ++i) {
+        history.push(input{i}, i);
+    }
+
+    ASSERT_EQ(history.size(), 4u);
+    ASSERT_EQ(history.num_lost(), 5u);
+}
@@ -0,0 +1,142 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/sys/server_side.hpp"
+#include "edyn/networking/sys/update_aabbs_of_interest.hpp"
+#include "edyn/networking/util/interest_grid.hpp"
+
+static std::vector<entt::entity> collect(const edyn::interest_grid &grid, const edyn::AABB &aabb) {
+    auto result = std::vector<entt::entity>{};
+    grid.each_entity(grid.get_cell_range(aabb), [&](entt::entity entity) {
+        result.push_back(entity);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(interest_grid_test, items_move_between_cells) {
+    auto registry = entt::registry{};
+    auto island = registry.create();
+    auto body0 = registry.create();
+    auto body1 = registry.create();
+    auto grid = edyn::interest_grid(10);
+    auto view = edyn::AABB{{-5, -5, -5}, {5, 5, 5}};
+    auto view_cells = grid.get_cell_range(view);
+
+    grid.begin_update();
+    grid.update_item(island, {{1, 1, 1}, {2, 2, 2}}, {body0, body1}, 1);
+    grid.end_update();
+    ASSERT_TRUE(grid.is_dirty(view_cells));
+    ASSERT_EQ(collect(grid, view), (std::vector<entt::entity>{body0, body1}));
+
+    // Moving within the same cell does not dirty it.
+    grid.begin_update();
+    grid.update_item(island, {{1.5, 1, 1}, {2.5, 2, 2}}, {body0, body1}, 1);
+    grid.end_update();
+    ASSERT_FALSE(grid.is_dirty(view_cells));
+
+    // Moving out of the view.
+    grid.begin_update();
+    grid.update_item(island, {{31, 1, 1}, {32, 2, 2}}, {body0, body1}, 1);
+    grid.end_update();
+    ASSERT_TRUE(grid.is_dirty(view_cells));
+    ASSERT_TRUE(collect(grid, view).empty());
+    ASSERT_EQ(collect(grid, {{25, -5, -5}, {35, 5, 5}}).size(), 2u);
+
+    // Items not updated are removed.
+    grid.begin_update();
+    grid.end_update();
+    ASSERT_TRUE(collect(grid, {{25, -5, -5}, {35, 5, 5}}).empty());
+}
+
+TEST(interest_grid_test, content_change_dirties_cells) {
+    auto registry = entt::registry{};
+    auto island = registry.create();
+    auto body0 = registry.create();
+    auto body1 = registry.create();
+    auto grid = edyn::interest_grid(10);
+    auto view_cells = grid.get_cell_range({{-5, -5, -5}, {5, 5, 5}});
+
+    grid.begin_update();
+    grid.update_item(island, {{1, 1, 1}, {2, 2, 2}}, {body0}, 1);
+    grid.end_update();
+
+    grid.begin_update();
+    grid.update_item(island, {{1, 1, 1}, {2, 2, 2}}, {body0, body1}, 2);
+    grid.end_update();
+    ASSERT_TRUE(grid.is_dirty(view_cells));
+}
+
+TEST(interest_grid_test, large_items) {
+    auto registry = entt::registry{};
+    auto ground = registry.create();
+    auto grid = edyn::interest_grid(1);
+
+    grid.begin_update();
+    grid.update_item(ground, {{-1000, -1, -1000}, {1000, 0, 1000}}, {ground}, 0);
+    grid.end_update();
+
+    ASSERT_EQ(collect(grid, {{500, -1, 500}, {501, 1, 501}}), (std::vector<entt::entity>{ground}));
+    ASSERT_TRUE(collect(grid, {{500, 10, 500}, {501, 11, 501}}).empty());
+}
+
+TEST(interest_grid_test, exact_intersection) {
+    auto registry = entt::registry{};
+    auto island = registry.create();
+    auto body = registry.create();
+    auto grid = edyn::interest_grid(10);
+    auto view = edyn::AABB{{-5, -5, -5}, {5, 5, 5}};
+
+    auto collect_exact = [&] {
+        auto result = std::vector<entt::entity>{};
+        grid.each_entity(view, [&](entt::entity entity) {
+            result.push_back(entity);
+        });
+        return result;
+    };
+
+    // In a cell overlapped by the view but outside of it.
+    grid.begin_update();
+    grid.update_item(island, {{7, 1, 1}, {8, 2, 2}}, {body}, 1);
+    grid.end_update();
+    ASSERT_EQ(collect(grid, view), (std::vector<entt::entity>{body}));
+    ASSERT_TRUE(collect_exact().empty());
+
+    // Moving into the view within the same cell.
+    grid.begin_update();
+    grid.update_item(island, {{4, 1, 1}, {5.5, 2, 2}}, {body}, 1);
+    grid.end_update();
+    ASSERT_FALSE(grid.is_dirty(grid.get_cell_range(view)));
+    ASSERT_TRUE(grid.is_dirty(view));
+    ASSERT_EQ(collect_exact(), (std::vector<entt::entity>{body}));
+
+    // Movement in cells entirely inside the AABB does not affect it.
+    auto large_view = edyn::AABB{{-5, -5, -5}, {25, 25, 25}};
+    grid.begin_update();
+    grid.update_item(island, {{11, 11, 11}, {12, 12, 12}}, {body}, 1);
+    grid.end_update();
+    grid.begin_update();
+    grid.update_item(island, {{13, 13, 13}, {14, 14, 14}}, {body}, 1);
+    grid.end_update();
+    ASSERT_FALSE(grid.is_dirty(large_view));
+}
+
+TEST(interest_grid_test, update_aabbs_of_interest_without_clients) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::init_network_server(registry);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.networked = true;
+    edyn::make_rigidbody(registry, def);
+    edyn::update(registry);
+
+    // The grid is updated even if there are no AABBs of interest.
+    edyn::update_aabbs_of_interest(registry);
+    ASSERT_TRUE(registry.ctx().contains<edyn::interest_grid>());
+
+    edyn::deinit_network_server(registry);
+    edyn::detach(registry);
+}
@@ -0,0 +1,69 @@
+#include "../common/common.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/util/lag_compensation_history.hpp"
+
+static entt::entity make_sphere(entt::registry &registry, edyn::scalar radius) {
+    auto entity = registry.create();
+    registry.emplace<edyn::networked_tag>(entity);
+    registry.emplace<edyn::procedural_tag>(entity);
+    registry.emplace<edyn::position>(entity, edyn::vector3_zero);
+    registry.emplace<edyn::orientation>(entity, edyn::quaternion_identity);
+    registry.emplace<edyn::AABB>(entity);
+    registry.emplace<edyn::sphere_shape>(entity, radius);
+    registry.emplace<edyn::shape_index>(entity, edyn::get_shape_index<edyn::sphere_shape>());
+    return entity;
+}
+
+static void set_position(entt::registry &registry, entt::entity entity, edyn::vector3 pos) {
+    auto radius = registry.get<edyn::sphere_shape>(entity).radius;
+    registry.get<edyn::position>(entity) = pos;
+    registry.get<edyn::AABB>(entity) = {pos - edyn::vector3_one * radius, pos + edyn::vector3_one * radius};
+}
+
+TEST(lag_compensation_history_test, query_past_state) {
+    auto registry = entt::registry{};
+    auto mover = make_sphere(registry, 0.5);
+    auto still = make_sphere(registry, 0.5);
+    set_position(registry, still, {0, 0, 10});
+
+    auto history = edyn::lag_compensation_history{};
+    history.set_chunk_size(4);
+
+    // Mover goes along the x axis one unit per frame. Frames beyond 16 are in
+    // the chunk that is still open.
+    for (int i = 0; i <= 18; ++i) {
+        set_position(registry, mover, {edyn::scalar(i), 0, 0});
+        history.record_frame(registry, i);
+    }
+
+    // Interpolated between frames 2 and 3.
+    auto query = edyn::AABB{{2.4, -0.1, -0.1}, {2.6, 0.1, 0.1}};
+    ASSERT_EQ(history.query_aabb(registry, 2.5, query), std::vector<entt::entity>{mover});
+    ASSERT_TRUE(history.query_aabb(registry, 8, query).empty());
+
+    auto result = history.raycast(registry, 7.5, {7.5, 5, 0}, {7.5, -5, 0});
+    ASSERT_EQ(result.entity, mover);
+    ASSERT_NEAR(result.fraction, 0.45, 0.001);
+
+    result = history.raycast(registry, 12, {7.5, 5, 0}, {7.5, -5, 0});
+    ASSERT_EQ(result.entity, entt::entity{entt::null});
+
+    // Open chunk.
+    result = history.raycast(registry, 17.25, {17.25, 5, 0}, {17.25, -5, 0});
+    ASSERT_EQ(result.entity, mover);
+
+    // Ignored entities and bodies which did not move.
+    result = history.raycast(registry, 3, {0, 0, 5}, {0, 0, 15}, {mover});
+    ASSERT_EQ(result.entity, still);
+
+    // Destroyed bodies are not returned.
+    auto far_query = edyn::AABB{{-1, -1, 9}, {1, 1, 11}};
+    ASSERT_EQ(history.query_aabb(registry, 3, far_query), std::vector<entt::entity>{still});
+    registry.destroy(still);
+    ASSERT_TRUE(history.query_aabb(registry, 3, far_query).empty());
+
+    // Whole chunks older than the given time are erased.
+    history.erase_until(9);
+    ASSERT_EQ(history.oldest_timestamp(), 8);
+    ASSERT_TRUE(history.query_aabb(registry, 2.5, query).empty());
+}
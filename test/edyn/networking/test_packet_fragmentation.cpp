@@ -0,0 +1,154 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/packet/edyn_packet.hpp"
+#include "edyn/networking/util/packet_fragmentation.hpp"
+
+static edyn::packet::registry_snapshot make_snapshot(entt::registry &registry, size_t num_entities) {
+    auto pos_index = edyn::tuple_index_of<edyn::component_index_type, edyn::position>(edyn::networked_components);
+    auto vel_index = edyn::tuple_index_of<edyn::component_index_type, edyn::linvel>(edyn::networked_components);
+    auto entities = std::vector<entt::entity>{};
+
+    for (size_t i = 0; i < num_entities; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::vector3{edyn::scalar(i), 1, 2});
+        // Only every other entity has a velocity.
+        if (i % 2 == 0) {
+            registry.emplace<edyn::linvel>(entity, edyn::vector3{0, edyn::scalar(i), 0});
+        }
+        entities.push_back(entity);
+    }
+
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.timestamp = 2.5;
+    auto view = registry.view<edyn::linvel>();
+    edyn::internal::snapshot_insert_entities<edyn::position>(registry, entities.begin(), entities.end(), snap, pos_index);
+    edyn::internal::snapshot_insert_entities<edyn::linvel>(registry, view.begin(), view.end(), snap, vel_index);
+
+    return snap;
+}
+
+template<typename Component>
+static std::vector<std::pair<entt::entity, Component>> get_elements(edyn::packet::registry_snapshot &snap) {
+    auto index = edyn::tuple_index_of<edyn::component_index_type, Component>(edyn::networked_components);
+    auto *pool = edyn::internal::get_pool<Component>(snap.pools, index);
+    auto result = std::vector<std::pair<entt::entity, Component>>{};
+
+    for (size_t i = 0; i < pool->entity_indices.size(); ++i) {
+        result.emplace_back(snap.entities[pool->entity_indices[i]], pool->components[i]);
+    }
+
+    return result;
+}
+
+TEST(packet_fragmentation_test, more_than_256_entities) {
+    auto registry = entt::registry{};
+    auto snap = make_snapshot(registry, 700);
+
+    auto buffer = std::vector<uint8_t>{};
+    auto output = edyn::memory_output_archive(buffer);
+    auto packet = edyn::packet::edyn_packet{snap};
+    output(packet);
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto result = edyn::packet::edyn_packet{};
+    input(result);
+    ASSERT_FALSE(input.failed());
+
+    auto &snap_in = std::get<edyn::packet::registry_snapshot>(result.var);
+    ASSERT_EQ(snap_in.entities, snap.entities);
+    ASSERT_EQ(get_elements<edyn::position>(snap_in).size(), 700u);
+    ASSERT_EQ(get_elements<edyn::position>(snap_in).back().second, edyn::vector3(699, 1, 2));
+    ASSERT_EQ(get_elements<edyn::linvel>(snap_in).size(), 350u);
+}
+
+TEST(packet_fragmentation_test, reject_invalid_pool_data) {
+    auto read_pool = [](std::vector<uint8_t> data) {
+        auto pool = edyn::pool_snapshot_data_impl<edyn::position>{};
+        auto input = edyn::memory_input_archive(data.data(), data.size());
+        pool.read(input);
+        EXPECT_TRUE(pool.entity_indices.empty());
+        EXPECT_TRUE(pool.components.empty());
+        return input.failed();
+    };
+
+    // Invalid index width.
+    ASSERT_TRUE(read_pool({3, 1, 0}));
+    // More indices than there is data for.
+    ASSERT_TRUE(read_pool({4, 0xff, 0xff, 0xff, 0xff, 0}));
+    // More components than there is data for.
+    ASSERT_TRUE(read_pool({1, 2, 0, 1}));
+}
+
+TEST(packet_fragmentation_test, reject_out_of_range_entity_index) {
+    auto registry = entt::registry{};
+    auto snap = make_snapshot(registry, 10);
+    snap.pools.front().ptr->entity_indices.back() = 10;
+
+    auto buffer = std::vector<uint8_t>{};
+    auto output = edyn::memory_output_archive(buffer);
+    auto packet = edyn::packet::edyn_packet{snap};
+    output(packet);
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto result = edyn::packet::edyn_packet{};
+    input(result);
+    ASSERT_TRUE(input.failed());
+}
+
+TEST(packet_fragmentation_test, split_registry_snapshot) {
+    auto registry = entt::registry{};
+    auto snap = make_snapshot(registry, 300);
+    const size_t max_size = 1200;
+
+    auto parts = edyn::split_registry_snapshot(snap, max_size);
+    ASSERT_GT(parts.size(), 1u);
+
+    auto positions = std::vector<std::pair<entt::entity, edyn::position>>{};
+    auto velocities = std::vector<std::pair<entt::entity, edyn::linvel>>{};
+    size_t num_entities = 0;
+
+    for (auto &part : parts) {
+        ASSERT_LE(edyn::serialized_packet_size(edyn::packet::edyn_packet{part}), max_size);
+        ASSERT_EQ(part.timestamp, snap.timestamp);
+        num_entities += part.entities.size();
+
+        for (auto &elem : get_elements<edyn::position>(part)) positions.push_back(elem);
+        for (auto &elem : get_elements<edyn::linvel>(part)) velocities.push_back(elem);
+    }
+
+    // Velocities are not in entity order in the original snapshot.
+    auto expected_velocities = get_elements<edyn::linvel>(snap);
+    auto by_entity = [](auto &&lhs, auto &&rhs) { return lhs.first < rhs.first; };
+    std::sort(velocities.begin(), velocities.end(), by_entity);
+    std::sort(expected_velocities.begin(), expected_velocities.end(), by_entity);
+
+    ASSERT_EQ(num_entities, snap.entities.size());
+    ASSERT_EQ(positions, get_elements<edyn::position>(snap));
+    ASSERT_EQ(velocities, expected_velocities);
+}
+
+TEST(packet_fragmentation_test, reassemble_out_of_order) {
+    auto registry = entt::registry{};
+    auto create = edyn::packet::create_entity{};
+    static_cast<edyn::packet::registry_snapshot &>(create) = make_snapshot(registry, 400);
+    auto packet = edyn::packet::edyn_packet{create};
+
+    auto fragments = edyn::fragment_packet(packet, 7, 500);
+    ASSERT_GT(fragments.size(), 2u);
+    std::reverse(fragments.begin(), fragments.end());
+
+    auto assembler = edyn::fragment_assembler{};
+    auto result = edyn::packet::edyn_packet{};
+
+    for (size_t i = 0; i < fragments.size(); ++i) {
+        ASSERT_LE(fragments[i].data.size(), 500u);
+        auto done = assembler.insert(fragments[i], result);
+        ASSERT_EQ(done, i + 1 == fragments.size());
+    }
+
+    auto &create_in = std::get<edyn::packet::create_entity>(result.var);
+    ASSERT_EQ(create_in.entities, create.entities);
+    ASSERT_EQ(get_elements<edyn::position>(create_in), get_elements<edyn::position>(create));
+}
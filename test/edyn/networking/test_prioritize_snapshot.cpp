@@ -0,0 +1,117 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/comp/remote_client.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/util/prioritize_snapshot.hpp"
+#include "edyn/networking/util/server_snapshot_exporter.hpp"
+
+static edyn::packet::registry_snapshot make_snapshot(entt::registry &registry,
+                                                     const std::vector<entt::entity> &entities) {
+    auto pos_index = edyn::tuple_index_of<edyn::component_index_type, edyn::position>(edyn::networked_components);
+    auto snap = edyn::packet::registry_snapshot{};
+    edyn::internal::snapshot_insert_entities<edyn::position>(registry, entities.begin(), entities.end(), snap, pos_index);
+    return snap;
+}
+
+TEST(prioritize_snapshot_test, nearest_first_and_eventually_all) {
+    auto registry = entt::registry{};
+    auto client_entity = registry.create();
+    auto &client = registry.emplace<edyn::remote_client>(client_entity);
+    registry.emplace<edyn::aabb_of_interest>(client_entity);
+
+    auto entities = std::vector<entt::entity>{};
+
+    // Entities further away are created first.
+    for (int i = 0; i < 40; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::vector3{edyn::scalar(40 - i) * 10, 0, 0});
+        entities.push_back(entity);
+    }
+
+    auto priority = edyn::snapshot_priority{};
+    priority.byte_budget = 200;
+
+    auto snap = make_snapshot(registry, entities);
+    edyn::prioritize_snapshot(registry, client_entity, client, snap, priority);
+    ASSERT_FALSE(snap.entities.empty());
+    ASSERT_LT(snap.entities.size(), entities.size());
+
+    // The closest entity must have been sent.
+    ASSERT_NE(std::find(snap.entities.begin(), snap.entities.end(), entities.back()), snap.entities.end());
+
+    // All entities are sent after enough snapshots.
+    auto sent = entt::sparse_set{};
+
+    for (auto entity : snap.entities) {
+        sent.emplace(entity);
+    }
+
+    for (int i = 0; i < 100 && sent.size() < entities.size(); ++i) {
+        snap = make_snapshot(registry, entities);
+        edyn::prioritize_snapshot(registry, client_entity, client, snap, priority);
+
+        for (auto entity : snap.entities) {
+            if (!sent.contains(entity)) {
+                sent.emplace(entity);
+            }
+        }
+    }
+
+    ASSERT_EQ(sent.size(), entities.size());
+}
+
+TEST(prioritize_snapshot_test, dropped_entities_are_sent_after_falling_asleep) {
+    auto registry = entt::registry{};
+    auto exporter = edyn::server_snapshot_exporter_impl(registry, edyn::networked_components);
+    auto client_entity = registry.create();
+    auto &client = registry.emplace<edyn::remote_client>(client_entity);
+    client.allow_full_ownership = false;
+    registry.emplace<edyn::aabb_of_interest>(client_entity);
+
+    auto entities = std::vector<entt::entity>{};
+    auto entities_of_interest = entt::sparse_set{};
+
+    for (int i = 0; i < 40; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::vector3{edyn::scalar(i) * 10, 0, 0});
+        entities.push_back(entity);
+        entities_of_interest.emplace(entity);
+    }
+
+    // The furthest body is modified once and falls asleep.
+    auto sleeper = entities.back();
+    registry.emplace<edyn::sleeping_tag>(sleeper);
+
+    for (auto entity : entities) {
+        registry.replace<edyn::position>(entity, registry.get<edyn::position>(entity));
+    }
+
+    auto priority = edyn::snapshot_priority{};
+    priority.byte_budget = 200;
+
+    auto time = 0.0;
+    auto sent = false;
+
+    for (int i = 0; i < 200 && !sent; ++i) {
+        auto snap = edyn::packet::registry_snapshot{};
+        exporter.export_modified(snap, entities_of_interest, client_entity);
+        edyn::insert_pending_snapshot_components(registry, exporter, client, entities_of_interest, snap);
+        edyn::prioritize_snapshot(registry, client_entity, client, snap, priority);
+
+        if (i == 0) {
+            ASSERT_EQ(std::find(snap.entities.begin(), snap.entities.end(), sleeper), snap.entities.end());
+        }
+
+        sent = std::find(snap.entities.begin(), snap.entities.end(), sleeper) != snap.entities.end();
+
+        // Modifications expire after the first snapshot.
+        time += 0.1;
+        exporter.update(time);
+    }
+
+    ASSERT_TRUE(sent);
+    ASSERT_EQ(client.snapshot_pending_components.count(sleeper), 0);
+}
@@ -0,0 +1,102 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/comp/remote_client.hpp"
+#include "edyn/networking/sys/server_side.hpp"
+
+static double server_time = 1;
+
+static double get_server_time() {
+    return server_time;
+}
+
+TEST(server_side_test, update_without_clients) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_time_source(registry, &get_server_time);
+    edyn::init_network_server(registry);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.networked = true;
+    edyn::make_rigidbody(registry, def);
+
+    // No AABBs of interest and no snapshots to be exported.
+    server_time = 1;
+    edyn::update(registry);
+    edyn::update_network_server(registry);
+
+    server_time = 1.01;
+    edyn::update(registry);
+    edyn::update_network_server(registry);
+
+    edyn::deinit_network_server(registry);
+    edyn::detach(registry);
+}
+
+TEST(server_side_test, update_with_client_not_due_a_snapshot) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_time_source(registry, &get_server_time);
+    edyn::init_network_server(registry);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.networked = true;
+    edyn::make_rigidbody(registry, def);
+
+    auto client_entity = edyn::server_make_client(registry);
+    auto &client = registry.get<edyn::remote_client>(client_entity);
+
+    // The first update is due a snapshot.
+    server_time = 1;
+    edyn::update(registry);
+    edyn::update_network_server(registry);
+    ASSERT_EQ(client.last_snapshot_time, 1);
+
+    // Within the snapshot period, no snapshot is exported.
+    server_time = 1 + 0.5 / client.snapshot_rate;
+    edyn::update(registry);
+    edyn::update_network_server(registry);
+    ASSERT_EQ(client.last_snapshot_time, 1);
+
+    edyn::deinit_network_server(registry);
+    edyn::detach(registry);
+}
+
+TEST(server_side_test, lag_compensation_is_opt_in) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_time_source(registry, &get_server_time);
+    edyn::init_network_server(registry);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.networked = true;
+    def.gravity = edyn::vector3_zero;
+    auto body = edyn::make_rigidbody(registry, def);
+    auto query = edyn::AABB{{-1, -1, -1}, {1, 1, 1}};
+
+    // Nothing is recorded by default.
+    server_time = 1;
+    edyn::update(registry);
+    edyn::update_network_server(registry);
+    ASSERT_TRUE(edyn::query_aabb_at(registry, edyn::get_simulation_timestamp(registry), query).empty());
+
+    auto &settings = registry.ctx().at<edyn::settings>();
+    std::get<edyn::server_network_settings>(settings.network_settings).lag_compensation_duration = 1;
+
+    server_time = 1.1;
+    edyn::update(registry);
+    edyn::update_network_server(registry);
+    auto result = edyn::query_aabb_at(registry, edyn::get_simulation_timestamp(registry), query);
+    ASSERT_EQ(result, std::vector<entt::entity>{body});
+
+    edyn::deinit_network_server(registry);
+    edyn::detach(registry);
+}
@@ -0,0 +1,91 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/util/snapshot_codec.hpp"
+
+static edyn::packet::registry_snapshot make_snapshot(entt::registry &registry,
+                                                     const std::vector<entt::entity> &entities) {
+    auto pos_index = edyn::tuple_index_of<edyn::component_index_type, edyn::position>(edyn::networked_components);
+    auto orn_index = edyn::tuple_index_of<edyn::component_index_type, edyn::orientation>(edyn::networked_components);
+    auto vel_index = edyn::tuple_index_of<edyn::component_index_type, edyn::linvel>(edyn::networked_components);
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.timestamp = 1.5;
+
+    for (auto entity : entities) {
+        edyn::internal::snapshot_insert_entity<edyn::position>(registry, entity, snap, pos_index);
+        edyn::internal::snapshot_insert_entity<edyn::orientation>(registry, entity, snap, orn_index);
+        edyn::internal::snapshot_insert_entity<edyn::linvel>(registry, entity, snap, vel_index);
+    }
+
+    return snap;
+}
+
+template<typename Component>
+static std::vector<Component> &get_components(edyn::packet::registry_snapshot &snap) {
+    auto index = edyn::tuple_index_of<edyn::component_index_type, Component>(edyn::networked_components);
+    return edyn::internal::get_pool<Component>(snap.pools, index)->components;
+}
+
+TEST(snapshot_codec_test, round_trip_with_delta) {
+    auto registry = entt::registry{};
+    auto entities = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 8; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::vector3{i * edyn::scalar(1.3), 2, -i * edyn::scalar(0.7)});
+        auto orn = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, edyn::scalar(i), 2}), i * edyn::scalar(0.4));
+        registry.emplace<edyn::orientation>(entity, orn);
+        registry.emplace<edyn::linvel>(entity, edyn::vector3{edyn::scalar(0.5), -edyn::scalar(i), 0});
+        entities.push_back(entity);
+    }
+
+    auto quantization = edyn::snapshot_quantization{};
+    auto encoder = edyn::snapshot_encoder{};
+    auto decoder = edyn::snapshot_decoder{};
+    auto origin = edyn::vector3{5, 0, 0};
+
+    auto snap = make_snapshot(registry, entities);
+    auto compact = encoder.encode(snap, origin, quantization);
+    ASSERT_EQ(compact.baseline, compact.sequence);
+
+    auto decoded = edyn::packet::registry_snapshot{};
+    ASSERT_TRUE(decoder.decode(compact, quantization, decoded));
+    ASSERT_EQ(decoded.entities, snap.entities);
+    ASSERT_EQ(decoded.timestamp, snap.timestamp);
+
+    auto &positions = get_components<edyn::position>(snap);
+    auto &decoded_positions = get_components<edyn::position>(decoded);
+    auto &orientations = get_components<edyn::orientation>(snap);
+    auto &decoded_orientations = get_components<edyn::orientation>(decoded);
+    ASSERT_EQ(decoded_positions.size(), positions.size());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT_LE(edyn::length(positions[i] - decoded_positions[i]), quantization.position_precision);
+        ASSERT_GT(std::abs(edyn::dot(orientations[i], decoded_orientations[i])), edyn::scalar(0.9999));
+    }
+
+    // Delta-encode against the acknowledged snapshot. Only one entity moves.
+    encoder.acknowledge(compact.sequence);
+    registry.get<edyn::position>(entities[3]).x += 1;
+
+    auto snap2 = make_snapshot(registry, entities);
+    auto compact2 = encoder.encode(snap2, origin, quantization);
+    ASSERT_EQ(compact2.baseline, compact.sequence);
+    ASSERT_LT(compact2.data.size(), compact.data.size());
+
+    auto decoded2 = edyn::packet::registry_snapshot{};
+    ASSERT_TRUE(decoder.decode(compact2, quantization, decoded2));
+
+    auto &positions2 = get_components<edyn::position>(snap2);
+    auto &decoded_positions2 = get_components<edyn::position>(decoded2);
+
+    for (size_t i = 0; i < positions2.size(); ++i) {
+        ASSERT_LE(edyn::length(positions2[i] - decoded_positions2[i]), quantization.position_precision);
+    }
+
+    // A decoder without the baseline must reject it.
+    auto other_decoder = edyn::snapshot_decoder{};
+    auto decoded3 = edyn::packet::registry_snapshot{};
+    ASSERT_FALSE(other_decoder.decode(compact2, quantization, decoded3));
+}
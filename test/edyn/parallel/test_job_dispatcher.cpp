@@ -2,6 +2,7 @@
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/parallel/parallel_for.hpp"
 #include "edyn/parallel/parallel_for_async.hpp"
+#include "edyn/parallel/atomic_counter_sync.hpp"
 
 #include <array>
 #include <atomic>
@@ -91,6 +92,91 @@ TEST_F(job_dispatcher_test, parallel_for_tiny) {
     }
 }
 
+TEST_F(job_dispatcher_test, parallel_for_step) {
+    constexpr size_t num_samples = 100003;
+    std::vector<int> values(num_samples);
+
+    edyn::parallel_for(dispatcher, size_t{0}, num_samples, size_t{3}, [&](size_t i) {
+        values[i] = 5;
+    });
+
+    for (size_t i = 0; i < num_samples; ++i) {
+        ASSERT_EQ(values[i], i % 3 == 0 ? 5 : 0);
+    }
+}
+
+TEST_F(job_dispatcher_test, parallel_for_each_index) {
+    constexpr size_t num_samples = 3591832;
+    std::vector<size_t> values(num_samples);
+
+    edyn::parallel_for_each(dispatcher, values.begin(), values.end(), [&](size_t &value, size_t index) {
+        value = index;
+    });
+
+    for (size_t i = 0; i < num_samples; ++i) {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+TEST_F(job_dispatcher_test, atomic_counter_sync) {
+    constexpr size_t num_jobs = 64;
+
+    for (auto k = 0; k < 256; ++k) {
+        auto counter = edyn::atomic_counter_sync(num_jobs);
+        auto j = edyn::job();
+        j.func = [](edyn::job::data_type &data) {
+            auto archive = edyn::memory_input_archive(data.data(), data.size());
+            intptr_t counter_ptr;
+            archive(counter_ptr);
+            reinterpret_cast<edyn::atomic_counter_sync *>(counter_ptr)->decrement();
+        };
+        auto archive = edyn::fixed_memory_output_archive(j.data.data(), j.data.size());
+        auto counter_ptr = reinterpret_cast<intptr_t>(&counter);
+        archive(counter_ptr);
+
+        for (size_t i = 0; i < num_jobs; ++i) {
+            dispatcher.async(j);
+        }
+
+        counter.wait();
+        ASSERT_TRUE(counter.done());
+    }
+}
+
+#if defined(__linux__)
+TEST(job_dispatcher_affinity_test, worker_cpus) {
+    struct context {
+        edyn::atomic_counter_sync counter {1};
+        std::vector<unsigned> cpus;
+    } ctx;
+
+    auto config = edyn::job_dispatcher_config{};
+    config.cpus = {0};
+
+    auto dispatcher = edyn::job_dispatcher{};
+    dispatcher.start(2, config);
+
+    auto j = edyn::job();
+    j.func = [](edyn::job::data_type &data) {
+        auto archive = edyn::memory_input_archive(data.data(), data.size());
+        intptr_t ctx_ptr;
+        archive(ctx_ptr);
+        auto *ctx = reinterpret_cast<context *>(ctx_ptr);
+        ctx->cpus = edyn::get_thread_affinity();
+        ctx->counter.decrement();
+    };
+    auto archive = edyn::fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto ctx_ptr = reinterpret_cast<intptr_t>(&ctx);
+    archive(ctx_ptr);
+
+    dispatcher.async(j);
+    ctx.counter.wait();
+    dispatcher.stop();
+
+    ASSERT_EQ(ctx.cpus, std::vector<unsigned>{0});
+}
+#endif
+
 void parallel_for_async_completion(edyn::job::data_type &data) {
     auto archive = edyn::memory_input_archive(data.data(), data.size());
     intptr_t self_ptr;
@@ -0,0 +1,157 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/serialization/mapped_paged_triangle_mesh.hpp"
+#include "edyn/shapes/create_paged_triangle_mesh.hpp"
+#include "edyn/time/time.hpp"
+#include "edyn/util/shape_util.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+class null_page_loader: public edyn::triangle_mesh_page_loader_base {
+public:
+    void load(edyn::paged_triangle_mesh *trimesh, size_t index) override {}
+};
+
+TEST(mapped_paged_triangle_mesh, write_and_load) {
+    edyn::job_dispatcher::global().start(2);
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(8, 8, 16, 16, vertices, indices);
+
+    for (auto &vertex : vertices) {
+        vertex.y = std::sin(vertex.x) * std::cos(vertex.z);
+    }
+
+    auto source = edyn::paged_triangle_mesh(std::make_shared<null_page_loader>());
+    edyn::create_paged_triangle_mesh(source, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 64, {}, {});
+    ASSERT_GT(source.num_submeshes(), 1);
+
+    auto filename = "paged_trimesh_mapped.bin";
+    ASSERT_TRUE(edyn::write_mapped_paged_triangle_mesh(filename, source));
+
+    auto loader = std::make_shared<edyn::mapped_paged_triangle_mesh_loader>(filename);
+    ASSERT_TRUE(loader->is_open());
+
+    auto paged = edyn::paged_triangle_mesh(loader);
+    ASSERT_TRUE(loader->init(paged));
+    ASSERT_EQ(paged.num_submeshes(), source.num_submeshes());
+
+    for (size_t i = 0; i < paged.num_submeshes(); ++i) {
+        loader->load(&paged, i);
+    }
+
+    auto all_loaded = [&]() {
+        for (size_t i = 0; i < paged.num_submeshes(); ++i) {
+            if (!paged.get_submesh(i)) return false;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < 200 && !all_loaded(); ++i) {
+        edyn::delay(10);
+    }
+
+    ASSERT_TRUE(all_loaded());
+
+    for (size_t i = 0; i < paged.num_submeshes(); ++i) {
+        auto expected = source.get_submesh(i);
+        auto actual = paged.get_submesh(i);
+        ASSERT_EQ(expected->num_vertices(), actual->num_vertices());
+        ASSERT_EQ(expected->num_triangles(), actual->num_triangles());
+        ASSERT_EQ(expected->num_edges(), actual->num_edges());
+
+        for (size_t j = 0; j < expected->num_vertices(); ++j) {
+            ASSERT_EQ(expected->get_vertex_position(j), actual->get_vertex_position(j));
+        }
+
+        for (size_t j = 0; j < expected->num_triangles(); ++j) {
+            for (size_t k = 0; k < 3; ++k) {
+                ASSERT_EQ(expected->get_face_vertex_index(j, k), actual->get_face_vertex_index(j, k));
+                ASSERT_EQ(expected->get_adjacent_face_normal(j, k), actual->get_adjacent_face_normal(j, k));
+            }
+        }
+
+        for (size_t j = 0; j < expected->num_edges(); ++j) {
+            ASSERT_EQ(expected->is_convex_edge(j), actual->is_convex_edge(j));
+            ASSERT_EQ(expected->is_boundary_edge(j), actual->is_boundary_edge(j));
+        }
+
+        ASSERT_SCALAR_EQ(expected->get_aabb().min.y, actual->get_aabb().min.y);
+        ASSERT_SCALAR_EQ(expected->get_aabb().max.y, actual->get_aabb().max.y);
+    }
+
+    edyn::job_dispatcher::global().stop();
+}
+
+TEST(mapped_paged_triangle_mesh, reject_invalid_file) {
+    auto filename = "paged_trimesh_invalid.bin";
+
+    {
+        auto file = std::ofstream(filename, std::ios::binary);
+        file << "not a paged triangle mesh";
+    }
+
+    auto loader = edyn::mapped_paged_triangle_mesh_loader(filename);
+    ASSERT_FALSE(loader.is_open());
+
+    auto missing = edyn::mapped_paged_triangle_mesh_loader("does_not_exist.bin");
+    ASSERT_FALSE(missing.is_open());
+}
+
+TEST(mapped_paged_triangle_mesh, reject_invalid_tree) {
+    edyn::job_dispatcher::global().start(2);
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(8, 8, 16, 16, vertices, indices);
+
+    auto source = edyn::paged_triangle_mesh(std::make_shared<null_page_loader>());
+    edyn::create_paged_triangle_mesh(source, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 64, {}, {});
+    edyn::job_dispatcher::global().stop();
+
+    auto filename = "paged_trimesh_invalid_tree.bin";
+    ASSERT_TRUE(edyn::write_mapped_paged_triangle_mesh(filename, source));
+
+    std::vector<char> data;
+
+    {
+        auto file = std::ifstream(filename, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // The tree nodes follow the magic, version, scalar size, thickness and
+    // node count, aligned to a cache line. Point the first leaf at a submesh
+    // that does not exist.
+    uint64_t num_nodes;
+    auto num_nodes_offset = sizeof(uint64_t) + 2 * sizeof(uint32_t) + sizeof(edyn::scalar);
+    std::memcpy(&num_nodes, data.data() + num_nodes_offset, sizeof(num_nodes));
+    ASSERT_GT(num_nodes, 0);
+    auto nodes_offset = size_t{64};
+    auto corrupted = false;
+
+    for (size_t i = 0; i < num_nodes && !corrupted; ++i) {
+        auto node = edyn::static_tree::tree_node{};
+        auto offset = nodes_offset + i * sizeof(node);
+        std::memcpy(&node, data.data() + offset, sizeof(node));
+
+        if (node.leaf()) {
+            node.id = static_cast<uint32_t>(source.num_submeshes());
+            std::memcpy(data.data() + offset, &node, sizeof(node));
+            corrupted = true;
+        }
+    }
+
+    ASSERT_TRUE(corrupted);
+
+    {
+        auto file = std::ofstream(filename, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+    }
+
+    auto loader = edyn::mapped_paged_triangle_mesh_loader(filename);
+    ASSERT_FALSE(loader.is_open());
+}
@@ -26,3 +26,80 @@ TEST(std_serialization_test, test_map) {
     ASSERT_EQ(map_in["one"], 1);
     ASSERT_EQ(map_in["twelve"], 12);
 }
+
+TEST(std_serialization_test, test_large_vector) {
+    auto vec = std::vector<edyn::vector3>(100000);
+
+    for (size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = edyn::vector3{edyn::scalar(i), edyn::scalar(i) * 2, edyn::scalar(i) * 3};
+    }
+
+    auto buffer = edyn::memory_output_archive::buffer_type{};
+    auto output = edyn::memory_output_archive(buffer);
+    serialize(output, vec);
+    ASSERT_EQ(buffer.size(), edyn::serialization_sizeof(vec));
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto vec_in = std::vector<edyn::vector3>{};
+    serialize(input, vec_in);
+    ASSERT_FALSE(input.failed());
+    ASSERT_TRUE(input.eof());
+    ASSERT_EQ(vec_in.size(), vec.size());
+    ASSERT_EQ(vec_in.back(), vec.back());
+
+    auto bits = std::vector<bool>(70000);
+    for (size_t i = 0; i < bits.size(); ++i) {
+        bits[i] = i % 3 == 0;
+    }
+
+    buffer.clear();
+    serialize(output, bits);
+    ASSERT_EQ(buffer.size(), edyn::serialization_sizeof(bits));
+
+    auto bits_input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto bits_in = std::vector<bool>{};
+    serialize(bits_input, bits_in);
+    ASSERT_FALSE(bits_input.failed());
+    ASSERT_EQ(bits_in, bits);
+}
+
+TEST(std_serialization_test, test_invalid_size) {
+    // Size far larger than the available data must fail without allocating.
+    auto buffer = edyn::memory_output_archive::buffer_type{};
+    auto output = edyn::memory_output_archive(buffer);
+    edyn::write_varint(output, uint64_t(1) << 40);
+    uint32_t value = 1;
+    output(value);
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto vec_in = std::vector<uint32_t>{};
+    serialize(input, vec_in);
+    ASSERT_TRUE(input.failed());
+    ASSERT_TRUE(vec_in.empty());
+}
+
+TEST(std_serialization_test, test_legacy_size_format) {
+    auto filename = "std_s11n_legacy.bin";
+
+    {
+        // Sizes used to be written as 16-bit integers.
+        auto output = edyn::file_output_archive(filename);
+        uint16_t size = 3;
+        output(size);
+        for (int32_t i = 0; i < size; ++i) {
+            output(i);
+        }
+        size = 2;
+        output(size);
+        char chars[] = {'o', 'k'};
+        output(chars[0], chars[1]);
+    }
+
+    auto input = edyn::file_input_archive(filename);
+    input.set_legacy_size_format(true);
+    auto vec_in = std::vector<int32_t>{};
+    auto str_in = std::string{};
+    input(vec_in, str_in);
+    ASSERT_EQ(vec_in, (std::vector<int32_t>{0, 1, 2}));
+    ASSERT_EQ(str_in, "ok");
+}
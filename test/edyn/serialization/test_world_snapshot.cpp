@@ -0,0 +1,296 @@
+#include "../common/common.hpp"
+#include "edyn/serialization/world_snapshot.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/simulation/stepper_sequential.hpp"
+#include <algorithm>
+#include <cstring>
+
+static void make_scene(entt::registry &registry, std::vector<entt::entity> &entities) {
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    entities.push_back(edyn::make_rigidbody(registry, floor_def));
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+
+    for (auto i = 0; i < 3; ++i) {
+        for (auto j = 0; j < 3; ++j) {
+            def.position = {i * edyn::scalar(0.5), edyn::scalar(0.2) + j * edyn::scalar(0.41), 0};
+            entities.push_back(edyn::make_rigidbody(registry, def));
+        }
+    }
+
+    // A pendulum far away from the boxes.
+    def.shape = edyn::sphere_shape{0.3};
+    def.position = {10, 2, 0};
+    auto bob = edyn::make_rigidbody(registry, def);
+    entities.push_back(bob);
+
+    def.kind = edyn::rigidbody_kind::rb_kinematic;
+    def.shape = {};
+    def.position = {10, 4, 0};
+    auto anchor = edyn::make_rigidbody(registry, def);
+    entities.push_back(anchor);
+
+    auto con_entity = edyn::make_constraint<edyn::distance_constraint>(registry, bob, anchor, [](auto &con) {
+        con.pivot[0] = edyn::vector3_zero;
+        con.pivot[1] = edyn::vector3_zero;
+        con.distance = 2;
+    });
+    entities.push_back(con_entity);
+}
+
+TEST(world_snapshot, restore_and_continue) {
+    entt::registry registry;
+    edyn::attach(registry);
+    edyn::set_paused(registry, true);
+
+    auto entities = std::vector<entt::entity>{};
+    make_scene(registry, entities);
+
+    // A resting box with its own island, which is put to sleep.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.position = {-10, 0.2, 0};
+    auto sleeper = edyn::make_rigidbody(registry, def);
+    entities.push_back(sleeper);
+
+    for (auto i = 0; i < 30; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto &manager = registry.ctx().at<edyn::stepper_sequential>().get_island_manager();
+    auto sleeper_island = registry.get<edyn::island_resident>(sleeper).island_entity;
+    manager.put_to_sleep(sleeper_island);
+
+    ASSERT_GT(registry.view<edyn::contact_manifold>().size(), 0);
+    auto num_islands = registry.view<edyn::island>().size();
+
+    auto buffer = std::vector<uint8_t>{};
+    edyn::write_world_snapshot(registry, buffer);
+
+    entt::registry restored;
+    edyn::attach(restored);
+    edyn::set_paused(restored, true);
+
+    auto emap = edyn::entity_map{};
+    ASSERT_TRUE(edyn::read_world_snapshot(restored, buffer.data(), buffer.size(), &emap));
+
+    ASSERT_EQ(restored.view<edyn::rigidbody_tag>().size(), registry.view<edyn::rigidbody_tag>().size());
+    ASSERT_EQ(restored.view<edyn::contact_manifold>().size(), registry.view<edyn::contact_manifold>().size());
+    ASSERT_EQ(restored.view<edyn::island>().size(), num_islands);
+
+    // Warm starting impulses are preserved.
+    for (auto [entity, manifold] : registry.view<edyn::contact_manifold>().each()) {
+        auto &restored_manifold = restored.get<edyn::contact_manifold>(emap.at(entity));
+        ASSERT_EQ(restored_manifold.num_points, manifold.num_points);
+        ASSERT_EQ(restored_manifold.body[0], emap.at(manifold.body[0]));
+        ASSERT_EQ(restored_manifold.body[1], emap.at(manifold.body[1]));
+
+        for (unsigned i = 0; i < manifold.num_points; ++i) {
+            ASSERT_SCALAR_EQ(restored_manifold.get_point(i).normal_impulse, manifold.get_point(i).normal_impulse);
+        }
+    }
+
+    auto restored_sleeper = emap.at(sleeper);
+    ASSERT_TRUE(restored.all_of<edyn::sleeping_tag>(restored_sleeper));
+
+    for (auto i = 0; i < 30; ++i) {
+        edyn::step_simulation(registry);
+        edyn::step_simulation(restored);
+    }
+
+    // Islands were not formed again and the sleeping island is still asleep.
+    ASSERT_EQ(restored.view<edyn::island>().size(), registry.view<edyn::island>().size());
+    ASSERT_TRUE(restored.all_of<edyn::sleeping_tag>(restored_sleeper));
+
+    for (auto entity : entities) {
+        if (!registry.all_of<edyn::position>(entity)) continue;
+
+        auto &pos = registry.get<edyn::position>(entity);
+        auto &restored_pos = restored.get<edyn::position>(emap.at(entity));
+        ASSERT_NEAR(pos.x, restored_pos.x, 0.01);
+        ASSERT_NEAR(pos.y, restored_pos.y, 0.01);
+        ASSERT_NEAR(pos.z, restored_pos.z, 0.01);
+    }
+
+    edyn::detach(restored);
+    edyn::detach(registry);
+}
+
+// Replaces the first vertex index of a mesh in a snapshot by one that is out
+// of range. The indices are found by their contents.
+static bool corrupt_mesh_indices(std::vector<uint8_t> &buffer, const std::vector<uint32_t> &indices) {
+    auto bytes = std::vector<uint8_t>(indices.size() * sizeof(uint32_t));
+    std::memcpy(bytes.data(), indices.data(), bytes.size());
+    auto it = std::search(buffer.begin(), buffer.end(), bytes.begin(), bytes.end());
+
+    if (it == buffer.end()) {
+        return false;
+    }
+
+    auto invalid_index = uint32_t{1000};
+    std::memcpy(&*it, &invalid_index, sizeof(invalid_index));
+    return true;
+}
+
+TEST(world_snapshot, reject_invalid_data) {
+    entt::registry registry;
+    edyn::attach(registry);
+
+    auto entities = std::vector<entt::entity>{};
+    make_scene(registry, entities);
+
+    auto buffer = std::vector<uint8_t>{};
+    edyn::write_world_snapshot(registry, buffer);
+
+    entt::registry restored;
+    edyn::attach(restored);
+
+    // Truncated snapshots are rejected without creating anything.
+    ASSERT_FALSE(edyn::read_world_snapshot(restored, buffer.data(), buffer.size() / 2));
+    ASSERT_TRUE(restored.view<edyn::rigidbody_tag>().empty());
+
+    auto corrupt = buffer;
+    corrupt[0] ^= 0xff;
+    ASSERT_FALSE(edyn::read_world_snapshot(restored, corrupt.data(), corrupt.size()));
+    ASSERT_TRUE(restored.view<edyn::rigidbody_tag>().empty());
+
+    // Duplicate entity indices in a pool are rejected. The indices of the
+    // position pool follow the header (magic, version and scalar size), the
+    // entities and the empty mesh and heightfield arrays, with sizes stored
+    // as a single byte.
+    size_t header_size = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint8_t);
+    auto num_entities = size_t{buffer[header_size]};
+    ASSERT_LT(num_entities, 128);
+    auto pool_offset = header_size + 1 + num_entities * sizeof(uint32_t) + 3;
+    ASSERT_GE(buffer[pool_offset], 2);
+
+    corrupt = buffer;
+    std::copy_n(corrupt.begin() + pool_offset + 1, sizeof(uint32_t),
+                corrupt.begin() + pool_offset + 1 + sizeof(uint32_t));
+    ASSERT_FALSE(edyn::read_world_snapshot(restored, corrupt.data(), corrupt.size()));
+    ASSERT_TRUE(restored.view<edyn::rigidbody_tag>().empty());
+
+    // The untouched buffer is still valid.
+    ASSERT_TRUE(edyn::read_world_snapshot(restored, buffer.data(), buffer.size()));
+
+    edyn::detach(restored);
+    edyn::detach(registry);
+
+    // Meshes with out of range vertex indices are rejected.
+    entt::registry mesh_registry;
+    edyn::attach(mesh_registry);
+
+    auto convex = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, convex->vertices, convex->indices, convex->faces);
+    convex->initialize();
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::polyhedron_shape{convex};
+    def.position = {0, 2, 0};
+    edyn::make_rigidbody(mesh_registry, def);
+
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    edyn::make_plane_mesh(4, 4, 4, 4, vertices, indices);
+    auto trimesh = std::make_shared<edyn::triangle_mesh>();
+    trimesh->insert_vertices(vertices.begin(), vertices.end());
+    trimesh->insert_indices(indices.begin(), indices.end());
+    trimesh->initialize();
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::mesh_shape{trimesh};
+    edyn::make_rigidbody(mesh_registry, floor_def);
+
+    auto mesh_buffer = std::vector<uint8_t>{};
+    edyn::write_world_snapshot(mesh_registry, mesh_buffer);
+
+    entt::registry mesh_restored;
+    edyn::attach(mesh_restored);
+
+    for (auto *mesh_indices : {&convex->indices, &indices}) {
+        corrupt = mesh_buffer;
+        ASSERT_TRUE(corrupt_mesh_indices(corrupt, *mesh_indices));
+        ASSERT_FALSE(edyn::read_world_snapshot(mesh_restored, corrupt.data(), corrupt.size()));
+        ASSERT_TRUE(mesh_restored.view<edyn::rigidbody_tag>().empty());
+    }
+
+    ASSERT_TRUE(edyn::read_world_snapshot(mesh_restored, mesh_buffer.data(), mesh_buffer.size()));
+    ASSERT_EQ(mesh_restored.view<edyn::polyhedron_shape>().size(), 1);
+    ASSERT_EQ(mesh_restored.view<edyn::mesh_shape>().size(), 1);
+
+    edyn::detach(mesh_restored);
+    edyn::detach(mesh_registry);
+}
+
+
+
+TEST(world_snapshot, heightfield) {
+    entt::registry registry;
+    edyn::attach(registry);
+    edyn::set_paused(registry, true);
+
+    constexpr size_t num_samples = 9;
+    auto heights = std::vector<edyn::scalar>(num_samples * num_samples);
+
+    for (size_t i = 0; i < heights.size(); ++i) {
+        heights[i] = edyn::scalar(i % num_samples) * edyn::scalar(0.05);
+    }
+
+    auto field = std::make_shared<edyn::heightfield>(num_samples, num_samples, edyn::vector2{1, 1},
+                                                     edyn::vector3{-4, 0, -4}, heights);
+    field->set_thickness(0.5);
+
+    // Two bodies share the same heightfield.
+    auto terrain_def = edyn::rigidbody_def{};
+    terrain_def.kind = edyn::rigidbody_kind::rb_static;
+    terrain_def.shape = edyn::heightfield_shape{field};
+    auto terrain0 = edyn::make_rigidbody(registry, terrain_def);
+    auto terrain1 = edyn::make_rigidbody(registry, terrain_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.position = {0, 1, 0};
+    auto box = edyn::make_rigidbody(registry, def);
+
+    for (auto i = 0; i < 30; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto buffer = std::vector<uint8_t>{};
+    edyn::write_world_snapshot(registry, buffer);
+
+    entt::registry restored;
+    edyn::attach(restored);
+    edyn::set_paused(restored, true);
+
+    auto emap = edyn::entity_map{};
+    ASSERT_TRUE(edyn::read_world_snapshot(restored, buffer.data(), buffer.size(), &emap));
+
+    auto &restored_field = restored.get<edyn::heightfield_shape>(emap.at(terrain0)).field;
+    ASSERT_EQ(restored_field, restored.get<edyn::heightfield_shape>(emap.at(terrain1)).field);
+    ASSERT_FALSE(restored_field->is_paged());
+    ASSERT_EQ(restored_field->num_columns(), num_samples);
+    ASSERT_EQ(restored_field->num_rows(), num_samples);
+    ASSERT_EQ(restored_field->get_heights(), heights);
+    ASSERT_SCALAR_EQ(restored_field->get_thickness(), field->get_thickness());
+    ASSERT_VECTOR3_EQ(restored_field->get_origin(), field->get_origin());
+
+    for (auto i = 0; i < 30; ++i) {
+        edyn::step_simulation(registry);
+        edyn::step_simulation(restored);
+    }
+
+    // The box keeps resting on the terrain.
+    auto &pos = registry.get<edyn::position>(box);
+    auto &restored_pos = restored.get<edyn::position>(emap.at(box));
+    ASSERT_NEAR(pos.x, restored_pos.x, 0.01);
+    ASSERT_NEAR(pos.y, restored_pos.y, 0.01);
+    ASSERT_NEAR(pos.z, restored_pos.z, 0.01);
+
+    edyn::detach(restored);
+    edyn::detach(registry);
+}
@@ -0,0 +1,274 @@
+#include "../common/common.hpp"
+#include "edyn/collision/collide.hpp"
+#include "edyn/shapes/heightfield.hpp"
+#include "edyn/util/shape_util.hpp"
+#include <algorithm>
+
+// Loads tiles immediately by copying them from a heightfield with all heights.
+class copying_tile_loader: public edyn::heightfield_tile_loader_base {
+public:
+    void load(edyn::heightfield *field, size_t tile_idx) override {
+        size_t first_column, first_row, num_columns, num_rows;
+        field->get_tile_samples(tile_idx, first_column, first_row, num_columns, num_rows);
+        std::vector<edyn::scalar> heights;
+
+        for (size_t row = 0; row < num_rows; ++row) {
+            for (size_t column = 0; column < num_columns; ++column) {
+                heights.push_back(source->get_height(first_column + column, first_row + row));
+            }
+        }
+
+        field->assign_tile(tile_idx, std::move(heights));
+        ++num_loads;
+    }
+
+    std::shared_ptr<edyn::heightfield> source;
+    size_t num_loads {0};
+};
+
+static constexpr size_t num_columns = 19;
+static constexpr size_t num_rows = 14;
+static constexpr auto spacing = edyn::vector2{0.5, 0.75};
+static constexpr auto origin = edyn::vector3{-4, 1, -5};
+
+static std::vector<edyn::scalar> make_heights() {
+    std::vector<edyn::scalar> heights;
+
+    for (size_t row = 0; row < num_rows; ++row) {
+        for (size_t column = 0; column < num_columns; ++column) {
+            heights.push_back(std::sin(column * edyn::scalar(0.7)) * std::cos(row * edyn::scalar(0.5)));
+        }
+    }
+
+    return heights;
+}
+
+static std::shared_ptr<edyn::heightfield> make_heightfield(bool build_pyramid = true) {
+    return std::make_shared<edyn::heightfield>(num_columns, num_rows, spacing, origin,
+                                               make_heights(), build_pyramid);
+}
+
+// Triangle mesh with the same vertices and triangles as the heightfield.
+static std::shared_ptr<edyn::triangle_mesh> make_equivalent_mesh(const edyn::heightfield &field) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+
+    for (size_t i = 0; i < field.num_vertices(); ++i) {
+        vertices.push_back(field.get_vertex_position(i));
+    }
+
+    for (size_t i = 0; i < field.num_triangles(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            indices.push_back(field.get_face_vertex_index(i, j));
+        }
+    }
+
+    auto trimesh = std::make_shared<edyn::triangle_mesh>();
+    trimesh->insert_vertices(vertices.begin(), vertices.end());
+    trimesh->insert_indices(indices.begin(), indices.end());
+    trimesh->initialize();
+    return trimesh;
+}
+
+static std::vector<size_t> visited_triangles(const edyn::heightfield &field, const edyn::AABB &aabb) {
+    std::vector<size_t> result;
+    field.visit_triangles(aabb, [&](auto tri_idx) { result.push_back(tri_idx); });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(test_heightfield, matches_triangle_mesh) {
+    auto field = make_heightfield();
+    auto trimesh = make_equivalent_mesh(*field);
+
+    ASSERT_EQ(field->num_triangles(), trimesh->num_triangles());
+    ASSERT_VECTOR3_EQ(field->get_aabb().min, trimesh->get_aabb().min);
+    ASSERT_VECTOR3_EQ(field->get_aabb().max, trimesh->get_aabb().max);
+
+    for (size_t i = 0; i < field->num_triangles(); ++i) {
+        auto normal = field->get_triangle_normal(i);
+        ASSERT_GT(normal.y, 0);
+        ASSERT_VECTOR3_EQ(normal, trimesh->get_triangle_normal(i));
+
+        for (size_t j = 0; j < 3; ++j) {
+            ASSERT_VECTOR3_EQ(field->get_adjacent_face_normal(i, j), trimesh->get_adjacent_face_normal(i, j));
+            ASSERT_EQ(field->is_convex_edge(field->get_face_edge_index(i, j)),
+                      trimesh->is_convex_edge(trimesh->get_face_edge_index(i, j)));
+        }
+    }
+}
+
+TEST(test_heightfield, visit_triangles) {
+    auto field = make_heightfield();
+    auto flat_field = make_heightfield(false);
+    auto trimesh = make_equivalent_mesh(*field);
+
+    auto queries = std::vector<edyn::AABB>{
+        {{-3.9, -1, -4.9}, {-3.2, 3, -4.1}},
+        {{-1.3, 1.2, -2.1}, {0.4, 1.5, 1.3}},
+        {{-10, 0.5, -10}, {10, 0.6, 10}},
+        {{-10, -10, -10}, {10, 10, 10}},
+        {{0.1, 5, 0.1}, {2.2, 6, 1.3}},
+        {{20, -10, 0}, {30, 10, 1}}
+    };
+
+    for (auto &aabb : queries) {
+        std::vector<size_t> expected;
+
+        for (size_t i = 0; i < trimesh->num_triangles(); ++i) {
+            auto tri_aabb = edyn::get_triangle_aabb(trimesh->get_triangle_vertices(i));
+
+            if (edyn::intersect(tri_aabb, aabb)) {
+                expected.push_back(i);
+            }
+        }
+
+        ASSERT_EQ(visited_triangles(*field, aabb), expected);
+        ASSERT_EQ(visited_triangles(*flat_field, aabb), expected);
+    }
+}
+
+TEST(test_heightfield, raycast) {
+    auto field = make_heightfield();
+    auto trimesh = make_equivalent_mesh(*field);
+    auto field_shape = edyn::heightfield_shape{field};
+    auto mesh_shape = edyn::mesh_shape{trimesh};
+
+    auto rays = std::vector<std::array<edyn::vector3, 2>>{
+        {{{-1.1, 5, -2.3}, {-1.1, -5, -2.3}}},
+        {{{-6, 3, -7}, {6, -1, 6}}},
+        {{{5, 1.5, 4}, {-5, 1.2, -6}}},
+        {{{2.3, -3, 0.4}, {2.1, 5, 0.2}}},
+        {{{-3, 4, 0}, {-2, 4.5, 1}}}
+    };
+
+    for (auto &ray : rays) {
+        auto ctx = edyn::raycast_context{edyn::vector3_zero, edyn::quaternion_identity, ray[0], ray[1]};
+        auto result = edyn::shape_raycast(field_shape, ctx);
+        auto expected = edyn::shape_raycast(mesh_shape, ctx);
+
+        ASSERT_EQ(result.fraction == EDYN_SCALAR_MAX, expected.fraction == EDYN_SCALAR_MAX);
+
+        if (expected.fraction != EDYN_SCALAR_MAX) {
+            ASSERT_SCALAR_EQ(result.fraction, expected.fraction);
+            ASSERT_VECTOR3_EQ(result.normal, expected.normal);
+        }
+    }
+}
+
+TEST(test_heightfield, collide_sphere) {
+    auto field = make_heightfield();
+    auto trimesh = make_equivalent_mesh(*field);
+    auto sphere = edyn::sphere_shape{0.4};
+
+    for (auto pos : {edyn::vector3{-1.1, 1.3, -2.3}, edyn::vector3{0.6, 1.2, 1.1}, edyn::vector3{3.2, 0.4, 2.7}}) {
+        auto ctx = edyn::collision_context{};
+        ctx.posA = pos;
+        ctx.ornA = edyn::quaternion_identity;
+        ctx.aabbA = edyn::shape_aabb(sphere, pos, ctx.ornA);
+        ctx.posB = edyn::vector3_zero;
+        ctx.ornB = edyn::quaternion_identity;
+        ctx.threshold = edyn::collision_threshold;
+
+        auto result = edyn::collision_result{};
+        edyn::collide(sphere, edyn::heightfield_shape{field}, ctx, result);
+        auto expected = edyn::collision_result{};
+        edyn::collide(sphere, *trimesh, ctx, expected);
+
+        // Points may differ since they're merged in a different order, but
+        // the deepest penetration must be the same.
+        ASSERT_GT(expected.num_points, 0);
+        ASSERT_GT(result.num_points, 0);
+
+        auto min_distance = [](const edyn::collision_result &res) {
+            auto distance = EDYN_SCALAR_MAX;
+
+            for (size_t i = 0; i < res.num_points; ++i) {
+                distance = std::min(distance, res.point[i].distance);
+            }
+
+            return distance;
+        };
+
+        ASSERT_SCALAR_EQ(min_distance(result), min_distance(expected));
+    }
+}
+
+TEST(test_heightfield, paging) {
+    auto source = make_heightfield();
+    auto loader = std::make_shared<copying_tile_loader>();
+    loader->source = source;
+
+    auto bounds = edyn::heightfield::height_range{-1, 1};
+    auto field = edyn::heightfield(num_columns, num_rows, spacing, origin, bounds, 4, loader);
+
+    // 18x13 cells in tiles of 4x4 cells.
+    ASSERT_EQ(field.num_tiles(), 5 * 4);
+    ASSERT_VECTOR3_EQ(field.get_aabb().min, origin + edyn::vector3{0, -1, 0});
+
+    auto aabb = edyn::AABB{{-2.1, -1, -3.3}, {-0.2, 3, -1.1}};
+    ASSERT_TRUE(visited_triangles(field, aabb).empty());
+
+    field.prefetch(aabb);
+    auto num_loads = loader->num_loads;
+    ASSERT_GT(num_loads, 0);
+    ASSERT_LT(num_loads, field.num_tiles());
+    ASSERT_EQ(visited_triangles(field, aabb), visited_triangles(*source, aabb));
+
+    // Tiles are not loaded again.
+    field.prefetch(aabb);
+    ASSERT_EQ(loader->num_loads, num_loads);
+
+    // Triangles match in loaded tiles, including the last partial ones.
+    field.prefetch(source->get_aabb());
+    ASSERT_EQ(loader->num_loads, field.num_tiles());
+
+    for (size_t i = 0; i < field.num_triangles(); ++i) {
+        ASSERT_VECTOR3_EQ(field.get_triangle_normal(i), source->get_triangle_normal(i));
+
+        for (size_t j = 0; j < 3; ++j) {
+            ASSERT_VECTOR3_EQ(field.get_adjacent_face_normal(i, j), source->get_adjacent_face_normal(i, j));
+            ASSERT_EQ(field.get_face_edge_index(i, j), source->get_face_edge_index(i, j));
+        }
+    }
+
+    // Raycasts cross tile boundaries.
+    auto p0 = edyn::vector3{-6, 3, -7}, p1 = edyn::vector3{6, -1, 6};
+    std::vector<size_t> crossed, expected_crossed;
+    field.raycast(p0, p1, [&](auto tri_idx) { crossed.push_back(tri_idx); });
+    source->raycast(p0, p1, [&](auto tri_idx) { expected_crossed.push_back(tri_idx); });
+    ASSERT_FALSE(crossed.empty());
+    ASSERT_EQ(crossed, expected_crossed);
+
+    for (size_t i = 0; i < field.num_tiles(); ++i) {
+        field.unload_tile(i);
+        ASSERT_FALSE(field.is_tile_loaded(i));
+    }
+
+    ASSERT_TRUE(visited_triangles(field, aabb).empty());
+}
+
+TEST(test_heightfield, paged_border_vertices) {
+    auto source = make_heightfield();
+    auto loader = std::make_shared<copying_tile_loader>();
+    loader->source = source;
+
+    auto bounds = edyn::heightfield::height_range{-1, 1};
+    constexpr size_t tile_size = 4;
+    auto field = edyn::heightfield(num_columns, num_rows, spacing, origin, bounds, tile_size, loader);
+
+    // Only the first tile is loaded. Its last column and row are the first
+    // of the neighboring tiles, which are not loaded.
+    loader->load(&field, 0);
+    ASSERT_TRUE(field.is_tile_loaded(0));
+    ASSERT_FALSE(field.is_tile_loaded(1));
+    // Tile below the first, in a grid of 5x4 tiles.
+    ASSERT_FALSE(field.is_tile_loaded(5));
+
+    for (size_t row = 0; row <= tile_size; ++row) {
+        for (size_t column = 0; column <= tile_size; ++column) {
+            auto vertex_idx = row * num_columns + column;
+            ASSERT_VECTOR3_EQ(field.get_vertex_position(vertex_idx), source->get_vertex_position(vertex_idx));
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include "../common/common.hpp"
+#include "edyn/shapes/mesh_asset_cache.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/util/shape_util.hpp"
+
+static std::shared_ptr<edyn::convex_mesh> make_box(edyn::vector3 half_extents, edyn::mesh_asset_cache &cache,
+                                                   bool replicate_by_hash = false) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices, faces;
+    edyn::make_box_mesh(half_extents, vertices, indices, faces);
+    return cache.make_convex_mesh(vertices, indices, faces, replicate_by_hash);
+}
+
+TEST(mesh_asset_cache, intern_identical_meshes) {
+    auto cache = edyn::mesh_asset_cache{};
+
+    auto mesh0 = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, mesh0->vertices, mesh0->indices, mesh0->faces);
+    mesh0->initialize();
+
+    auto mesh1 = std::make_shared<edyn::convex_mesh>(*mesh0);
+
+    ASSERT_EQ(edyn::content_hash(*mesh0), edyn::content_hash(*mesh1));
+    ASSERT_EQ(cache.intern(mesh0), mesh0);
+    ASSERT_EQ(cache.intern(mesh1), mesh0);
+    ASSERT_EQ(cache.num_convex_meshes(), 1);
+
+    // Meshes created from the same data are created only once.
+    auto box0 = make_box({1, 2, 3}, cache);
+    auto box1 = make_box({1, 2, 3}, cache);
+    auto box2 = make_box({1, 2, 4}, cache);
+    ASSERT_EQ(box0, box1);
+    ASSERT_NE(box0, box2);
+    ASSERT_EQ(cache.num_convex_meshes(), 3);
+
+    edyn::mesh_asset_cache::hash_type hash;
+    ASSERT_TRUE(cache.get_hash(box0.get(), hash));
+    ASSERT_EQ(cache.find_convex_mesh(hash), box0);
+    ASSERT_FALSE(cache.get_replicated_hash(box0.get(), hash));
+
+    // Entries of freed meshes are removed.
+    box2.reset();
+    ASSERT_EQ(cache.purge_expired(), 1);
+    ASSERT_EQ(cache.num_convex_meshes(), 2);
+}
+
+TEST(mesh_asset_cache, cached_inertia) {
+    auto cache = edyn::mesh_asset_cache{};
+    auto mesh = make_box({0.5, 1, 1.5}, cache);
+
+    edyn::matrix3x3 unit_inertia;
+    ASSERT_TRUE(cache.get_unit_inertia(mesh.get(), unit_inertia));
+
+    auto expected = edyn::moment_of_inertia_polyhedron(3, mesh->vertices, mesh->indices, mesh->faces);
+    auto inertia = unit_inertia * edyn::scalar(3);
+
+    for (auto i = 0; i < 3; ++i) {
+        for (auto j = 0; j < 3; ++j) {
+            ASSERT_NEAR(inertia[i][j], expected[i][j], 0.0001);
+        }
+    }
+}
+
+TEST(mesh_asset_cache, intern_triangle_meshes) {
+    auto cache = edyn::mesh_asset_cache{};
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices;
+    edyn::make_plane_mesh(10, 10, 4, 4, vertices, indices);
+
+    auto mesh0 = cache.make_triangle_mesh(vertices, indices);
+    auto mesh1 = cache.make_triangle_mesh(vertices, indices);
+    ASSERT_EQ(mesh0, mesh1);
+    ASSERT_EQ(cache.find_triangle_mesh(edyn::content_hash(*mesh0)), mesh0);
+
+    vertices[0].y += 1;
+    auto mesh2 = cache.make_triangle_mesh(vertices, indices);
+    ASSERT_NE(mesh0, mesh2);
+    ASSERT_EQ(cache.num_triangle_meshes(), 2);
+
+    // Interned meshes are immutable. Copies can be deformed.
+    ASSERT_TRUE(mesh0->is_interned());
+    auto copy = std::make_shared<edyn::triangle_mesh>(*mesh0);
+    ASSERT_FALSE(copy->is_interned());
+    ASSERT_EQ(cache.intern(copy), mesh0);
+
+    // Meshes with the same vertices but different properties are distinct.
+    copy->set_thickness(2);
+    ASSERT_EQ(cache.intern(copy), copy);
+    ASSERT_TRUE(copy->is_interned());
+    ASSERT_EQ(cache.num_triangle_meshes(), 3);
+}
+
+TEST(mesh_asset_cache, purge_automatically) {
+    auto cache = edyn::mesh_asset_cache{};
+
+    // Entries of freed meshes do not accumulate.
+    for (int i = 0; i < 1000; ++i) {
+        make_box({1, 1, edyn::scalar(i + 1)}, cache);
+    }
+
+    ASSERT_LT(cache.num_convex_meshes(), 200);
+
+    cache.purge_expired();
+    ASSERT_EQ(cache.num_convex_meshes(), 0);
+}
+
+TEST(mesh_asset_cache, serialize_by_hash) {
+    auto &cache = edyn::mesh_asset_cache::global();
+    auto replicated = make_box({0.25, 0.5, 0.75}, cache, true);
+    auto local = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.75, 0.5, 0.25}, local->vertices, local->indices, local->faces);
+    local->initialize();
+
+    auto replicated_shape = edyn::polyhedron_shape(replicated);
+    auto local_shape = edyn::polyhedron_shape(local);
+
+    auto buffer = edyn::memory_output_archive::buffer_type{};
+    auto output = edyn::memory_output_archive(buffer);
+    output(replicated_shape);
+    auto replicated_size = buffer.size();
+    output(local_shape);
+
+    // Only the hash is written for replicated meshes.
+    ASSERT_LT(replicated_size, sizeof(edyn::mesh_asset_cache::hash_type) + 2);
+    ASSERT_GT(buffer.size() - replicated_size, local->vertices.size() * sizeof(edyn::vector3));
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto replicated_result = edyn::polyhedron_shape{};
+    auto local_result = edyn::polyhedron_shape{};
+    input(replicated_result);
+    input(local_result);
+    ASSERT_FALSE(input.failed());
+
+    ASSERT_EQ(replicated_result.mesh, replicated);
+    ASSERT_NE(local_result.mesh, local);
+    ASSERT_EQ(local_result.mesh->vertices, local->vertices);
+
+    // Received meshes are interned.
+    auto local_copy = edyn::polyhedron_shape{};
+    auto input2 = edyn::memory_input_archive(buffer.data() + replicated_size, buffer.size() - replicated_size);
+    input2(local_copy);
+    ASSERT_EQ(local_copy.mesh, local_result.mesh);
+
+    // Meshes replicated by hash must have been interned by the receiver.
+    cache.clear();
+    auto unknown = edyn::polyhedron_shape{};
+    auto input3 = edyn::memory_input_archive(buffer.data(), replicated_size);
+    input3(unknown);
+    ASSERT_TRUE(input3.failed());
+    ASSERT_FALSE(unknown.mesh);
+}
@@ -1,12 +1,34 @@
 #include "../common/common.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/shapes/create_paged_triangle_mesh.hpp"
+#include "edyn/util/shape_util.hpp"
 
 class triangle_mesh_page_loader: public edyn::triangle_mesh_page_loader_base {
 public:
     void load(edyn::paged_triangle_mesh *trimesh, size_t index) override {}
 };
 
+// Loads submeshes immediately by copying them from a source.
+class copying_page_loader: public edyn::triangle_mesh_page_loader_base {
+public:
+    void load(edyn::paged_triangle_mesh *trimesh, size_t index) override {
+        trimesh->assign_mesh(index, std::make_shared<edyn::triangle_mesh>(*submeshes[index]));
+    }
+
+    std::vector<std::shared_ptr<edyn::triangle_mesh>> submeshes;
+};
+
+// Fails to load any submesh.
+class failing_page_loader: public edyn::triangle_mesh_page_loader_base {
+public:
+    void load(edyn::paged_triangle_mesh *trimesh, size_t index) override {
+        trimesh->cancel_loading(index);
+        ++num_loads;
+    }
+
+    size_t num_loads {0};
+};
+
 TEST(test_paged_trimesh, voronoi_regions) {
     edyn::job_dispatcher::global().start(1);
 
@@ -47,3 +69,78 @@ TEST(test_paged_trimesh, voronoi_regions) {
 
     edyn::job_dispatcher::global().stop();
 }
+
+TEST(test_paged_trimesh, cache_budget_and_prefetch) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(8, 8, 16, 16, vertices, indices);
+
+    auto loader = std::make_shared<copying_page_loader>();
+    auto trimesh = edyn::paged_triangle_mesh(loader);
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(), indices.begin(), indices.end(), 32, {}, {});
+    ASSERT_GT(trimesh.num_submeshes(), 4);
+
+    for (size_t i = 0; i < trimesh.num_submeshes(); ++i) {
+        loader->submeshes.push_back(trimesh.get_submesh(i));
+    }
+
+    auto total_size = trimesh.get_cache_stats().cache_size;
+    ASSERT_GT(total_size, 0);
+
+    trimesh.clear_cache();
+    trimesh.reset_cache_stats();
+    ASSERT_EQ(trimesh.get_cache_stats().cache_size, 0);
+
+    // Visiting everything with half the budget must unload submeshes.
+    trimesh.m_max_cache_size = total_size / 2;
+    size_t num_visited = 0;
+    trimesh.visit_submeshes(trimesh.get_aabb(), [&](size_t) { ++num_visited; });
+
+    auto stats = trimesh.get_cache_stats();
+    ASSERT_EQ(num_visited, trimesh.num_submeshes());
+    ASSERT_EQ(stats.misses, trimesh.num_submeshes());
+    ASSERT_EQ(stats.loads, trimesh.num_submeshes());
+    ASSERT_EQ(stats.loads_in_flight, 0);
+    ASSERT_GT(stats.evictions, 0);
+    ASSERT_LE(stats.cache_size, trimesh.m_max_cache_size);
+
+    // Prefetched submeshes are hits when visited later.
+    trimesh.m_max_cache_size = total_size * 2;
+    trimesh.clear_cache();
+    trimesh.reset_cache_stats();
+
+    auto corner = edyn::AABB{{-4, -1, -4}, {-3, 1, -3}};
+    trimesh.prefetch(corner);
+    stats = trimesh.get_cache_stats();
+    ASSERT_GT(stats.prefetches, 0);
+    ASSERT_EQ(stats.prefetches, stats.loads);
+    ASSERT_EQ(stats.hits + stats.misses, 0);
+
+    trimesh.visit_submeshes(corner, [](size_t) {});
+    stats = trimesh.get_cache_stats();
+    ASSERT_GT(stats.hits, 0);
+    ASSERT_EQ(stats.misses, 0);
+    ASSERT_DOUBLE_EQ(stats.hit_rate(), 1.0);
+}
+
+TEST(test_paged_trimesh, failed_load) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(8, 8, 16, 16, vertices, indices);
+
+    auto loader = std::make_shared<failing_page_loader>();
+    auto trimesh = edyn::paged_triangle_mesh(loader);
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(), indices.begin(), indices.end(), 32, {}, {});
+    trimesh.clear_cache();
+    trimesh.reset_cache_stats();
+
+    // Reserved space is released and submeshes can be requested again.
+    trimesh.prefetch(trimesh.get_aabb());
+    auto stats = trimesh.get_cache_stats();
+    ASSERT_EQ(stats.loads, trimesh.num_submeshes());
+    ASSERT_EQ(stats.loads_in_flight, 0);
+    ASSERT_EQ(stats.cache_size, 0);
+
+    trimesh.prefetch(trimesh.get_aabb());
+    ASSERT_EQ(loader->num_loads, 2 * trimesh.num_submeshes());
+}
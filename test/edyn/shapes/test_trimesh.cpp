@@ -1,4 +1,8 @@
 #include "../common/common.hpp"
+#include "edyn/util/shape_util.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
 
 TEST(test_trimesh, voronoi_regions) {
     auto vertices = std::vector<edyn::vector3>{};
@@ -39,3 +43,193 @@ TEST(test_trimesh, voronoi_regions) {
     ASSERT_VECTOR3_EQ(trimesh.get_aabb().min, {-1, 0, -1});
     ASSERT_VECTOR3_EQ(trimesh.get_aabb().max, {2, 1, 1});
 }
+
+static edyn::triangle_mesh make_terrain(edyn::scalar amplitude) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(16, 16, 17, 17, vertices, indices);
+
+    for (auto &vertex : vertices) {
+        vertex.y = amplitude * std::sin(vertex.x) * std::cos(vertex.z);
+    }
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+    return trimesh;
+}
+
+TEST(test_trimesh, edge_adjacency) {
+    auto trimesh = make_terrain(1);
+
+    for (size_t tri_idx = 0; tri_idx < trimesh.num_triangles(); ++tri_idx) {
+        for (size_t i = 0; i < 3; ++i) {
+            auto edge_idx = trimesh.get_face_edge_index(tri_idx, i);
+            auto edge_vertices = trimesh.get_edge_vertex_indices(edge_idx);
+            auto v0 = trimesh.get_face_vertex_index(tri_idx, i);
+            auto v1 = trimesh.get_face_vertex_index(tri_idx, (i + 1) % 3);
+            ASSERT_TRUE((edge_vertices[0] == v0 && edge_vertices[1] == v1) ||
+                        (edge_vertices[0] == v1 && edge_vertices[1] == v0));
+
+            auto face_indices = trimesh.get_edge_face_indices(edge_idx);
+            ASSERT_TRUE(face_indices[0] == tri_idx || face_indices[1] == tri_idx);
+            ASSERT_EQ(trimesh.is_boundary_edge(edge_idx), face_indices[0] == face_indices[1]);
+        }
+    }
+
+    // A grid of 16x16 quads has 16*17 edges in each direction plus one
+    // diagonal per quad.
+    ASSERT_EQ(trimesh.num_edges(), 2 * 16 * 17 + 16 * 16);
+}
+
+TEST(test_trimesh, update_vertices) {
+    auto trimesh = make_terrain(1);
+    auto expected = make_terrain(1);
+
+    // Dig a crater in both meshes. Update one locally and the other from
+    // scratch.
+    auto center = edyn::vector3{1, 0, 1};
+    std::vector<edyn::triangle_mesh::index_type> moved;
+    std::vector<edyn::vector3> vertices;
+
+    for (size_t i = 0; i < trimesh.num_vertices(); ++i) {
+        auto position = trimesh.get_vertex_position(i);
+
+        if (edyn::distance_sqr(position, center) < 4) {
+            position.y -= 1;
+            trimesh.set_vertex_position(i, position);
+            moved.push_back(i);
+        }
+
+        vertices.push_back(position);
+    }
+
+    ASSERT_FALSE(moved.empty());
+    trimesh.update_vertices(moved.begin(), moved.end());
+
+    std::vector<edyn::triangle_mesh::index_type> indices;
+
+    for (size_t i = 0; i < expected.num_triangles(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            indices.push_back(expected.get_face_vertex_index(i, j));
+        }
+    }
+
+    expected = edyn::triangle_mesh{};
+    expected.insert_vertices(vertices.begin(), vertices.end());
+    expected.insert_indices(indices.begin(), indices.end());
+    expected.initialize();
+
+    for (size_t i = 0; i < trimesh.num_triangles(); ++i) {
+        ASSERT_VECTOR3_EQ(trimesh.get_triangle_normal(i), expected.get_triangle_normal(i));
+
+        for (size_t j = 0; j < 3; ++j) {
+            ASSERT_VECTOR3_EQ(trimesh.get_adjacent_face_normal(i, j), expected.get_adjacent_face_normal(i, j));
+        }
+    }
+
+    for (size_t i = 0; i < trimesh.num_edges(); ++i) {
+        ASSERT_EQ(trimesh.is_convex_edge(i), expected.is_convex_edge(i));
+    }
+
+    ASSERT_VECTOR3_EQ(trimesh.get_aabb().min, expected.get_aabb().min);
+    ASSERT_VECTOR3_EQ(trimesh.get_aabb().max, expected.get_aabb().max);
+
+    // Every triangle in the crater must be found by a query.
+    auto crater = edyn::AABB{center - edyn::vector3{1, 2, 1}, center + edyn::vector3{1, 0, 1}};
+    std::vector<size_t> found, expected_found;
+    trimesh.visit_triangles(crater, [&](auto tri_idx) { found.push_back(tri_idx); });
+    expected.visit_triangles(crater, [&](auto tri_idx) { expected_found.push_back(tri_idx); });
+    std::sort(found.begin(), found.end());
+    std::sort(expected_found.begin(), expected_found.end());
+    ASSERT_FALSE(found.empty());
+    ASSERT_EQ(found, expected_found);
+}
+
+TEST(test_trimesh, update_rigidbody_aabb) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto trimesh = std::make_shared<edyn::triangle_mesh>(make_terrain(1));
+    auto def = edyn::rigidbody_def{};
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.shape = edyn::mesh_shape{trimesh};
+    auto entity = edyn::make_rigidbody(registry, def);
+
+    auto &bphase = registry.ctx().at<edyn::broadphase>();
+    bphase.init_new_aabb_entities();
+
+    // Dig a deep crater below the current AABB.
+    auto center = edyn::vector3{1, 0, 1};
+    std::vector<edyn::triangle_mesh::index_type> moved;
+
+    for (size_t i = 0; i < trimesh->num_vertices(); ++i) {
+        auto position = trimesh->get_vertex_position(i);
+
+        if (edyn::distance_sqr(position, center) < 4) {
+            position.y -= 4;
+            trimesh->set_vertex_position(i, position);
+            moved.push_back(i);
+        }
+    }
+
+    trimesh->update_vertices(moved.begin(), moved.end());
+
+    auto bottom = edyn::AABB{center - edyn::vector3{0.5, 4.5, 0.5}, center + edyn::vector3{0.5, -3.5, 0.5}};
+    auto found = false;
+    bphase.query_non_procedural(bottom, [&](entt::entity e) { found |= e == entity; });
+    ASSERT_FALSE(found);
+
+    edyn::rigidbody_update_aabb(registry, entity);
+    auto &aabb = registry.get<edyn::AABB>(entity);
+    ASSERT_VECTOR3_EQ(aabb.min, trimesh->get_aabb().min);
+    ASSERT_VECTOR3_EQ(aabb.max, trimesh->get_aabb().max);
+
+    bphase.query_non_procedural(bottom, [&](entt::entity e) { found |= e == entity; });
+    ASSERT_TRUE(found);
+
+    edyn::detach(registry);
+}
+
+TEST(test_trimesh, validate_deserialized_mesh) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<edyn::triangle_mesh::index_type>{};
+    edyn::make_plane_mesh(4, 4, 4, 4, vertices, indices);
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+    ASSERT_TRUE(trimesh.is_valid());
+
+    auto buffer = std::vector<uint8_t>{};
+    auto output = edyn::memory_output_archive(buffer);
+    output(trimesh);
+
+    // Vertices come first, thus replacing them by a shorter array results in
+    // faces referring to vertices that do not exist.
+    auto vertex_buffer = std::vector<uint8_t>{};
+    auto vertex_output = edyn::memory_output_archive(vertex_buffer);
+    vertex_output(vertices);
+
+    auto corrupt_buffer = std::vector<uint8_t>{};
+    auto corrupt_output = edyn::memory_output_archive(corrupt_buffer);
+    auto fewer_vertices = std::vector<edyn::vector3>(vertices.begin(), vertices.end() - 1);
+    corrupt_output(fewer_vertices);
+    corrupt_buffer.insert(corrupt_buffer.end(), buffer.begin() + vertex_buffer.size(), buffer.end());
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto loaded = edyn::triangle_mesh{};
+    input(loaded);
+    ASSERT_FALSE(input.failed());
+    ASSERT_TRUE(loaded.is_valid());
+
+    auto corrupt_input = edyn::memory_input_archive(corrupt_buffer.data(), corrupt_buffer.size());
+    auto corrupt = edyn::triangle_mesh{};
+    corrupt_input(corrupt);
+    ASSERT_FALSE(corrupt_input.failed());
+    ASSERT_FALSE(corrupt.is_valid());
+}
@@ -0,0 +1,139 @@
+#include "../common/common.hpp"
+#include "edyn/comp/simulation_partition.hpp"
+
+#include <array>
+#include <chrono>
+#include <thread>
+
+static constexpr auto region_size = edyn::scalar(10);
+
+static void attach_multiple_workers(entt::registry &registry) {
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::asynchronous;
+    config.num_simulation_workers = 2;
+    config.partition_region_size = region_size;
+    config.partition_margin = edyn::scalar(1);
+    edyn::attach(registry, config);
+}
+
+static entt::entity make_box(entt::registry &registry, edyn::vector3 pos, edyn::vector3 vel) {
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+    def.position = pos;
+    def.linvel = vel;
+    def.gravity = edyn::vector3_zero;
+    return edyn::make_rigidbody(registry, def);
+}
+
+static unsigned worker_of(entt::registry &registry, entt::entity entity) {
+    return registry.get<edyn::simulation_partition>(entity).worker_index;
+}
+
+// Updates the registry until the predicate holds or time runs out.
+template<typename Predicate>
+static bool update_until(entt::registry &registry, Predicate predicate, double timeout = 5) {
+    auto start = edyn::performance_time();
+
+    while (edyn::performance_time() - start < timeout) {
+        edyn::update(registry);
+
+        if (predicate()) {
+            return true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    return false;
+}
+
+TEST(test_stepper_async, partition_assignment) {
+    entt::registry registry;
+    attach_multiple_workers(registry);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, -10};
+    auto floor = edyn::make_rigidbody(registry, floor_def);
+
+    auto bodies = std::array<entt::entity, 4>{
+        make_box(registry, {5, 0, 0}, {0, 1, 0}),
+        make_box(registry, {15, 0, 0}, {0, 1, 0}),
+        make_box(registry, {25, 0, 0}, {0, 1, 0}),
+        make_box(registry, {-5, 0, 0}, {0, 1, 0})
+    };
+
+    // Slabs along the x axis are assigned round-robin. Non-procedural entities
+    // are present in all workers.
+    ASSERT_FALSE(registry.all_of<edyn::simulation_partition>(floor));
+    ASSERT_EQ(worker_of(registry, bodies[0]), 0);
+    ASSERT_EQ(worker_of(registry, bodies[1]), 1);
+    ASSERT_EQ(worker_of(registry, bodies[2]), 0);
+    ASSERT_EQ(worker_of(registry, bodies[3]), 1);
+
+    // All workers advance and report the state of their bodies.
+    auto moved = update_until(registry, [&] {
+        for (auto entity : bodies) {
+            if (registry.get<edyn::position>(entity).y < edyn::scalar(0.1)) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    ASSERT_TRUE(moved);
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        ASSERT_EQ(worker_of(registry, bodies[i]), i % 2);
+    }
+
+    edyn::detach(registry);
+}
+
+TEST(test_stepper_async, migration_across_regions) {
+    entt::registry registry;
+    attach_multiple_workers(registry);
+
+    auto entity = make_box(registry, {5, 0, 0}, {10, 0, 0});
+    ASSERT_EQ(worker_of(registry, entity), 0);
+
+    // Once its island lies entirely in the next slab, the body is moved into
+    // the worker responsible for it and keeps being simulated there.
+    auto migrated = update_until(registry, [&] { return worker_of(registry, entity) == 1; });
+    ASSERT_TRUE(migrated);
+    ASSERT_GT(registry.get<edyn::position>(entity).x, region_size);
+
+    auto x = registry.get<edyn::position>(entity).x;
+    auto advanced = update_until(registry, [&] { return registry.get<edyn::position>(entity).x > x + 1; });
+    ASSERT_TRUE(advanced);
+    ASSERT_EQ(worker_of(registry, entity), 1);
+
+    edyn::detach(registry);
+}
+
+TEST(test_stepper_async, merge_across_workers) {
+    entt::registry registry;
+    attach_multiple_workers(registry);
+
+    auto entity0 = make_box(registry, {8, 0, 0}, {1, 0, 0});
+    auto entity1 = make_box(registry, {12, 0, 0}, {-1, 0, 0});
+    ASSERT_NE(worker_of(registry, entity0), worker_of(registry, entity1));
+
+    // Islands that get close are brought into the same worker so they can
+    // collide.
+    auto merged = update_until(registry, [&] {
+        return worker_of(registry, entity0) == worker_of(registry, entity1);
+    });
+    ASSERT_TRUE(merged);
+
+    // Bodies collide and stop instead of going through each other.
+    auto collided = update_until(registry, [&] {
+        return registry.get<edyn::linvel>(entity0).x < edyn::scalar(0.5) &&
+               registry.get<edyn::linvel>(entity1).x > edyn::scalar(-0.5);
+    });
+    ASSERT_TRUE(collided);
+    ASSERT_EQ(worker_of(registry, entity0), worker_of(registry, entity1));
+    ASSERT_LT(registry.get<edyn::position>(entity0).x, registry.get<edyn::position>(entity1).x);
+
+    edyn::detach(registry);
+}
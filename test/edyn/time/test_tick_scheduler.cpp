@@ -0,0 +1,52 @@
+#include "../common/common.hpp"
+#include "edyn/time/tick_scheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static double start_time;
+
+// Time source which advances at half the rate of the real time.
+static double slow_time() {
+    return (edyn::performance_time() - start_time) * 0.5;
+}
+
+// Time source which does not advance.
+static double frozen_time() {
+    return 0;
+}
+
+TEST(test_tick_scheduler, sleep_for) {
+    auto scheduler = edyn::tick_scheduler{};
+    auto t0 = edyn::performance_time();
+    ASSERT_TRUE(scheduler.sleep_for(0.02));
+    ASSERT_GE(edyn::performance_time() - t0, 0.02);
+}
+
+TEST(test_tick_scheduler, custom_time_source) {
+    auto scheduler = edyn::tick_scheduler{};
+    start_time = edyn::performance_time();
+    auto deadline = slow_time() + 0.02;
+
+    ASSERT_TRUE(scheduler.sleep_until(deadline, &slow_time));
+    ASSERT_GE(slow_time(), deadline);
+    // Twice as long in real time.
+    ASSERT_GE(edyn::performance_time() - start_time, 0.04);
+}
+
+TEST(test_tick_scheduler, wake_stalled_time_source) {
+    auto scheduler = edyn::tick_scheduler{};
+    auto woken = std::atomic<bool>{false};
+
+    auto waker = std::thread([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        woken.store(true);
+        scheduler.wake();
+    });
+
+    // Never reaches the deadline since the time source does not advance.
+    ASSERT_FALSE(scheduler.sleep_until(1, &frozen_time));
+    ASSERT_TRUE(woken.load());
+    waker.join();
+}
@@ -0,0 +1,131 @@
+#include "../common/common.hpp"
+#include "edyn/util/convex_decomposition.hpp"
+#include "edyn/util/shape_util.hpp"
+#include "edyn/math/shape_volume.hpp"
+#include <cstdio>
+
+// Appends a closed box to a triangle mesh.
+static void add_box(const edyn::vector3 &center, const edyn::vector3 &half_extents,
+                    std::vector<edyn::vector3> &vertices, std::vector<uint32_t> &indices) {
+    auto box = edyn::convex_mesh{};
+    edyn::make_box_mesh(half_extents, box.vertices, box.indices, box.faces);
+    auto base = static_cast<uint32_t>(vertices.size());
+
+    for (auto &v : box.vertices) {
+        vertices.push_back(v + center);
+    }
+
+    for (size_t i = 0; i < box.num_faces(); ++i) {
+        auto first = box.faces[i * 2];
+        auto count = box.faces[i * 2 + 1];
+
+        for (uint32_t j = 1; j + 1 < count; ++j) {
+            indices.push_back(base + box.indices[first]);
+            indices.push_back(base + box.indices[first + j]);
+            indices.push_back(base + box.indices[first + j + 1]);
+        }
+    }
+}
+
+static edyn::scalar total_volume(const std::vector<edyn::polyhedron_with_center> &polyhedrons) {
+    edyn::scalar volume = 0;
+
+    for (auto &poly : polyhedrons) {
+        volume += edyn::mesh_volume(*poly.shape.mesh);
+    }
+
+    return volume;
+}
+
+TEST(test_convex_decomposition, convex_mesh) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices;
+    add_box({1, 2, 3}, {1, 0.5, 0.25}, vertices, indices);
+
+    auto polyhedrons = edyn::decompose_into_convex_polyhedrons(vertices, indices);
+    ASSERT_EQ(polyhedrons.size(), 1);
+
+    // A single hull with the faces of the box.
+    auto &mesh = *polyhedrons.front().shape.mesh;
+    ASSERT_EQ(mesh.vertices.size(), 8);
+    ASSERT_EQ(mesh.num_faces(), 6);
+    ASSERT_TRUE(mesh.validate());
+    ASSERT_NEAR(polyhedrons.front().center.x, 1, 0.001);
+    ASSERT_NEAR(polyhedrons.front().center.y, 2, 0.001);
+    ASSERT_NEAR(polyhedrons.front().center.z, 3, 0.001);
+    ASSERT_NEAR(total_volume(polyhedrons), 1, 0.01);
+}
+
+TEST(test_convex_decomposition, concave_mesh) {
+    // An L shape made of two overlapping boxes.
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices;
+    add_box({1, 0, 0}, {1.5, 0.5, 0.5}, vertices, indices);
+    add_box({0, 1.5, 0}, {0.5, 2, 0.5}, vertices, indices);
+
+    auto settings = edyn::convex_decomposition_settings{};
+    settings.max_vertices_per_hull = 16;
+    auto polyhedrons = edyn::decompose_into_convex_polyhedrons(vertices, indices, settings);
+
+    ASSERT_GE(polyhedrons.size(), 2);
+    ASSERT_LE(polyhedrons.size(), settings.max_hulls);
+
+    for (auto &poly : polyhedrons) {
+        ASSERT_LE(poly.shape.mesh->vertices.size(), settings.max_vertices_per_hull);
+        ASSERT_TRUE(poly.shape.mesh->validate());
+    }
+
+    // The union has a volume of 3 + 4 - 1. The hulls mostly don't overlap.
+    auto volume = total_volume(polyhedrons);
+    ASSERT_GT(volume, edyn::scalar(5.5));
+    ASSERT_LT(volume, edyn::scalar(7));
+
+    // Limit the number of hulls.
+    settings.max_hulls = 2;
+    polyhedrons = edyn::decompose_into_convex_polyhedrons(vertices, indices, settings);
+    ASSERT_EQ(polyhedrons.size(), 2);
+
+    auto compound = edyn::make_convex_decomposition(vertices, indices, settings);
+    ASSERT_EQ(compound.nodes.size(), 2);
+}
+
+TEST(test_convex_decomposition, cache) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices;
+    add_box({0, 0, 0}, {1, 1, 1}, vertices, indices);
+    add_box({2, 0, 0}, {0.5, 2, 0.5}, vertices, indices);
+
+    auto settings = edyn::convex_decomposition_settings{};
+    settings.resolution = 32;
+    auto path = std::string("convex_decomposition_test.bin");
+    auto polyhedrons = edyn::decompose_into_convex_polyhedrons(vertices, indices, settings);
+    ASSERT_TRUE(edyn::save_convex_decomposition(path, polyhedrons, vertices, indices, settings));
+
+    auto loaded = std::vector<edyn::polyhedron_with_center>{};
+    ASSERT_TRUE(edyn::load_convex_decomposition(path, vertices, indices, settings, loaded));
+    ASSERT_EQ(loaded.size(), polyhedrons.size());
+
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        ASSERT_EQ(loaded[i].shape.mesh->vertices, polyhedrons[i].shape.mesh->vertices);
+        ASSERT_EQ(loaded[i].shape.mesh->faces, polyhedrons[i].shape.mesh->faces);
+        ASSERT_VECTOR3_EQ(loaded[i].center, polyhedrons[i].center);
+    }
+
+    // Loaded hulls are interned, thus loading again shares the meshes.
+    auto reloaded = std::vector<edyn::polyhedron_with_center>{};
+    ASSERT_TRUE(edyn::load_convex_decomposition(path, vertices, indices, settings, reloaded));
+    ASSERT_EQ(reloaded.size(), loaded.size());
+
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        ASSERT_EQ(reloaded[i].shape.mesh, loaded[i].shape.mesh);
+    }
+
+    // The cache is invalidated when the settings or the mesh change.
+    settings.max_hulls = 4;
+    ASSERT_FALSE(edyn::load_convex_decomposition(path, vertices, indices, settings, loaded));
+    settings.max_hulls = 32;
+    vertices[0].x += 1;
+    ASSERT_FALSE(edyn::load_convex_decomposition(path, vertices, indices, settings, loaded));
+
+    std::remove(path.c_str());
+}
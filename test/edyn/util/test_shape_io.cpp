@@ -0,0 +1,148 @@
+#include "../common/common.hpp"
+#include "edyn/util/shape_io.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+TEST(test_shape_io, load_tri_mesh) {
+    auto ss = std::stringstream{};
+    ss << "# comment\n"
+       << "o quad\n"
+       << "v 0 0 0 1 0 0\n"
+       << "v 1.5 0 0 0 1 0\r\n"
+       << "v  1.5 -2e-1 +1\n"
+       << "v\t0 0 1\n"
+       << "vn 0 1 0\n"
+       << "\n"
+       << "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+       << "f -4 -3 -2";
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<edyn::vector3> colors;
+    edyn::load_tri_mesh_from_obj(ss, vertices, indices, &colors);
+
+    ASSERT_EQ(vertices.size(), 4);
+    ASSERT_VECTOR3_EQ(vertices[1], {1.5, 0, 0});
+    ASSERT_VECTOR3_EQ(vertices[2], {1.5, -0.2, 1});
+    ASSERT_EQ(colors.size(), 2);
+    ASSERT_VECTOR3_EQ(colors[1], {0, 1, 0});
+
+    // The quad is triangulated as a fan.
+    auto expected = std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 0, 1, 2};
+    ASSERT_EQ(indices, expected);
+}
+
+TEST(test_shape_io, load_meshes) {
+    auto ss = std::stringstream{};
+    ss << "o first\n"
+       << "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+       << "f 1 2 3\n"
+       << "o second\n"
+       << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+       << "f 4 5 6 7\n";
+
+    std::vector<edyn::obj_mesh> meshes;
+    edyn::load_meshes_from_obj(ss, meshes, {0, 2, 0});
+
+    ASSERT_EQ(meshes.size(), 2);
+    ASSERT_EQ(meshes[0].name, "first");
+    ASSERT_EQ(meshes[1].name, "second");
+    ASSERT_VECTOR3_EQ(meshes[1].vertices[2], {1, 3, 0});
+
+    // Indices are relative to each mesh and faces are not triangulated.
+    auto expected_indices = std::vector<uint32_t>{0, 1, 2, 3};
+    auto expected_faces = std::vector<uint32_t>{0, 4};
+    ASSERT_EQ(meshes[1].indices, expected_indices);
+    ASSERT_EQ(meshes[1].faces, expected_faces);
+}
+
+TEST(test_shape_io, face_indices) {
+    auto text = std::string("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                            "f 1 2 3\nf -4 -2 -1\n");
+
+    // Positive and negative indices refer to the vertices appended from the
+    // file, after the existing ones.
+    std::vector<edyn::vector3> vertices(2, edyn::vector3_zero);
+    std::vector<uint32_t> indices;
+    auto ss = std::stringstream(text);
+    edyn::load_tri_mesh_from_obj(ss, vertices, indices);
+
+    ASSERT_EQ(vertices.size(), 6);
+    auto expected = std::vector<uint32_t>{2, 3, 4, 2, 4, 5};
+    ASSERT_EQ(indices, expected);
+
+    // Indices out of range are rejected.
+    auto filename = "test_shape_io_invalid.obj";
+
+    for (auto face : {"f 1 2 5\n", "f 1 2 -5\n", "f 0 1 2\n"}) {
+        {
+            auto file = std::ofstream(filename);
+            file << text << face;
+        }
+
+        vertices.clear();
+        indices.clear();
+        ASSERT_FALSE(edyn::load_tri_mesh_from_obj(filename, vertices, indices));
+    }
+
+    std::remove(filename);
+
+    // Faces referring to vertices of another object are skipped.
+    auto meshes_ss = std::stringstream();
+    meshes_ss << "o first\n" << text
+              << "o second\n" << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+              << "f 5 6 7\nf 1 2 3\nf -4 -2 -1\n";
+
+    std::vector<edyn::obj_mesh> meshes;
+    edyn::load_meshes_from_obj(meshes_ss, meshes);
+
+    ASSERT_EQ(meshes.size(), 2);
+    auto expected_mesh_indices = std::vector<uint32_t>{0, 1, 2, 0, 2, 3};
+    auto expected_faces = std::vector<uint32_t>{0, 3, 3, 3};
+    ASSERT_EQ(meshes[1].indices, expected_mesh_indices);
+    ASSERT_EQ(meshes[1].faces, expected_faces);
+}
+
+TEST(test_shape_io, load_large_file) {
+    edyn::job_dispatcher::global().start(4);
+
+    // Big enough to be split into multiple chunks which are parsed in
+    // parallel.
+    auto filename = "test_shape_io_large.obj";
+    constexpr size_t num_quads = 1 << 16;
+
+    {
+        auto file = std::ofstream(filename);
+
+        for (size_t i = 0; i < num_quads; ++i) {
+            file << "v " << i << " 0 0\n"
+                 << "v " << i << " 0 1\n"
+                 << "v " << i << ".5 0.25 1\n"
+                 << "v " << i << ".5 0.25 0\n"
+                 << "f -4 -3 -2 -1\n";
+        }
+    }
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(edyn::load_tri_mesh_from_obj(filename, vertices, indices, nullptr,
+                                             edyn::vector3_zero, edyn::quaternion_identity, {2, 2, 2}));
+    std::remove(filename);
+    edyn::job_dispatcher::global().stop();
+
+    ASSERT_EQ(vertices.size(), num_quads * 4);
+    ASSERT_EQ(indices.size(), num_quads * 6);
+
+    for (size_t i = 0; i < num_quads; ++i) {
+        auto x = edyn::scalar(i);
+        ASSERT_VECTOR3_EQ(vertices[i * 4 + 2], {(x + edyn::scalar(0.5)) * 2, 0.5, 2});
+
+        auto base = static_cast<uint32_t>(i * 4);
+        auto expected = std::vector<uint32_t>{base, base + 1, base + 2, base, base + 2, base + 3};
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), indices.begin() + i * 6));
+    }
+
+    ASSERT_FALSE(edyn::load_tri_mesh_from_obj("does_not_exist.obj", vertices, indices));
+}